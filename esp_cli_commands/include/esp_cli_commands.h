@@ -75,6 +75,41 @@ esp_err_t esp_cli_commands_unregister_cmd(const char *cmd_name);
  */
 esp_err_t esp_cli_commands_execute(const char *cmdline, int *cmd_ret, esp_cli_command_set_handle_t cmd_set, esp_cli_commands_exec_arg_t *cmd_args);
 
+/**
+ * @brief Outcome of the execution of a script
+ */
+typedef struct esp_cli_commands_script_result {
+    size_t nb_of_executed_lines;    /*!< Number of lines with a command, executed or not found */
+    size_t nb_of_failed_lines;      /*!< Number of lines with an unknown command or a command returning non-zero */
+    size_t first_failed_line;       /*!< Number of the first failed line, starting at 1, or 0 if no line failed */
+    esp_err_t first_failed_err;     /*!< ESP_ERR_NOT_FOUND if the command of the first failed line is unknown, ESP_OK otherwise */
+    int first_failed_cmd_ret;       /*!< Return value of the command of the first failed line */
+} esp_cli_commands_script_result_t;
+
+/**
+ * @brief Execute the command lines of a script
+ *
+ * The lines are separated by '\n' or "\r\n", and lines without any argument are skipped.
+ * Unlike calling esp_cli_commands_execute() for each line, the configuration is read once
+ * for the whole script, and the command of each distinct name is looked up once, unless
+ * commands are registered or unregistered while the script runs.
+ *
+ * @param script Buffer containing the lines, does not need to be null-terminated
+ * @param script_len Length of the script in bytes
+ * @param cmd_set Set of commands allowed to execute. If NULL, all registered commands are allowed
+ * @param cmd_args Structure containing dynamic arguments passed to every command, so their
+ * output goes through the same write function
+ * @param stop_on_error If true, stop at the first line with an unknown command or a command
+ * returning non-zero
+ * @param[out] result Outcome of the execution, can be NULL
+ * @return ESP_OK if all lines were executed and succeeded
+ *         ESP_FAIL if a line failed, see result for details
+ *         ESP_ERR_INVALID_ARG if the script is NULL
+ */
+esp_err_t esp_cli_commands_execute_script(const char *script, size_t script_len, esp_cli_command_set_handle_t cmd_set,
+                                          esp_cli_commands_exec_arg_t *cmd_args, bool stop_on_error,
+                                          esp_cli_commands_script_result_t *result);
+
 /**
  * @brief Find a command by name within a specific command set.
  *
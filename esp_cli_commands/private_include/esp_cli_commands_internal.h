@@ -9,8 +9,25 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "esp_heap_caps.h"
 
+/**
+ * @brief Hash of a command name (FNV-1a)
+ *
+ * @param name Null-terminated command name
+ * @return uint32_t
+ */
+static inline uint32_t esp_cli_commands_hash_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)(*name++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 /**
  * @brief Component specific implementation of malloc
  *
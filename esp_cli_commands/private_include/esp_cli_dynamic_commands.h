@@ -128,6 +128,33 @@ esp_err_t esp_cli_dynamic_commands_replace(esp_cli_command_t *old_cmd, esp_cli_c
  */
 esp_err_t esp_cli_dynamic_commands_remove(esp_cli_command_t *item_cmd);
 
+/**
+ * @brief Find a dynamically registered command by name.
+ *
+ * The commands are found through a hash table of their names, which is
+ * updated by esp_cli_dynamic_commands_add() and esp_cli_dynamic_commands_remove().
+ *
+ * @param name Name of the command to find.
+ * @return Pointer to the command, or NULL if no command has this name.
+ *
+ * @note The function acquires the lock internally.
+ */
+esp_cli_command_t *esp_cli_dynamic_commands_find(const char *name);
+
+/**
+ * @brief Call the completion callback for every dynamically registered
+ * command starting with the given prefix, in the order of their names.
+ *
+ * @param prefix Prefix of the command names.
+ * @param prefix_len Length of the prefix.
+ * @param cb_ctx Context passed to the completion callback.
+ * @param completion_cb Completion callback.
+ *
+ * @note The function acquires the lock internally and calls the
+ *       completion callback with the lock held.
+ */
+void esp_cli_dynamic_commands_get_completion(const char *prefix, size_t prefix_len, void *cb_ctx, esp_cli_command_get_completion_t completion_cb);
+
 /**
  * @brief Get the number of registered dynamic commands.
  *
@@ -135,6 +162,17 @@ esp_err_t esp_cli_dynamic_commands_remove(esp_cli_command_t *item_cmd);
  */
 size_t esp_cli_dynamic_commands_get_number_of_cmd(void);
 
+/**
+ * @brief Get the generation of the dynamic commands.
+ *
+ * The generation changes every time a command is added, replaced
+ * or removed, so pointers to commands found before are only valid
+ * as long as the generation is the same.
+ *
+ * @return The current generation.
+ */
+uint32_t esp_cli_dynamic_commands_get_generation(void);
+
 #ifdef __cplusplus
 }
 #endif
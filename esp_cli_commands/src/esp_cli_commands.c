@@ -18,6 +18,9 @@
 /* Default foreground color */
 #define ANSI_COLOR_DEFAULT 39
 
+/* Number of commands remembered by esp_cli_commands_execute_script, power of 2 */
+#define SCRIPT_RESOLVED_CMDS_SIZE 32
+
 /* static mutex used to protect access to the static configuration */
 static SemaphoreHandle_t s_esp_cli_commands_mutex = NULL;
 static StaticSemaphore_t s_esp_cli_commands_mutex_buf;
@@ -97,6 +100,62 @@ static inline __attribute__((always_inline)) bool command_is_static(esp_cli_comm
     return false;
 }
 
+/**
+ * @brief check if the statically registered commands are sorted by name
+ *
+ * The linker sorts the .esp_cli_commands section by the name of the input
+ * sections, which embeds the command name (see linker.lf), so the static
+ * commands can be binary searched. This is checked once, on first use.
+ */
+static bool static_commands_are_sorted(void)
+{
+    static int s_static_commands_sorted = -1;
+
+    if (s_static_commands_sorted < 0) {
+        int sorted = 1;
+        for (esp_cli_command_t *cmd = &_esp_cli_commands_start + 1; cmd < &_esp_cli_commands_end; cmd++) {
+            if (strcmp((cmd - 1)->name, cmd->name) > 0) {
+                sorted = 0;
+                break;
+            }
+        }
+        s_static_commands_sorted = sorted;
+    }
+    return s_static_commands_sorted == 1;
+}
+
+/**
+ * @brief get the position of the first static command with a name
+ * greater than or equal to the given name
+ */
+static size_t static_commands_search(const char *name)
+{
+    size_t low = 0;
+    size_t high = ESP_CLI_COMMANDS_COUNT;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (strcmp((&_esp_cli_commands_start)[mid].name, name) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief check if the command is part of the set of command pointers
+ */
+static bool command_is_in_set(const esp_cli_command_set_t *cmd_set, const esp_cli_command_t *cmd)
+{
+    for (size_t i = 0; i < cmd_set->cmd_set_size; i++) {
+        if (cmd_set->cmd_ptr_set[i] == cmd) {
+            return true;
+        }
+    }
+    return false;
+}
+
 typedef bool (*walker_t)(void *walker_ctx, esp_cli_command_t *cmd);
 static inline __attribute__((always_inline))
 void go_through_commands(esp_cli_command_sets_t *cmd_sets, void *cmd_walker_ctx, walker_t cmd_walker)
@@ -247,6 +306,38 @@ esp_err_t esp_cli_commands_unregister_cmd(const char *cmd_name)
     }
 }
 
+/**
+ * @brief call the function of the command found for the command line
+ */
+static void call_command(const esp_cli_command_t *cmd, int *cmd_ret, esp_cli_command_set_handle_t cmd_set,
+                         esp_cli_commands_exec_arg_t *cmd_args, size_t argc, char **argv)
+{
+    if (!cmd->func) {
+        return;
+    }
+
+    if (strcmp("help", cmd->name) == 0) {
+        esp_cli_commands_exec_arg_t help_args;
+
+        /* reuse the out_fd and write_func received as parameter by esp_cli_commands_execute
+         * to allow the help command function to print information on the correct IO. Use
+         * default values in case the parameters provided are not set */
+        help_args.out_fd = (cmd_args && cmd_args->out_fd != -1) ? cmd_args->out_fd : STDOUT_FILENO;
+        help_args.write_func = (cmd_args && cmd_args->write_func) ? cmd_args->write_func : write;
+
+        /* the help command needs the cmd_set to be able to only print the help for commands
+         * in the user set of commands */
+        help_args.dynamic_ctx = cmd_set;
+
+        /* call the help command function with the specific dynamic context */
+        *cmd_ret = (*cmd->func)(cmd->func_ctx, &help_args, argc, argv);
+    } else {
+        /* regular command function has to be called, just passed the cmd_args as provided
+         * to the esp_cli_commands_execute function */
+        *cmd_ret = (*cmd->func)(cmd->func_ctx, cmd_args, argc, argv);
+    }
+}
+
 esp_err_t esp_cli_commands_execute(const char *cmdline, int *cmd_ret, esp_cli_command_set_handle_t cmd_set, esp_cli_commands_exec_arg_t *cmd_args)
 {
     esp_cli_commands_lock();
@@ -273,15 +364,10 @@ esp_err_t esp_cli_commands_execute(const char *cmdline, int *cmd_ret, esp_cli_co
     /* try to find the command from the first argument in the command line */
     const esp_cli_command_t *cmd = NULL;
     esp_cli_command_sets_t *temp_set = cmd_set;
-    bool is_cmd_help = false;
     if (strcmp("help", argv[0]) == 0) {
         /* set the set to NULL because the help is not in the set passed by the user
          * since this command is registered by esp_cli_commands itself */
         temp_set = (esp_cli_command_sets_t *)NULL;
-
-        /* keep in mind that the command being executed is the help. This is needed
-         * when calling the help command function, to pass a specific dynamic context */
-        is_cmd_help = true;
     }
     cmd = esp_cli_commands_find_command(temp_set, argv[0]);
 
@@ -289,29 +375,144 @@ esp_err_t esp_cli_commands_execute(const char *cmdline, int *cmd_ret, esp_cli_co
         return ESP_ERR_NOT_FOUND;
     }
 
-    if (cmd->func) {
-        if (is_cmd_help) {
-            esp_cli_commands_exec_arg_t help_args;
+    call_command(cmd, cmd_ret, cmd_set, cmd_args, argc, argv);
+    return ESP_OK;
+}
 
-            /* reuse the out_fd and write_func received as parameter by esp_cli_commands_execute
-             * to allow the help command function to print information on the correct IO. Use
-             * default values in case the parameters provided are not set */
-            help_args.out_fd = (cmd_args && cmd_args->out_fd != -1) ? cmd_args->out_fd : STDOUT_FILENO;
-            help_args.write_func = (cmd_args && cmd_args->write_func) ? cmd_args->write_func : write;
+esp_err_t esp_cli_commands_execute_script(const char *script, size_t script_len, esp_cli_command_set_handle_t cmd_set,
+                                          esp_cli_commands_exec_arg_t *cmd_args, bool stop_on_error,
+                                          esp_cli_commands_script_result_t *result)
+{
+    if (!script) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-            /* the help command needs the cmd_set to be able to only print the help for commands
-             * in the user set of commands */
-            help_args.dynamic_ctx = cmd_set;
+    esp_cli_commands_script_result_t temp_result;
+    if (!result) {
+        result = &temp_result;
+    }
+    memset(result, 0x00, sizeof(esp_cli_commands_script_result_t));
 
-            /* call the help command function with the specific dynamic context */
-            *cmd_ret = (*cmd->func)(cmd->func_ctx, &help_args, argc, argv);
-        } else {
-            /* regular command function has to be called, just passed the cmd_args as provided
-             * to the esp_cli_commands_execute function */
-            *cmd_ret = (*cmd->func)(cmd->func_ctx, cmd_args, argc, argv);
+    /* one copy of the configuration for all the lines */
+    esp_cli_commands_lock();
+    const size_t copy_max_cmdline_args = s_config.max_cmdline_args;
+    const size_t copy_max_cmdline_length = s_config.max_cmdline_length;
+    esp_cli_commands_unlock();
+
+    /* the buffers are reused from line to line, the parsing of a line does not need them to be zeroed */
+    char *argv[copy_max_cmdline_args];
+    char tmp_line_buf[copy_max_cmdline_length];
+
+    /* commands found for the previous lines, indexed by the hash of their name. A command
+     * could be unregistered by a line of the script, so they are forgotten every time the
+     * dynamic commands change */
+    const esp_cli_command_t *resolved_cmds[SCRIPT_RESOLVED_CMDS_SIZE];
+    memset(resolved_cmds, 0x00, sizeof(resolved_cmds));
+    uint32_t generation = esp_cli_dynamic_commands_get_generation();
+
+    esp_err_t ret_val = ESP_OK;
+    const char *script_end = script + script_len;
+    const char *line = script;
+    size_t line_nb = 0;
+    while (line < script_end) {
+        const char *line_end = memchr(line, '\n', script_end - line);
+        if (!line_end) {
+            line_end = script_end;
+        }
+        size_t line_len = line_end - line;
+        if (line_len > 0 && line[line_len - 1] == '\r') {
+            line_len--;
+        }
+
+        /* copy the line into the temp buffer, truncated as by esp_cli_commands_execute */
+        if (line_len > copy_max_cmdline_length - 1) {
+            line_len = copy_max_cmdline_length - 1;
+        }
+        memcpy(tmp_line_buf, line, line_len);
+        tmp_line_buf[line_len] = '\0';
+        /* the last line may end without a newline, do not advance past the end of the script */
+        line = (line_end < script_end) ? line_end + 1 : script_end;
+        line_nb++;
+
+        const size_t argc = esp_cli_commands_split_argv(tmp_line_buf, argv, copy_max_cmdline_args);
+        if (argc == 0) {
+            continue;
+        }
+
+        const uint32_t current_generation = esp_cli_dynamic_commands_get_generation();
+        if (current_generation != generation) {
+            memset(resolved_cmds, 0x00, sizeof(resolved_cmds));
+            generation = current_generation;
+        }
+        const size_t slot = esp_cli_commands_hash_name(argv[0]) & (SCRIPT_RESOLVED_CMDS_SIZE - 1);
+        const esp_cli_command_t *cmd = resolved_cmds[slot];
+        if (!cmd || strcmp(cmd->name, argv[0]) != 0) {
+            /* the help command is found even if it is not in the set */
+            cmd = esp_cli_commands_find_command(cmd_set, argv[0]);
+            if (cmd) {
+                resolved_cmds[slot] = cmd;
+            }
+        }
+
+        result->nb_of_executed_lines++;
+        esp_err_t exec_ret = ESP_ERR_NOT_FOUND;
+        int cmd_ret = 0;
+        if (cmd) {
+            call_command(cmd, &cmd_ret, cmd_set, cmd_args, argc, argv);
+            exec_ret = ESP_OK;
+        }
+
+        if (exec_ret != ESP_OK || cmd_ret != 0) {
+            if (result->nb_of_failed_lines == 0) {
+                result->first_failed_line = line_nb;
+                result->first_failed_err = exec_ret;
+                result->first_failed_cmd_ret = cmd_ret;
+            }
+            result->nb_of_failed_lines++;
+            ret_val = ESP_FAIL;
+            if (stop_on_error) {
+                break;
+            }
         }
     }
-    return ESP_OK;
+
+    return ret_val;
+}
+
+/**
+ * @brief find the command with the given name among all registered commands
+ * if cmd_sets is NULL, or among the commands of cmd_sets otherwise
+ */
+static esp_cli_command_t *find_command(esp_cli_command_sets_t *cmd_sets, const char *name)
+{
+    if (!static_commands_are_sorted()) {
+        find_cmd_ctx_t ctx = { .cmd = NULL, .name = name };
+        go_through_commands(cmd_sets, &ctx, compare_command_name);
+
+        /* if command was found during the walk, cmd field will be populated with
+         * the command matching the name given in parameter, otherwise it will still
+         * be NULL (value set as default value above) */
+        return ctx.cmd;
+    }
+
+    /* several static commands can have the same name if they are registered in
+     * different files, return the first one which is part of the set. As in
+     * go_through_commands, a set without static commands does not filter them */
+    for (size_t i = static_commands_search(name); i < ESP_CLI_COMMANDS_COUNT; i++) {
+        esp_cli_command_t *cmd = &_esp_cli_commands_start + i;
+        if (strcmp(cmd->name, name) != 0) {
+            break;
+        }
+        if (!cmd_sets || !cmd_sets->static_set.cmd_ptr_set || command_is_in_set(&cmd_sets->static_set, cmd)) {
+            return cmd;
+        }
+    }
+
+    esp_cli_command_t *cmd = esp_cli_dynamic_commands_find(name);
+    if (cmd && cmd_sets && !command_is_in_set(&cmd_sets->dynamic_set, cmd)) {
+        return NULL;
+    }
+    return cmd;
 }
 
 esp_cli_command_t *esp_cli_commands_find_command(esp_cli_command_set_handle_t cmd_set, const char *name)
@@ -322,20 +523,16 @@ esp_cli_command_t *esp_cli_commands_find_command(esp_cli_command_set_handle_t cm
         return NULL;
     }
 
-    find_cmd_ctx_t ctx = { .cmd = NULL, .name = name };
-    go_through_commands(cmd_set, &ctx, compare_command_name);
+    esp_cli_command_t *cmd = find_command(cmd_set, name);
 
     /* The "help" command is a built-in registered by esp_cli_commands itself.
      * It must always be found regardless of the command set passed by the user.
      * If not found in the filtered set, search all commands. */
-    if (!ctx.cmd && cmd_set != NULL && strcmp(name, "help") == 0) {
-        go_through_commands(NULL, &ctx, compare_command_name);
+    if (!cmd && cmd_set != NULL && strcmp(name, "help") == 0) {
+        cmd = find_command(NULL, name);
     }
 
-    /* if command was found during the walk, cmd field will be populated with
-     * the command matching the name given in parameter, otherwise it will still
-     * be NULL (value set as default value above) */
-    return ctx.cmd;
+    return cmd;
 }
 typedef struct create_cmd_set_ctx {
     esp_cli_commands_get_field_t get_field;
@@ -540,13 +737,26 @@ void esp_cli_commands_get_completion(esp_cli_command_set_handle_t cmd_set, const
         return;
     }
 
-    call_completion_cb_ctx_t ctx = {
-        .buf = buf,
-        .buf_len = len,
-        .cb_ctx = cb_ctx,
-        .completion_cb = completion_cb
-    };
-    go_through_commands(cmd_set, &ctx, call_completion_cb);
+    if (!cmd_set && static_commands_are_sorted()) {
+        /* the commands starting with buf follow each other in the sorted
+         * static commands and in the sorted dynamic commands */
+        for (size_t i = static_commands_search(buf); i < ESP_CLI_COMMANDS_COUNT; i++) {
+            const esp_cli_command_t *cmd = &_esp_cli_commands_start + i;
+            if (strncmp(cmd->name, buf, len) != 0) {
+                break;
+            }
+            completion_cb(cb_ctx, cmd->name);
+        }
+        esp_cli_dynamic_commands_get_completion(buf, len, cb_ctx, completion_cb);
+    } else {
+        call_completion_cb_ctx_t ctx = {
+            .buf = buf,
+            .buf_len = len,
+            .cb_ctx = cb_ctx,
+            .completion_cb = completion_cb
+        };
+        go_through_commands(cmd_set, &ctx, call_completion_cb);
+    }
 
     /* The "help" command is a built-in that must always be completable
      * regardless of the command set */
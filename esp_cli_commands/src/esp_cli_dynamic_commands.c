@@ -8,6 +8,8 @@
 #include <ctype.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "esp_cli_commands_internal.h"
@@ -17,11 +19,27 @@
 #define CONTAINER_OF(ptr, type, member) \
     ((type *)((char *)(ptr) - offsetof(type, member)))
 
+/* Minimum size of the sorted array and of the hash table of the index */
+#define DYNAMIC_CMD_INDEX_MIN_CAPACITY 8
+#define DYNAMIC_CMD_INDEX_MIN_SLOTS 16
+
 static esp_cli_command_internal_ll_t s_dynamic_cmd_list = SLIST_HEAD_INITIALIZER(esp_cli_command_internal);
 static size_t s_number_of_registered_commands = 0;
+/* incremented every time a command is added, replaced or removed */
+static uint32_t s_generation = 0;
 static SemaphoreHandle_t s_esp_cli_commands_dyn_mutex = NULL;
 static StaticSemaphore_t s_esp_cli_commands_dyn_mutex_buf;
 
+/* Index of the dynamic commands, allocated while at least one command is registered.
+ * s_sorted_cmds holds the commands in the order of s_dynamic_cmd_list, which is sorted
+ * by name, and s_cmd_slots is a hash table of the same commands with linear probing,
+ * at most half full. If the index cannot be allocated, the list is walked instead and
+ * the index is built again on next use. */
+static esp_cli_command_t **s_sorted_cmds = NULL;
+static size_t s_sorted_cmds_capacity = 0;
+static esp_cli_command_t **s_cmd_slots = NULL;
+static size_t s_cmd_slots_mask = 0;
+
 void esp_cli_dynamic_commands_lock(void)
 {
     /* check if the mutex needs to be initialized and initialized it only
@@ -47,6 +65,148 @@ const esp_cli_command_internal_ll_t *esp_cli_dynamic_commands_get_list(void)
     return &s_dynamic_cmd_list;
 }
 
+static void index_free(void)
+{
+    free(s_sorted_cmds);
+    free(s_cmd_slots);
+    s_sorted_cmds = NULL;
+    s_sorted_cmds_capacity = 0;
+    s_cmd_slots = NULL;
+    s_cmd_slots_mask = 0;
+}
+
+static void index_slots_insert(esp_cli_command_t **slots, size_t mask, esp_cli_command_t *cmd)
+{
+    size_t i = esp_cli_commands_hash_name(cmd->name) & mask;
+    while (slots[i]) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = cmd;
+}
+
+/**
+ * @brief Position of the first command with a name greater than or equal to name,
+ * or greater than name if after_equal is true
+ */
+static size_t index_search(const char *name, bool after_equal)
+{
+    size_t low = 0;
+    size_t high = s_number_of_registered_commands;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int cmp = strcmp(s_sorted_cmds[mid]->name, name);
+        if (cmp < 0 || (after_equal && cmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Make room in the index for nb_of_cmd commands
+ */
+static bool index_reserve(size_t nb_of_cmd)
+{
+    if (nb_of_cmd > s_sorted_cmds_capacity) {
+        size_t capacity = s_sorted_cmds_capacity ? s_sorted_cmds_capacity * 2 : DYNAMIC_CMD_INDEX_MIN_CAPACITY;
+        while (capacity < nb_of_cmd) {
+            capacity *= 2;
+        }
+        esp_cli_command_t **sorted_cmds = esp_cli_commands_malloc(capacity * sizeof(esp_cli_command_t *));
+        if (!sorted_cmds) {
+            return false;
+        }
+        if (s_sorted_cmds) {
+            memcpy(sorted_cmds, s_sorted_cmds, s_number_of_registered_commands * sizeof(esp_cli_command_t *));
+            free(s_sorted_cmds);
+        }
+        s_sorted_cmds = sorted_cmds;
+        s_sorted_cmds_capacity = capacity;
+    }
+
+    if (!s_cmd_slots || nb_of_cmd * 2 > s_cmd_slots_mask + 1) {
+        size_t nb_of_slots = DYNAMIC_CMD_INDEX_MIN_SLOTS;
+        while (nb_of_slots < nb_of_cmd * 2) {
+            nb_of_slots *= 2;
+        }
+        esp_cli_command_t **slots = esp_cli_commands_malloc(nb_of_slots * sizeof(esp_cli_command_t *));
+        if (!slots) {
+            return false;
+        }
+        memset(slots, 0x00, nb_of_slots * sizeof(esp_cli_command_t *));
+        for (size_t i = 0; i < s_number_of_registered_commands; i++) {
+            index_slots_insert(slots, nb_of_slots - 1, s_sorted_cmds[i]);
+        }
+        free(s_cmd_slots);
+        s_cmd_slots = slots;
+        s_cmd_slots_mask = nb_of_slots - 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Build the index from the list if it is not there
+ *
+ * @return false if the index cannot be allocated
+ */
+static bool index_build(void)
+{
+    if (s_sorted_cmds || s_number_of_registered_commands == 0) {
+        return true;
+    }
+
+    size_t capacity = DYNAMIC_CMD_INDEX_MIN_CAPACITY;
+    while (capacity < s_number_of_registered_commands) {
+        capacity *= 2;
+    }
+    s_sorted_cmds = esp_cli_commands_malloc(capacity * sizeof(esp_cli_command_t *));
+    if (!s_sorted_cmds) {
+        return false;
+    }
+    s_sorted_cmds_capacity = capacity;
+
+    size_t i = 0;
+    esp_cli_command_internal_t *it = NULL;
+    SLIST_FOREACH(it, &s_dynamic_cmd_list, next_item) {
+        s_sorted_cmds[i++] = &it->cmd;
+    }
+
+    /* allocate the hash table and fill it from the sorted array */
+    if (!index_reserve(s_number_of_registered_commands)) {
+        index_free();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Remove the command at position pos of the sorted array from the index
+ */
+static void index_remove(size_t pos)
+{
+    esp_cli_command_t *cmd = s_sorted_cmds[pos];
+    memmove(&s_sorted_cmds[pos], &s_sorted_cmds[pos + 1],
+            (s_number_of_registered_commands - pos - 1) * sizeof(esp_cli_command_t *));
+
+    size_t hole = esp_cli_commands_hash_name(cmd->name) & s_cmd_slots_mask;
+    while (s_cmd_slots[hole] != cmd) {
+        hole = (hole + 1) & s_cmd_slots_mask;
+    }
+    /* move back the following commands of the probe sequence, unless their
+     * hash points between the hole and their slot */
+    size_t i = hole;
+    while (s_cmd_slots[i = (i + 1) & s_cmd_slots_mask]) {
+        const size_t home = esp_cli_commands_hash_name(s_cmd_slots[i]->name) & s_cmd_slots_mask;
+        if (((i - home) & s_cmd_slots_mask) >= ((i - hole) & s_cmd_slots_mask)) {
+            s_cmd_slots[hole] = s_cmd_slots[i];
+            hole = i;
+        }
+    }
+    s_cmd_slots[hole] = NULL;
+}
+
 esp_err_t esp_cli_dynamic_commands_add(esp_cli_command_t *cmd)
 {
     if (!cmd) {
@@ -67,11 +227,25 @@ esp_err_t esp_cli_dynamic_commands_add(esp_cli_command_t *cmd)
      * mutex is initialized */
     esp_cli_dynamic_commands_lock();
 
-    SLIST_FOREACH(it, &s_dynamic_cmd_list, next_item) {
-        if (strcmp(it->cmd.name, list_item->cmd.name) > 0) {
-            break;
+    if (index_build() && index_reserve(s_number_of_registered_commands + 1)) {
+        /* the new command goes after the commands with a lower or equal name,
+         * the one before it in the sorted array is the one before it in the list */
+        const size_t pos = index_search(list_item->cmd.name, true);
+        if (pos > 0) {
+            last = CONTAINER_OF(s_sorted_cmds[pos - 1], esp_cli_command_internal_t, cmd);
+        }
+        memmove(&s_sorted_cmds[pos + 1], &s_sorted_cmds[pos],
+                (s_number_of_registered_commands - pos) * sizeof(esp_cli_command_t *));
+        s_sorted_cmds[pos] = &list_item->cmd;
+        index_slots_insert(s_cmd_slots, s_cmd_slots_mask, &list_item->cmd);
+    } else {
+        index_free();
+        SLIST_FOREACH(it, &s_dynamic_cmd_list, next_item) {
+            if (strcmp(it->cmd.name, list_item->cmd.name) > 0) {
+                break;
+            }
+            last = it;
         }
-        last = it;
     }
 
     if (last == NULL) {
@@ -81,6 +255,7 @@ esp_err_t esp_cli_dynamic_commands_add(esp_cli_command_t *cmd)
     }
 
     s_number_of_registered_commands++;
+    s_generation++;
 
     esp_cli_dynamic_commands_unlock();
 
@@ -93,6 +268,7 @@ esp_err_t esp_cli_dynamic_commands_replace(esp_cli_command_t *old_cmd, esp_cli_c
 
     esp_cli_command_internal_t *list_item = CONTAINER_OF(old_cmd, esp_cli_command_internal_t, cmd);
     memcpy(&list_item->cmd, new_cmd, sizeof(esp_cli_command_t));
+    s_generation++;
 
     esp_cli_dynamic_commands_unlock();
 
@@ -104,9 +280,35 @@ esp_err_t esp_cli_dynamic_commands_remove(esp_cli_command_t *item_cmd)
     esp_cli_dynamic_commands_lock();
 
     esp_cli_command_internal_t *list_item = CONTAINER_OF(item_cmd, esp_cli_command_internal_t, cmd);
-    SLIST_REMOVE(&s_dynamic_cmd_list, list_item, esp_cli_command_internal, next_item);
+
+    size_t pos = SIZE_MAX;
+    if (index_build()) {
+        for (size_t i = index_search(item_cmd->name, false); i < s_number_of_registered_commands; i++) {
+            if (s_sorted_cmds[i] == item_cmd) {
+                pos = i;
+                break;
+            }
+        }
+    }
+
+    if (pos == 0) {
+        SLIST_REMOVE_HEAD(&s_dynamic_cmd_list, next_item);
+        index_remove(pos);
+    } else if (pos != SIZE_MAX) {
+        /* the command before it in the sorted array is the one before it in the list */
+        esp_cli_command_internal_t *prev = CONTAINER_OF(s_sorted_cmds[pos - 1], esp_cli_command_internal_t, cmd);
+        SLIST_NEXT(prev, next_item) = SLIST_NEXT(list_item, next_item);
+        index_remove(pos);
+    } else {
+        SLIST_REMOVE(&s_dynamic_cmd_list, list_item, esp_cli_command_internal, next_item);
+        index_free();
+    }
 
     s_number_of_registered_commands--;
+    s_generation++;
+    if (s_number_of_registered_commands == 0) {
+        index_free();
+    }
 
     esp_cli_dynamic_commands_unlock();
 
@@ -115,6 +317,57 @@ esp_err_t esp_cli_dynamic_commands_remove(esp_cli_command_t *item_cmd)
     return ESP_OK;
 }
 
+esp_cli_command_t *esp_cli_dynamic_commands_find(const char *name)
+{
+    esp_cli_command_t *cmd = NULL;
+
+    esp_cli_dynamic_commands_lock();
+
+    if (index_build()) {
+        if (s_cmd_slots) {
+            size_t i = esp_cli_commands_hash_name(name) & s_cmd_slots_mask;
+            while (s_cmd_slots[i] && strcmp(s_cmd_slots[i]->name, name) != 0) {
+                i = (i + 1) & s_cmd_slots_mask;
+            }
+            cmd = s_cmd_slots[i];
+        }
+    } else {
+        esp_cli_command_internal_t *it = NULL;
+        SLIST_FOREACH(it, &s_dynamic_cmd_list, next_item) {
+            if (strcmp(it->cmd.name, name) == 0) {
+                cmd = &it->cmd;
+                break;
+            }
+        }
+    }
+
+    esp_cli_dynamic_commands_unlock();
+
+    return cmd;
+}
+
+void esp_cli_dynamic_commands_get_completion(const char *prefix, size_t prefix_len, void *cb_ctx, esp_cli_command_get_completion_t completion_cb)
+{
+    esp_cli_dynamic_commands_lock();
+
+    if (index_build()) {
+        for (size_t i = index_search(prefix, false);
+                i < s_number_of_registered_commands && strncmp(s_sorted_cmds[i]->name, prefix, prefix_len) == 0;
+                i++) {
+            completion_cb(cb_ctx, s_sorted_cmds[i]->name);
+        }
+    } else {
+        esp_cli_command_internal_t *it = NULL;
+        SLIST_FOREACH(it, &s_dynamic_cmd_list, next_item) {
+            if (strncmp(it->cmd.name, prefix, prefix_len) == 0) {
+                completion_cb(cb_ctx, it->cmd.name);
+            }
+        }
+    }
+
+    esp_cli_dynamic_commands_unlock();
+}
+
 size_t esp_cli_dynamic_commands_get_number_of_cmd(void)
 {
     esp_cli_dynamic_commands_lock();
@@ -122,3 +375,11 @@ size_t esp_cli_dynamic_commands_get_number_of_cmd(void)
     esp_cli_dynamic_commands_unlock();
     return nb_of_registered_cmd;
 }
+
+uint32_t esp_cli_dynamic_commands_get_generation(void)
+{
+    esp_cli_dynamic_commands_lock();
+    uint32_t generation = s_generation;
+    esp_cli_dynamic_commands_unlock();
+    return generation;
+}
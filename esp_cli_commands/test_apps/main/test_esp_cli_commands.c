@@ -6,9 +6,17 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <pthread.h>
+#include "sdkconfig.h"
 #include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
 #include "esp_heap_caps.h"
 #include "esp_cli_commands.h"
 #include "test_esp_cli_commands_utils.h"
@@ -459,3 +467,405 @@ TEST_CASE("test hint and glossary callbacks", "[esp_cli_commands]")
 
     esp_cli_commands_destroy_cmd_set(&handle_set);
 }
+
+#define TEST_MANY_CMDS_NB 300
+#define TEST_MANY_CMDS_NAME_SIZE 16
+
+typedef struct completion_order_ctx {
+    size_t nb_of_calls;
+    char last_name[TEST_MANY_CMDS_NAME_SIZE];
+    bool in_order;
+} completion_order_ctx_t;
+
+/* the static commands are completed in order, then the dynamic ones */
+static void test_completion_order_cb(void *cb_ctx, const char *completed_cmd_name)
+{
+    completion_order_ctx_t *ctx = (completion_order_ctx_t *)cb_ctx;
+    if (ctx->nb_of_calls > 0 && strcmp(ctx->last_name, completed_cmd_name) > 0) {
+        ctx->in_order = false;
+    }
+    strlcpy(ctx->last_name, completed_cmd_name, sizeof(ctx->last_name));
+    ctx->nb_of_calls++;
+}
+
+static size_t test_completion_count(esp_cli_command_set_handle_t cmd_set, const char *buf)
+{
+    completion_order_ctx_t ctx = { .nb_of_calls = 0, .in_order = true };
+    esp_cli_commands_get_completion(cmd_set, buf, &ctx, test_completion_order_cb);
+    TEST_ASSERT_TRUE(ctx.in_order);
+    return ctx.nb_of_calls;
+}
+
+static void test_register_many_cmds(char (*names)[TEST_MANY_CMDS_NAME_SIZE], size_t nb_cmds)
+{
+    /* register the commands out of order */
+    for (size_t i = 0; i < nb_cmds; i++) {
+        const size_t j = (i * 7919) % nb_cmds;
+        snprintf(names[j], TEST_MANY_CMDS_NAME_SIZE, "diag_%03u", (unsigned)j);
+        esp_cli_command_t cmd = {
+            .name = names[j],
+            .group = "diag",
+            .help = "dummy help",
+            .func = dummy_cmd_func,
+            .func_ctx = names[j],
+            .hint_cb = NULL,
+            .glossary_cb = NULL
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_register_cmd(&cmd));
+    }
+}
+
+TEST_CASE("test lookup and completion with many commands", "[esp_cli_commands]")
+{
+    test_setup();
+
+    char (*names)[TEST_MANY_CMDS_NAME_SIZE] = malloc(TEST_MANY_CMDS_NB * TEST_MANY_CMDS_NAME_SIZE);
+    TEST_ASSERT_NOT_NULL(names);
+    test_register_many_cmds(names, TEST_MANY_CMDS_NB);
+
+    for (size_t i = 0; i < TEST_MANY_CMDS_NB; i++) {
+        esp_cli_command_t *cmd = esp_cli_commands_find_command(NULL, names[i]);
+        TEST_ASSERT_NOT_NULL(cmd);
+        TEST_ASSERT_EQUAL_PTR(names[i], cmd->func_ctx);
+    }
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(NULL, "diag_300"));
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(NULL, "diag_"));
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(NULL, "diag_0000"));
+    TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(NULL, "cmd_c"));
+    TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(NULL, "help"));
+
+    /* static commands cannot be replaced, dynamic ones are replaced in place */
+    esp_cli_command_t cmd = {
+        .name = "cmd_c",
+        .group = "diag",
+        .help = "replaced help",
+        .func = dummy_cmd_func,
+    };
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_register_cmd(&cmd));
+    esp_cli_command_t *replaced_cmd = esp_cli_commands_find_command(NULL, names[5]);
+    cmd.name = names[5];
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_register_cmd(&cmd));
+    TEST_ASSERT_EQUAL_PTR(replaced_cmd, esp_cli_commands_find_command(NULL, names[5]));
+    TEST_ASSERT_EQUAL_STRING("replaced help", replaced_cmd->help);
+
+    TEST_ASSERT_EQUAL(TEST_MANY_CMDS_NB, test_completion_count(NULL, "diag_"));
+    TEST_ASSERT_EQUAL(TEST_MANY_CMDS_NB, test_completion_count(NULL, "d"));
+    TEST_ASSERT_EQUAL(100, test_completion_count(NULL, "diag_1"));
+    TEST_ASSERT_EQUAL(10, test_completion_count(NULL, "diag_29"));
+    TEST_ASSERT_EQUAL(1, test_completion_count(NULL, "diag_299"));
+    TEST_ASSERT_EQUAL(0, test_completion_count(NULL, "diag_3"));
+    TEST_ASSERT_EQUAL(8, test_completion_count(NULL, "cmd_"));
+    TEST_ASSERT_EQUAL(1, test_completion_count(NULL, "he"));
+
+    /* lookup in a set */
+    const char *set[] = {"diag_010", "cmd_a"};
+    esp_cli_command_set_handle_t handle_set = ESP_CLI_COMMANDS_CREATE_CMD_SET(set, ESP_CLI_COMMAND_FIELD_ACCESSOR(name));
+    TEST_ASSERT_NOT_NULL(handle_set);
+    TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(handle_set, "diag_010"));
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(handle_set, "diag_011"));
+    TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(handle_set, "cmd_a"));
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(handle_set, "cmd_b"));
+    TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(handle_set, "help"));
+    esp_cli_commands_destroy_cmd_set(&handle_set);
+
+    /* unregister every other command */
+    for (size_t i = 0; i < TEST_MANY_CMDS_NB; i += 2) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd(names[i]));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_cli_commands_unregister_cmd(names[0]));
+    for (size_t i = 0; i < TEST_MANY_CMDS_NB; i++) {
+        int cmd_ret = -1;
+        TEST_ASSERT_EQUAL(i % 2 ? ESP_OK : ESP_ERR_NOT_FOUND, esp_cli_commands_execute(names[i], &cmd_ret, NULL, NULL));
+        TEST_ASSERT_EQUAL(i % 2 ? 0 : -1, cmd_ret);
+    }
+    TEST_ASSERT_EQUAL(50, test_completion_count(NULL, "diag_1"));
+
+    /* a set is created by going through the list of dynamic commands, which stays sorted */
+    const char *group_set[] = {"diag"};
+    handle_set = ESP_CLI_COMMANDS_CREATE_CMD_SET(group_set, ESP_CLI_COMMAND_FIELD_ACCESSOR(group));
+    TEST_ASSERT_NOT_NULL(handle_set);
+    TEST_ASSERT_EQUAL(TEST_MANY_CMDS_NB / 2, test_completion_count(handle_set, "diag_"));
+    esp_cli_commands_destroy_cmd_set(&handle_set);
+
+    for (size_t i = 1; i < TEST_MANY_CMDS_NB; i += 2) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd(names[i]));
+    }
+    TEST_ASSERT_EQUAL(0, test_completion_count(NULL, "diag_"));
+    TEST_ASSERT_NULL(esp_cli_commands_find_command(NULL, names[1]));
+
+    free(names);
+}
+
+#define TEST_BENCHMARK_CMDS_NB 500
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT "ns"
+#else
+#define TEST_BENCHMARK_UNIT "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+static void test_completion_nop_cb(void *cb_ctx, const char *completed_cmd_name)
+{
+    (*(size_t *)cb_ctx)++;
+}
+
+TEST_CASE("test lookup and completion benchmark", "[esp_cli_commands][benchmark]")
+{
+    test_setup();
+
+    char (*names)[TEST_MANY_CMDS_NAME_SIZE] = malloc(TEST_BENCHMARK_CMDS_NB * TEST_MANY_CMDS_NAME_SIZE);
+    TEST_ASSERT_NOT_NULL(names);
+    uint64_t start = test_benchmark_now();
+    test_register_many_cmds(names, TEST_BENCHMARK_CMDS_NB);
+    const uint64_t register_time = test_benchmark_now() - start;
+
+    start = test_benchmark_now();
+    for (size_t i = 0; i < TEST_BENCHMARK_CMDS_NB; i++) {
+        TEST_ASSERT_NOT_NULL(esp_cli_commands_find_command(NULL, names[i]));
+    }
+    const uint64_t find_time = test_benchmark_now() - start;
+
+    /* every command is completed once */
+    size_t nb_of_completions = 0;
+    char prefix[TEST_MANY_CMDS_NAME_SIZE];
+    start = test_benchmark_now();
+    for (size_t i = 0; i < TEST_BENCHMARK_CMDS_NB / 10; i++) {
+        snprintf(prefix, sizeof(prefix), "diag_%02u", (unsigned)i);
+        esp_cli_commands_get_completion(NULL, prefix, &nb_of_completions, test_completion_nop_cb);
+    }
+    const uint64_t completion_time = test_benchmark_now() - start;
+    TEST_ASSERT_EQUAL(TEST_BENCHMARK_CMDS_NB, nb_of_completions);
+
+    int cmd_ret;
+    start = test_benchmark_now();
+    for (size_t i = 0; i < TEST_BENCHMARK_CMDS_NB; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute(names[i], &cmd_ret, NULL, NULL));
+    }
+    const uint64_t execute_time = test_benchmark_now() - start;
+
+    printf("%d commands, per command: register %" PRIu64 ", find %" PRIu64 ", execute %" PRIu64
+           ", per completion: %" PRIu64 " " TEST_BENCHMARK_UNIT "\n", TEST_BENCHMARK_CMDS_NB,
+           register_time / TEST_BENCHMARK_CMDS_NB, find_time / TEST_BENCHMARK_CMDS_NB,
+           execute_time / TEST_BENCHMARK_CMDS_NB, completion_time / (TEST_BENCHMARK_CMDS_NB / 10));
+
+    for (size_t i = 0; i < TEST_BENCHMARK_CMDS_NB; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd(names[i]));
+    }
+    free(names);
+}
+
+typedef struct script_output {
+    char buf[256];
+    size_t len;
+} script_output_t;
+
+static script_output_t s_script_output;
+
+static ssize_t test_script_write(int fd, const void *buf, size_t count)
+{
+    TEST_ASSERT_EQUAL(-2, fd);
+    TEST_ASSERT_LESS_THAN(sizeof(s_script_output.buf), s_script_output.len + count);
+    memcpy(s_script_output.buf + s_script_output.len, buf, count);
+    s_script_output.len += count;
+    s_script_output.buf[s_script_output.len] = '\0';
+    return count;
+}
+
+/* prints its arguments and returns the first one */
+static int test_script_echo_func(void *context, esp_cli_commands_exec_arg_t *cmd_args, int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        cmd_args->write_func(cmd_args->out_fd, argv[i], strlen(argv[i]));
+        cmd_args->write_func(cmd_args->out_fd, i + 1 < argc ? " " : "\n", 1);
+    }
+    return argc > 1 ? atoi(argv[1]) : 0;
+}
+
+static int test_script_unregister_func(void *context, esp_cli_commands_exec_arg_t *cmd_args, int argc, char **argv)
+{
+    return esp_cli_commands_unregister_cmd(argv[1]) == ESP_OK ? 0 : 1;
+}
+
+TEST_CASE("test script execution", "[esp_cli_commands]")
+{
+    test_setup();
+
+    esp_cli_command_t cmd = {
+        .name = "echo",
+        .group = "script",
+        .help = "dummy help",
+        .func = test_script_echo_func,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_register_cmd(&cmd));
+    cmd.name = "unreg";
+    cmd.func = test_script_unregister_func;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_register_cmd(&cmd));
+
+    esp_cli_commands_exec_arg_t cmd_args = { .out_fd = -2, .write_func = test_script_write, .dynamic_ctx = NULL };
+    esp_cli_commands_script_result_t result;
+
+    /* empty lines are skipped, the last line does not need a line feed */
+    const char script[] = "echo 0 a\r\n\n   \necho 0 \"b c\"\nnope x\necho 2\necho 0 d";
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_execute_script(script, strlen(script), NULL, &cmd_args, false, &result));
+    TEST_ASSERT_EQUAL_STRING("echo 0 a\necho 0 b c\necho 2\necho 0 d\n", s_script_output.buf);
+    TEST_ASSERT_EQUAL(5, result.nb_of_executed_lines);
+    TEST_ASSERT_EQUAL(2, result.nb_of_failed_lines);
+    TEST_ASSERT_EQUAL(5, result.first_failed_line);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, result.first_failed_err);
+
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_execute_script(script, strlen(script), NULL, &cmd_args, true, &result));
+    TEST_ASSERT_EQUAL_STRING("echo 0 a\necho 0 b c\n", s_script_output.buf);
+    TEST_ASSERT_EQUAL(3, result.nb_of_executed_lines);
+    TEST_ASSERT_EQUAL(1, result.nb_of_failed_lines);
+
+    /* a command returning non-zero fails its line */
+    const char failing_script[] = "echo 0\n\necho 3 x\necho 0\n";
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_execute_script(failing_script, strlen(failing_script), NULL, &cmd_args, true, &result));
+    TEST_ASSERT_EQUAL_STRING("echo 0\necho 3 x\n", s_script_output.buf);
+    TEST_ASSERT_EQUAL(3, result.first_failed_line);
+    TEST_ASSERT_EQUAL(ESP_OK, result.first_failed_err);
+    TEST_ASSERT_EQUAL(3, result.first_failed_cmd_ret);
+
+    const char ok_script[] = "echo 0 x\necho 0 y\n";
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute_script(ok_script, strlen(ok_script), NULL, &cmd_args, true, NULL));
+
+    /* the script is not null terminated, and its last line ends at the end of the buffer */
+    const size_t unterminated_len = strlen(ok_script) - 1;
+    char *unterminated = malloc(unterminated_len);
+    TEST_ASSERT_NOT_NULL(unterminated);
+    memcpy(unterminated, ok_script, unterminated_len);
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute_script(unterminated, unterminated_len, NULL, &cmd_args, true, &result));
+    TEST_ASSERT_EQUAL_STRING("echo 0 x\necho 0 y\n", s_script_output.buf);
+    TEST_ASSERT_EQUAL(2, result.nb_of_executed_lines);
+    free(unterminated);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute_script(ok_script, 0, NULL, &cmd_args, true, &result));
+    TEST_ASSERT_EQUAL(0, result.nb_of_executed_lines);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cli_commands_execute_script(NULL, 0, NULL, &cmd_args, true, &result));
+
+    /* only the commands of the set and help are executed, help prints through the write function */
+    const char *set[] = {"cmd_a"};
+    esp_cli_command_set_handle_t handle_set = ESP_CLI_COMMANDS_CREATE_CMD_SET(set, ESP_CLI_COMMAND_FIELD_ACCESSOR(name));
+    TEST_ASSERT_NOT_NULL(handle_set);
+    const char set_script[] = "echo 0\nhelp cmd_a -v 0\n";
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_execute_script(set_script, strlen(set_script), handle_set, &cmd_args, false, &result));
+    TEST_ASSERT_EQUAL(1, result.first_failed_line);
+    TEST_ASSERT_EQUAL(1, result.nb_of_failed_lines);
+    TEST_ASSERT_EQUAL_STRING("cmd_a cmd_a_hint\n", s_script_output.buf);
+    esp_cli_commands_destroy_cmd_set(&handle_set);
+
+    /* a command unregistered by the script is not found by the next lines */
+    const char unregister_script[] = "echo 0 x\nunreg echo\necho 0 y\n";
+    memset(&s_script_output, 0x00, sizeof(s_script_output));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_cli_commands_execute_script(unregister_script, strlen(unregister_script), NULL, &cmd_args, false, &result));
+    TEST_ASSERT_EQUAL_STRING("echo 0 x\n", s_script_output.buf);
+    TEST_ASSERT_EQUAL(3, result.first_failed_line);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, result.first_failed_err);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd("unreg"));
+}
+
+#define TEST_SCRIPT_BENCHMARK_LINES 2000
+#define TEST_SCRIPT_BENCHMARK_CMDS 16
+#define TEST_SCRIPT_BENCHMARK_LINE_SIZE 32
+
+static int test_script_nop_func(void *context, esp_cli_commands_exec_arg_t *cmd_args, int argc, char **argv)
+{
+    (*(size_t *)context)++;
+    return 0;
+}
+
+TEST_CASE("test script execution benchmark", "[esp_cli_commands][benchmark]")
+{
+    test_setup();
+
+    /* the script uses a few commands among many registered ones */
+    char (*names)[TEST_MANY_CMDS_NAME_SIZE] = malloc((TEST_MANY_CMDS_NB + TEST_SCRIPT_BENCHMARK_CMDS) * TEST_MANY_CMDS_NAME_SIZE);
+    char *script = malloc(TEST_SCRIPT_BENCHMARK_LINES * TEST_SCRIPT_BENCHMARK_LINE_SIZE);
+    char **lines = malloc(TEST_SCRIPT_BENCHMARK_LINES * sizeof(char *));
+    TEST_ASSERT_NOT_NULL(names);
+    TEST_ASSERT_NOT_NULL(script);
+    TEST_ASSERT_NOT_NULL(lines);
+    test_register_many_cmds(names, TEST_MANY_CMDS_NB);
+
+    size_t nb_of_calls = 0;
+    char (*bench_names)[TEST_MANY_CMDS_NAME_SIZE] = names + TEST_MANY_CMDS_NB;
+    for (size_t i = 0; i < TEST_SCRIPT_BENCHMARK_CMDS; i++) {
+        snprintf(bench_names[i], TEST_MANY_CMDS_NAME_SIZE, "bench_%02u", (unsigned)i);
+        esp_cli_command_t cmd = {
+            .name = bench_names[i],
+            .group = "bench",
+            .help = "dummy help",
+            .func = test_script_nop_func,
+            .func_ctx = &nb_of_calls,
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_register_cmd(&cmd));
+    }
+
+    /* the same lines, as a script and one by one */
+    size_t script_len = 0;
+    for (size_t i = 0; i < TEST_SCRIPT_BENCHMARK_LINES; i++) {
+        lines[i] = script + script_len;
+        script_len += snprintf(script + script_len, TEST_SCRIPT_BENCHMARK_LINE_SIZE, "bench_%02u set %u\n",
+                               (unsigned)(i % TEST_SCRIPT_BENCHMARK_CMDS), (unsigned)i);
+    }
+    char *line_by_line = malloc(script_len + 1);
+    TEST_ASSERT_NOT_NULL(line_by_line);
+    memcpy(line_by_line, script, script_len + 1);
+    for (size_t i = 0; i < TEST_SCRIPT_BENCHMARK_LINES; i++) {
+        lines[i] = line_by_line + (lines[i] - script);
+        *strchr(lines[i], '\n') = '\0';
+    }
+
+    int cmd_ret;
+    uint64_t start = test_benchmark_now();
+    for (size_t i = 0; i < TEST_SCRIPT_BENCHMARK_LINES; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute(lines[i], &cmd_ret, NULL, NULL));
+    }
+    const uint64_t execute_time = test_benchmark_now() - start;
+    TEST_ASSERT_EQUAL(TEST_SCRIPT_BENCHMARK_LINES, nb_of_calls);
+
+    esp_cli_commands_script_result_t result;
+    start = test_benchmark_now();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_execute_script(script, script_len, NULL, NULL, true, &result));
+    const uint64_t script_time = test_benchmark_now() - start;
+    TEST_ASSERT_EQUAL(TEST_SCRIPT_BENCHMARK_LINES, result.nb_of_executed_lines);
+    TEST_ASSERT_EQUAL(2 * TEST_SCRIPT_BENCHMARK_LINES, nb_of_calls);
+
+    printf("%d lines, per command: esp_cli_commands_execute %" PRIu64 ", esp_cli_commands_execute_script %" PRIu64
+           " " TEST_BENCHMARK_UNIT "\n", TEST_SCRIPT_BENCHMARK_LINES,
+           execute_time / TEST_SCRIPT_BENCHMARK_LINES, script_time / TEST_SCRIPT_BENCHMARK_LINES);
+#if CONFIG_IDF_TARGET_LINUX
+    printf("commands/s: esp_cli_commands_execute %" PRIu64 ", esp_cli_commands_execute_script %" PRIu64 "\n",
+           (uint64_t)TEST_SCRIPT_BENCHMARK_LINES * 1000000000 / execute_time,
+           (uint64_t)TEST_SCRIPT_BENCHMARK_LINES * 1000000000 / script_time);
+#endif
+
+    for (size_t i = 0; i < TEST_SCRIPT_BENCHMARK_CMDS; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd(bench_names[i]));
+    }
+    for (size_t i = 0; i < TEST_MANY_CMDS_NB; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_cli_commands_unregister_cmd(names[i]));
+    }
+    free(line_by_line);
+    free(lines);
+    free(script);
+    free(names);
+}
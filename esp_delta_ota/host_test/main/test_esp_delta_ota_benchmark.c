@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Delta OTA apply benchmark
+ *
+ * Applies detools patches from files using file-backed read and write callbacks, and reports
+ * the apply speed, the number and size distribution of read_cb/write_cb calls and the peak heap
+ * usage of the delta OTA process.
+ *
+ * By default the bundled test assets are used. To benchmark own patches, e.g. generated with
+ * different detools algorithms and compressions, set:
+ *   DELTA_OTA_BENCH_SRC     path of the source image
+ *   DELTA_OTA_BENCH_PATCHES comma separated list of patch files generated against the source image
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <sys/time.h>
+
+#include "unity.h"
+#include "esp_delta_ota.h"
+
+extern const uint8_t base_bin_start[] asm("_binary_base_bin_start");
+extern const uint8_t base_bin_end[]   asm("_binary_base_bin_end");
+extern const uint8_t patch_bin_start[] asm("_binary_patch_bin_start");
+extern const uint8_t patch_bin_end[]   asm("_binary_patch_bin_end");
+
+#define BENCH_HIST_BUCKETS      14      /* power of two buckets: 1, 2-3, 4-7, ..., >= 8192 */
+#define BENCH_FEED_SIZE         1024
+#define BENCH_MIN_APPLY_US      200000  /* repeat small patches until the measurement is meaningful */
+
+typedef struct {
+    uint32_t calls;
+    uint64_t bytes;
+    uint32_t hist[BENCH_HIST_BUCKETS];
+} bench_io_stats_t;
+
+typedef struct {
+    FILE *src;
+    FILE *dst;
+    bench_io_stats_t read;
+    bench_io_stats_t write;
+    size_t heap_base;
+    size_t heap_peak;
+} bench_ctx_t;
+
+typedef struct {
+    const char *name;
+    size_t src_cache_size;
+    size_t write_buf_size;
+} bench_cfg_t;
+
+/* Static stdio buffers, so the file I/O does not show up in the heap measurement */
+static char s_src_stdio_buf[BUFSIZ];
+static char s_dst_stdio_buf[BUFSIZ];
+
+static const bench_cfg_t s_bench_cfgs[] = {
+    { "direct", 0, 0 },
+    { "cached", 4096, 4096 },
+};
+
+static uint64_t get_micros(void)
+{
+    struct timeval tv = { 0 };
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static size_t heap_used(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return (size_t)mallinfo().uordblks;
+#endif
+}
+
+static void bench_sample_heap(bench_ctx_t *ctx)
+{
+    size_t used = heap_used();
+    if (used > ctx->heap_base && used - ctx->heap_base > ctx->heap_peak) {
+        ctx->heap_peak = used - ctx->heap_base;
+    }
+}
+
+static void bench_io_record(bench_io_stats_t *stats, size_t size)
+{
+    int bucket = 0;
+    while (bucket < BENCH_HIST_BUCKETS - 1 && (size >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+    stats->calls++;
+    stats->bytes += size;
+    stats->hist[bucket]++;
+}
+
+static esp_err_t bench_read_cb(uint8_t *buf_p, size_t size, int src_offset, void *user_data)
+{
+    bench_ctx_t *ctx = (bench_ctx_t *)user_data;
+    bench_io_record(&ctx->read, size);
+    bench_sample_heap(ctx);
+    if (fseek(ctx->src, src_offset, SEEK_SET) != 0 || fread(buf_p, 1, size, ctx->src) != size) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t bench_write_cb(const uint8_t *buf_p, size_t size, void *user_data)
+{
+    bench_ctx_t *ctx = (bench_ctx_t *)user_data;
+    bench_io_record(&ctx->write, size);
+    bench_sample_heap(ctx);
+    if (fwrite(buf_p, 1, size, ctx->dst) != size) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static uint8_t *bench_load_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, path);
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(*size);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL(*size, fread(buf, 1, *size, f));
+    fclose(f);
+    return buf;
+}
+
+static void bench_print_hist(const char *name, const bench_io_stats_t *stats)
+{
+    printf("  %-5s %8" PRIu32 " calls, %10llu bytes, avg %6.1f B:", name, stats->calls,
+           (unsigned long long)stats->bytes, stats->calls ? (double)stats->bytes / stats->calls : 0.0);
+    for (int i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        if (stats->hist[i]) {
+            printf(" [%u..]=%" PRIu32, 1u << i, stats->hist[i]);
+        }
+    }
+    printf("\n");
+}
+
+static void bench_apply(const char *label, FILE *src, size_t src_size, const uint8_t *patch, size_t patch_size,
+                        const bench_cfg_t *bench_cfg)
+{
+    bench_ctx_t ctx = { .src = src };
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = &ctx,
+        .read_cb_with_user_data = &bench_read_cb,
+        .write_cb_with_user_data = &bench_write_cb,
+        .src_cache_size = bench_cfg->src_cache_size,
+        .src_size = src_size,
+        .write_buf_size = bench_cfg->write_buf_size,
+    };
+    size_t dst_size = 0;
+    uint32_t runs = 0;
+    uint64_t elapsed = 0;
+
+    do {
+        ctx.dst = tmpfile();
+        TEST_ASSERT_NOT_NULL(ctx.dst);
+        setvbuf(ctx.dst, s_dst_stdio_buf, _IOFBF, sizeof(s_dst_stdio_buf));
+        memset(&ctx.read, 0, sizeof(ctx.read));
+        memset(&ctx.write, 0, sizeof(ctx.write));
+        ctx.heap_base = heap_used();
+        ctx.heap_peak = 0;
+
+        uint64_t start = get_micros();
+        esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+        TEST_ASSERT_NOT_NULL(handle);
+        bench_sample_heap(&ctx);
+        for (size_t i = 0; i < patch_size; i += BENCH_FEED_SIZE) {
+            size_t size = (patch_size - i) < BENCH_FEED_SIZE ? patch_size - i : BENCH_FEED_SIZE;
+            TEST_ESP_OK(esp_delta_ota_feed_patch(handle, patch + i, size));
+        }
+        TEST_ESP_OK(esp_delta_ota_finalize(handle));
+        TEST_ESP_OK(esp_delta_ota_deinit(handle));
+        elapsed += get_micros() - start;
+        runs++;
+
+        dst_size = ftell(ctx.dst);
+        fclose(ctx.dst);
+    } while (elapsed < BENCH_MIN_APPLY_US);
+
+    double seconds = (double)elapsed / runs / 1000000.0;
+    printf("%s [%s, src_cache_size %zu, write_buf_size %zu]\n", label, bench_cfg->name,
+           bench_cfg->src_cache_size, bench_cfg->write_buf_size);
+    printf("  patch %zu B -> image %zu B in %.3f ms, %.2f MB/s output, peak heap %zu B\n", patch_size, dst_size,
+           seconds * 1000.0, dst_size / seconds / (1024.0 * 1024.0), ctx.heap_peak);
+    bench_print_hist("read", &ctx.read);
+    bench_print_hist("write", &ctx.write);
+}
+
+TEST_CASE("Delta OTA apply benchmark", "[esp_delta_ota][benchmark]")
+{
+    const char *src_path = getenv("DELTA_OTA_BENCH_SRC");
+    const char *patch_paths = getenv("DELTA_OTA_BENCH_PATCHES");
+    FILE *src = NULL;
+    size_t src_size = 0;
+
+    if (src_path && patch_paths) {
+        src = fopen(src_path, "rb");
+        TEST_ASSERT_NOT_NULL_MESSAGE(src, src_path);
+        setvbuf(src, s_src_stdio_buf, _IOFBF, sizeof(s_src_stdio_buf));
+        fseek(src, 0, SEEK_END);
+        src_size = ftell(src);
+
+        char *paths = strdup(patch_paths);
+        TEST_ASSERT_NOT_NULL(paths);
+        char *saveptr = NULL;
+        for (char *path = strtok_r(paths, ",", &saveptr); path; path = strtok_r(NULL, ",", &saveptr)) {
+            size_t patch_size;
+            uint8_t *patch = bench_load_file(path, &patch_size);
+            for (int i = 0; i < sizeof(s_bench_cfgs) / sizeof(s_bench_cfgs[0]); i++) {
+                bench_apply(path, src, src_size, patch, patch_size, &s_bench_cfgs[i]);
+            }
+            free(patch);
+        }
+        free(paths);
+    } else {
+        src = tmpfile();
+        TEST_ASSERT_NOT_NULL(src);
+        setvbuf(src, s_src_stdio_buf, _IOFBF, sizeof(s_src_stdio_buf));
+        src_size = base_bin_end - base_bin_start;
+        TEST_ASSERT_EQUAL(src_size, fwrite(base_bin_start, 1, src_size, src));
+        fflush(src);
+        for (int i = 0; i < sizeof(s_bench_cfgs) / sizeof(s_bench_cfgs[0]); i++) {
+            bench_apply("patch.bin", src, src_size, patch_bin_start, patch_bin_end - patch_bin_start, &s_bench_cfgs[i]);
+        }
+    }
+    fclose(src);
+}
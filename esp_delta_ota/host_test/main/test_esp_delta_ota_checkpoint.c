@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "unity.h"
+#include "esp_delta_ota.h"
+
+extern const uint8_t base_bin_start[] asm("_binary_base_bin_start");
+extern const uint8_t new_bin_start[] asm("_binary_new_bin_start");
+extern const uint8_t new_bin_end[]   asm("_binary_new_bin_end");
+extern const uint8_t patch_bin_start[] asm("_binary_patch_bin_start");
+extern const uint8_t patch_bin_end[]   asm("_binary_patch_bin_end");
+
+#define TEST_FEED_SIZE              32
+#define TEST_CHECKPOINT_INTERVAL    128
+
+typedef struct {
+    uint8_t output[1300];
+    size_t output_index;
+    uint8_t *checkpoint;
+    size_t checkpoint_size;
+    int checkpoints;
+    int failed_checkpoints;
+    bool fail_checkpoint;
+} test_ctx_t;
+
+static esp_err_t read_cb(uint8_t *buf_p, size_t size, int src_offset, void *user_data)
+{
+    memcpy(buf_p, base_bin_start + src_offset, size);
+    return ESP_OK;
+}
+
+static esp_err_t write_cb(const uint8_t *buf_p, size_t size, void *user_data)
+{
+    test_ctx_t *ctx = (test_ctx_t *)user_data;
+    if (ctx->output_index + size > sizeof(ctx->output)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(ctx->output + ctx->output_index, buf_p, size);
+    ctx->output_index += size;
+    return ESP_OK;
+}
+
+static esp_err_t checkpoint_cb(const void *buf, size_t size, void *user_data)
+{
+    test_ctx_t *ctx = (test_ctx_t *)user_data;
+    if (ctx->fail_checkpoint) {
+        ctx->failed_checkpoints++;
+        return ESP_FAIL;
+    }
+    free(ctx->checkpoint);
+    ctx->checkpoint = malloc(size);
+    if (!ctx->checkpoint) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(ctx->checkpoint, buf, size);
+    ctx->checkpoint_size = size;
+    ctx->checkpoints++;
+    return ESP_OK;
+}
+
+static esp_err_t feed(esp_delta_ota_handle_t handle, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i += TEST_FEED_SIZE) {
+        int size = (to - i) < TEST_FEED_SIZE ? to - i : TEST_FEED_SIZE;
+        esp_err_t err = esp_delta_ota_feed_patch(handle, patch_bin_start + i, size);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+static void resume_after_interruption(size_t write_buf_size, bool keep_interrupted)
+{
+    const size_t patch_size = patch_bin_end - patch_bin_start;
+    test_ctx_t ctx = { 0 };
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = &ctx,
+        .read_cb_with_user_data = &read_cb,
+        .write_cb_with_user_data = &write_cb,
+        .write_buf_size = write_buf_size,
+        .checkpoint_cb = &checkpoint_cb,
+        .checkpoint_interval = TEST_CHECKPOINT_INTERVAL,
+    };
+
+    /* Interrupt the process somewhere after the middle of the patch */
+    esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_OK(feed(handle, 0, patch_size / 2 + TEST_FEED_SIZE * 2));
+    TEST_ASSERT_GREATER_THAN(0, ctx.checkpoints);
+    esp_delta_ota_handle_t interrupted = handle;
+    if (!keep_interrupted) {
+        TEST_ESP_OK(esp_delta_ota_deinit(interrupted));
+    }
+
+    /* Resume with a new handle, as after a restart. While the interrupted one is
+     * still allocated, the new one cannot be placed at the same address. */
+    esp_delta_ota_checkpoint_info_t info;
+    handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_OK(esp_delta_ota_restore_checkpoint(handle, ctx.checkpoint, ctx.checkpoint_size, &info));
+    if (keep_interrupted) {
+        TEST_ASSERT_NOT_EQUAL(interrupted, handle);
+        TEST_ESP_OK(esp_delta_ota_deinit(interrupted));
+    }
+    TEST_ASSERT_GREATER_THAN(0, info.patch_offset);
+    TEST_ASSERT_LESS_OR_EQUAL(ctx.output_index, info.dst_offset);
+    ctx.output_index = info.dst_offset;
+
+    TEST_ESP_OK(feed(handle, info.patch_offset, patch_size));
+    TEST_ESP_OK(esp_delta_ota_finalize(handle));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+    free(ctx.checkpoint);
+
+    TEST_ASSERT_EQUAL(new_bin_end - new_bin_start, ctx.output_index);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(new_bin_start, ctx.output, ctx.output_index));
+}
+
+TEST_CASE("Resume patching from a checkpoint", "[esp_delta_ota][checkpoint]")
+{
+    resume_after_interruption(0, false);
+}
+
+TEST_CASE("Resume patching from a checkpoint with pending coalesced output", "[esp_delta_ota][checkpoint]")
+{
+    resume_after_interruption(512, false);
+}
+
+TEST_CASE("Resume patching from a checkpoint into a context at another address", "[esp_delta_ota][checkpoint]")
+{
+    resume_after_interruption(512, true);
+}
+
+TEST_CASE("Failed automatic checkpoint does not fail the feed", "[esp_delta_ota][checkpoint]")
+{
+    const size_t patch_size = patch_bin_end - patch_bin_start;
+    test_ctx_t ctx = { .fail_checkpoint = true };
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = &ctx,
+        .read_cb_with_user_data = &read_cb,
+        .write_cb_with_user_data = &write_cb,
+        .checkpoint_cb = &checkpoint_cb,
+        .checkpoint_interval = TEST_CHECKPOINT_INTERVAL,
+    };
+
+    /* The chunk was applied, feeding it again would corrupt the image */
+    esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_OK(feed(handle, 0, TEST_CHECKPOINT_INTERVAL));
+    TEST_ASSERT_EQUAL(1, ctx.failed_checkpoints);
+
+    /* Retried after the next chunk */
+    ctx.fail_checkpoint = false;
+    TEST_ESP_OK(feed(handle, TEST_CHECKPOINT_INTERVAL, patch_size));
+    TEST_ASSERT_GREATER_THAN(0, ctx.checkpoints);
+    TEST_ESP_OK(esp_delta_ota_finalize(handle));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+    free(ctx.checkpoint);
+
+    TEST_ASSERT_EQUAL(new_bin_end - new_bin_start, ctx.output_index);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(new_bin_start, ctx.output, ctx.output_index));
+}
+
+TEST_CASE("Corrupted checkpoint is rejected", "[esp_delta_ota][checkpoint]")
+{
+    test_ctx_t ctx = { 0 };
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = &ctx,
+        .read_cb_with_user_data = &read_cb,
+        .write_cb_with_user_data = &write_cb,
+        .checkpoint_cb = &checkpoint_cb,
+    };
+
+    esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_OK(feed(handle, 0, TEST_FEED_SIZE * 4));
+    TEST_ASSERT_EQUAL(0, ctx.checkpoints);
+    TEST_ESP_OK(esp_delta_ota_checkpoint(handle));
+    TEST_ASSERT_EQUAL(1, ctx.checkpoints);
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_delta_ota_restore_checkpoint(handle, ctx.checkpoint, ctx.checkpoint_size, NULL));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+
+    ctx.checkpoint[ctx.checkpoint_size - 1] ^= 0xFF;
+    handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_ERR(ESP_ERR_INVALID_CRC, esp_delta_ota_restore_checkpoint(handle, ctx.checkpoint, ctx.checkpoint_size, NULL));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_delta_ota_restore_checkpoint(handle, ctx.checkpoint, ctx.checkpoint_size - 1, NULL));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+    free(ctx.checkpoint);
+}
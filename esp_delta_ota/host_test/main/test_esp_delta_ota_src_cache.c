@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "unity.h"
+#include "esp_delta_ota.h"
+
+extern const uint8_t base_bin_start[] asm("_binary_base_bin_start");
+extern const uint8_t base_bin_end[]   asm("_binary_base_bin_end");
+extern const uint8_t new_bin_start[] asm("_binary_new_bin_start");
+extern const uint8_t new_bin_end[]   asm("_binary_new_bin_end");
+extern const uint8_t patch_bin_start[] asm("_binary_patch_bin_start");
+extern const uint8_t patch_bin_end[]   asm("_binary_patch_bin_end");
+
+#define TEST_ITERATIONS     200
+
+typedef struct {
+    FILE *src;
+    uint8_t output[1300];
+    size_t output_index;
+} test_ctx_t;
+
+static uint64_t get_micros(void)
+{
+    struct timeval tv = { 0 };
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static esp_err_t file_read_cb(uint8_t *buf_p, size_t size, int src_offset, void *user_data)
+{
+    test_ctx_t *ctx = (test_ctx_t *)user_data;
+    if (fseek(ctx->src, src_offset, SEEK_SET) != 0) {
+        return ESP_FAIL;
+    }
+    if (fread(buf_p, 1, size, ctx->src) != size) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_cb(const uint8_t *buf_p, size_t size, void *user_data)
+{
+    test_ctx_t *ctx = (test_ctx_t *)user_data;
+    if (ctx->output_index + size > sizeof(ctx->output)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(ctx->output + ctx->output_index, buf_p, size);
+    ctx->output_index += size;
+    return ESP_OK;
+}
+
+static FILE *create_src_file(void)
+{
+    FILE *src = tmpfile();
+    TEST_ASSERT_NOT_NULL(src);
+    size_t size = base_bin_end - base_bin_start;
+    TEST_ASSERT_EQUAL(size, fwrite(base_bin_start, 1, size, src));
+    fflush(src);
+    return src;
+}
+
+static void apply_patch(test_ctx_t *ctx, size_t src_cache_size, size_t src_size, esp_delta_ota_src_cache_stats_t *stats)
+{
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = ctx,
+        .read_cb_with_user_data = &file_read_cb,
+        .write_cb_with_user_data = &write_cb,
+        .src_cache_size = src_cache_size,
+        .src_size = src_size,
+    };
+    ctx->output_index = 0;
+
+    esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ESP_OK(esp_delta_ota_feed_patch(handle, patch_bin_start, patch_bin_end - patch_bin_start));
+    TEST_ESP_OK(esp_delta_ota_finalize(handle));
+    TEST_ESP_OK(esp_delta_ota_get_src_cache_stats(handle, stats));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+
+    TEST_ASSERT_EQUAL(new_bin_end - new_bin_start, ctx->output_index);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(new_bin_start, ctx->output, ctx->output_index));
+}
+
+TEST_CASE("Source cache produces the same image as uncached reads", "[esp_delta_ota][src_cache]")
+{
+    const size_t src_size = base_bin_end - base_bin_start;
+    test_ctx_t ctx = { .src = create_src_file() };
+    esp_delta_ota_src_cache_stats_t uncached, cached, tiny;
+
+    apply_patch(&ctx, 0, src_size, &uncached);
+    apply_patch(&ctx, 4096, src_size, &cached);
+    apply_patch(&ctx, 16, src_size, &tiny);
+    fclose(ctx.src);
+
+    TEST_ASSERT_EQUAL(uncached.read_requests, uncached.src_reads);
+    TEST_ASSERT_EQUAL(0, uncached.cache_hits);
+    TEST_ASSERT_EQUAL(uncached.read_requests, cached.read_requests);
+    TEST_ASSERT_LESS_OR_EQUAL(uncached.src_reads, cached.src_reads);
+    TEST_ASSERT_GREATER_THAN(0, cached.cache_hits);
+    TEST_ASSERT_EQUAL(uncached.read_requests, tiny.read_requests);
+}
+
+TEST_CASE("Source cache read-ahead past the end of a source of unknown size", "[esp_delta_ota][src_cache]")
+{
+    test_ctx_t ctx = { .src = create_src_file() };
+    esp_delta_ota_src_cache_stats_t stats;
+
+    /* The read callback fails past the end of the file, as a read past the end of a partition */
+    apply_patch(&ctx, 4096, 0, &stats);
+    apply_patch(&ctx, 1024, 0, &stats);
+    apply_patch(&ctx, 16, 0, &stats);
+    fclose(ctx.src);
+}
+
+TEST_CASE("Source cache apply time with file-backed source", "[esp_delta_ota][src_cache][benchmark]")
+{
+    const size_t cache_sizes[] = { 0, 256, 1024, 4096 };
+    test_ctx_t ctx = { .src = create_src_file() };
+
+    for (int i = 0; i < sizeof(cache_sizes) / sizeof(cache_sizes[0]); i++) {
+        esp_delta_ota_src_cache_stats_t stats;
+        uint64_t start = get_micros();
+        for (int j = 0; j < TEST_ITERATIONS; j++) {
+            apply_patch(&ctx, cache_sizes[i], base_bin_end - base_bin_start, &stats);
+        }
+        uint64_t elapsed = get_micros() - start;
+        printf("src_cache_size %5zu: %8llu us/patch, %u requests, %u hits, %u reads, %zu bytes read\n",
+               cache_sizes[i], (unsigned long long)(elapsed / TEST_ITERATIONS), stats.read_requests,
+               stats.cache_hits, stats.src_reads, stats.src_bytes_read);
+    }
+    fclose(ctx.src);
+}
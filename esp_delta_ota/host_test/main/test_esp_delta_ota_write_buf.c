@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "unity.h"
+#include "esp_delta_ota.h"
+
+extern const uint8_t base_bin_start[] asm("_binary_base_bin_start");
+extern const uint8_t new_bin_start[] asm("_binary_new_bin_start");
+extern const uint8_t new_bin_end[]   asm("_binary_new_bin_end");
+extern const uint8_t patch_bin_start[] asm("_binary_patch_bin_start");
+extern const uint8_t patch_bin_end[]   asm("_binary_patch_bin_end");
+
+typedef struct {
+    uint8_t output[1300];
+    size_t output_index;
+    size_t write_buf_size;
+    int writes;
+    int unaligned_writes;
+} test_ctx_t;
+
+static esp_err_t read_cb(uint8_t *buf_p, size_t size, int src_offset, void *user_data)
+{
+    memcpy(buf_p, base_bin_start + src_offset, size);
+    return ESP_OK;
+}
+
+static esp_err_t write_cb(const uint8_t *buf_p, size_t size, void *user_data)
+{
+    test_ctx_t *ctx = (test_ctx_t *)user_data;
+    if (ctx->output_index + size > sizeof(ctx->output)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (ctx->write_buf_size && (ctx->output_index % ctx->write_buf_size) != 0) {
+        ctx->unaligned_writes++;
+    }
+    memcpy(ctx->output + ctx->output_index, buf_p, size);
+    ctx->output_index += size;
+    ctx->writes++;
+    return ESP_OK;
+}
+
+static void apply_patch(test_ctx_t *ctx, size_t write_buf_size, size_t feed_size)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->write_buf_size = write_buf_size;
+    esp_delta_ota_cfg_t cfg = {
+        .user_data = ctx,
+        .read_cb_with_user_data = &read_cb,
+        .write_cb_with_user_data = &write_cb,
+        .write_buf_size = write_buf_size,
+    };
+
+    esp_delta_ota_handle_t handle = esp_delta_ota_init(&cfg);
+    TEST_ASSERT_NOT_NULL(handle);
+    for (const uint8_t *p = patch_bin_start; p < patch_bin_end; p += feed_size) {
+        int size = (patch_bin_end - p) < feed_size ? patch_bin_end - p : feed_size;
+        TEST_ESP_OK(esp_delta_ota_feed_patch(handle, p, size));
+    }
+    TEST_ESP_OK(esp_delta_ota_finalize(handle));
+    TEST_ESP_OK(esp_delta_ota_deinit(handle));
+
+    TEST_ASSERT_EQUAL(new_bin_end - new_bin_start, ctx->output_index);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(new_bin_start, ctx->output, ctx->output_index));
+}
+
+TEST_CASE("Write coalescing emits aligned, buffer-sized writes", "[esp_delta_ota][write_buf]")
+{
+    const size_t new_size = new_bin_end - new_bin_start;
+    test_ctx_t ctx;
+
+    apply_patch(&ctx, 0, 64);
+    int unbuffered_writes = ctx.writes;
+
+    apply_patch(&ctx, 256, 64);
+    TEST_ASSERT_EQUAL(0, ctx.unaligned_writes);
+    TEST_ASSERT_LESS_OR_EQUAL((new_size + 255) / 256, ctx.writes);
+    TEST_ASSERT_LESS_OR_EQUAL(unbuffered_writes, ctx.writes);
+
+    apply_patch(&ctx, 256, 1);
+    TEST_ASSERT_EQUAL(0, ctx.unaligned_writes);
+    TEST_ASSERT_LESS_OR_EQUAL((new_size + 255) / 256, ctx.writes);
+}
+
+TEST_CASE("Write coalescing flushes the whole image in finalize", "[esp_delta_ota][write_buf]")
+{
+    test_ctx_t ctx;
+
+    /* The whole image fits into the buffer, so it must arrive in a single write */
+    apply_patch(&ctx, 4096, 64);
+    TEST_ASSERT_EQUAL(1, ctx.writes);
+}
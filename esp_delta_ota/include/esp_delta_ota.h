@@ -29,6 +29,9 @@ typedef esp_err_t (*src_read_cb_with_user_ctx_t)(uint8_t *buf_p, size_t size, in
 typedef esp_err_t (*merged_stream_write_cb_t)(const uint8_t *buf_p, size_t size);
 typedef esp_err_t (*merged_stream_write_cb_with_user_ctx_t)(const uint8_t *buf_p, size_t size, void *user_data);
 
+// Callback for persisting a checkpoint of the patching process
+typedef esp_err_t (*checkpoint_save_cb_t)(const void *buf, size_t size, void *user_data);
+
 typedef struct esp_delta_ota_cfg {
     void *user_data;              /*!< User Data */
     union {
@@ -39,10 +42,35 @@ typedef struct esp_delta_ota_cfg {
         merged_stream_write_cb_with_user_ctx_t write_cb_with_user_data;     /*!< Write Callback with user data */
         merged_stream_write_cb_t write_cb DEPRECATED_ATTRIBUTE;             /*!< Write Callback */
     };
+    size_t src_cache_size;        /*!< Size of the source read cache in bytes, 0 disables the cache */
+    size_t src_size;              /*!< Size of the source image in bytes, bounds the cache read-ahead. 0 if unknown,
+                                       a read-ahead which fails is then retried as an uncached read */
+    size_t write_buf_size;        /*!< Size of the output aggregation buffer in bytes, 0 disables write coalescing.
+                                       Use a multiple of the flash sector size (4096) for sector-aligned writes */
+    checkpoint_save_cb_t checkpoint_cb;   /*!< Checkpoint Callback, NULL disables checkpoints */
+    size_t checkpoint_interval;   /*!< Number of patch bytes fed between two automatic checkpoints, 0 for manual checkpoints only */
 } esp_delta_ota_cfg_t;
 
+/**
+ * @brief Source read cache statistics
+ */
+typedef struct esp_delta_ota_src_cache_stats {
+    uint32_t read_requests;       /*!< Number of source reads requested by the patcher */
+    uint32_t cache_hits;          /*!< Number of requests served entirely from the cache */
+    uint32_t src_reads;           /*!< Number of calls made to the user read callback */
+    size_t src_bytes_read;        /*!< Number of bytes fetched through the user read callback */
+} esp_delta_ota_src_cache_stats_t;
+
 #undef DEPRECATED_ATTRIBUTE
 
+/**
+ * @brief Position from which a restored delta OTA process continues
+ */
+typedef struct esp_delta_ota_checkpoint_info {
+    size_t patch_offset;          /*!< Offset in the patch from which esp_delta_ota_feed_patch() must continue */
+    size_t dst_offset;            /*!< Offset in the destination at which the write callback will continue */
+} esp_delta_ota_checkpoint_info_t;
+
 /**
  * @brief Initializes the delta OTA process
  *
@@ -55,6 +83,9 @@ esp_delta_ota_handle_t esp_delta_ota_init(esp_delta_ota_cfg_t *cfg);
 /**
  * @brief This function performs the patch applying operation on the source data.
  *
+ * When a `checkpoint_interval` is configured, a failure of the automatic checkpoint is only logged:
+ * the patch data was consumed, and the checkpoint is tried again after the next call.
+ *
  * @param[in] handle    esp_delta_ota_handle_t handle
  * @param[in] buf       pointer to patch buffer
  * @param[in] size      size of patch buffer.
@@ -64,14 +95,71 @@ esp_delta_ota_handle_t esp_delta_ota_init(esp_delta_ota_cfg_t *cfg);
  */
 esp_err_t esp_delta_ota_feed_patch(esp_delta_ota_handle_t handle, const uint8_t *buf, int size);
 
+/**
+ * @brief Take a checkpoint of the patching process
+ *
+ * Serializes the patcher state together with the source, patch and destination offsets and
+ * passes it to the `checkpoint_cb` from the configuration. It is also called automatically from
+ * esp_delta_ota_feed_patch() every `checkpoint_interval` patch bytes.
+ *
+ * @note Output already passed to the write callback must be persisted by the sink before the
+ *       checkpoint is stored, the checkpoint only records its size.
+ *
+ * @param[in] handle    esp_delta_ota_handle_t handle
+ * @return - ESP_OK
+ *         - ESP_ERR_INVALID_ARG
+ *         - ESP_ERR_INVALID_STATE if no checkpoint callback is configured
+ *         - ESP_ERR_NO_MEM
+ *         - error returned by the checkpoint callback
+ */
+esp_err_t esp_delta_ota_checkpoint(esp_delta_ota_handle_t handle);
+
+/**
+ * @brief Resume the patching process from a checkpoint
+ *
+ * Must be called on a freshly initialized handle, with the same configuration, before any patch
+ * is fed. Patch data must then be fed from `info->patch_offset` on, and the write callback
+ * continues at `info->dst_offset` of the destination.
+ *
+ * @note A checkpoint is only valid for the firmware which produced it, as identified by the ELF SHA-256 of the app.
+ *
+ * @param[in]  handle   esp_delta_ota_handle_t handle
+ * @param[in]  buf      checkpoint passed to the checkpoint callback
+ * @param[in]  size     size of the checkpoint
+ * @param[out] info     position to resume from, may be NULL
+ * @return - ESP_OK
+ *         - ESP_ERR_INVALID_ARG
+ *         - ESP_ERR_INVALID_STATE if patch data was already fed
+ *         - ESP_ERR_INVALID_SIZE if the checkpoint is malformed or does not fit the write buffer
+ *         - ESP_ERR_INVALID_CRC if the checkpoint is corrupted
+ *         - ESP_ERR_INVALID_VERSION if the checkpoint was taken by a different firmware
+ */
+esp_err_t esp_delta_ota_restore_checkpoint(esp_delta_ota_handle_t handle, const void *buf, size_t size,
+        esp_delta_ota_checkpoint_info_t *info);
+
 /**
  * @brief This function finishes the patch applying operation.
  *
+ * When write coalescing is enabled, the remaining buffered output is passed to the write callback here.
+ *
  * @param[in] handle    esp_delta_ota_handle_t
  * @return int
  */
 esp_err_t esp_delta_ota_finalize(esp_delta_ota_handle_t handle);
 
+/**
+ * @brief Get the statistics of the source read cache
+ *
+ * The counters are accumulated since esp_delta_ota_init(). `src_reads` and `src_bytes_read`
+ * are updated even when the cache is disabled.
+ *
+ * @param[in]  handle   esp_delta_ota_handle_t
+ * @param[out] stats    pointer to esp_delta_ota_src_cache_stats_t structure to fill
+ * @return - ESP_OK
+ *         - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_delta_ota_get_src_cache_stats(esp_delta_ota_handle_t handle, esp_delta_ota_src_cache_stats_t *stats);
+
 /**
  * @brief Clean-up delta ota process
  *
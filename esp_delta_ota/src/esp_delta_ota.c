@@ -8,15 +8,34 @@
 #include <stdint.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/param.h>
 
+#include "sdkconfig.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_idf_version.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_app_desc.h"
+#else
+#include "esp_ota_ops.h"
+#define esp_app_get_elf_sha256 esp_ota_get_app_elf_sha256
+#endif
+#endif
 
 #include "esp_delta_ota.h"
 #include "detools.h"
 
 static const char *TAG = "esp_delta_ota";
 
+#define ESP_DELTA_OTA_CHECKPOINT_MAGIC  0xDE17A0C9
+/* Layout of the checkpoint blob and of the saved patcher state, bump on any change to them */
+#define ESP_DELTA_OTA_CHECKPOINT_VERSION    2
+#define ESP_DELTA_OTA_ELF_SHA256_LEN        65
+
 typedef struct esp_delta_ota_ctx {
     void *user_data;
     union {
@@ -29,51 +48,222 @@ typedef struct esp_delta_ota_ctx {
     };
     struct detools_apply_patch_t *apply_patch;
     int src_offset;
+    size_t src_size;
+    uint8_t *src_cache;                             /*!< Source read cache window */
+    size_t src_cache_size;
+    int src_cache_start;                            /*!< Source offset of the first cached byte */
+    size_t src_cache_len;                           /*!< Number of valid bytes in the cache */
+    bool src_seek_backward;                         /*!< Direction of the last seek, used for read-ahead */
+    esp_delta_ota_src_cache_stats_t src_cache_stats;
+    uint8_t *write_buf;                             /*!< Output aggregation buffer */
+    size_t write_buf_size;
+    size_t write_buf_len;                           /*!< Number of bytes pending in the output buffer */
+    size_t patch_offset;                            /*!< Number of patch bytes consumed */
+    size_t dst_offset;                              /*!< Number of output bytes passed to the write callback */
+    checkpoint_save_cb_t checkpoint_cb;
+    size_t checkpoint_interval;
+    size_t checkpoint_patch_offset;                 /*!< Patch offset of the last checkpoint */
 } esp_delta_ota_ctx;
 
-static int esp_delta_ota_write_cb(void *arg_p, const uint8_t *buf_p, size_t size)
+/* Checkpoint blob layout: header, raw patcher state, pending output bytes */
+typedef struct esp_delta_ota_checkpoint_hdr {
+    uint32_t magic;
+    uint32_t crc;                                   /*!< CRC32 of the blob following this field */
+    uint32_t version;                               /*!< ESP_DELTA_OTA_CHECKPOINT_VERSION */
+    char elf_sha256[ESP_DELTA_OTA_ELF_SHA256_LEN];  /*!< ELF SHA-256 of the app which took the checkpoint, empty on Linux */
+    uintptr_t code_addr;                            /*!< Address of esp_delta_ota_read_cb(), to rebase code pointers */
+    uint32_t patcher_size;
+    uint32_t write_buf_len;
+    int32_t src_offset;
+    uint32_t patch_offset;
+    uint32_t dst_offset;
+} esp_delta_ota_checkpoint_hdr_t;
+
+static esp_err_t esp_delta_ota_sink_write(esp_delta_ota_ctx *handle, const uint8_t *buf_p, size_t size)
 {
-    if (size <= 0) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    esp_delta_ota_ctx *handle = (esp_delta_ota_ctx *)arg_p;
     esp_err_t err = ESP_OK;
     if (!handle->user_data) {
         err = handle->write_cb(buf_p, size);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Error in write_cb(): %s", esp_err_to_name(err));
-            return ESP_FAIL;
+            return err;
         }
     } else {
         err = handle->write_cb_with_user_data(buf_p, size, handle->user_data);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Error in write_cb_with_user_data(): %s", esp_err_to_name(err));
-            return ESP_FAIL;
+            return err;
         }
     }
+    handle->dst_offset += size;
     return ESP_OK;
 }
 
-static int esp_delta_ota_read_cb(void *arg_p, uint8_t *buf_p, size_t size)
+static esp_err_t esp_delta_ota_write_buf_flush(esp_delta_ota_ctx *handle)
 {
-    if (size <= 0 || !arg_p) {
-        return -ESP_ERR_INVALID_ARG;
+    if (handle->write_buf_len == 0) {
+        return ESP_OK;
+    }
+    esp_err_t err = esp_delta_ota_sink_write(handle, handle->write_buf, handle->write_buf_len);
+    handle->write_buf_len = 0;
+    return err;
+}
+
+/* Aggregate the patcher output into write_buf_size chunks, so the sink only
+ * sees writes which are aligned to, and sized as, whole buffers. */
+static esp_err_t esp_delta_ota_write_buf_append(esp_delta_ota_ctx *handle, const uint8_t *buf_p, size_t size)
+{
+    esp_err_t err = ESP_OK;
+    while (size > 0) {
+        if (handle->write_buf_len == 0 && size >= handle->write_buf_size) {
+            /* Nothing pending, pass whole buffers through without copying */
+            size_t len = size - (size % handle->write_buf_size);
+            err = esp_delta_ota_sink_write(handle, buf_p, len);
+            if (err != ESP_OK) {
+                return err;
+            }
+            buf_p += len;
+            size -= len;
+            continue;
+        }
+
+        size_t len = MIN(size, handle->write_buf_size - handle->write_buf_len);
+        memcpy(handle->write_buf + handle->write_buf_len, buf_p, len);
+        handle->write_buf_len += len;
+        buf_p += len;
+        size -= len;
+        if (handle->write_buf_len == handle->write_buf_size) {
+            err = esp_delta_ota_write_buf_flush(handle);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+static int esp_delta_ota_write_cb(void *arg_p, const uint8_t *buf_p, size_t size)
+{
+    if (size <= 0) {
+        return ESP_ERR_INVALID_ARG;
     }
     esp_delta_ota_ctx *handle = (esp_delta_ota_ctx *)arg_p;
+    esp_err_t err = ESP_OK;
+    if (handle->write_buf) {
+        err = esp_delta_ota_write_buf_append(handle, buf_p, size);
+    } else {
+        err = esp_delta_ota_sink_write(handle, buf_p, size);
+    }
+    if (err != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t esp_delta_ota_src_read(esp_delta_ota_ctx *handle, uint8_t *buf_p, size_t size, int src_offset, bool log_error)
+{
     esp_err_t err = ESP_OK;
     if (!handle->user_data) {
-        err = handle->read_cb(buf_p, size, handle->src_offset);
+        err = handle->read_cb(buf_p, size, src_offset);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Error in read_cb(): %s", esp_err_to_name(err));
-            return ESP_FAIL;
+            if (log_error) {
+                ESP_LOGE(TAG, "Error in read_cb(): %s", esp_err_to_name(err));
+            }
+            return err;
         }
     } else {
-        err = handle->read_cb_with_user_data(buf_p, size, handle->src_offset, handle->user_data);
+        err = handle->read_cb_with_user_data(buf_p, size, src_offset, handle->user_data);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Error in read_cb_with_user_data(): %s", esp_err_to_name(err));
-            return ESP_FAIL;
+            if (log_error) {
+                ESP_LOGE(TAG, "Error in read_cb_with_user_data(): %s", esp_err_to_name(err));
+            }
+            return err;
         }
     }
+    handle->src_cache_stats.src_reads++;
+    handle->src_cache_stats.src_bytes_read += size;
+    return ESP_OK;
+}
+
+/* Refill the cache window so that it covers [src_offset, src_offset + size).
+ * The window is placed ahead of the request in the direction of the last seek. */
+static esp_err_t esp_delta_ota_src_cache_fill(esp_delta_ota_ctx *handle, int src_offset, size_t size)
+{
+    int start = src_offset;
+    if (handle->src_seek_backward) {
+        start = MAX(0, src_offset + (int)size - (int)handle->src_cache_size);
+    }
+    size_t len = handle->src_cache_size;
+    if (handle->src_size) {
+        len = MIN(len, handle->src_size - start);
+    }
+
+    handle->src_cache_len = 0;
+    /* Without the source size, a read-ahead past the end is expected to fail and is retried by the caller */
+    esp_err_t err = esp_delta_ota_src_read(handle, handle->src_cache, len, start, handle->src_size != 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    handle->src_cache_start = start;
+    handle->src_cache_len = len;
+    return ESP_OK;
+}
+
+static esp_err_t esp_delta_ota_src_cache_read(esp_delta_ota_ctx *handle, uint8_t *buf_p, size_t size)
+{
+    int offset = handle->src_offset;
+    bool hit = true;
+
+    handle->src_cache_stats.read_requests++;
+    while (size > 0) {
+        int cache_end = handle->src_cache_start + (int)handle->src_cache_len;
+        if (offset >= handle->src_cache_start && offset < cache_end) {
+            size_t len = MIN(size, (size_t)(cache_end - offset));
+            memcpy(buf_p, handle->src_cache + (offset - handle->src_cache_start), len);
+            buf_p += len;
+            offset += len;
+            size -= len;
+            continue;
+        }
+
+        hit = false;
+        /* Reads bigger than the window, or past the known end of the source, bypass the cache */
+        if (size >= handle->src_cache_size || (handle->src_size && offset + size > handle->src_size)) {
+            return esp_delta_ota_src_read(handle, buf_p, size, offset, true);
+        }
+        esp_err_t err = esp_delta_ota_src_cache_fill(handle, offset, size);
+        if (err != ESP_OK) {
+            if (handle->src_size) {
+                return err;
+            }
+            /* The read-ahead may run past the end of a source of unknown size, read only what was requested */
+            ESP_LOGD(TAG, "Read-ahead at %d failed, reading %zu bytes uncached", offset, size);
+            return esp_delta_ota_src_read(handle, buf_p, size, offset, true);
+        }
+    }
+
+    if (hit) {
+        handle->src_cache_stats.cache_hits++;
+    }
+    return ESP_OK;
+}
+
+static int esp_delta_ota_read_cb(void *arg_p, uint8_t *buf_p, size_t size)
+{
+    if (size <= 0 || !arg_p) {
+        return -ESP_ERR_INVALID_ARG;
+    }
+    esp_delta_ota_ctx *handle = (esp_delta_ota_ctx *)arg_p;
+    esp_err_t err = ESP_OK;
+    if (handle->src_cache) {
+        err = esp_delta_ota_src_cache_read(handle, buf_p, size);
+    } else {
+        handle->src_cache_stats.read_requests++;
+        err = esp_delta_ota_src_read(handle, buf_p, size, handle->src_offset, true);
+    }
+    if (err != ESP_OK) {
+        return ESP_FAIL;
+    }
 
     handle->src_offset += size;
     return ESP_OK;
@@ -83,6 +273,9 @@ static int esp_delta_ota_seek_cb(void *arg_p, int offset)
 {
     esp_delta_ota_ctx *handle = (esp_delta_ota_ctx *)arg_p;
     handle->src_offset += offset;
+    if (offset != 0) {
+        handle->src_seek_backward = (offset < 0);
+    }
     return ESP_OK;
 }
 
@@ -96,9 +289,35 @@ esp_delta_ota_handle_t esp_delta_ota_init(esp_delta_ota_cfg_t *cfg)
     ctx->user_data = cfg->user_data;
     ctx->read_cb = cfg->read_cb;
     ctx->write_cb_with_user_data = cfg->write_cb_with_user_data;
+    ctx->src_size = cfg->src_size;
+    ctx->checkpoint_cb = cfg->checkpoint_cb;
+    ctx->checkpoint_interval = cfg->checkpoint_interval;
+    if (cfg->src_cache_size) {
+        ctx->src_cache = malloc(cfg->src_cache_size);
+        if (!ctx->src_cache) {
+            ESP_LOGE(TAG, "Unable to allocate memory");
+            free(ctx);
+            ctx = NULL;
+            return NULL;
+        }
+        ctx->src_cache_size = cfg->src_cache_size;
+    }
+    if (cfg->write_buf_size) {
+        ctx->write_buf = malloc(cfg->write_buf_size);
+        if (!ctx->write_buf) {
+            ESP_LOGE(TAG, "Unable to allocate memory");
+            free(ctx->src_cache);
+            free(ctx);
+            ctx = NULL;
+            return NULL;
+        }
+        ctx->write_buf_size = cfg->write_buf_size;
+    }
     ctx->apply_patch = calloc(1, sizeof(struct detools_apply_patch_t));
     if (!ctx->apply_patch) {
         ESP_LOGE(TAG, "Unable to allocate memory");
+        free(ctx->write_buf);
+        free(ctx->src_cache);
         free(ctx);
         ctx = NULL;
         return NULL;
@@ -108,6 +327,8 @@ esp_delta_ota_handle_t esp_delta_ota_init(esp_delta_ota_cfg_t *cfg)
         ESP_LOGE(TAG, "Error while initializing delta_ota: %s", detools_error_as_string(ret));
         free(ctx->apply_patch);
         ctx->apply_patch = NULL;
+        free(ctx->write_buf);
+        free(ctx->src_cache);
         free(ctx);
         ctx = NULL;
         return NULL;
@@ -115,6 +336,152 @@ esp_delta_ota_handle_t esp_delta_ota_init(esp_delta_ota_cfg_t *cfg)
     return (esp_delta_ota_handle_t)ctx;
 }
 
+#define ESP_DELTA_OTA_REBASE_CODE(func, delta)  do {                 \
+        if (func) {                                                     \
+            (func) = (__typeof__(func))((uintptr_t)(func) + (delta));   \
+        }                                                               \
+    } while (0)
+
+static void esp_delta_ota_get_elf_sha256(char *dst)
+{
+    memset(dst, 0, ESP_DELTA_OTA_ELF_SHA256_LEN);
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_app_get_elf_sha256(dst, ESP_DELTA_OTA_ELF_SHA256_LEN);
+#endif
+}
+
+/* Restore the saved patcher state into the patcher of this context. The state is
+ * plain data (heatshrink window, offsets, counters) except for the members below,
+ * which point to the context, to the patcher itself or to the last patch chunk. */
+static void esp_delta_ota_restore_patcher(esp_delta_ota_ctx *ctx, const uint8_t *saved, uintptr_t code_delta)
+{
+    struct detools_apply_patch_t *patcher = ctx->apply_patch;
+    /* Callbacks and their argument, as set by detools_apply_patch_init() for this context */
+    detools_read_t from_read = patcher->from_read;
+    detools_seek_t from_seek = patcher->from_seek;
+    detools_write_t to_write = patcher->to_write;
+
+    memcpy(patcher, saved, sizeof(struct detools_apply_patch_t));
+    patcher->from_read = from_read;
+    patcher->from_seek = from_seek;
+    patcher->to_write = to_write;
+    patcher->arg_p = ctx;
+    if (patcher->patch_reader.patch_chunk_p) {
+        patcher->patch_reader.patch_chunk_p = &patcher->chunk;
+    }
+    /* The chunk was fully consumed by the esp_delta_ota_feed_patch() which preceded the checkpoint */
+    patcher->chunk.buf_p = NULL;
+    /* Decompressor functions of the same firmware, which may be loaded at another address, e.g. a PIE host build */
+    ESP_DELTA_OTA_REBASE_CODE(patcher->patch_reader.destroy, code_delta);
+    ESP_DELTA_OTA_REBASE_CODE(patcher->patch_reader.decompress, code_delta);
+}
+
+esp_err_t esp_delta_ota_checkpoint(esp_delta_ota_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_delta_ota_ctx *ctx = (esp_delta_ota_ctx *)handle;
+    if (ctx->checkpoint_cb == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t size = sizeof(esp_delta_ota_checkpoint_hdr_t) + sizeof(struct detools_apply_patch_t) + ctx->write_buf_len;
+    uint8_t *buf = malloc(size);
+    if (!buf) {
+        ESP_LOGE(TAG, "Unable to allocate memory");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_delta_ota_checkpoint_hdr_t *hdr = (esp_delta_ota_checkpoint_hdr_t *)buf;
+    *hdr = (esp_delta_ota_checkpoint_hdr_t) {
+        .magic = ESP_DELTA_OTA_CHECKPOINT_MAGIC,
+        .version = ESP_DELTA_OTA_CHECKPOINT_VERSION,
+        .code_addr = (uintptr_t)&esp_delta_ota_read_cb,
+        .patcher_size = sizeof(struct detools_apply_patch_t),
+        .write_buf_len = ctx->write_buf_len,
+        .src_offset = ctx->src_offset,
+        .patch_offset = ctx->patch_offset,
+        .dst_offset = ctx->dst_offset,
+    };
+    esp_delta_ota_get_elf_sha256(hdr->elf_sha256);
+    uint8_t *data = buf + sizeof(esp_delta_ota_checkpoint_hdr_t);
+    memcpy(data, ctx->apply_patch, sizeof(struct detools_apply_patch_t));
+    if (ctx->write_buf_len) {
+        memcpy(data + sizeof(struct detools_apply_patch_t), ctx->write_buf, ctx->write_buf_len);
+    }
+    hdr->crc = esp_rom_crc32_le(0, buf + offsetof(esp_delta_ota_checkpoint_hdr_t, version),
+                                size - offsetof(esp_delta_ota_checkpoint_hdr_t, version));
+
+    esp_err_t err = ctx->checkpoint_cb(buf, size, ctx->user_data);
+    free(buf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error in checkpoint_cb(): %s", esp_err_to_name(err));
+        return err;
+    }
+    ctx->checkpoint_patch_offset = ctx->patch_offset;
+    return ESP_OK;
+}
+
+esp_err_t esp_delta_ota_restore_checkpoint(esp_delta_ota_handle_t handle, const void *buf, size_t size,
+        esp_delta_ota_checkpoint_info_t *info)
+{
+    if (handle == NULL || buf == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_delta_ota_ctx *ctx = (esp_delta_ota_ctx *)handle;
+    if (ctx->patch_offset != 0) {
+        ESP_LOGE(TAG, "Checkpoint can only be restored before feeding the patch");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_delta_ota_checkpoint_hdr_t hdr;
+    if (size < sizeof(hdr)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.magic != ESP_DELTA_OTA_CHECKPOINT_MAGIC
+            || size != sizeof(hdr) + hdr.patcher_size + hdr.write_buf_len) {
+        ESP_LOGE(TAG, "Invalid checkpoint");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *bytes = (const uint8_t *)buf;
+    if (hdr.crc != esp_rom_crc32_le(0, bytes + offsetof(esp_delta_ota_checkpoint_hdr_t, version),
+                                    size - offsetof(esp_delta_ota_checkpoint_hdr_t, version))) {
+        ESP_LOGE(TAG, "Checkpoint CRC mismatch");
+        return ESP_ERR_INVALID_CRC;
+    }
+    /* The saved state holds code pointers, so it is only valid for the firmware which produced it */
+    char elf_sha256[ESP_DELTA_OTA_ELF_SHA256_LEN];
+    esp_delta_ota_get_elf_sha256(elf_sha256);
+    if (hdr.version != ESP_DELTA_OTA_CHECKPOINT_VERSION || hdr.patcher_size != sizeof(struct detools_apply_patch_t)
+            || memcmp(hdr.elf_sha256, elf_sha256, sizeof(elf_sha256)) != 0) {
+        ESP_LOGE(TAG, "Checkpoint was taken by a different firmware");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (hdr.write_buf_len > ctx->write_buf_size) {
+        ESP_LOGE(TAG, "Checkpoint holds more pending output than the write buffer can take");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *data = bytes + sizeof(hdr);
+    esp_delta_ota_restore_patcher(ctx, data, (uintptr_t)&esp_delta_ota_read_cb - hdr.code_addr);
+    if (hdr.write_buf_len) {
+        memcpy(ctx->write_buf, data + hdr.patcher_size, hdr.write_buf_len);
+    }
+    ctx->write_buf_len = hdr.write_buf_len;
+    ctx->src_offset = hdr.src_offset;
+    ctx->src_cache_len = 0;
+    ctx->patch_offset = hdr.patch_offset;
+    ctx->dst_offset = hdr.dst_offset;
+    ctx->checkpoint_patch_offset = hdr.patch_offset;
+
+    if (info) {
+        info->patch_offset = hdr.patch_offset;
+        info->dst_offset = hdr.dst_offset;
+    }
+    return ESP_OK;
+}
+
 esp_err_t esp_delta_ota_feed_patch(esp_delta_ota_handle_t handle, const uint8_t *buf, int size)
 {
     if (handle == NULL) {
@@ -127,6 +494,17 @@ esp_err_t esp_delta_ota_feed_patch(esp_delta_ota_handle_t handle, const uint8_t
         ESP_LOGE(TAG, "Error while applying patch: %s", detools_error_as_string(err));
         return ESP_FAIL;
     }
+    ctx->patch_offset += size;
+
+    /* The chunk is consumed at this point, so a failed checkpoint must not fail the feed:
+     * the caller would feed the chunk again. It is retried after the next chunk. */
+    if (ctx->checkpoint_cb && ctx->checkpoint_interval
+            && ctx->patch_offset - ctx->checkpoint_patch_offset >= ctx->checkpoint_interval) {
+        esp_err_t ret = esp_delta_ota_checkpoint(handle);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Automatic checkpoint at patch offset %zu failed: %s", ctx->patch_offset, esp_err_to_name(ret));
+        }
+    }
     return ESP_OK;
 }
 
@@ -142,6 +520,20 @@ esp_err_t esp_delta_ota_finalize(esp_delta_ota_handle_t handle)
         ESP_LOGE(TAG, "Error while finishing the patching: %s", detools_error_as_string(err));
         return ESP_FAIL;
     }
+    if (esp_delta_ota_write_buf_flush(ctx) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_delta_ota_get_src_cache_stats(esp_delta_ota_handle_t handle, esp_delta_ota_src_cache_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_delta_ota_ctx *ctx = (esp_delta_ota_ctx *)handle;
+
+    *stats = ctx->src_cache_stats;
     return ESP_OK;
 }
 
@@ -154,6 +546,10 @@ esp_err_t esp_delta_ota_deinit(esp_delta_ota_handle_t handle)
 
     free(ctx->apply_patch);
     ctx->apply_patch = NULL;
+    free(ctx->src_cache);
+    ctx->src_cache = NULL;
+    free(ctx->write_buf);
+    ctx->write_buf = NULL;
     free(ctx);
     ctx = NULL;
     return ESP_OK;
@@ -30,8 +30,41 @@ typedef enum {
 typedef enum {
     JPEG_IMAGE_FORMAT_RGB888 = 0,   /*!< Format RGB888 */
     JPEG_IMAGE_FORMAT_RGB565,       /*!< Format RGB565 */
+    JPEG_IMAGE_FORMAT_YUV422,       /*!< Format YUV422, packed Y0 U Y1 V (YUYV), 2 bytes per pixel. Swapped color bytes give U Y0 V Y1 (UYVY).
+                                         Full range Y/Cb/Cr of the JPEG without RGB conversion, chroma of each pixel pair is taken from the first pixel */
+    JPEG_IMAGE_FORMAT_YUV420,       /*!< Format YUV420, planar I420: Y plane, U and V planes of half width and height (rounded up).
+                                         Swapped color bytes give YV12 (V plane first). Chroma is taken from pixels at even rows and columns */
 } esp_jpeg_image_format_t;
 
+/**
+ * @brief Input callback for streaming decoding
+ *
+ * Called by the decoder whenever it needs more JPEG data. The callback may block until data is available
+ * (e.g. waiting for the next camera or HTTP chunk) and may return fewer bytes than requested.
+ *
+ * @param[out] buf      Buffer to be filled with JPEG data
+ * @param[in]  len      Maximum number of bytes to write to buf
+ * @param[in]  user_ctx User context from esp_jpeg_image_cfg_t
+ *
+ * @return Number of bytes written to buf, 0 at the end of the stream or on error
+ */
+typedef size_t (*esp_jpeg_input_cb_t)(uint8_t *buf, size_t len, void *user_ctx);
+
+/**
+ * @brief Output callback for band decoding
+ *
+ * Called by the decoder whenever a band of rows is decoded. The band buffer is reused for the next band
+ * after the callback returns, so the data must be consumed (or copied) in the callback.
+ *
+ * @param[in] band     Decoded rows, each row has the width of the output image
+ * @param[in] y        First row of the band in the output image
+ * @param[in] height   Number of rows in the band
+ * @param[in] user_ctx User context from esp_jpeg_image_cfg_t
+ *
+ * @return ESP_OK to continue decoding, other value stops decoding and is returned from esp_jpeg_decode()
+ */
+typedef esp_err_t (*esp_jpeg_output_cb_t)(const uint8_t *band, uint16_t y, uint16_t height, void *user_ctx);
+
 /**
  * @brief JPEG Configuration Type
  *
@@ -48,15 +81,47 @@ typedef struct esp_jpeg_image_cfg_s {
         uint8_t swap_color_bytes: 1; /*!< Swap first and last color bytes */
     } flags;
 
+    struct {
+        esp_jpeg_input_cb_t read_cb; /*!< If set, the JPEG is read through this callback instead of indata (streaming decoding).
+                                          indata and indata_size are not used in esp_jpeg_decode() then */
+        void *user_ctx;              /*!< User context passed to read_cb */
+    } input;
+
+    struct {
+        uint16_t x;         /*!< Left edge of the region in the output (scaled) image */
+        uint16_t y;         /*!< Top edge of the region in the output (scaled) image */
+        uint16_t width;     /*!< Width of the region. If width or height is 0, the whole image is decoded */
+        uint16_t height;    /*!< Height of the region */
+    } roi;                  /*!< Region of interest. Only this region is decoded and written to outbuf */
+
+    struct {
+        esp_jpeg_output_cb_t band_cb;   /*!< If set, the image is output in bands through this callback. outbuf holds only one band
+                                             and must have at least band_len bytes (see esp_jpeg_get_image_info()) */
+        void *user_ctx;                 /*!< User context passed to band_cb */
+    } output;
+
     struct {
         void *working_buffer;       /*!< If set to NULL, a working buffer will be allocated in esp_jpeg_decode().
                                          Tjpgd does not use dynamic allocation, se we pass this buffer to Tjpgd that uses it as scratchpad */
         size_t working_buffer_size; /*!< Size of the working buffer. Must be set it working_buffer != NULL.
-                                         Default size is 3.1kB or 65kB if JD_FASTDECODE == 2 */
+                                         Default size is 3.1kB (5kB with JD_PROGRESSIVE) or 65kB if JD_FASTDECODE >= 2 */
+        uint8_t workers;            /*!< Number of tasks decoding the image in parallel. 0 or 1 decodes in the calling task only.
+                                         Used only for images with restart markers in indata and without the ROM decoder.
+                                         Each additional worker allocates a working buffer of working_buffer_size */
+        void *coef_buffer;          /*!< Coefficient buffer for progressive JPEG (JD_PROGRESSIVE). If set to NULL, it is allocated
+                                         in esp_jpeg_decode(), in PSRAM if available. Not used for baseline JPEG */
+        size_t coef_buffer_size;    /*!< Size of the coefficient buffer, at least coef_len (see esp_jpeg_get_image_info()) */
     } advanced;
 
     struct {
         uint32_t read;  /*!< Internal count of read bytes */
+        void (*out_row)(uint8_t *dst, const uint8_t *src, size_t width); /*!< Internal output row conversion, selected per image */
+        struct {
+            uint16_t left, top, right, bottom;
+        } out_rect;     /*!< Internal region of the output image, which is written to outbuf */
+        uint16_t band_top;      /*!< Internal first row of the band in outbuf */
+        uint16_t band_bottom;   /*!< Internal last row of the band in outbuf */
+        esp_err_t band_err;     /*!< Internal error returned from band_cb */
     } priv;
 } esp_jpeg_image_cfg_t;
 
@@ -67,12 +132,38 @@ typedef struct esp_jpeg_image_output_s {
     uint16_t width;    /*!< Width of the output image */
     uint16_t height;   /*!< Height of the output image */
     size_t output_len; /*!< Length of the output image in bytes */
+    uint16_t band_height; /*!< Height of one band (MCU row) of the output image */
+    size_t band_len;   /*!< Length of one band of the output image in bytes (size of outbuf in band mode) */
+    size_t coef_len;   /*!< Length of the coefficient buffer for a progressive JPEG, 0 for baseline JPEG */
 } esp_jpeg_image_output_t;
 
+/**
+ * @brief JPEG decoder handle
+ *
+ * The handle keeps its working buffer and the Huffman and quantization tables between images.
+ */
+typedef struct esp_jpeg_decoder_s *esp_jpeg_decoder_handle_t;
+
+/**
+ * @brief JPEG decoder handle configuration
+ */
+typedef struct {
+    size_t working_buffer_size; /*!< Size of the working buffer of the decoder, 0: default size.
+                                     Default size is 5kB or 65kB if JD_FASTDECODE >= 2 (3.1kB with the ROM decoder) */
+} esp_jpeg_decoder_config_t;
+
 /**
  * @brief Decode JPEG image
  *
  * @note This function is blocking.
+ * @note If cfg->input.read_cb is set, the image is decoded while it is being read, so the whole JPEG
+ *       does not need to be in memory.
+ * @note If cfg->roi is set, only the region is decoded. The output image (and outbuf) then has the size of the region.
+ * @note If cfg->output.band_cb is set, the image is decoded in bands of band_height rows. outbuf holds one band,
+ *       which is passed to the callback. Parallel decoding (advanced.workers) is not used in this mode.
+ * @note Progressive JPEG needs JD_PROGRESSIVE. All scans are decoded into the coefficient buffer (advanced.coef_buffer)
+ *       before the image is output, so it is not decoded in parallel.
+ * @note YUV output formats are not supported with the ROM decoder. JPEG_IMAGE_FORMAT_YUV420 is not supported in band mode.
  *
  * @param[in]  cfg: Configuration structure
  * @param[out] img: Output image info
@@ -80,7 +171,10 @@ typedef struct esp_jpeg_image_output_s {
  * @return
  *      - ESP_OK            on success
  *      - ESP_ERR_NO_MEM    if there is no memory for allocating main structure
+ *      - ESP_ERR_INVALID_ARG if advanced.coef_buffer is smaller than needed for the image
+ *      - ESP_ERR_NOT_SUPPORTED if the output format is not supported in this configuration
  *      - ESP_FAIL          if there is an error in decoding JPEG
+ *      - Error returned from cfg->output.band_cb, if it stopped decoding
  */
 esp_err_t esp_jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img);
 
@@ -88,7 +182,9 @@ esp_err_t esp_jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *im
  * @brief Get information about the JPEG image
  *
  * Use this function to get the size of the JPEG image without decoding it.
- * Allocate a buffer of size img->output_len to store the decoded image.
+ * Allocate a buffer of size img->output_len to store the decoded image,
+ * or of size img->band_len when decoding in bands (cfg->output.band_cb).
+ * A progressive JPEG also needs a coefficient buffer of size img->coef_len.
  *
  * @note cfg->outbuf and cfg->outbuf_size are not used in this function.
  * @param[in]  cfg: Configuration structure
@@ -97,10 +193,57 @@ esp_err_t esp_jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *im
  * @return
  *      - ESP_OK              on success
  *      - ESP_ERR_INVALID_ARG if cfg or img is NULL
+ *      - ESP_ERR_NOT_SUPPORTED if the image is a progressive JPEG and JD_PROGRESSIVE is disabled
  *      - ESP_FAIL            if there is an error in decoding JPEG
  */
 esp_err_t esp_jpeg_get_image_info(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img);
 
+/**
+ * @brief Create a JPEG decoder handle
+ *
+ * Use a decoder handle to decode many images, e.g. frames of MJPEG video. The working buffer is allocated once,
+ * and the Huffman and quantization tables, which are usually the same in all frames, are created only when they change.
+ *
+ * @param[in]  config: Decoder configuration, NULL for the default configuration
+ * @param[out] ret_decoder: Created decoder handle
+ *
+ * @return
+ *      - ESP_OK              on success
+ *      - ESP_ERR_INVALID_ARG if ret_decoder is NULL
+ *      - ESP_ERR_NO_MEM      if there is no memory for the decoder
+ */
+esp_err_t esp_jpeg_decoder_create(const esp_jpeg_decoder_config_t *config, esp_jpeg_decoder_handle_t *ret_decoder);
+
+/**
+ * @brief Decode JPEG image with a decoder handle
+ *
+ * Same as esp_jpeg_decode(), but the working buffer of the decoder is used (cfg->advanced.working_buffer is ignored).
+ * A table defined with the same data as in the previous image is not created again.
+ *
+ * @note The decoder must not be used by more tasks at the same time.
+ * @note The ROM decoder can't keep the tables, only the working buffer is reused.
+ *
+ * @param[in]  decoder: Decoder handle
+ * @param[in]  cfg: Configuration structure
+ * @param[out] img: Output image info
+ *
+ * @return
+ *      - ESP_ERR_INVALID_ARG if decoder, cfg or img is NULL
+ *      - Other return values as esp_jpeg_decode()
+ */
+esp_err_t esp_jpeg_decoder_decode(esp_jpeg_decoder_handle_t decoder, esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img);
+
+/**
+ * @brief Delete a JPEG decoder handle
+ *
+ * @param[in] decoder: Decoder handle
+ *
+ * @return
+ *      - ESP_OK              on success
+ *      - ESP_ERR_INVALID_ARG if decoder is NULL
+ */
+esp_err_t esp_jpeg_decoder_delete(esp_jpeg_decoder_handle_t decoder);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,15 +5,17 @@
  */
 
 #include <string.h>
+#include <sys/param.h>
 #include "freertos/FreeRTOS.h"
 #include "esp_system.h"
-#include "esp_rom_caps.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
 #include "jpeg_decoder.h"
+#include "jpeg_out_row.h"
 
 #if CONFIG_JD_USE_ROM
+#include "esp_rom_caps.h"
 /* When supported in ROM, use ROM functions */
 #if defined(ESP_ROM_HAS_JPEG_DECODE)
 #include "rom/tjpgd.h"
@@ -23,25 +25,42 @@
 
 /* The ROM code of TJPGD is older and has different return type in decode callback */
 typedef unsigned int jpeg_decode_out_t;
+typedef unsigned int jpeg_decode_in_size_t;
 #else
 /* When Tiny JPG Decoder is not in ROM or selected external code */
+#include <pthread.h>
 #include "tjpgd.h"
 
 /* The TJPGD outside the ROM code is newer and has different return type in decode callback */
 typedef int jpeg_decode_out_t;
+typedef size_t jpeg_decode_in_size_t;
 #endif
 
 static const char *TAG = "JPEG";
 
-#define LOBYTE(u16)     ((uint8_t)(((uint16_t)(u16)) & 0xff))
-#define HIBYTE(u16)     ((uint8_t)((((uint16_t)(u16))>>8) & 0xff))
+struct esp_jpeg_decoder_s {
+    JDEC jd;                /* Decoder object, keeps the tables of the previous image in workbuf */
+    uint8_t *workbuf;
+    size_t workbuf_size;
+};
 
-#if defined(JD_FASTDECODE) && (JD_FASTDECODE == 2)
+#if defined(JD_FASTDECODE) && (JD_FASTDECODE >= 2)
 #define JPEG_WORK_BUF_SIZE  65472
+#elif defined(JD_PROGRESSIVE) && JD_PROGRESSIVE
+#define JPEG_WORK_BUF_SIZE  5120    /* Huffman tables of progressive JPEG are redefined (and may grow) between scans */
 #else
 #define JPEG_WORK_BUF_SIZE  3100    /* Recommended buffer size; Independent on the size of the image */
 #endif
 
+/* A decoder handle keeps all tables at their max size at the start of its working buffer */
+#if defined(JD_FASTDECODE) && (JD_FASTDECODE >= 2)
+#define JPEG_DECODER_WORK_BUF_SIZE  65472
+#elif CONFIG_JD_USE_ROM
+#define JPEG_DECODER_WORK_BUF_SIZE  JPEG_WORK_BUF_SIZE  /* The ROM decoder doesn't keep the tables */
+#else
+#define JPEG_DECODER_WORK_BUF_SIZE  5120
+#endif
+
 /* If not set JD_FORMAT, it is set in ROM to RGB888, otherwise, it can be set in config */
 #ifndef JD_FORMAT
 #define JD_FORMAT 0
@@ -50,8 +69,10 @@ static const char *TAG = "JPEG";
 /* Output color bytes from tjpgd (depends on JD_FORMAT) */
 #if (JD_FORMAT==0)
 #define ESP_JPEG_COLOR_BYTES    3
+#define ESP_JPEG_IN_FORMAT      JPEG_IMAGE_FORMAT_RGB888
 #elif  (JD_FORMAT==1)
 #define ESP_JPEG_COLOR_BYTES    2
+#define ESP_JPEG_IN_FORMAT      JPEG_IMAGE_FORMAT_RGB565
 #elif  (JD_FORMAT==2)
 #error Grayscale image output format is not supported
 #define ESP_JPEG_COLOR_BYTES    1
@@ -62,10 +83,21 @@ static const char *TAG = "JPEG";
 *******************************************************************************/
 static uint8_t jpeg_get_div_by_scale(esp_jpeg_image_scale_t scale);
 static uint8_t jpeg_get_color_bytes(esp_jpeg_image_format_t format);
+static size_t jpeg_get_output_len(esp_jpeg_image_format_t format, uint16_t width, uint16_t height);
+static inline bool jpeg_is_yuv(esp_jpeg_image_format_t format);
 
-static unsigned int jpeg_decode_in_cb(JDEC *jd, uint8_t *buff, unsigned int nbyte);
+static jpeg_decode_in_size_t jpeg_decode_in_cb(JDEC *jd, uint8_t *buff, jpeg_decode_in_size_t nbyte);
+static jpeg_decode_in_size_t jpeg_decode_in_stream(esp_jpeg_image_cfg_t *cfg, uint8_t *buff, jpeg_decode_in_size_t nbyte);
 static jpeg_decode_out_t jpeg_decode_out_cb(JDEC *jd, void *bitmap, JRECT *rect);
+static esp_err_t jpeg_band_flush(esp_jpeg_image_cfg_t *cfg);
+static void jpeg_out_row_yuv422(const esp_jpeg_image_cfg_t *cfg, uint8_t *dst, const uint8_t *in, uint16_t x, size_t width);
+static void jpeg_out_chroma_yuv420(const esp_jpeg_image_cfg_t *cfg, const uint8_t *in, size_t in_stride,
+                                   uint16_t left, uint16_t top, uint16_t right, uint16_t bottom);
 static inline uint16_t ldb_word(const void *ptr);
+#if !CONFIG_JD_USE_ROM
+static esp_err_t jpeg_decode_parallel(esp_jpeg_image_cfg_t *cfg, JDEC *jd, const JRECT *rect, size_t workbuf_size, bool *decoded);
+#endif
+static esp_err_t jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img, JDEC *jd, uint8_t *workbuf, size_t workbuf_size, bool cached);
 /*******************************************************************************
 * Public API functions
 *******************************************************************************/
@@ -74,7 +106,6 @@ esp_err_t esp_jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *im
 {
     esp_err_t ret = ESP_OK;
     uint8_t *workbuf = NULL;
-    JRESULT res;
     JDEC JDEC;
 
     assert(cfg != NULL);
@@ -84,40 +115,55 @@ esp_err_t esp_jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *im
     const size_t workbuf_size = allocate_buffer ? JPEG_WORK_BUF_SIZE : cfg->advanced.working_buffer_size;
     if (allocate_buffer) {
         workbuf = heap_caps_malloc(JPEG_WORK_BUF_SIZE, MALLOC_CAP_DEFAULT);
-        ESP_GOTO_ON_FALSE(workbuf, ESP_ERR_NO_MEM, err, TAG, "no mem for JPEG work buffer");
+        ESP_RETURN_ON_FALSE(workbuf, ESP_ERR_NO_MEM, TAG, "no mem for JPEG work buffer");
     } else {
         workbuf = cfg->advanced.working_buffer;
         ESP_RETURN_ON_FALSE(workbuf_size != 0, ESP_ERR_INVALID_ARG, TAG, "Working buffer size not defined!");
     }
 
-    cfg->priv.read = 0;
+    ret = jpeg_decode(cfg, img, &JDEC, workbuf, workbuf_size, false);
 
-    /* Prepare image */
-    res = jd_prepare(&JDEC, jpeg_decode_in_cb, workbuf, workbuf_size, cfg);
-    ESP_GOTO_ON_FALSE((res == JDR_OK), ESP_FAIL, err, TAG, "Error in preparing JPEG image! %d", res);
+    if (allocate_buffer) {
+        free(workbuf);
+    }
 
-    const uint8_t scale_div       = jpeg_get_div_by_scale(cfg->out_scale);
-    const uint8_t out_color_bytes = jpeg_get_color_bytes(cfg->out_format);
+    return ret;
+}
 
-    /* Size of output image */
-    const uint32_t outsize = (JDEC.height / scale_div) * (JDEC.width / scale_div) * out_color_bytes;
-    ESP_GOTO_ON_FALSE((outsize <= cfg->outbuf_size), ESP_ERR_NO_MEM, err, TAG, "Not enough size in output buffer!");
+esp_err_t esp_jpeg_decoder_create(const esp_jpeg_decoder_config_t *config, esp_jpeg_decoder_handle_t *ret_decoder)
+{
+    ESP_RETURN_ON_FALSE(ret_decoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    const size_t workbuf_size = (config && config->working_buffer_size) ? config->working_buffer_size : JPEG_DECODER_WORK_BUF_SIZE;
+    esp_jpeg_decoder_handle_t decoder = calloc(1, sizeof(struct esp_jpeg_decoder_s));   /* Zeroed decoder object has no tables yet */
+    ESP_RETURN_ON_FALSE(decoder, ESP_ERR_NO_MEM, TAG, "no mem for JPEG decoder");
+    decoder->workbuf = heap_caps_malloc(workbuf_size, MALLOC_CAP_DEFAULT);
+    if (decoder->workbuf == NULL) {
+        free(decoder);
+        ESP_LOGE(TAG, "no mem for JPEG work buffer");
+        return ESP_ERR_NO_MEM;
+    }
+    decoder->workbuf_size = workbuf_size;
+    *ret_decoder = decoder;
 
-    /* Size of output image */
-    img->height = JDEC.height / scale_div;
-    img->width = JDEC.width / scale_div;
-    img->output_len = outsize;
+    return ESP_OK;
+}
 
-    /* Decode JPEG */
-    res = jd_decomp(&JDEC, jpeg_decode_out_cb, cfg->out_scale);
-    ESP_GOTO_ON_FALSE((res == JDR_OK), ESP_FAIL, err, TAG, "Error in decoding JPEG image! %d", res);
+esp_err_t esp_jpeg_decoder_decode(esp_jpeg_decoder_handle_t decoder, esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img)
+{
+    ESP_RETURN_ON_FALSE(decoder && cfg && img, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
 
-err:
-    if (workbuf && allocate_buffer) {
-        free(workbuf);
-    }
+    return jpeg_decode(cfg, img, &decoder->jd, decoder->workbuf, decoder->workbuf_size, true);
+}
 
-    return ret;
+esp_err_t esp_jpeg_decoder_delete(esp_jpeg_decoder_handle_t decoder)
+{
+    ESP_RETURN_ON_FALSE(decoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    free(decoder->workbuf);
+    free(decoder);
+
+    return ESP_OK;
 }
 
 esp_err_t esp_jpeg_get_image_info(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img)
@@ -147,7 +193,14 @@ esp_err_t esp_jpeg_get_image_info(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_outp
             return ESP_FAIL; // No more data
         }
 
+#if defined(JD_PROGRESSIVE) && JD_PROGRESSIVE
+        if ((marker & 0xFF) == 0xC0 || (marker & 0xFF) == 0xC2) {  /* SOF0 (baseline JPEG) or SOF2 (progressive JPEG) */
+#else
+        if ((marker & 0xFF) == 0xC2) {
+            return ESP_ERR_NOT_SUPPORTED;   /* SOF2 (progressive JPEG) is decoded only with JD_PROGRESSIVE */
+        }
         if ((marker & 0xFF) == 0xC0) {  /* SOF0 (baseline JPEG) */
+#endif
             seg += 4; /* Skip marker and length field */
 
             /* Size of output image */
@@ -155,7 +208,21 @@ esp_err_t esp_jpeg_get_image_info(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_outp
             img->width = ldb_word(seg + 3);
             const uint8_t scale_div       = jpeg_get_div_by_scale(cfg->out_scale);
             const uint8_t out_color_bytes = jpeg_get_color_bytes(cfg->out_format);
-            img->output_len = (img->height / scale_div) * (img->width / scale_div) * out_color_bytes;
+            img->output_len = jpeg_get_output_len(cfg->out_format, img->width / scale_div, img->height / scale_div);
+            const uint8_t msy = (len >= 10) ? MAX(seg[7] & 0x0F, 1) : 1;    /* Vertical sampling factor of Y */
+            img->band_height = MAX((8 * msy) / scale_div, 1);
+            img->band_len = (img->width / scale_div) * img->band_height * out_color_bytes;
+
+            img->coef_len = 0;
+#if defined(JD_PROGRESSIVE) && JD_PROGRESSIVE
+            /* Coefficients of all blocks in the image are buffered for progressive JPEG */
+            if ((marker & 0xFF) == 0xC2) {
+                const uint8_t msx = (len >= 10) ? MAX(seg[7] >> 4, 1) : 1;  /* Horizontal sampling factor of Y */
+                const size_t nmcu = ((img->width + 8 * msx - 1) / (8 * msx)) * ((img->height + 8 * msy - 1) / (8 * msy));
+                const uint8_t blocks = msx * msy + ((len >= 10 && seg[5] == 3) ? 2 : 0);    /* Y blocks and Cb, Cr blocks of an MCU */
+                img->coef_len = nmcu * blocks * 64 * sizeof(int16_t);
+            }
+#endif
             ret = ESP_OK;
             break;
         }
@@ -167,7 +234,133 @@ esp_err_t esp_jpeg_get_image_info(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_outp
 * Private API functions
 *******************************************************************************/
 
-static unsigned int jpeg_decode_in_cb(JDEC *dec, uint8_t *buff, unsigned int nbyte)
+/*
+ * Decode the image with the decoder object and working buffer of esp_jpeg_decode() or of a decoder handle.
+ * With cached set, the tables of the previous image in jd and workbuf are reused if they are the same.
+ */
+static esp_err_t jpeg_decode(esp_jpeg_image_cfg_t *cfg, esp_jpeg_image_output_t *img, JDEC *jd, uint8_t *workbuf, size_t workbuf_size, bool cached)
+{
+    esp_err_t ret = ESP_OK;
+    int16_t *coefbuf = NULL;
+    JRESULT res;
+
+    cfg->priv.read = 0;
+    cfg->priv.out_row = jpeg_out_row_get(ESP_JPEG_IN_FORMAT, cfg->out_format, cfg->flags.swap_color_bytes);
+    ESP_GOTO_ON_FALSE(cfg->priv.out_row, ESP_ERR_NOT_SUPPORTED, err, TAG, "Selected output format is not supported!");
+#if CONFIG_JD_USE_ROM
+    ESP_GOTO_ON_FALSE(!jpeg_is_yuv(cfg->out_format), ESP_ERR_NOT_SUPPORTED, err, TAG, "YUV output is not supported by the ROM decoder!");
+#endif
+    ESP_GOTO_ON_FALSE(!(cfg->output.band_cb && cfg->out_format == JPEG_IMAGE_FORMAT_YUV420), ESP_ERR_NOT_SUPPORTED, err, TAG,
+                      "Planar output is not supported in band mode!");
+
+    /* Prepare image */
+#if CONFIG_JD_USE_ROM
+    (void)cached;   /* The ROM decoder can't keep the tables */
+    res = jd_prepare(jd, jpeg_decode_in_cb, workbuf, workbuf_size, cfg);
+#else
+    res = cached ? jd_prepare_cached(jd, jpeg_decode_in_cb, workbuf, workbuf_size, cfg)
+          : jd_prepare(jd, jpeg_decode_in_cb, workbuf, workbuf_size, cfg);
+#endif
+    ESP_GOTO_ON_FALSE((res == JDR_OK), ESP_FAIL, err, TAG, "Error in preparing JPEG image! %d", res);
+#if !CONFIG_JD_USE_ROM
+    jd->ycc = jpeg_is_yuv(cfg->out_format);    /* TJPGD outputs Y/Cb/Cr without RGB conversion */
+#endif
+
+    const uint8_t scale_div       = jpeg_get_div_by_scale(cfg->out_scale);
+    const uint8_t out_color_bytes = jpeg_get_color_bytes(cfg->out_format);
+
+    /* Region of the scaled image to output */
+    uint16_t out_width = jd->width / scale_div;
+    uint16_t out_height = jd->height / scale_div;
+    if (cfg->roi.width && cfg->roi.height) {
+        ESP_GOTO_ON_FALSE((cfg->roi.x + cfg->roi.width <= out_width && cfg->roi.y + cfg->roi.height <= out_height),
+                          ESP_ERR_INVALID_ARG, err, TAG, "Region of interest is out of the image!");
+        out_width = cfg->roi.width;
+        out_height = cfg->roi.height;
+        cfg->priv.out_rect.left = cfg->roi.x;
+        cfg->priv.out_rect.top = cfg->roi.y;
+    } else {
+        cfg->priv.out_rect.left = 0;
+        cfg->priv.out_rect.top = 0;
+    }
+    cfg->priv.out_rect.right = cfg->priv.out_rect.left + out_width - 1;
+    cfg->priv.out_rect.bottom = cfg->priv.out_rect.top + out_height - 1;
+
+    /* Size of output image; in band mode, outbuf holds only one MCU row */
+    const uint32_t outsize = jpeg_get_output_len(cfg->out_format, out_width, out_height);
+    const uint16_t band_height = MAX((jd->msy * 8) / scale_div, 1);
+    const uint32_t band_len = out_width * band_height * out_color_bytes;
+    const bool band_mode = (cfg->output.band_cb != NULL);
+    ESP_GOTO_ON_FALSE(((band_mode ? band_len : outsize) <= cfg->outbuf_size), ESP_ERR_NO_MEM, err, TAG, "Not enough size in output buffer!");
+    cfg->priv.band_top = UINT16_MAX;
+    cfg->priv.band_err = ESP_OK;
+
+    /* Size of output image */
+    img->height = out_height;
+    img->width = out_width;
+    img->output_len = outsize;
+    img->band_height = band_height;
+    img->band_len = band_len;
+    img->coef_len = 0;
+
+#if defined(JD_PROGRESSIVE) && JD_PROGRESSIVE
+    /* Progressive JPEG: coefficients of all scans are buffered, preferably in PSRAM as the buffer is large */
+    if (jd->progressive) {
+        img->coef_len = jd->sz_coef;
+        if (cfg->advanced.coef_buffer) {
+            ESP_GOTO_ON_FALSE((cfg->advanced.coef_buffer_size >= jd->sz_coef), ESP_ERR_INVALID_ARG, err, TAG, "Not enough size in coefficient buffer!");
+            jd->coef = cfg->advanced.coef_buffer;
+        } else {
+#if CONFIG_SPIRAM
+            coefbuf = heap_caps_malloc(jd->sz_coef, MALLOC_CAP_SPIRAM);
+#endif
+            if (coefbuf == NULL) {
+                coefbuf = heap_caps_malloc(jd->sz_coef, MALLOC_CAP_DEFAULT);
+            }
+            ESP_GOTO_ON_FALSE(coefbuf, ESP_ERR_NO_MEM, err, TAG, "no mem for JPEG coefficient buffer");
+            jd->coef = coefbuf;
+        }
+    }
+#endif
+
+    /* Decode JPEG */
+#if CONFIG_JD_USE_ROM
+    /* ROM decoder always decodes the whole image, the region is cropped in the output callback */
+    res = jd_decomp(jd, jpeg_decode_out_cb, cfg->out_scale);
+#else
+    /* Only MCUs in the region are converted and output */
+    const JRECT roi = {
+        .left = cfg->priv.out_rect.left,
+        .right = cfg->priv.out_rect.right,
+        .top = cfg->priv.out_rect.top,
+        .bottom = cfg->priv.out_rect.bottom,
+    };
+    bool decoded = false;
+    if (cfg->advanced.workers > 1) {
+        ret = jpeg_decode_parallel(cfg, jd, &roi, workbuf_size, &decoded);
+        if (decoded || ret != ESP_OK) {
+            goto err;
+        }
+    }
+    res = jd_decomp_rect(jd, jpeg_decode_out_cb, cfg->out_scale, &roi);
+#endif
+    if (res == JDR_INTR && cfg->priv.band_err != ESP_OK) {
+        ret = cfg->priv.band_err;   /* Stopped by the band callback */
+        goto err;
+    }
+    ESP_GOTO_ON_FALSE((res == JDR_OK), ESP_FAIL, err, TAG, "Error in decoding JPEG image! %d", res);
+
+    if (band_mode) {
+        ret = jpeg_band_flush(cfg); /* The last band */
+    }
+
+err:
+    free(coefbuf);
+
+    return ret;
+}
+
+static jpeg_decode_in_size_t jpeg_decode_in_cb(JDEC *dec, uint8_t *buff, jpeg_decode_in_size_t nbyte)
 {
     assert(dec != NULL);
 
@@ -175,6 +368,10 @@ static unsigned int jpeg_decode_in_cb(JDEC *dec, uint8_t *buff, unsigned int nby
     esp_jpeg_image_cfg_t *cfg = (esp_jpeg_image_cfg_t *)dec->device;
     assert(cfg != NULL);
 
+    if (cfg->input.read_cb) {
+        return jpeg_decode_in_stream(cfg, buff, nbyte);
+    }
+
     if (buff) {
         if (cfg->priv.read + to_read > cfg->indata_size) {
             to_read = cfg->indata_size - cfg->priv.read;
@@ -191,60 +388,326 @@ static unsigned int jpeg_decode_in_cb(JDEC *dec, uint8_t *buff, unsigned int nby
     return to_read;
 }
 
+static jpeg_decode_in_size_t jpeg_decode_in_stream(esp_jpeg_image_cfg_t *cfg, uint8_t *buff, jpeg_decode_in_size_t nbyte)
+{
+    uint8_t skip_buf[64];
+    jpeg_decode_in_size_t done = 0;
+
+    /* The decoder expects the requested amount of data, so collect it from as many chunks as needed */
+    while (done < nbyte) {
+        uint8_t *dst = buff ? buff + done : skip_buf;
+        size_t len = nbyte - done;
+        if (!buff && len > sizeof(skip_buf)) {
+            len = sizeof(skip_buf);     /* Skip data by reading it to a scratch buffer */
+        }
+
+        size_t received = cfg->input.read_cb(dst, len, cfg->input.user_ctx);
+        if (received == 0 || received > len) {
+            break;  /* End of stream or invalid callback return value */
+        }
+        done += received;
+    }
+    cfg->priv.read += done;
+
+    return done;
+}
+
 static jpeg_decode_out_t jpeg_decode_out_cb(JDEC *dec, void *bitmap, JRECT *rect)
 {
-    uint16_t color = 0;
     assert(dec != NULL);
 
     esp_jpeg_image_cfg_t *cfg = (esp_jpeg_image_cfg_t *)dec->device;
     assert(cfg != NULL);
     assert(bitmap != NULL);
     assert(rect != NULL);
+    assert(cfg->priv.out_row != NULL);
+
+    /* Crop the block to the output region */
+    const uint16_t out_left = cfg->priv.out_rect.left;
+    const uint16_t out_top = cfg->priv.out_rect.top;
+    const uint16_t out_right = cfg->priv.out_rect.right;
+    const uint16_t out_bottom = cfg->priv.out_rect.bottom;
+    if (rect->right < out_left || rect->left > out_right || rect->bottom < out_top || rect->top > out_bottom) {
+        return 1;
+    }
+    const uint16_t left = MAX(rect->left, out_left);
+    const uint16_t right = MIN(rect->right, out_right);
+    const uint16_t top = MAX(rect->top, out_top);
+    const uint16_t bottom = MIN(rect->bottom, out_bottom);
 
-    uint8_t scale_div = jpeg_get_div_by_scale(cfg->out_scale);
     uint8_t out_color_bytes = jpeg_get_color_bytes(cfg->out_format);
-
-    /* Copy decoded image data to output buffer */
-    uint8_t *in = (uint8_t *)bitmap;
-    uint32_t line = dec->width / scale_div;
-    uint8_t *dst = (uint8_t *)cfg->outbuf;
-    for (int y = rect->top; y <= rect->bottom; y++) {
-        for (int x = rect->left; x <= rect->right; x++) {
-            if ((JD_FORMAT == 0 && cfg->out_format == JPEG_IMAGE_FORMAT_RGB888) ||
-                    (JD_FORMAT == 1 && cfg->out_format == JPEG_IMAGE_FORMAT_RGB565)) {
-                /* Output image format is same as set in TJPGD */
-                for (int b = 0; b < ESP_JPEG_COLOR_BYTES; b++) {
-                    if (cfg->flags.swap_color_bytes) {
-                        dst[(y * line * out_color_bytes) + x * out_color_bytes + b] = in[out_color_bytes - b - 1];
-                    } else {
-                        dst[(y * line * out_color_bytes) + x * out_color_bytes + b] = in[b];
-                    }
-                }
-            } else if (JD_FORMAT == 0 && cfg->out_format == JPEG_IMAGE_FORMAT_RGB565) {
-                /* Output image format is not same as set in TJPGD */
-                /* We need to convert the 3 bytes in `in` to a rgb565 value */
-                color = ((in[0] & 0xF8) << 8);
-                color |= ((in[1] & 0xFC) << 3);
-                color |= (in[2] >> 3);
-
-                if (cfg->flags.swap_color_bytes) {
-                    dst[(y * line * out_color_bytes) + (x * out_color_bytes)] = HIBYTE(color);
-                    dst[(y * line * out_color_bytes) + (x * out_color_bytes) + 1] = LOBYTE(color);
-                } else {
-                    dst[(y * line * out_color_bytes) + (x * out_color_bytes) + 1] = HIBYTE(color);
-                    dst[(y * line * out_color_bytes) + (x * out_color_bytes)] = LOBYTE(color);
-                }
-            } else {
-                ESP_LOGE(TAG, "Selected output format is not supported!");
-                assert(0);
+    const size_t in_bytes = jpeg_is_yuv(cfg->out_format) ? 3 : ESP_JPEG_COLOR_BYTES;  /* TJPGD outputs Y/Cb/Cr for YUV formats */
+
+    /* In band mode, outbuf holds only the rows of the current MCU row */
+    uint16_t outbuf_top = out_top;
+    if (cfg->output.band_cb) {
+        if (top != cfg->priv.band_top) {
+            /* First block of the next MCU row, the previous band is complete */
+            if (jpeg_band_flush(cfg) != ESP_OK) {
+                return 0;
             }
-            in += ESP_JPEG_COLOR_BYTES;
+            cfg->priv.band_top = top;
+            cfg->priv.band_bottom = bottom;
+        }
+        outbuf_top = top;
+    }
+
+    /* Copy decoded image data to output buffer, row by row */
+    const size_t width = right - left + 1;
+    const size_t in_stride = (rect->right - rect->left + 1) * in_bytes;
+    const size_t out_stride = (out_right - out_left + 1) * out_color_bytes;
+    const uint8_t *in = (const uint8_t *)bitmap + (top - rect->top) * in_stride + (left - rect->left) * in_bytes;
+    uint8_t *dst = (uint8_t *)cfg->outbuf + (top - outbuf_top) * out_stride + (left - out_left) * out_color_bytes;
+    if (cfg->out_format == JPEG_IMAGE_FORMAT_YUV420) {
+        jpeg_out_chroma_yuv420(cfg, in, in_stride, left, top, right, bottom);
+    }
+    for (int y = top; y <= bottom; y++) {
+        if (cfg->out_format == JPEG_IMAGE_FORMAT_YUV422) {
+            jpeg_out_row_yuv422(cfg, dst, in, left, width);
+        } else {
+            cfg->priv.out_row(dst, in, width);
         }
+        in += in_stride;
+        dst += out_stride;
     }
 
     return 1;
 }
 
+/*
+ * YUV422 row of a block. Pixel pairs start at even columns of the output image, so a pair is split between
+ * two blocks if the block starts or ends in the middle of it (odd region of interest or 1/8 scale).
+ */
+static void jpeg_out_row_yuv422(const esp_jpeg_image_cfg_t *cfg, uint8_t *dst, const uint8_t *in, uint16_t x, size_t width)
+{
+    const unsigned int y_ofs = cfg->flags.swap_color_bytes ? 1 : 0;   /* Offset of Y in the two bytes of a pixel */
+
+    if ((x - cfg->priv.out_rect.left) & 1) {
+        dst[y_ofs] = in[0];     /* Second pixel of a pair, its chroma is output with the first pixel */
+        dst += 2;
+        in += 3;
+        x++;
+        width--;
+    }
+    cfg->priv.out_row(dst, in, width);
+    if ((width & 1) && x + width - 1 < cfg->priv.out_rect.right) {
+        dst[2 * width + 1 - y_ofs] = in[3 * (width - 1) + 2];  /* V of the first pixel of a pair split with the next block */
+    }
+}
+
+/* Chroma planes of YUV420 output from the pixels of a block at even rows and columns of the output image */
+static void jpeg_out_chroma_yuv420(const esp_jpeg_image_cfg_t *cfg, const uint8_t *in, size_t in_stride,
+                                   uint16_t left, uint16_t top, uint16_t right, uint16_t bottom)
+{
+    const uint16_t out_left = cfg->priv.out_rect.left;
+    const uint16_t out_top = cfg->priv.out_rect.top;
+    const size_t out_width = cfg->priv.out_rect.right - out_left + 1;
+    const size_t out_height = cfg->priv.out_rect.bottom - out_top + 1;
+    const size_t chroma_width = (out_width + 1) / 2;
+    uint8_t *u = cfg->outbuf + out_width * out_height;
+    uint8_t *v = u + chroma_width * ((out_height + 1) / 2);
+    if (cfg->flags.swap_color_bytes) {
+        uint8_t *t = u;     /* YV12: V plane first */
+        u = v;
+        v = t;
+    }
+
+    const unsigned int x_odd = (left - out_left) & 1;
+    for (int y = top + ((top - out_top) & 1); y <= bottom; y += 2) {
+        const uint8_t *p = in + (y - top) * in_stride + x_odd * 3;
+        size_t i = ((y - out_top) / 2) * chroma_width + (left - out_left + 1) / 2;
+        for (int x = left + x_odd; x <= right; x += 2) {
+            u[i] = p[1];
+            v[i] = p[2];
+            i++;
+            p += 6;
+        }
+    }
+}
+
+#if !CONFIG_JD_USE_ROM
+/* Restart intervals decoded by one worker */
+typedef struct {
+    esp_jpeg_image_cfg_t cfg;   /* Copy of the configuration, each worker reads the input from its own position */
+    JDEC *jd;                   /* Prepared decoder object, NULL: the worker prepares its own in workbuf */
+    void *workbuf;
+    size_t workbuf_size;
+    const JRECT *rect;
+    uint32_t offset;            /* Input offset of the first interval */
+    unsigned int first;         /* First restart interval */
+    unsigned int count;         /* Number of restart intervals */
+    JRESULT res;
+} jpeg_worker_t;
+
+static void *jpeg_decode_worker(void *arg)
+{
+    jpeg_worker_t *worker = (jpeg_worker_t *)arg;
+    JDEC local_jd;
+    JDEC *jd = worker->jd;
+
+    if (jd == NULL) {
+        /* Each additional worker needs its own decoder object and tables, so parse the headers again */
+        jd = &local_jd;
+        worker->cfg.priv.read = 0;
+        worker->res = jd_prepare(jd, jpeg_decode_in_cb, worker->workbuf, worker->workbuf_size, &worker->cfg);
+        if (worker->res != JDR_OK) {
+            return NULL;
+        }
+        jd->ycc = jpeg_is_yuv(worker->cfg.out_format);
+    }
+    ((esp_jpeg_image_cfg_t *)jd->device)->priv.read = worker->offset;
+    worker->res = jd_decomp_part(jd, jpeg_decode_out_cb, worker->cfg.out_scale, worker->rect, worker->first, worker->count);
+
+    return NULL;
+}
+
+/* Find the start of the entropy coded data of each restart interval. Returns number of intervals found. */
+static unsigned int jpeg_index_restart_intervals(const uint8_t *data, size_t size, size_t ofs, uint32_t *offsets, unsigned int max)
+{
+    unsigned int n = 0;
+
+    offsets[n++] = ofs;
+    while (n < max) {
+        const uint8_t *ff = memchr(data + ofs, 0xFF, size - ofs);
+        if (ff == NULL || ff + 1 >= data + size) {
+            break;
+        }
+        ofs = ff - data;
+        const uint8_t marker = data[ofs + 1];
+        if (marker == 0xFF) {
+            ofs += 1;   /* Fill byte */
+        } else if (marker == 0x00) {
+            ofs += 2;   /* Stuffed 0xFF data byte */
+        } else if ((marker & 0xF8) == 0xD0) {
+            ofs += 2;   /* RSTn marker, next interval starts after it */
+            offsets[n++] = ofs;
+        } else {
+            break;      /* EOI or other marker, end of entropy coded data */
+        }
+    }
+
+    return n;
+}
+
+/*
+ * Decode the restart intervals of the image in parallel.
+ * Each worker decodes a contiguous range of intervals with its own decoder object and working buffer,
+ * output rectangles of the workers don't overlap. The calling task is the first worker and reuses the prepared
+ * decoder object, so the working buffer (and the tables kept in it by a decoder handle) is not parsed again.
+ */
+static esp_err_t jpeg_decode_parallel(esp_jpeg_image_cfg_t *cfg, JDEC *jd, const JRECT *rect, size_t workbuf_size, bool *decoded)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t *offsets = NULL;
+    jpeg_worker_t *workers = NULL;
+    pthread_t *threads = NULL;
+    unsigned int started = 0;
+
+    *decoded = false;
+    if (jd->nrst == 0 || cfg->input.read_cb != NULL) {
+        return ESP_OK;  /* Intervals can be found only in an image with restart markers in memory */
+    }
+    if (cfg->output.band_cb != NULL) {
+        return ESP_OK;  /* Bands must be output in order through one buffer */
+    }
+#if JD_PROGRESSIVE
+    if (jd->progressive) {
+        return ESP_OK;  /* All scans must be decoded before the image is output */
+    }
+#endif
+
+    const unsigned int mx = jd->msx * 8;
+    const unsigned int my = jd->msy * 8;
+    const unsigned int nmcu = ((jd->width + mx - 1) / mx) * ((jd->height + my - 1) / my);
+    const unsigned int nintervals = (nmcu + jd->nrst - 1) / jd->nrst;
+    const unsigned int nworkers = MIN(cfg->advanced.workers, nintervals);
+    if (nworkers < 2) {
+        return ESP_OK;
+    }
+
+    offsets = malloc(nintervals * sizeof(uint32_t));
+    ESP_GOTO_ON_FALSE(offsets, ESP_ERR_NO_MEM, err, TAG, "no mem for restart interval index");
+
+    /* Entropy coded data starts at the first byte not consumed by jd_prepare() */
+    const size_t data_start = cfg->priv.read - jd->dctr;
+    if (jpeg_index_restart_intervals(cfg->indata, cfg->indata_size, data_start, offsets, nintervals) != nintervals) {
+        ESP_LOGD(TAG, "Restart markers don't match the restart interval, decoding sequentially");
+        goto err;
+    }
+
+    workers = calloc(nworkers, sizeof(jpeg_worker_t));
+    threads = calloc(nworkers, sizeof(pthread_t));
+    ESP_GOTO_ON_FALSE(workers && threads, ESP_ERR_NO_MEM, err, TAG, "no mem for JPEG workers");
+
+    for (unsigned int i = 0; i < nworkers; i++) {
+        jpeg_worker_t *worker = &workers[i];
+        worker->cfg = *cfg;
+        worker->rect = rect;
+        worker->first = nintervals * i / nworkers;
+        worker->count = nintervals * (i + 1) / nworkers - worker->first;
+        worker->offset = offsets[worker->first];
+        worker->workbuf_size = workbuf_size;
+        if (i == 0) {
+            worker->jd = jd;    /* The calling task reuses the main decoder object */
+        } else {
+            worker->workbuf = heap_caps_malloc(workbuf_size, MALLOC_CAP_DEFAULT);
+            ESP_GOTO_ON_FALSE(worker->workbuf, ESP_ERR_NO_MEM, err, TAG, "no mem for JPEG work buffer");
+        }
+    }
+
+    /* Start the workers, the first range of intervals is decoded in the calling task */
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+#if !CONFIG_IDF_TARGET_LINUX
+    pthread_attr_setstacksize(&attr, 4096);
+#endif
+    for (started = 1; started < nworkers; started++) {
+        if (pthread_create(&threads[started], &attr, jpeg_decode_worker, &workers[started]) != 0) {
+            break;  /* Remaining intervals are decoded in the calling task */
+        }
+    }
+    pthread_attr_destroy(&attr);
+
+    jpeg_decode_worker(&workers[0]);
+    for (unsigned int i = started; i < nworkers; i++) {
+        jpeg_decode_worker(&workers[i]);
+    }
+    for (unsigned int i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    *decoded = true;
+    for (unsigned int i = 0; i < nworkers; i++) {
+        ESP_GOTO_ON_FALSE((workers[i].res == JDR_OK), ESP_FAIL, err, TAG, "Error in decoding JPEG image! %d", workers[i].res);
+    }
+
+err:
+    if (workers) {
+        for (unsigned int i = 1; i < nworkers; i++) {
+            free(workers[i].workbuf);
+        }
+    }
+    free(threads);
+    free(workers);
+    free(offsets);
+    return ret;
+}
+#endif
+
+static esp_err_t jpeg_band_flush(esp_jpeg_image_cfg_t *cfg)
+{
+    if (cfg->priv.band_top == UINT16_MAX) {
+        return ESP_OK;  /* No band decoded yet */
+    }
+
+    const uint16_t y = cfg->priv.band_top - cfg->priv.out_rect.top;
+    const uint16_t height = cfg->priv.band_bottom - cfg->priv.band_top + 1;
+    cfg->priv.band_top = UINT16_MAX;
+    cfg->priv.band_err = cfg->output.band_cb(cfg->outbuf, y, height, cfg->output.user_ctx);
+
+    return cfg->priv.band_err;
+}
+
 static uint8_t jpeg_get_div_by_scale(esp_jpeg_image_scale_t scale)
 {
     switch (scale) {
@@ -274,11 +737,32 @@ static uint8_t jpeg_get_color_bytes(esp_jpeg_image_format_t format)
     /* RGB565 (16-bit/pix) */
     case JPEG_IMAGE_FORMAT_RGB565:
         return 2;
+    /* YUV422 (16-bit/pix) */
+    case JPEG_IMAGE_FORMAT_YUV422:
+        return 2;
+    /* YUV420 (bytes per pixel of the Y plane) */
+    case JPEG_IMAGE_FORMAT_YUV420:
+        return 1;
     }
 
     return 1;
 }
 
+static size_t jpeg_get_output_len(esp_jpeg_image_format_t format, uint16_t width, uint16_t height)
+{
+    if (format == JPEG_IMAGE_FORMAT_YUV420) {
+        /* Y plane and two chroma planes of half width and height */
+        return (size_t)width * height + 2 * (size_t)((width + 1) / 2) * ((height + 1) / 2);
+    }
+
+    return (size_t)width * height * jpeg_get_color_bytes(format);
+}
+
+static inline bool jpeg_is_yuv(esp_jpeg_image_format_t format)
+{
+    return format == JPEG_IMAGE_FORMAT_YUV422 || format == JPEG_IMAGE_FORMAT_YUV420;
+}
+
 static inline uint16_t ldb_word(const void *ptr)
 {
     const uint8_t *p = (const uint8_t *)ptr;
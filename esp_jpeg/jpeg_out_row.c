@@ -0,0 +1,208 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "jpeg_out_row.h"
+
+/* Words are assembled in little-endian order, which is the byte order of all ESP chips and the Linux host */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error Output row conversion expects a little-endian target
+#endif
+
+/* Store a 32-bit word to a 4-byte aligned address; compiles to a single store instruction */
+static inline void store_word(uint8_t *dst, uint32_t word)
+{
+    memcpy(__builtin_assume_aligned(dst, 4), &word, sizeof(word));
+}
+
+static inline uint16_t rgb888_to_rgb565(const uint8_t *src)
+{
+    return ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+}
+
+static inline uint16_t swap16(uint16_t v)
+{
+    return (uint16_t)((v << 8) | (v >> 8));
+}
+
+void jpeg_out_row_rgb888(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    memcpy(dst, src, width * 3);
+}
+
+void jpeg_out_row_rgb565(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    memcpy(dst, src, width * 2);
+}
+
+void jpeg_out_row_rgb888_swap(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    /* Align the output, so the main loop can write 4 pixels as 3 words */
+    while (width && ((uintptr_t)dst & 3)) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst += 3;
+        src += 3;
+        width--;
+    }
+    for (; width >= 4; width -= 4) {
+        store_word(dst, src[2] | (src[1] << 8) | (src[0] << 16) | ((uint32_t)src[5] << 24));
+        store_word(dst + 4, src[4] | (src[3] << 8) | (src[8] << 16) | ((uint32_t)src[7] << 24));
+        store_word(dst + 8, src[6] | (src[11] << 8) | (src[10] << 16) | ((uint32_t)src[9] << 24));
+        dst += 12;
+        src += 12;
+    }
+    while (width--) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst += 3;
+        src += 3;
+    }
+}
+
+void jpeg_out_row_rgb565_swap(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    if (width && ((uintptr_t)dst & 3)) {
+        dst[0] = src[1];
+        dst[1] = src[0];
+        dst += 2;
+        src += 2;
+        width--;
+    }
+    if (((uintptr_t)dst & 1) == 0) {
+        /* Swap bytes of 2 pixels in one word */
+        for (; width >= 2; width -= 2) {
+            uint32_t w = src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+            store_word(dst, ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF));
+            dst += 4;
+            src += 4;
+        }
+    }
+    while (width--) {
+        dst[0] = src[1];
+        dst[1] = src[0];
+        dst += 2;
+        src += 2;
+    }
+}
+
+/* Convert RGB888 to RGB565, optionally with swapped bytes. Inlined to the two public variants with constant 'swap'. */
+static inline __attribute__((always_inline)) void rgb888_to_rgb565_row(uint8_t *dst, const uint8_t *src, size_t width, bool swap)
+{
+    if (width && ((uintptr_t)dst & 3)) {
+        uint16_t c = rgb888_to_rgb565(src);
+        c = swap ? swap16(c) : c;
+        dst[0] = (uint8_t)c;
+        dst[1] = (uint8_t)(c >> 8);
+        dst += 2;
+        src += 3;
+        width--;
+    }
+    if (((uintptr_t)dst & 1) == 0) {
+        for (; width >= 2; width -= 2) {
+            uint32_t c0 = rgb888_to_rgb565(src);
+            uint32_t c1 = rgb888_to_rgb565(src + 3);
+            if (swap) {
+                c0 = swap16(c0);
+                c1 = swap16(c1);
+            }
+            store_word(dst, c0 | (c1 << 16));
+            dst += 4;
+            src += 6;
+        }
+    }
+    while (width--) {
+        uint16_t c = rgb888_to_rgb565(src);
+        c = swap ? swap16(c) : c;
+        dst[0] = (uint8_t)c;
+        dst[1] = (uint8_t)(c >> 8);
+        dst += 2;
+        src += 3;
+    }
+}
+
+void jpeg_out_row_rgb888_to_rgb565(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    rgb888_to_rgb565_row(dst, src, width, false);
+}
+
+void jpeg_out_row_rgb888_to_rgb565_swap(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    rgb888_to_rgb565_row(dst, src, width, true);
+}
+
+/* Pack a pixel pair of Y/Cb/Cr from TJPGD to YUYV or UYVY, chroma of the first pixel is used */
+static inline uint32_t ycc_to_yuv422(const uint8_t *src, bool uyvy)
+{
+    if (uyvy) {
+        return src[1] | (src[0] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+    }
+    return src[0] | (src[1] << 8) | (src[3] << 16) | ((uint32_t)src[2] << 24);
+}
+
+static inline __attribute__((always_inline)) void ycc_to_yuv422_row(uint8_t *dst, const uint8_t *src, size_t width, bool uyvy)
+{
+    if (((uintptr_t)dst & 3) == 0) {
+        for (; width >= 2; width -= 2) {
+            store_word(dst, ycc_to_yuv422(src, uyvy));
+            dst += 4;
+            src += 6;
+        }
+    }
+    for (; width >= 2; width -= 2) {
+        const uint32_t w = ycc_to_yuv422(src, uyvy);
+        memcpy(dst, &w, sizeof(w));
+        dst += 4;
+        src += 6;
+    }
+    if (width) {
+        /* Odd width, the last pixel has only Y and U */
+        dst[0] = uyvy ? src[1] : src[0];
+        dst[1] = uyvy ? src[0] : src[1];
+    }
+}
+
+void jpeg_out_row_ycc_to_yuyv(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    ycc_to_yuv422_row(dst, src, width, false);
+}
+
+void jpeg_out_row_ycc_to_uyvy(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    ycc_to_yuv422_row(dst, src, width, true);
+}
+
+void jpeg_out_row_ycc_to_y(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    while (width--) {
+        *dst++ = *src;
+        src += 3;
+    }
+}
+
+jpeg_out_row_t jpeg_out_row_get(esp_jpeg_image_format_t in_format, esp_jpeg_image_format_t out_format, bool swap)
+{
+    if (in_format == JPEG_IMAGE_FORMAT_RGB888 && out_format == JPEG_IMAGE_FORMAT_RGB888) {
+        return swap ? jpeg_out_row_rgb888_swap : jpeg_out_row_rgb888;
+    }
+    if (in_format == JPEG_IMAGE_FORMAT_RGB888 && out_format == JPEG_IMAGE_FORMAT_RGB565) {
+        return swap ? jpeg_out_row_rgb888_to_rgb565_swap : jpeg_out_row_rgb888_to_rgb565;
+    }
+    if (in_format == JPEG_IMAGE_FORMAT_RGB565 && out_format == JPEG_IMAGE_FORMAT_RGB565) {
+        return swap ? jpeg_out_row_rgb565_swap : jpeg_out_row_rgb565;
+    }
+    /* For YUV output, TJPGD outputs Y/Cb/Cr (3 bytes per pixel) in any JD_FORMAT */
+    if (out_format == JPEG_IMAGE_FORMAT_YUV422) {
+        return swap ? jpeg_out_row_ycc_to_uyvy : jpeg_out_row_ycc_to_yuyv;
+    }
+    if (out_format == JPEG_IMAGE_FORMAT_YUV420) {
+        return jpeg_out_row_ycc_to_y;   /* Y plane, the chroma planes are written by the caller */
+    }
+
+    return NULL;
+}
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "jpeg_decoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Output row conversion function
+ *
+ * Converts one row of pixels decoded by TJPGD into the output buffer.
+ *
+ * @param[out] dst   Output pixels; no alignment requirements
+ * @param[in]  src   Pixels from TJPGD in its output format (JD_FORMAT), or Y/Cb/Cr (3 bytes per pixel) for YUV output formats
+ * @param[in]  width Number of pixels in the row
+ */
+typedef void (*jpeg_out_row_t)(uint8_t *dst, const uint8_t *src, size_t width);
+
+/**
+ * @brief Select the output row conversion function
+ *
+ * The selection is done once per decoded image, so the row functions don't need to check format or flags per pixel.
+ *
+ * @param[in] in_format  Format of the pixels from TJPGD (JD_FORMAT 0 is RGB888, 1 is RGB565), not used for YUV output formats
+ * @param[in] out_format Requested output format
+ * @param[in] swap       Swap the first and last color bytes
+ *
+ * @return Row conversion function or NULL if the conversion is not supported
+ */
+jpeg_out_row_t jpeg_out_row_get(esp_jpeg_image_format_t in_format, esp_jpeg_image_format_t out_format, bool swap);
+
+/* Row conversion functions, exposed for testing */
+void jpeg_out_row_rgb888(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_rgb888_swap(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_rgb565(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_rgb565_swap(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_rgb888_to_rgb565(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_rgb888_to_rgb565_swap(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_ycc_to_yuyv(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_ycc_to_uyvy(uint8_t *dst, const uint8_t *src, size_t width);
+void jpeg_out_row_ycc_to_y(uint8_t *dst, const uint8_t *src, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
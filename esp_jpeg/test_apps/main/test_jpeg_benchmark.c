@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+#include "jpeg_decoder.h"
+#include "test_logo_jpg.h"
+#include "test_usb_camera_2_jpg.h"
+#if CONFIG_JD_DEFAULT_HUFFMAN
+#include "test_usb_camera_jpg.h"
+#endif
+
+#define TEST_BENCHMARK_ITERATIONS   100
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/* Number of MCUs in the image, from the sampling factors of the luminance component in SOF0 */
+static uint32_t test_mcu_count(const uint8_t *jpg, size_t jpg_len)
+{
+    for (size_t i = 2; i + 10 < jpg_len; i++) {
+        if (jpg[i] == 0xFF && jpg[i + 1] == 0xC0) {
+            const uint32_t height = (jpg[i + 5] << 8) | jpg[i + 6];
+            const uint32_t width = (jpg[i + 7] << 8) | jpg[i + 8];
+            const uint32_t mcu_w = 8 * (jpg[i + 11] >> 4);
+            const uint32_t mcu_h = 8 * (jpg[i + 11] & 0x0F);
+            return ((width + mcu_w - 1) / mcu_w) * ((height + mcu_h - 1) / mcu_h);
+        }
+    }
+    return 0;
+}
+
+static void test_benchmark_image(const char *name, const uint8_t *jpg, size_t jpg_len)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &outimg));
+    jpeg_cfg.outbuf_size = outimg.output_len;
+    jpeg_cfg.outbuf = malloc(outimg.output_len);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    const uint32_t mcus = test_mcu_count(jpg, jpg_len);
+    TEST_ASSERT_NOT_EQUAL(0, mcus);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg)); // Warm up caches
+
+    uint64_t total = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        const uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+        total += (uint32_t)(test_benchmark_now() - start); // The cycle counter is 32-bit, a single decode does not overflow it
+    }
+
+    printf("%-16s %3dx%-3d %4"PRIu32" MCUs: %8"PRIu64" %s/MCU\n", name, outimg.width, outimg.height, mcus,
+           total / TEST_BENCHMARK_ITERATIONS / mcus, TEST_BENCHMARK_UNIT);
+    free(jpeg_cfg.outbuf);
+}
+
+/**
+ * @brief Decoder benchmark
+ *
+ * Prints the decoding time per MCU of the test images for the configured optimization level (JD_FASTDECODE).
+ * Run the test app with each sdkconfig.ci.fastdecode_* configuration to compare the levels.
+ */
+TEST_CASE("Test JPEG decompression library: Decoder benchmark", "[esp_jpeg][benchmark]")
+{
+#if CONFIG_JD_USE_ROM
+    printf("Decoder: ROM (JD_FASTDECODE = 0)\n");
+#else
+    printf("Decoder: JD_FASTDECODE = %d\n", CONFIG_JD_FASTDECODE);
+#endif
+    test_benchmark_image("logo.jpg", logo_jpg, logo_jpg_len);
+    test_benchmark_image("usb_camera_2.jpg", camera_2_jpg, camera_2_jpg_len);
+#if CONFIG_JD_DEFAULT_HUFFMAN
+    test_benchmark_image("usb_camera.jpg", jpeg_no_huffman, jpeg_no_huffman_len);
+#endif
+}
+
+/* Decoding time per frame of a stream of the same frame (MJPEG), decoded by esp_jpeg_decode() and with a decoder handle */
+static void test_benchmark_stream(const char *name, const uint8_t *jpg, size_t jpg_len, esp_jpeg_decoder_handle_t decoder)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &outimg));
+    jpeg_cfg.outbuf_size = outimg.output_len;
+    jpeg_cfg.outbuf = malloc(outimg.output_len);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg)); // Warm up caches
+    uint64_t total_decode = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        const uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+        total_decode += (uint32_t)(test_benchmark_now() - start);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_decode(decoder, &jpeg_cfg, &outimg)); // The first frame creates the tables
+    uint64_t total_handle = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        const uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_decode(decoder, &jpeg_cfg, &outimg));
+        total_handle += (uint32_t)(test_benchmark_now() - start);
+    }
+
+    printf("%-16s %3dx%-3d esp_jpeg_decode: %8"PRIu64" %s/frame, decoder handle: %8"PRIu64" %s/frame\n", name,
+           outimg.width, outimg.height, total_decode / TEST_BENCHMARK_ITERATIONS, TEST_BENCHMARK_UNIT,
+           total_handle / TEST_BENCHMARK_ITERATIONS, TEST_BENCHMARK_UNIT);
+    free(jpeg_cfg.outbuf);
+}
+
+/**
+ * @brief Decoder handle benchmark
+ *
+ * Prints the decoding time per frame of MJPEG-like streams of the test images. The decoder handle does not allocate
+ * the working buffer and does not create the tables for each frame.
+ */
+TEST_CASE("Test JPEG decompression library: Decoder handle benchmark", "[esp_jpeg][benchmark]")
+{
+    esp_jpeg_decoder_handle_t decoder = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_create(NULL, &decoder));
+    test_benchmark_stream("logo.jpg", logo_jpg, logo_jpg_len, decoder);
+    test_benchmark_stream("usb_camera_2.jpg", camera_2_jpg, camera_2_jpg_len, decoder);
+#if CONFIG_JD_DEFAULT_HUFFMAN
+    test_benchmark_stream("usb_camera.jpg", jpeg_no_huffman, jpeg_no_huffman_len, decoder);
+#endif
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_delete(decoder));
+}
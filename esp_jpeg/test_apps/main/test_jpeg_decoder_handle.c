@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "jpeg_decoder.h"
+#include "test_logo_jpg.h"
+#include "test_usb_camera_2_jpg.h"
+#if CONFIG_JD_DEFAULT_HUFFMAN
+#include "test_usb_camera_jpg.h"
+#endif
+#if CONFIG_JD_PROGRESSIVE
+#include "test_progressive_jpg.h"
+#endif
+
+typedef struct {
+    const uint8_t *jpg;
+    size_t jpg_len;
+    esp_jpeg_image_scale_t scale;
+    uint8_t workers;
+} test_frame_t;
+
+/* Decode the image with the decoder handle and check, that it is the same as decoded by esp_jpeg_decode() */
+static void test_decode_frame(esp_jpeg_decoder_handle_t decoder, const test_frame_t *frame)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)frame->jpg,
+        .indata_size = frame->jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = frame->scale,
+        .advanced = {
+            .workers = frame->workers,
+        },
+    };
+    esp_jpeg_image_output_t ref, outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &ref));
+    jpeg_cfg.outbuf_size = ref.output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &ref));
+    uint8_t *reference = jpeg_cfg.outbuf;
+
+    jpeg_cfg.outbuf = calloc(1, jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_decode(decoder, &jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(ref.width, outimg.width);
+    TEST_ASSERT_EQUAL(ref.height, outimg.height);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, jpeg_cfg.outbuf, ref.output_len);
+
+    free(jpeg_cfg.outbuf);
+    free(reference);
+}
+
+/**
+ * @brief Decoder handle test
+ *
+ * The same and different images are decoded one after another with one decoder handle,
+ * so the tables are reused, replaced by different ones and replaced by the default ones.
+ */
+TEST_CASE("Test JPEG decompression library: Decoder handle", "[esp_jpeg]")
+{
+    const test_frame_t frames[] = {
+        { logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+        { logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+        { camera_2_jpg, camera_2_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+        { camera_2_jpg, camera_2_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+#if CONFIG_JD_DEFAULT_HUFFMAN
+        { jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 0 },
+        { jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 2 },
+        { jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 0 },
+#endif
+#if CONFIG_JD_PROGRESSIVE
+        { progressive_jpg, progressive_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+        { progressive_ref_jpg, progressive_ref_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+#endif
+#if CONFIG_JD_USE_SCALE || CONFIG_JD_USE_ROM
+        { camera_2_jpg, camera_2_jpg_len, JPEG_IMAGE_SCALE_1_2, 0 },
+#endif
+        { logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 0 },
+    };
+
+    esp_jpeg_decoder_handle_t decoder = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_create(NULL, &decoder));
+    TEST_ASSERT_NOT_NULL(decoder);
+    for (size_t i = 0; i < sizeof(frames) / sizeof(frames[0]); i++) {
+        test_decode_frame(decoder, &frames[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_delete(decoder));
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_jpeg_decoder_create(NULL, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_jpeg_decoder_delete(NULL));
+}
+
+/* Copy of the JPEG without the segments of the marker */
+static uint8_t *test_remove_segments(const uint8_t *jpg, size_t jpg_len, uint8_t marker, size_t *out_len)
+{
+    uint8_t *out = malloc(jpg_len);
+    TEST_ASSERT_NOT_NULL(out);
+    memcpy(out, jpg, 2);    /* SOI */
+    size_t ofs = 2, len = 2;
+    while (ofs + 4 <= jpg_len) {
+        const size_t seg_len = 2 + ((jpg[ofs + 2] << 8) | jpg[ofs + 3]);
+        if (jpg[ofs + 1] == 0xDA) {
+            break;  /* SOS, copy the rest of the image */
+        }
+        if (jpg[ofs + 1] != marker) {
+            memcpy(out + len, jpg + ofs, seg_len);
+            len += seg_len;
+        }
+        ofs += seg_len;
+    }
+    memcpy(out + len, jpg + ofs, jpg_len - ofs);
+    *out_len = len + jpg_len - ofs;
+
+    return out;
+}
+
+/**
+ * @brief Tables of the previous image must not be used for an image without them
+ */
+TEST_CASE("Test JPEG decompression library: Decoder handle with missing tables", "[esp_jpeg]")
+{
+    size_t no_dqt_len;
+    uint8_t *no_dqt = test_remove_segments(logo_jpg, logo_jpg_len, 0xDB, &no_dqt_len);
+    TEST_ASSERT_LESS_THAN(logo_jpg_len, no_dqt_len);
+
+    esp_jpeg_decoder_handle_t decoder = NULL;
+    const esp_jpeg_decoder_config_t config = {
+        .working_buffer_size = 65472,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_create(&config, &decoder));
+    const test_frame_t frame = { logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 0 };
+    test_decode_frame(decoder, &frame);
+
+    uint8_t outbuf[46 * 46 * 3];
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = no_dqt,
+        .indata_size = no_dqt_len,
+        .outbuf = outbuf,
+        .outbuf_size = sizeof(outbuf),
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_jpeg_decoder_decode(decoder, &jpeg_cfg, &outimg));
+
+    /* The decoder still works after the error */
+    test_decode_frame(decoder, &frame);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_delete(decoder));
+    free(no_dqt);
+}
+
+/* Offset of the first segment of the marker */
+static size_t test_find_segment(const uint8_t *jpg, size_t jpg_len, uint8_t marker)
+{
+    size_t ofs = 2;
+    while (ofs + 4 <= jpg_len && jpg[ofs + 1] != marker) {
+        TEST_ASSERT_NOT_EQUAL(0xDA, jpg[ofs + 1]);
+        ofs += 2 + ((jpg[ofs + 2] << 8) | jpg[ofs + 3]);
+    }
+    TEST_ASSERT_LESS_THAN(jpg_len, ofs + 4);
+    return ofs;
+}
+
+/**
+ * @brief A table with the same hash as the kept one, but different data, must be created again
+ *
+ * The last 4 quantizers of the first table of the logo are replaced by two sets of values,
+ * which give the same hash of the DQT table definition.
+ */
+TEST_CASE("Test JPEG decompression library: Decoder handle with table hash collision", "[esp_jpeg]")
+{
+    static const uint8_t tails[2][4] = {
+        { 31, 64, 64, 3 },
+        { 51, 23, 36, 4 },
+    };
+    const size_t dqt = test_find_segment(logo_jpg, logo_jpg_len, 0xDB);
+    TEST_ASSERT_EQUAL(0, logo_jpg[dqt + 4]);    /* 8-bit table 0 */
+
+    uint8_t *jpg[2];
+    for (int i = 0; i < 2; i++) {
+        jpg[i] = malloc(logo_jpg_len);
+        TEST_ASSERT_NOT_NULL(jpg[i]);
+        memcpy(jpg[i], logo_jpg, logo_jpg_len);
+        memcpy(jpg[i] + dqt + 5 + 60, tails[i], sizeof(tails[i]));
+    }
+
+    esp_jpeg_decoder_handle_t decoder = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_create(NULL, &decoder));
+    for (int i = 0; i < 2; i++) {
+        const test_frame_t frame = { jpg[i], logo_jpg_len, JPEG_IMAGE_SCALE_0, 0 };
+        test_decode_frame(decoder, &frame);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decoder_delete(decoder));
+    free(jpg[0]);
+    free(jpg[1]);
+}
@@ -0,0 +1,326 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "jpeg_decoder.h"
+#include "jpeg_out_row.h"
+#include "test_logo_jpg.h"
+
+#define TEST_ROW_MAX_WIDTH  37  /* Odd width, so all head/tail paths of the row functions are used */
+#define TEST_LOGO_W         46
+#define TEST_LOGO_H         46
+
+/* Per pixel reference conversion, as it was done in the decoder output callback */
+static void ref_out_row(uint8_t *dst, const uint8_t *src, size_t width,
+                        esp_jpeg_image_format_t in_format, esp_jpeg_image_format_t out_format, bool swap)
+{
+    const size_t in_bytes = (in_format == JPEG_IMAGE_FORMAT_RGB888) ? 3 : 2;
+    const size_t out_bytes = (out_format == JPEG_IMAGE_FORMAT_RGB888) ? 3 : 2;
+
+    for (size_t x = 0; x < width; x++) {
+        if (in_format == out_format) {
+            for (size_t b = 0; b < out_bytes; b++) {
+                dst[b] = swap ? src[out_bytes - b - 1] : src[b];
+            }
+        } else {
+            uint16_t color = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+            dst[swap ? 1 : 0] = color & 0xFF;
+            dst[swap ? 0 : 1] = color >> 8;
+        }
+        src += in_bytes;
+        dst += out_bytes;
+    }
+}
+
+static void test_out_row(esp_jpeg_image_format_t in_format, esp_jpeg_image_format_t out_format, bool swap)
+{
+    uint8_t src[TEST_ROW_MAX_WIDTH * 3];
+    /* Word aligned, so the offset below selects the alignment of the output */
+    uint32_t out_words[(TEST_ROW_MAX_WIDTH * 3 + 8) / 4];
+    uint32_t ref_words[(TEST_ROW_MAX_WIDTH * 3 + 8) / 4];
+    uint8_t *out = (uint8_t *)out_words;
+    uint8_t *ref = (uint8_t *)ref_words;
+
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    jpeg_out_row_t out_row = jpeg_out_row_get(in_format, out_format, swap);
+    TEST_ASSERT_NOT_NULL(out_row);
+
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t width = 0; width <= TEST_ROW_MAX_WIDTH; width++) {
+            memset(out_words, 0xA5, sizeof(out_words));
+            memset(ref_words, 0xA5, sizeof(ref_words));
+            out_row(out + offset, src, width);
+            ref_out_row(ref + offset, src, width, in_format, out_format, swap);
+            /* Compare whole buffers to also catch writes past the end of the row */
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, sizeof(out_words));
+        }
+    }
+}
+
+TEST_CASE("Test JPEG output row conversion", "[esp_jpeg]")
+{
+    test_out_row(JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_FORMAT_RGB888, false);
+    test_out_row(JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_FORMAT_RGB888, true);
+    test_out_row(JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_FORMAT_RGB565, false);
+    test_out_row(JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_FORMAT_RGB565, true);
+    test_out_row(JPEG_IMAGE_FORMAT_RGB565, JPEG_IMAGE_FORMAT_RGB565, false);
+    test_out_row(JPEG_IMAGE_FORMAT_RGB565, JPEG_IMAGE_FORMAT_RGB565, true);
+
+    /* Upscaling RGB565 from TJPGD to RGB888 is not supported */
+    TEST_ASSERT_NULL(jpeg_out_row_get(JPEG_IMAGE_FORMAT_RGB565, JPEG_IMAGE_FORMAT_RGB888, false));
+}
+
+/* Per pixel reference of the YUV row functions, src is Y/Cb/Cr from TJPGD */
+static void ref_ycc_row(uint8_t *dst, const uint8_t *src, size_t width, esp_jpeg_image_format_t out_format, bool swap)
+{
+    for (size_t x = 0; x < width; x++) {
+        const uint8_t *s = src + 3 * x;
+        if (out_format == JPEG_IMAGE_FORMAT_YUV420) {
+            dst[x] = s[0];
+            continue;
+        }
+        /* Chroma of a pixel pair is taken from its first pixel */
+        const uint8_t c = (x & 1) ? s[-3 + 2] : s[1];
+        dst[2 * x + (swap ? 1 : 0)] = s[0];
+        dst[2 * x + (swap ? 0 : 1)] = c;
+    }
+}
+
+static void test_ycc_row(esp_jpeg_image_format_t out_format, bool swap)
+{
+    uint8_t src[TEST_ROW_MAX_WIDTH * 3];
+    uint32_t out_words[(TEST_ROW_MAX_WIDTH * 2 + 8) / 4];
+    uint32_t ref_words[(TEST_ROW_MAX_WIDTH * 2 + 8) / 4];
+    uint8_t *out = (uint8_t *)out_words;
+    uint8_t *ref = (uint8_t *)ref_words;
+
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    /* TJPGD outputs Y/Cb/Cr for YUV formats in any JD_FORMAT */
+    jpeg_out_row_t out_row = jpeg_out_row_get(JPEG_IMAGE_FORMAT_RGB565, out_format, swap);
+    TEST_ASSERT_EQUAL_PTR(out_row, jpeg_out_row_get(JPEG_IMAGE_FORMAT_RGB888, out_format, swap));
+    TEST_ASSERT_NOT_NULL(out_row);
+
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t width = 0; width <= TEST_ROW_MAX_WIDTH; width++) {
+            memset(out_words, 0xA5, sizeof(out_words));
+            memset(ref_words, 0xA5, sizeof(ref_words));
+            out_row(out + offset, src, width);
+            ref_ycc_row(ref + offset, src, width, out_format, swap);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, sizeof(out_words));
+        }
+    }
+}
+
+TEST_CASE("Test JPEG output row conversion: YUV", "[esp_jpeg]")
+{
+    test_ycc_row(JPEG_IMAGE_FORMAT_YUV422, false);
+    test_ycc_row(JPEG_IMAGE_FORMAT_YUV422, true);
+    test_ycc_row(JPEG_IMAGE_FORMAT_YUV420, false);
+}
+
+static uint8_t *test_decode_logo(esp_jpeg_image_format_t format, bool swap)
+{
+    const size_t outsize = TEST_LOGO_W * TEST_LOGO_H * 3;
+    uint8_t *outbuf = malloc(outsize);
+    TEST_ASSERT_NOT_NULL(outbuf);
+
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = outsize,
+        .out_format = format,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .flags = {
+            .swap_color_bytes = swap,
+        }
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(TEST_LOGO_W, outimg.width);
+    TEST_ASSERT_EQUAL(TEST_LOGO_H, outimg.height);
+
+    return outbuf;
+}
+
+TEST_CASE("Test JPEG decompression library: Output formats", "[esp_jpeg]")
+{
+#if CONFIG_JD_USE_ROM || (CONFIG_JD_FORMAT == 0)
+    const size_t pixels = TEST_LOGO_W * TEST_LOGO_H;
+    uint8_t *rgb888 = test_decode_logo(JPEG_IMAGE_FORMAT_RGB888, false);
+    uint8_t *expected = malloc(pixels * 3);
+    TEST_ASSERT_NOT_NULL(expected);
+
+    /* Every output variant must match the RGB888 image converted per pixel */
+    const struct {
+        esp_jpeg_image_format_t format;
+        bool swap;
+    } variants[] = {
+        { JPEG_IMAGE_FORMAT_RGB888, true },
+        { JPEG_IMAGE_FORMAT_RGB565, false },
+        { JPEG_IMAGE_FORMAT_RGB565, true },
+    };
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        const size_t out_bytes = (variants[i].format == JPEG_IMAGE_FORMAT_RGB888) ? 3 : 2;
+        ref_out_row(expected, rgb888, pixels, JPEG_IMAGE_FORMAT_RGB888, variants[i].format, variants[i].swap);
+        uint8_t *decoded = test_decode_logo(variants[i].format, variants[i].swap);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, decoded, pixels * out_bytes);
+        free(decoded);
+    }
+
+    free(expected);
+    free(rgb888);
+#else
+    TEST_IGNORE_MESSAGE("TJPGD is configured for RGB565 output");
+#endif
+}
+
+#if !CONFIG_JD_USE_ROM
+static esp_err_t test_band_discard(const uint8_t *band, uint16_t y, uint16_t height, void *user_ctx)
+{
+    return ESP_OK;
+}
+
+static uint8_t *test_decode_yuv(esp_jpeg_image_format_t format, bool swap, esp_jpeg_image_scale_t scale,
+                                const esp_jpeg_image_cfg_t *roi_cfg, esp_jpeg_image_output_t *outimg)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .out_format = format,
+        .out_scale = scale,
+        .flags = {
+            .swap_color_bytes = swap,
+        }
+    };
+    if (roi_cfg) {
+        jpeg_cfg.roi = roi_cfg->roi;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, outimg));
+    jpeg_cfg.outbuf_size = outimg->output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    memset(jpeg_cfg.outbuf, 0xA5, jpeg_cfg.outbuf_size);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, outimg));
+
+    return jpeg_cfg.outbuf;
+}
+
+/*
+ * Every YUV variant must be the same image: Y of YUV422 is the Y plane of YUV420, and the chroma
+ * of YUV422 at even rows are the chroma planes. roi_cfg must have an even x and y to compare with the whole image.
+ */
+static void test_yuv_variants(esp_jpeg_image_scale_t scale, const esp_jpeg_image_cfg_t *roi_cfg)
+{
+    esp_jpeg_image_output_t img422, img420, full, tmp;
+    uint8_t *yuyv = test_decode_yuv(JPEG_IMAGE_FORMAT_YUV422, false, scale, roi_cfg, &img422);
+    uint8_t *i420 = test_decode_yuv(JPEG_IMAGE_FORMAT_YUV420, false, scale, roi_cfg, &img420);
+    const size_t w = img422.width;
+    const size_t h = img422.height;
+    const size_t cw = (w + 1) / 2;
+    const size_t ch = (h + 1) / 2;
+
+    TEST_ASSERT_EQUAL(w * h * 2, img422.output_len);
+    TEST_ASSERT_EQUAL(w * h + 2 * cw * ch, img420.output_len);
+    const uint8_t *u = i420 + w * h;
+    const uint8_t *v = u + cw * ch;
+    for (size_t y = 0; y < h; y++) {
+        for (size_t x = 0; x < w; x++) {
+            const uint8_t *p = yuyv + (y * w + x) * 2;
+            TEST_ASSERT_EQUAL_HEX8(p[0], i420[y * w + x]);
+            if ((x & 1) == 0 && (y & 1) == 0) {
+                TEST_ASSERT_EQUAL_HEX8(p[1], u[(y / 2) * cw + x / 2]);
+                if (x + 1 < w) {
+                    TEST_ASSERT_EQUAL_HEX8(p[3], v[(y / 2) * cw + x / 2]);
+                }
+            }
+        }
+    }
+
+    /* UYVY is YUYV with swapped bytes of each pixel, YV12 has the chroma planes swapped */
+    uint8_t *uyvy = test_decode_yuv(JPEG_IMAGE_FORMAT_YUV422, true, scale, roi_cfg, &tmp);
+    for (size_t i = 0; i + 1 < img422.output_len; i += 2) {
+        TEST_ASSERT_EQUAL_HEX8(yuyv[i], uyvy[i + 1]);
+        TEST_ASSERT_EQUAL_HEX8(yuyv[i + 1], uyvy[i]);
+    }
+    uint8_t *yv12 = test_decode_yuv(JPEG_IMAGE_FORMAT_YUV420, true, scale, roi_cfg, &tmp);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(i420, yv12, w * h);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(u, yv12 + w * h + cw * ch, cw * ch);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(v, yv12 + w * h, cw * ch);
+
+    /* The region must be the same as in the whole image */
+    if (roi_cfg) {
+        uint8_t *whole = test_decode_yuv(JPEG_IMAGE_FORMAT_YUV422, false, scale, NULL, &full);
+        for (size_t row = 0; row < h; row++) {
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(whole + ((roi_cfg->roi.y + row) * full.width + roi_cfg->roi.x) * 2,
+                                         yuyv + row * w * 2, (w & ~1) * 2);
+        }
+        free(whole);
+    }
+
+    free(yv12);
+    free(uyvy);
+    free(i420);
+    free(yuyv);
+}
+#endif
+
+TEST_CASE("Test JPEG decompression library: YUV output formats", "[esp_jpeg]")
+{
+#if CONFIG_JD_USE_ROM
+    esp_jpeg_image_output_t outimg;
+    uint8_t outbuf[2];
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = sizeof(outbuf),
+        .out_format = JPEG_IMAGE_FORMAT_YUV422,
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_jpeg_decode(&jpeg_cfg, &outimg));
+#else
+    const esp_jpeg_image_cfg_t roi_cfg = {
+        .roi = {
+            .x = 6,
+            .y = 10,
+            .width = 21,
+            .height = 11,
+        },
+    };
+    test_yuv_variants(JPEG_IMAGE_SCALE_0, NULL);
+    test_yuv_variants(JPEG_IMAGE_SCALE_0, &roi_cfg);
+#if CONFIG_JD_USE_SCALE
+    /* At 1/8 scale every block is one pixel, so the pixel pairs are split between blocks */
+    test_yuv_variants(JPEG_IMAGE_SCALE_1_2, NULL);
+    test_yuv_variants(JPEG_IMAGE_SCALE_1_8, NULL);
+#endif
+
+    /* Chroma planes of YUV420 can't be output in bands */
+    esp_jpeg_image_output_t outimg;
+    uint8_t outbuf[2];
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = sizeof(outbuf),
+        .out_format = JPEG_IMAGE_FORMAT_YUV420,
+        .output = {
+            .band_cb = test_band_discard,
+        },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_jpeg_decode(&jpeg_cfg, &outimg));
+#endif
+}
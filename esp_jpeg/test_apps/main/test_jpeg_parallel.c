@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "jpeg_decoder.h"
+#include "test_logo_jpg.h"
+#include "test_usb_camera_2_jpg.h"
+#if CONFIG_JD_DEFAULT_HUFFMAN
+#include "test_usb_camera_jpg.h"
+#endif
+
+#define TEST_BENCHMARK_ITERATIONS   100
+
+static uint8_t *test_decode(const uint8_t *jpg, size_t jpg_len, uint8_t workers, const esp_jpeg_image_cfg_t *roi_cfg,
+                            esp_jpeg_image_output_t *outimg)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .advanced = {
+            .workers = workers,
+        },
+    };
+    if (roi_cfg) {
+        jpeg_cfg.roi = roi_cfg->roi;
+        jpeg_cfg.out_scale = roi_cfg->out_scale;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, outimg));
+    jpeg_cfg.outbuf_size = outimg->output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, outimg));
+    return jpeg_cfg.outbuf;
+}
+
+static void test_parallel_same_output(const uint8_t *jpg, size_t jpg_len, const esp_jpeg_image_cfg_t *roi_cfg)
+{
+    esp_jpeg_image_output_t ref_img, outimg;
+    uint8_t *reference = test_decode(jpg, jpg_len, 1, roi_cfg, &ref_img);
+
+    for (uint8_t workers = 2; workers <= 5; workers++) {
+        uint8_t *decoded = test_decode(jpg, jpg_len, workers, roi_cfg, &outimg);
+        TEST_ASSERT_EQUAL(ref_img.width, outimg.width);
+        TEST_ASSERT_EQUAL(ref_img.height, outimg.height);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, decoded, ref_img.output_len);
+        free(decoded);
+    }
+    free(reference);
+}
+
+/**
+ * @brief Parallel decoding test
+ *
+ * Images with restart markers are decoded by several workers, images without them sequentially.
+ * The output must be the same as from sequential decoding.
+ */
+TEST_CASE("Test JPEG decompression library: Parallel decoding", "[esp_jpeg]")
+{
+    test_parallel_same_output(logo_jpg, logo_jpg_len, NULL);
+    test_parallel_same_output(camera_2_jpg, camera_2_jpg_len, NULL);
+#if CONFIG_JD_DEFAULT_HUFFMAN
+    test_parallel_same_output(jpeg_no_huffman, jpeg_no_huffman_len, NULL);
+
+    const esp_jpeg_image_cfg_t roi_cfg = {
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .roi = {
+            .x = 20,
+            .y = 30,
+            .width = 100,
+            .height = 50,
+        },
+    };
+    test_parallel_same_output(jpeg_no_huffman, jpeg_no_huffman_len, &roi_cfg);
+#endif
+}
+
+static uint32_t test_decode_time_us(const uint8_t *jpg, size_t jpg_len, uint8_t *outbuf, size_t outbuf_size, uint8_t workers)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = outbuf_size,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .advanced = {
+            .workers = workers,
+        },
+    };
+    esp_jpeg_image_output_t outimg;
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const int64_t elapsed_us = (end.tv_sec - start.tv_sec) * 1000000LL + (end.tv_nsec - start.tv_nsec) / 1000;
+    return (uint32_t)(elapsed_us / TEST_BENCHMARK_ITERATIONS);
+}
+
+static void test_benchmark_image(const char *name, const uint8_t *jpg, size_t jpg_len)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &outimg));
+    uint8_t *outbuf = malloc(outimg.output_len);
+    TEST_ASSERT_NOT_NULL(outbuf);
+
+    const uint32_t sequential_us = test_decode_time_us(jpg, jpg_len, outbuf, outimg.output_len, 1);
+    printf("%-16s %3dx%-3d  1 worker : %6"PRIu32" us\n", name, outimg.width, outimg.height, sequential_us);
+    for (uint8_t workers = 2; workers <= 4; workers *= 2) {
+        const uint32_t parallel_us = test_decode_time_us(jpg, jpg_len, outbuf, outimg.output_len, workers);
+        printf("%-16s %3dx%-3d  %d workers: %6"PRIu32" us (%.2fx)\n", name, outimg.width, outimg.height, workers, parallel_us,
+               parallel_us ? (double)sequential_us / parallel_us : 0.0);
+    }
+    free(outbuf);
+}
+
+/**
+ * @brief Parallel decoding benchmark
+ *
+ * Prints the decoding time of the test images with 1, 2 and 4 workers.
+ * Only images with restart markers (usb_camera.jpg) can be decoded in parallel.
+ */
+TEST_CASE("Test JPEG decompression library: Parallel decoding benchmark", "[esp_jpeg][benchmark]")
+{
+    test_benchmark_image("logo.jpg", logo_jpg, logo_jpg_len);
+    test_benchmark_image("usb_camera_2.jpg", camera_2_jpg, camera_2_jpg_len);
+#if CONFIG_JD_DEFAULT_HUFFMAN
+    test_benchmark_image("usb_camera.jpg", jpeg_no_huffman, jpeg_no_huffman_len);
+#endif
+}
@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "jpeg_decoder.h"
+#include "test_progressive_jpg.h"
+
+#define TEST_PROG_W 160
+#define TEST_PROG_H 120
+
+#if CONFIG_JD_PROGRESSIVE
+
+static uint8_t *test_decode_rgb(const uint8_t *jpg, size_t jpg_len, esp_jpeg_image_scale_t scale,
+                                const esp_jpeg_image_cfg_t *roi_cfg, esp_jpeg_image_output_t *outimg)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = scale,
+    };
+    if (roi_cfg) {
+        jpeg_cfg.roi = roi_cfg->roi;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, outimg));
+    jpeg_cfg.outbuf_size = outimg->output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, outimg));
+
+    return jpeg_cfg.outbuf;
+}
+
+/* The progressive image must decode to the same pixels as the baseline image with the same quantization tables */
+static void test_progressive_same(esp_jpeg_image_scale_t scale, const esp_jpeg_image_cfg_t *roi_cfg)
+{
+    esp_jpeg_image_output_t prog, ref;
+    uint8_t *prog_out = test_decode_rgb(progressive_jpg, progressive_jpg_len, scale, roi_cfg, &prog);
+    uint8_t *ref_out = test_decode_rgb(progressive_ref_jpg, progressive_ref_jpg_len, scale, roi_cfg, &ref);
+
+    TEST_ASSERT_EQUAL(ref.width, prog.width);
+    TEST_ASSERT_EQUAL(ref.height, prog.height);
+    TEST_ASSERT_EQUAL(ref.output_len, prog.output_len);
+    TEST_ASSERT_NOT_EQUAL(0, prog.coef_len);
+    TEST_ASSERT_EQUAL(0, ref.coef_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref_out, prog_out, ref.output_len);
+
+    free(prog_out);
+    free(ref_out);
+}
+
+/**
+ * @brief Progressive JPEG test
+ *
+ * The image has several scans with spectral selection, successive approximation, redefined huffman tables
+ * and restart markers. It must be the same as the baseline image, also scaled and in a region.
+ */
+TEST_CASE("Test JPEG decompression library: Progressive JPEG", "[esp_jpeg]")
+{
+    test_progressive_same(JPEG_IMAGE_SCALE_0, NULL);
+#if CONFIG_JD_USE_SCALE
+    test_progressive_same(JPEG_IMAGE_SCALE_1_2, NULL);
+    test_progressive_same(JPEG_IMAGE_SCALE_1_4, NULL);
+    test_progressive_same(JPEG_IMAGE_SCALE_1_8, NULL);
+#endif
+
+    const esp_jpeg_image_cfg_t roi_cfg = {
+        .roi = {
+            .x = 37,
+            .y = 41,
+            .width = 50,
+            .height = 30,
+        },
+    };
+    test_progressive_same(JPEG_IMAGE_SCALE_0, &roi_cfg);
+}
+
+/**
+ * @brief Progressive JPEG with a coefficient buffer from the application
+ */
+TEST_CASE("Test JPEG decompression library: Progressive JPEG coefficient buffer", "[esp_jpeg]")
+{
+    esp_jpeg_image_output_t ref;
+    uint8_t *ref_out = test_decode_rgb(progressive_jpg, progressive_jpg_len, JPEG_IMAGE_SCALE_0, NULL, &ref);
+    TEST_ASSERT_EQUAL(TEST_PROG_W, ref.width);
+    TEST_ASSERT_EQUAL(TEST_PROG_H, ref.height);
+
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)progressive_jpg,
+        .indata_size = progressive_jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .outbuf_size = ref.output_len,
+        .advanced = {
+            .coef_buffer_size = ref.coef_len,
+        },
+    };
+    esp_jpeg_image_output_t outimg;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    jpeg_cfg.advanced.coef_buffer = malloc(ref.coef_len);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.advanced.coef_buffer);
+
+    /* Coefficients from a previous image must not matter */
+    memset(jpeg_cfg.advanced.coef_buffer, 0x5A, ref.coef_len);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(ref.coef_len, outimg.coef_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref_out, jpeg_cfg.outbuf, ref.output_len);
+
+    /* Too small buffer */
+    jpeg_cfg.advanced.coef_buffer_size = ref.coef_len - 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_jpeg_decode(&jpeg_cfg, &outimg));
+
+    free(jpeg_cfg.advanced.coef_buffer);
+    free(jpeg_cfg.outbuf);
+    free(ref_out);
+}
+#else
+/**
+ * @brief Progressive JPEG is rejected without JD_PROGRESSIVE, already by esp_jpeg_get_image_info()
+ */
+TEST_CASE("Test JPEG decompression library: Progressive JPEG not supported", "[esp_jpeg]")
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)progressive_jpg,
+        .indata_size = progressive_jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .outbuf_size = TEST_PROG_W * TEST_PROG_H * 3,
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_jpeg_get_image_info(&jpeg_cfg, &outimg));
+
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    free(jpeg_cfg.outbuf);
+
+    /* The baseline image encoded from the same picture is decoded */
+    jpeg_cfg.indata = (uint8_t *)progressive_ref_jpg;
+    jpeg_cfg.indata_size = progressive_ref_jpg_len;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(TEST_PROG_W, outimg.width);
+    TEST_ASSERT_EQUAL(TEST_PROG_H, outimg.height);
+    TEST_ASSERT_EQUAL(0, outimg.coef_len);
+}
+#endif
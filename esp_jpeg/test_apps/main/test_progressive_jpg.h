@@ -0,0 +1,19 @@
+/*
+progressive.jpg and progressive_ref.jpg were encoded from the same image with libjpeg, with the same quantization tables.
+progressive_ref.jpg is baseline, so both images decode to the same pixels.
+*/
+
+// Progressive JPEG 160x120, 4:2:0, 1490 bytes, restart interval of two MCU rows, spectral selection and successive approximation
+extern const unsigned char progressive_jpg[] asm("_binary_progressive_jpg_start");
+
+extern char _binary_progressive_jpg_start;
+extern char _binary_progressive_jpg_end;
+// Must be defined as macro because extern variables are not known at compile time (but at link time)
+#define progressive_jpg_len (&_binary_progressive_jpg_end - &_binary_progressive_jpg_start)
+
+// Baseline JPEG 160x120, 4:2:0, 1035 bytes
+extern const unsigned char progressive_ref_jpg[] asm("_binary_progressive_ref_jpg_start");
+
+extern char _binary_progressive_ref_jpg_start;
+extern char _binary_progressive_ref_jpg_end;
+#define progressive_ref_jpg_len (&_binary_progressive_ref_jpg_end - &_binary_progressive_ref_jpg_start)
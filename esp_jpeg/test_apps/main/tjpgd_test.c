@@ -141,7 +141,11 @@ TEST_CASE("Test JPEG unknown size", "[esp_jpeg]")
     free(decoded);
 }
 
+#if CONFIG_JD_FASTDECODE >= 2
+#define WORKING_BUFFER_SIZE 32768   /* Fast huffman decode tables are allocated in the working buffer */
+#else
 #define WORKING_BUFFER_SIZE 4096
+#endif
 TEST_CASE("Test JPEG decompression library: User defined working buffer", "[esp_jpeg]")
 {
     unsigned char *decoded, *p;
@@ -324,3 +328,296 @@ TEST_CASE("Test JPEG invalid marker 0xFFFF", "[esp_jpeg]")
 
     free(decoded);
 }
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    size_t chunk;
+} test_jpeg_stream_t;
+
+static size_t test_jpeg_stream_read(uint8_t *buf, size_t len, void *user_ctx)
+{
+    test_jpeg_stream_t *stream = (test_jpeg_stream_t *)user_ctx;
+    size_t n = stream->size - stream->pos;
+    /* Deliver the data in small chunks, as it would arrive from a camera or network */
+    if (n > stream->chunk) {
+        n = stream->chunk;
+    }
+    if (n > len) {
+        n = len;
+    }
+    memcpy(buf, stream->data + stream->pos, n);
+    stream->pos += n;
+    return n;
+}
+
+/**
+ * @brief Streaming input test
+ *
+ * The JPEG is not passed as a buffer but read through an input callback
+ * which delivers it in small chunks. The decoded image must be the same
+ * as when decoding from a buffer.
+ */
+TEST_CASE("Test JPEG decompression library: Streaming input", "[esp_jpeg]")
+{
+    unsigned char *decoded, *p;
+    const unsigned char *o;
+    int decoded_outsize = TESTW * TESTH * 3;
+
+    decoded = malloc(decoded_outsize);
+    TEST_ASSERT_NOT_NULL(decoded);
+
+    test_jpeg_stream_t stream = {
+        .data = logo_jpg,
+        .size = logo_jpg_len,
+        .chunk = 37,
+    };
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .outbuf = decoded,
+        .outbuf_size = decoded_outsize,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .input = {
+            .read_cb = test_jpeg_stream_read,
+            .user_ctx = &stream,
+        },
+    };
+    esp_jpeg_image_output_t outimg;
+    esp_err_t err = esp_jpeg_decode(&jpeg_cfg, &outimg);
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+
+    /* Decoded image size */
+    TEST_ASSERT_EQUAL(TESTW, outimg.width);
+    TEST_ASSERT_EQUAL(TESTH, outimg.height);
+
+    p = decoded;
+    o = logo_rgb888;
+    for (int x = 0; x < outimg.width * outimg.height; x++) {
+        /* The color can be +- 2 */
+        TEST_ASSERT_UINT8_WITHIN(2, o[0], p[0]);
+        TEST_ASSERT_UINT8_WITHIN(2, o[1], p[1]);
+        TEST_ASSERT_UINT8_WITHIN(2, o[2], p[2]);
+
+        p += 3;
+        o += 3;
+    }
+
+    /* Truncated stream must fail */
+    stream.pos = 0;
+    stream.size = logo_jpg_len / 2;
+    err = esp_jpeg_decode(&jpeg_cfg, &outimg);
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, err);
+
+    free(decoded);
+}
+
+static void test_jpeg_roi(const uint8_t *jpg, size_t jpg_len, esp_jpeg_image_scale_t scale,
+                          uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = scale,
+    };
+    esp_jpeg_image_output_t full;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &full));
+
+    /* Decode the whole image as reference */
+    jpeg_cfg.outbuf_size = full.output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &full));
+    uint8_t *reference = jpeg_cfg.outbuf;
+
+    /* Decode only the region; the output buffer is just large enough for it */
+    esp_jpeg_image_output_t outimg;
+    jpeg_cfg.roi.x = x;
+    jpeg_cfg.roi.y = y;
+    jpeg_cfg.roi.width = w;
+    jpeg_cfg.roi.height = h;
+    jpeg_cfg.outbuf_size = w * h * 3;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(w, outimg.width);
+    TEST_ASSERT_EQUAL(h, outimg.height);
+    TEST_ASSERT_EQUAL(w * h * 3, outimg.output_len);
+
+    /* The region must be the same as in the whole image */
+    for (int row = 0; row < h; row++) {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(reference + ((y + row) * full.width + x) * 3, jpeg_cfg.outbuf + row * w * 3, w * 3);
+    }
+
+    free(jpeg_cfg.outbuf);
+    free(reference);
+}
+
+/**
+ * @brief Region of interest test
+ *
+ * Only a region of the image is decoded to a buffer of the region size.
+ * It must be the same as the region of the whole decoded image.
+ */
+TEST_CASE("Test JPEG decompression library: Region of interest", "[esp_jpeg]")
+{
+    test_jpeg_roi(logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 0, 0, TESTW, TESTH);
+    test_jpeg_roi(logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, 5, 9, 20, 11);
+    test_jpeg_roi(logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_0, TESTW - 1, TESTH - 1, 1, 1);
+#if CONFIG_JD_USE_SCALE || CONFIG_JD_USE_ROM
+    test_jpeg_roi(logo_jpg, logo_jpg_len, JPEG_IMAGE_SCALE_1_2, 3, 4, 10, 7);
+#endif
+
+    /* Region out of the image */
+    uint8_t outbuf[3];
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = sizeof(outbuf),
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .roi = {
+            .x = TESTW,
+            .y = 0,
+            .width = 1,
+            .height = 1,
+        },
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_jpeg_decode(&jpeg_cfg, &outimg));
+}
+
+#if CONFIG_JD_DEFAULT_HUFFMAN
+#include "test_usb_camera_jpg.h"
+
+/**
+ * @brief Region of interest test with restart markers
+ *
+ * The USB camera frame has a restart interval of one MCU row, so the rows
+ * outside of the region are skipped without entropy decoding.
+ */
+TEST_CASE("Test JPEG decompression library: Region of interest with restart markers", "[esp_jpeg]")
+{
+    test_jpeg_roi(jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 0, 0, 160, 120);
+    test_jpeg_roi(jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 37, 41, 50, 30);
+    test_jpeg_roi(jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 0, 112, 160, 8);
+    test_jpeg_roi(jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_0, 150, 60, 10, 1);
+#if CONFIG_JD_USE_SCALE || CONFIG_JD_USE_ROM
+    test_jpeg_roi(jpeg_no_huffman, jpeg_no_huffman_len, JPEG_IMAGE_SCALE_1_4, 10, 10, 12, 8);
+#endif
+}
+#endif
+
+typedef struct {
+    uint8_t *image;         /* Whole image assembled from the bands */
+    size_t row_len;
+    uint16_t next_y;        /* Expected first row of the next band */
+    uint16_t band_height;
+    int bands;
+    int stop_after;         /* Stop decoding after this number of bands, 0: never */
+} test_band_ctx_t;
+
+static esp_err_t test_band_cb(const uint8_t *band, uint16_t y, uint16_t height, void *user_ctx)
+{
+    test_band_ctx_t *ctx = (test_band_ctx_t *)user_ctx;
+
+    /* Bands must come in order and no band may be higher than band_height */
+    TEST_ASSERT_EQUAL(ctx->next_y, y);
+    TEST_ASSERT_LESS_OR_EQUAL(ctx->band_height, height);
+    memcpy(ctx->image + y * ctx->row_len, band, height * ctx->row_len);
+    ctx->next_y = y + height;
+    ctx->bands++;
+
+    return (ctx->stop_after && ctx->bands == ctx->stop_after) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+static void test_jpeg_bands(const uint8_t *jpg, size_t jpg_len, esp_jpeg_image_format_t format, esp_jpeg_image_scale_t scale,
+                            uint16_t roi_x, uint16_t roi_y, uint16_t roi_w, uint16_t roi_h)
+{
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)jpg,
+        .indata_size = jpg_len,
+        .out_format = format,
+        .out_scale = scale,
+        .roi = {
+            .x = roi_x,
+            .y = roi_y,
+            .width = roi_w,
+            .height = roi_h,
+        },
+    };
+    esp_jpeg_image_output_t info, full, outimg;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_get_image_info(&jpeg_cfg, &info));
+
+    /* Decode the whole image (or region) as reference */
+    jpeg_cfg.outbuf_size = info.output_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &full));
+    uint8_t *reference = jpeg_cfg.outbuf;
+
+    /* Decode in bands to a buffer of one band */
+    test_band_ctx_t ctx = {
+        .image = calloc(1, full.output_len),
+        .row_len = full.output_len / full.height,
+        .band_height = info.band_height,
+    };
+    TEST_ASSERT_NOT_NULL(ctx.image);
+    jpeg_cfg.outbuf_size = info.band_len;
+    jpeg_cfg.outbuf = malloc(jpeg_cfg.outbuf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_cfg.outbuf);
+    jpeg_cfg.output.band_cb = test_band_cb;
+    jpeg_cfg.output.user_ctx = &ctx;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(info.band_height, outimg.band_height);
+    TEST_ASSERT_EQUAL(full.height, ctx.next_y);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reference, ctx.image, full.output_len);
+
+    /* Error from the callback stops decoding */
+    ctx.next_y = 0;
+    ctx.bands = 0;
+    ctx.stop_after = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_jpeg_decode(&jpeg_cfg, &outimg));
+    TEST_ASSERT_EQUAL(1, ctx.bands);
+
+    free(jpeg_cfg.outbuf);
+    free(ctx.image);
+    free(reference);
+}
+
+/**
+ * @brief Band output test
+ *
+ * The image is decoded to a buffer of one MCU row, which is passed to a callback.
+ * The bands put together must be the same as the image decoded at once.
+ */
+TEST_CASE("Test JPEG decompression library: Band output", "[esp_jpeg]")
+{
+    test_jpeg_bands(logo_jpg, logo_jpg_len, JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_SCALE_0, 0, 0, 0, 0);
+    test_jpeg_bands(logo_jpg, logo_jpg_len, JPEG_IMAGE_FORMAT_RGB565, JPEG_IMAGE_SCALE_0, 3, 5, 30, 33);
+    test_jpeg_bands(camera_2_jpg, camera_2_jpg_len, JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_SCALE_0, 0, 0, 0, 0);
+#if CONFIG_JD_USE_SCALE || CONFIG_JD_USE_ROM
+    test_jpeg_bands(logo_jpg, logo_jpg_len, JPEG_IMAGE_FORMAT_RGB888, JPEG_IMAGE_SCALE_1_8, 0, 0, 0, 0);
+    test_jpeg_bands(camera_2_jpg, camera_2_jpg_len, JPEG_IMAGE_FORMAT_RGB565, JPEG_IMAGE_SCALE_1_2, 11, 7, 60, 40);
+#endif
+
+    /* Output buffer smaller than one band */
+    uint8_t outbuf[16];
+    test_band_ctx_t ctx = { 0 };
+    esp_jpeg_image_cfg_t jpeg_cfg = {
+        .indata = (uint8_t *)logo_jpg,
+        .indata_size = logo_jpg_len,
+        .outbuf = outbuf,
+        .outbuf_size = sizeof(outbuf),
+        .out_format = JPEG_IMAGE_FORMAT_RGB888,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .output = {
+            .band_cb = test_band_cb,
+            .user_ctx = &ctx,
+        },
+    };
+    esp_jpeg_image_output_t outimg;
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_jpeg_decode(&jpeg_cfg, &outimg));
+}
@@ -1,6 +1,26 @@
 import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
 
 
 @pytest.mark.generic
 def test_esp_jpeg(dut) -> None:
     dut.run_all_single_board_cases()
+
+
+@pytest.mark.generic
+@pytest.mark.parametrize('config', ['fastdecode_basic', 'fastdecode_table', 'fastdecode_table_ac'], indirect=True)
+def test_esp_jpeg_fastdecode(dut: Dut, config: str) -> None:
+    dut.run_all_single_board_cases()
+
+
+@pytest.mark.generic
+@pytest.mark.parametrize('config', ['progressive'], indirect=True)
+def test_esp_jpeg_progressive(dut: Dut, config: str) -> None:
+    dut.run_all_single_board_cases()
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_esp_jpeg_linux(dut: Dut) -> None:
+    dut.run_all_single_board_cases()
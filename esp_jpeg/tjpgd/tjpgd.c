@@ -29,10 +29,17 @@
 
 #if JD_FASTDECODE == 2
 #define HUFF_BIT    10  /* Bit length to apply fast huffman decode */
+#elif JD_FASTDECODE == 3
+#define HUFF_BIT    11  /* Bit length to apply fast huffman decode (and AC value extraction) */
+#endif
+#if JD_FASTDECODE >= 2
 #define HUFF_LEN    (1 << HUFF_BIT)
 #define HUFF_MASK   (HUFF_LEN - 1)
 #endif
 
+#define TBL_HUFF(id, cls)   (1 << ((id) * 2 + (cls)))   /* Bit of a huffman table in tbldef */
+#define TBL_QT(id)          (0x10 << (id))              /* Bit of a dequantizer table in tbldef */
+
 
 /*-----------------------------------------------*/
 /* Zigzag-order to raster-order conversion table */
@@ -154,6 +161,198 @@ static void *alloc_pool (   /* Pointer to allocated memory block (NULL:no memory
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* Hash of table definition data (FNV-1a), never 0                       */
+/*-----------------------------------------------------------------------*/
+/* Only used to reject a different table quickly, a table with the same
+/  hash is compared with the kept definition data. */
+
+#define HASH_INIT   2166136261U
+
+static uint32_t hash_tbl (
+    uint32_t h,             /* Hash of the preceding data or HASH_INIT */
+    const uint8_t *data,    /* Pointer to the data */
+    size_t ndata            /* Size of the data */
+)
+{
+    while (ndata--) {
+        h = (h ^ *data++) * 16777619U;
+    }
+
+    return h | 1;   /* 0 is used for no table */
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Check if a kept huffman table has the same definition data            */
+/*-----------------------------------------------------------------------*/
+
+static int same_huffman_tbl (  /* 1:Same, 0:Different */
+    JDEC *jd,               /* Pointer to the decompressor object */
+    unsigned int num,       /* Table number (0/1) */
+    unsigned int cls,       /* Table class (0:DC, 1:AC) */
+    uint32_t h,             /* Hash of the definition data */
+    const uint8_t *bits,    /* Number of codes for 1 to 16-bit code */
+    const uint8_t *data,    /* Decoded data of the codes */
+    size_t np               /* Number of codes */
+)
+{
+    return jd->tblhash[num * 2 + cls] == h
+           && !memcmp(jd->huffbits[num][cls], bits, 16)
+           && !memcmp(jd->huffdata[num][cls], data, np);
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Allocate all tables at their max size for jd_prepare_cached()         */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT alloc_tables (  /* 0:OK, !0:Failed */
+    JDEC *jd                /* Pointer to the decompressor object */
+)
+{
+    unsigned int num, cls, cap;
+
+
+    for (num = 0; num < 2; num++) {
+        for (cls = 0; cls < 2; cls++) {
+            cap = cls ? 256 : 16;   /* Max number of codes, so the tables are never allocated again */
+            jd->huffbits[num][cls] = alloc_pool(jd, 16);
+            jd->huffcode[num][cls] = alloc_pool(jd, cap * sizeof (uint16_t));
+            jd->huffdata[num][cls] = alloc_pool(jd, cap);
+            if (!jd->huffbits[num][cls] || !jd->huffcode[num][cls] || !jd->huffdata[num][cls]) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->huffcap[num][cls] = (uint16_t)cap;
+        }
+#if JD_FASTDECODE >= 2
+        jd->hufflut_ac[num] = alloc_pool(jd, HUFF_LEN * sizeof (uint16_t));
+        jd->hufflut_dc[num] = alloc_pool(jd, HUFF_LEN * sizeof (uint8_t));
+        if (!jd->hufflut_ac[num] || !jd->hufflut_dc[num]) {
+            return JDR_MEM1;
+        }
+#if JD_FASTDECODE == 3
+        jd->hufflut_fac[num] = alloc_pool(jd, HUFF_LEN * sizeof (int16_t));
+        if (!jd->hufflut_fac[num]) {
+            return JDR_MEM1;
+        }
+#endif
+#endif
+    }
+    for (num = 0; num < 4; num++) {
+        jd->qttbl[num] = alloc_pool(jd, 64 * sizeof (int32_t));
+        jd->qtdef[num] = alloc_pool(jd, 64);
+        if (!jd->qttbl[num] || !jd->qtdef[num]) {
+            return JDR_MEM1;
+        }
+    }
+
+    return JDR_OK;
+}
+
+
+
+#if JD_FASTDECODE >= 2
+/*-----------------------------------------------------------------------*/
+/* Create fast huffman decode tables for a huffman table                 */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT create_huffman_lut ( /* 0:OK, !0:Failed */
+    JDEC *jd,               /* Pointer to the decompressor object */
+    unsigned int num,       /* Table number (0/1) */
+    unsigned int cls        /* Table class (0:DC, 1:AC) */
+)
+{
+    unsigned int i, j, b, span, td, ti;
+    const uint8_t *pb = jd->huffbits[num][cls];
+    const uint16_t *ph = jd->huffcode[num][cls];
+    const uint8_t *pd = jd->huffdata[num][cls];
+    uint16_t *tbl_ac = 0;
+    uint8_t *tbl_dc = 0;
+
+
+    if (cls) {
+        tbl_ac = jd->hufflut_ac[num];   /* The LUT of a redefined table is reused */
+        if (!tbl_ac) {
+            tbl_ac = alloc_pool(jd, HUFF_LEN * sizeof (uint16_t));  /* LUT for AC elements */
+            if (!tbl_ac) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->hufflut_ac[num] = tbl_ac;
+        }
+        memset(tbl_ac, 0xFF, HUFF_LEN * sizeof (uint16_t));     /* Default value (0xFFFF: may be long code) */
+    } else {
+        tbl_dc = jd->hufflut_dc[num];
+        if (!tbl_dc) {
+            tbl_dc = alloc_pool(jd, HUFF_LEN * sizeof (uint8_t));   /* LUT for AC elements */
+            if (!tbl_dc) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->hufflut_dc[num] = tbl_dc;
+        }
+        memset(tbl_dc, 0xFF, HUFF_LEN * sizeof (uint8_t));      /* Default value (0xFF: may be long code) */
+    }
+    for (i = b = 0; b < HUFF_BIT; b++) {    /* Create LUT */
+        for (j = pb[b]; j; j--) {
+            ti = ph[i] << (HUFF_BIT - 1 - b) & HUFF_MASK;   /* Index of input pattern for the code */
+            if (cls) {
+                td = pd[i++] | ((b + 1) << 8);  /* b15..b8: code length, b7..b0: zero run and data length */
+                for (span = 1 << (HUFF_BIT - 1 - b); span; span--, tbl_ac[ti++] = (uint16_t)td) ;
+            } else {
+                td = pd[i++] | ((b + 1) << 4);  /* b7..b4: code length, b3..b0: data length */
+                for (span = 1 << (HUFF_BIT - 1 - b); span; span--, tbl_dc[ti++] = (uint8_t)td) ;
+            }
+        }
+    }
+    jd->longofs[num][cls] = i;  /* Code table offset for long code */
+
+#if JD_FASTDECODE == 3
+    if (cls) {  /* Create LUT of AC elements whose code and data bits fit in HUFF_BIT */
+        int16_t *tbl_fac = jd->hufflut_fac[num];
+        unsigned int cl, run, nb;
+        int v;
+
+        if (!tbl_fac) {
+            tbl_fac = alloc_pool(jd, HUFF_LEN * sizeof (int16_t));
+            if (!tbl_fac) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->hufflut_fac[num] = tbl_fac;
+        }
+        for (ti = 0; ti < HUFF_LEN; ti++) {
+            tbl_fac[ti] = 0;    /* Default value (0: not in this table) */
+            td = tbl_ac[ti];
+            if (td == 0xFFFF) {
+                continue;       /* Long code */
+            }
+            cl = td >> 8; run = (td >> 4) & 0x0F; nb = td & 0x0F;
+            if (nb == 0) {      /* EOB or ZRL: zero value with the code length (and 15 zero run for ZRL) */
+                if (run == 0 || run == 15) {
+                    tbl_fac[ti] = (int16_t)((run << 4) + cl);
+                }
+                continue;
+            }
+            if (nb > 7 || cl + nb > HUFF_BIT) {
+                continue;       /* The data does not fit in the entry or the index */
+            }
+            v = (ti >> (HUFF_BIT - cl - nb)) & ((1 << nb) - 1);    /* Data bits following the code */
+            if (!(v & (1 << (nb - 1)))) {
+                v -= (1 << nb) - 1;     /* Restore negative value */
+            }
+            tbl_fac[ti] = (int16_t)(v * 256 + (run << 4) + cl + nb);   /* b15..b8: value, b7..b4: zero run, b3..b0: total bit length */
+        }
+    }
+#endif
+
+    return JDR_OK;
+}
+#endif
+
+
+
 #if JD_DEFAULT_HUFFMAN
 /*-----------------------------------------------------------------------*/
 /* Load default Huffman table                                            */
@@ -189,25 +388,42 @@ JRESULT jd_load_default_huffman (JDEC *jd)
     // Loop over Y/CbCr channels and DC/AC components to initialize Huffman tables
     for (int ycbcr = 0; ycbcr < 2; ycbcr++) { // Loop for Luminance (Y) and Chrominance (CbCr)
         for (int dcac = 0; dcac < 2; dcac++) { // Loop for DC and AC tables
-            // Assign the bit lengths and values arrays to Huffman table fields in the JDEC structure
-            jd->huffbits[ycbcr][dcac] = num_bits[ycbcr][dcac];
-            jd->huffdata[ycbcr][dcac] = values[ycbcr][dcac];
-
-            // Calculate Huffman codes from bit lengths to construct codeword tables
             pb = num_bits[ycbcr][dcac]; // Access bit length array
             size_t np = codes_total[ycbcr][dcac]; // Total number of codes
-
-            // The bits and values are usually in the Huffman table of the JPEG picture.
-            // The codes themselves must be calculated based on the bits and values; that is what we do here.
-            // Since this function uses default bits and values that are constant and known at compile time,
-            // We could optimize this even more by providing pre-calculated codes too...
-
-            // Allocate memory for the Huffman codeword table
-            ph = alloc_pool(jd, np * sizeof(uint16_t));
-            if (!ph) {
-                return JDR_MEM1;    // Error: Memory allocation failed
+            jd->tbldef |= TBL_HUFF(ycbcr, dcac);
+
+            if (jd->tblpool) {
+                // jd_prepare_cached() keeps the tables, so copy the default ones there (unless they are there already)
+                uint8_t d = (uint8_t)(dcac << 4 | ycbcr);  // Class and number as in a DHT segment, which gives the same hash
+                uint32_t h = hash_tbl(hash_tbl(hash_tbl(HASH_INIT, &d, 1), pb, 16), values[ycbcr][dcac], np);
+                if (same_huffman_tbl(jd, ycbcr, dcac, h, pb, values[ycbcr][dcac], np)) {
+                    continue;
+                }
+                memcpy(jd->huffbits[ycbcr][dcac], pb, 16);
+                memcpy(jd->huffdata[ycbcr][dcac], values[ycbcr][dcac], np);
+                jd->tblhash[ycbcr * 2 + dcac] = h;
+                pb = jd->huffbits[ycbcr][dcac];
+                ph = jd->huffcode[ycbcr][dcac];
+            } else {
+                // Assign the bit lengths and values arrays to Huffman table fields in the JDEC structure
+                jd->huffbits[ycbcr][dcac] = pb;
+                jd->huffdata[ycbcr][dcac] = values[ycbcr][dcac];
+                jd->huffcap[ycbcr][dcac] = 0;   // The tables are constant, a redefinition must not reuse them
+
+                // The bits and values are usually in the Huffman table of the JPEG picture.
+                // The codes themselves must be calculated based on the bits and values; that is what we do here.
+                // Since this function uses default bits and values that are constant and known at compile time,
+                // We could optimize this even more by providing pre-calculated codes too...
+
+                // Allocate memory for the Huffman codeword table
+                ph = alloc_pool(jd, np * sizeof(uint16_t));
+                if (!ph) {
+                    return JDR_MEM1;    // Error: Memory allocation failed
+                }
+                jd->huffcode[ycbcr][dcac] = ph; // Store allocated memory address for code table
             }
-            jd->huffcode[ycbcr][dcac] = ph; // Store allocated memory address for code table
+
+            // Calculate Huffman codes from bit lengths to construct codeword tables
             hc = 0; // Initialize Huffman code
 
             // Generate Huffman codes based on the bit lengths in pb
@@ -218,6 +434,13 @@ JRESULT jd_load_default_huffman (JDEC *jd)
                 }
                 hc <<= 1; // Left shift code to increase bit length
             }
+#if JD_FASTDECODE >= 2
+            // Create fast huffman decode tables
+            JRESULT rc = create_huffman_lut(jd, ycbcr, dcac);
+            if (rc != JDR_OK) {
+                return rc;
+            }
+#endif
         }
     }
     return JDR_OK; // Return success status
@@ -237,6 +460,7 @@ static JRESULT create_qt_tbl (  /* 0:OK, !0:Failed */
     unsigned int i, zi;
     uint8_t d;
     int32_t *pb;
+    uint32_t h;
 
 
     while (ndata) { /* Process all tables in the segment */
@@ -249,11 +473,24 @@ static JRESULT create_qt_tbl (  /* 0:OK, !0:Failed */
             return JDR_FMT1;    /* Err: not 8-bit resolution */
         }
         i = d & 3;                              /* Get table ID */
-        pb = alloc_pool(jd, 64 * sizeof (int32_t));/* Allocate a memory block for the table */
+        jd->tbldef |= TBL_QT(i);
+        if (jd->tblpool) {                      /* jd_prepare_cached(): skip the table if it is the same as in the previous image */
+            h = hash_tbl(hash_tbl(HASH_INIT, &d, 1), data, 64);
+            if (jd->tblhash[4 + i] == h && !memcmp(jd->qtdef[i], data, 64)) {
+                data += 64;
+                continue;
+            }
+            memcpy(jd->qtdef[i], data, 64);
+            jd->tblhash[4 + i] = h;
+        }
+        pb = jd->qttbl[i];                      /* A redefined table is overwritten */
         if (!pb) {
-            return JDR_MEM1;    /* Err: not enough memory */
+            pb = alloc_pool(jd, 64 * sizeof (int32_t));/* Allocate a memory block for the table */
+            if (!pb) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->qttbl[i] = pb;                  /* Register the table */
         }
-        jd->qttbl[i] = pb;                      /* Register the table */
         for (i = 0; i < 64; i++) {              /* Load the table */
             zi = Zig[i];                        /* Zigzag-order to raster-order conversion */
             pb[zi] = (int32_t)((uint32_t) * data++ * Ipsf[zi]); /* Apply scale factor of Arai algorithm to the de-quantizers */
@@ -277,9 +514,10 @@ static JRESULT create_huffman_tbl ( /* 0:OK, !0:Failed */
 )
 {
     unsigned int i, j, b, cls, num;
-    size_t np;
+    size_t np, cap;
     uint8_t d, *pb, *pd;
     uint16_t hc, *ph;
+    uint32_t h = 0;
 
 
     while (ndata) { /* Process all tables in the segment */
@@ -292,7 +530,27 @@ static JRESULT create_huffman_tbl ( /* 0:OK, !0:Failed */
             return JDR_FMT1;    /* Err: invalid class/number */
         }
         cls = d >> 4; num = d & 0x0F;       /* class = dc(0)/ac(1), table number = 0/1 */
-        pb = alloc_pool(jd, 16);            /* Allocate a memory block for the bit distribution table */
+        jd->tbldef |= TBL_HUFF(num, cls);
+        if (jd->tblpool) {                  /* jd_prepare_cached(): skip the table if it is the same as in the previous image */
+            for (np = i = 0; i < 16; i++) {
+                np += data[i];
+            }
+            if (ndata < np) {
+                return JDR_FMT1;    /* Err: wrong data size */
+            }
+            h = hash_tbl(hash_tbl(HASH_INIT, &d, 1), data, 16 + np);
+            if (same_huffman_tbl(jd, num, cls, h, data, data + 16, np)) {
+                data += 16 + np;
+                ndata -= np;
+                continue;
+            }
+            jd->tblhash[num * 2 + cls] = 0; /* Invalid until the table is created */
+            if (np > jd->huffcap[num][cls]) {
+                return JDR_FMT1;    /* Err: more codes than symbols, the kept tables are not reallocated */
+            }
+        }
+        cap = jd->huffcap[num][cls];        /* A redefined table reuses its memory (progressive JPEG redefines them between scans) */
+        pb = cap ? jd->huffbits[num][cls] : alloc_pool(jd, 16);  /* Allocate a memory block for the bit distribution table */
         if (!pb) {
             return JDR_MEM1;    /* Err: not enough memory */
         }
@@ -300,11 +558,18 @@ static JRESULT create_huffman_tbl ( /* 0:OK, !0:Failed */
         for (np = i = 0; i < 16; i++) {     /* Load number of patterns for 1 to 16-bit code */
             np += (pb[i] = *data++);        /* Get sum of code words for each code */
         }
-        ph = alloc_pool(jd, np * sizeof (uint16_t));/* Allocate a memory block for the code word table */
-        if (!ph) {
-            return JDR_MEM1;    /* Err: not enough memory */
+        if (np > cap) {
+            cap = (cap && np < (cls ? 256U : 16U)) ? (cls ? 256U : 16U) : np;  /* A grown table gets the max size, so it is not grown again */
+            jd->huffcap[num][cls] = (uint16_t)cap;
+            ph = alloc_pool(jd, cap * sizeof (uint16_t));/* Allocate a memory block for the code word table */
+            pd = alloc_pool(jd, cap);       /* Allocate a memory block for the decoded data */
+            if (!ph || !pd) {
+                return JDR_MEM1;    /* Err: not enough memory */
+            }
+            jd->huffcode[num][cls] = ph;
+            jd->huffdata[num][cls] = pd;
         }
-        jd->huffcode[num][cls] = ph;
+        ph = jd->huffcode[num][cls];
         hc = 0;
         for (j = i = 0; i < 16; i++) {      /* Re-build huffman code word table */
             b = pb[i];
@@ -318,11 +583,7 @@ static JRESULT create_huffman_tbl ( /* 0:OK, !0:Failed */
             return JDR_FMT1;    /* Err: wrong data size */
         }
         ndata -= np;
-        pd = alloc_pool(jd, np);            /* Allocate a memory block for the decoded data */
-        if (!pd) {
-            return JDR_MEM1;    /* Err: not enough memory */
-        }
-        jd->huffdata[num][cls] = pd;
+        pd = jd->huffdata[num][cls];
         for (i = 0; i < np; i++) {          /* Load decoded data corresponds to each code word */
             d = *data++;
             if (!cls && d > 11) {
@@ -330,46 +591,72 @@ static JRESULT create_huffman_tbl ( /* 0:OK, !0:Failed */
             }
             pd[i] = d;
         }
-#if JD_FASTDECODE == 2
+#if JD_FASTDECODE >= 2
         { /* Create fast huffman decode table */
-            unsigned int span, td, ti;
-            uint16_t *tbl_ac = 0;
-            uint8_t *tbl_dc = 0;
+            JRESULT rc = create_huffman_lut(jd, num, cls);
+            if (rc != JDR_OK) {
+                return rc;
+            }
+        }
+#endif
+        jd->tblhash[num * 2 + cls] = h;     /* The table is complete */
+    }
 
-            if (cls) {
-                tbl_ac = alloc_pool(jd, HUFF_LEN * sizeof (uint16_t));  /* LUT for AC elements */
-                if (!tbl_ac) {
-                    return JDR_MEM1;    /* Err: not enough memory */
+    return JDR_OK;
+}
+
+
+
+
+#if JD_FASTDECODE >= 1
+/*-----------------------------------------------------------------------*/
+/* Fill the working register with at least N bits from input stream     */
+/*-----------------------------------------------------------------------*/
+
+static inline int wreg_fill (   /* >=0: number of bits in the working register, <0: error code */
+    JDEC *jd,           /* Pointer to the decompressor object */
+    unsigned int nbit   /* Number of bits required (1 to 16) */
+)
+{
+    size_t dc = jd->dctr;
+    uint8_t *dp = jd->dptr;
+    unsigned int d, flg = 0, wbit = jd->dbit % 32;
+    uint32_t w = jd->wreg & ((1UL << wbit) - 1);
+
+
+    while (wbit < nbit) {   /* Prepare nbit bits into the working register */
+        if (jd->marker) {
+            d = 0xFF;   /* Input stream has stalled for a marker. Generate stuff bits */
+        } else {
+            if (!dc) {  /* Buffer empty, re-fill input buffer */
+                dp = jd->inbuf;                     /* Top of input buffer */
+                dc = jd->infunc(jd, dp, JD_SZBUF);
+                if (!dc) {
+                    return 0 - (int)JDR_INP;    /* Err: read error or wrong stream termination */
                 }
-                jd->hufflut_ac[num] = tbl_ac;
-                memset(tbl_ac, 0xFF, HUFF_LEN * sizeof (uint16_t));     /* Default value (0xFFFF: may be long code) */
-            } else {
-                tbl_dc = alloc_pool(jd, HUFF_LEN * sizeof (uint8_t));   /* LUT for AC elements */
-                if (!tbl_dc) {
-                    return JDR_MEM1;    /* Err: not enough memory */
+            }
+            d = *dp++; dc--;
+            if (flg) {      /* In flag sequence? */
+                flg = 0;    /* Exit flag sequence */
+                if (d != 0) {
+                    jd->marker = d;    /* Not an escape of 0xFF but a marker */
                 }
-                jd->hufflut_dc[num] = tbl_dc;
-                memset(tbl_dc, 0xFF, HUFF_LEN * sizeof (uint8_t));      /* Default value (0xFF: may be long code) */
-            }
-            for (i = b = 0; b < HUFF_BIT; b++) {    /* Create LUT */
-                for (j = pb[b]; j; j--) {
-                    ti = ph[i] << (HUFF_BIT - 1 - b) & HUFF_MASK;   /* Index of input pattern for the code */
-                    if (cls) {
-                        td = pd[i++] | ((b + 1) << 8);  /* b15..b8: code length, b7..b0: zero run and data length */
-                        for (span = 1 << (HUFF_BIT - 1 - b); span; span--, tbl_ac[ti++] = (uint16_t)td) ;
-                    } else {
-                        td = pd[i++] | ((b + 1) << 4);  /* b7..b4: code length, b3..b0: data length */
-                        for (span = 1 << (HUFF_BIT - 1 - b); span; span--, tbl_dc[ti++] = (uint8_t)td) ;
-                    }
+                d = 0xFF;
+            } else {
+                if (d == 0xFF) {        /* Is start of flag sequence? */
+                    flg = 1; continue;  /* Enter flag sequence, get trailing byte */
                 }
             }
-            jd->longofs[num][cls] = i;  /* Code table offset for long code */
         }
-#endif
+        w = w << 8 | d; /* Shift 8 bits in the working register */
+        wbit += 8;
     }
+    jd->dctr = dc; jd->dptr = dp;
+    jd->wreg = w; jd->dbit = wbit;  /* The register holds only the available bits */
 
-    return JDR_OK;
+    return (int)wbit;
 }
+#endif
 
 
 
@@ -384,11 +671,12 @@ static int huffext (    /* >=0: decoded data, <0: error code */
     unsigned int cls    /* Table class (0:DC, 1:AC) */
 )
 {
-    size_t dc = jd->dctr;
-    uint8_t *dp = jd->dptr;
-    unsigned int d, flg = 0;
+    unsigned int d;
 
 #if JD_FASTDECODE == 0
+    size_t dc = jd->dctr;
+    uint8_t *dp = jd->dptr;
+    unsigned int flg = 0;
     uint8_t bm, nd, bl;
     const uint8_t *hb = jd->huffbits[id][cls];  /* Bit distribution table */
     const uint16_t *hc = jd->huffcode[id][cls]; /* Code word table */
@@ -441,41 +729,18 @@ static int huffext (    /* >=0: decoded data, <0: error code */
 #else
     const uint8_t *hb, *hd;
     const uint16_t *hc;
-    unsigned int nc, bl, wbit = jd->dbit % 32;
-    uint32_t w = jd->wreg & ((1UL << wbit) - 1);
+    unsigned int nc, bl, wbit;
+    uint32_t w;
+    int rc;
 
 
-    while (wbit < 16) { /* Prepare 16 bits into the working register */
-        if (jd->marker) {
-            d = 0xFF;   /* Input stream has stalled for a marker. Generate stuff bits */
-        } else {
-            if (!dc) {  /* Buffer empty, re-fill input buffer */
-                dp = jd->inbuf;                     /* Top of input buffer */
-                dc = jd->infunc(jd, dp, JD_SZBUF);
-                if (!dc) {
-                    return 0 - (int)JDR_INP;    /* Err: read error or wrong stream termination */
-                }
-            }
-            d = *dp++; dc--;
-            if (flg) {      /* In flag sequence? */
-                flg = 0;    /* Exit flag sequence */
-                if (d != 0) {
-                    jd->marker = d;    /* Not an escape of 0xFF but a marker */
-                }
-                d = 0xFF;
-            } else {
-                if (d == 0xFF) {        /* Is start of flag sequence? */
-                    flg = 1; continue;  /* Enter flag sequence, get trailing byte */
-                }
-            }
-        }
-        w = w << 8 | d; /* Shift 8 bits in the working register */
-        wbit += 8;
+    rc = wreg_fill(jd, 16);     /* Prepare 16 bits into the working register */
+    if (rc < 0) {
+        return rc;
     }
-    jd->dctr = dc; jd->dptr = dp;
-    jd->wreg = w;
+    wbit = (unsigned int)rc; w = jd->wreg;
 
-#if JD_FASTDECODE == 2
+#if JD_FASTDECODE >= 2
     /* Table search for the short codes */
     d = (unsigned int)(w >> (wbit - HUFF_BIT)); /* Short code as table index */
     if (cls) {  /* AC element */
@@ -534,11 +799,10 @@ static int bitext ( /* >=0: extracted data, <0: error code */
     unsigned int nbit   /* Number of bits to extract (1 to 16) */
 )
 {
+#if JD_FASTDECODE == 0
     size_t dc = jd->dctr;
     uint8_t *dp = jd->dptr;
     unsigned int d, flg = 0;
-
-#if JD_FASTDECODE == 0
     uint8_t mbit = jd->dbit;
 
     d = 0;
@@ -579,41 +843,18 @@ static int bitext ( /* >=0: extracted data, <0: error code */
     return (int)d;
 
 #else
-    unsigned int wbit = jd->dbit % 32;
-    uint32_t w = jd->wreg & ((1UL << wbit) - 1);
+    unsigned int wbit;
+    int rc;
 
 
-    while (wbit < nbit) {   /* Prepare nbit bits into the working register */
-        if (jd->marker) {
-            d = 0xFF;   /* Input stream stalled, generate stuff bits */
-        } else {
-            if (!dc) {  /* Buffer empty, re-fill input buffer */
-                dp = jd->inbuf; /* Top of input buffer */
-                dc = jd->infunc(jd, dp, JD_SZBUF);
-                if (!dc) {
-                    return 0 - (int)JDR_INP;    /* Err: read error or wrong stream termination */
-                }
-            }
-            d = *dp++; dc--;
-            if (flg) {      /* In flag sequence? */
-                flg = 0;    /* Exit flag sequence */
-                if (d != 0) {
-                    jd->marker = d;    /* Not an escape of 0xFF but a marker */
-                }
-                d = 0xFF;
-            } else {
-                if (d == 0xFF) {        /* Is start of flag sequence? */
-                    flg = 1; continue;  /* Enter flag sequence, get trailing byte */
-                }
-            }
-        }
-        w = w << 8 | d; /* Get 8 bits into the working register */
-        wbit += 8;
+    rc = wreg_fill(jd, nbit);   /* Prepare nbit bits into the working register */
+    if (rc < 0) {
+        return rc;
     }
-    jd->wreg = w; jd->dbit = wbit - nbit;
-    jd->dctr = dc; jd->dptr = dp;
+    wbit = (unsigned int)rc;
+    jd->dbit = wbit - nbit;
 
-    return (int)(w >> ((wbit - nbit) % 32));
+    return (int)(jd->wreg >> ((wbit - nbit) % 32));
 #endif
 }
 
@@ -636,20 +877,21 @@ static JRESULT restart (
 #if JD_FASTDECODE == 0
     uint16_t d = 0;
 
-    /* Get two bytes from the input stream */
-    for (i = 0; i < 2; i++) {
-        if (!dc) {  /* No input data is available, re-fill input buffer */
-            dp = jd->inbuf;
-            dc = jd->infunc(jd, dp, JD_SZBUF);
-            if (!dc) {
-                return JDR_INP;
+    do {    /* Get two bytes from the input stream, skip stuffed 0xFF bytes of padding (some encoders add them) */
+        for (i = 0; i < 2; i++) {
+            if (!dc) {  /* No input data is available, re-fill input buffer */
+                dp = jd->inbuf;
+                dc = jd->infunc(jd, dp, JD_SZBUF);
+                if (!dc) {
+                    return JDR_INP;
+                }
+            } else {
+                dp++;
             }
-        } else {
-            dp++;
+            dc--;
+            d = d << 8 | *dp;   /* Get a byte */
         }
-        dc--;
-        d = d << 8 | *dp;   /* Get a byte */
-    }
+    } while (d == 0xFF00);
     jd->dptr = dp; jd->dctr = dc; jd->dbit = 0;
 
     /* Check the marker */
@@ -688,8 +930,534 @@ static JRESULT restart (
     jd->dbit = 0;           /* Discard stuff bits */
 #endif
 
-    jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;   /* Reset DC offset */
-    return JDR_OK;
+    jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;   /* Reset DC offset */
+    return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Find the next marker in the input stream                              */
+/*-----------------------------------------------------------------------*/
+
+static int find_marker (    /* >0: marker code (second byte), <0: error code */
+    JDEC *jd            /* Pointer to the decompressor object */
+)
+{
+    uint8_t *dp = jd->dptr;
+    size_t dc = jd->dctr;
+    unsigned int d, flg = 0;
+
+
+#if JD_FASTDECODE >= 1
+    if (jd->marker) {   /* The marker has already been detected */
+        d = jd->marker;
+        jd->marker = 0;
+        return (int)d;
+    }
+#endif
+    for (;;) {  /* Search the entropy coded data for a marker */
+        if (!dc) {  /* No input data is available, re-fill input buffer */
+            dp = jd->inbuf;
+            dc = jd->infunc(jd, dp, JD_SZBUF);
+            if (!dc) {
+                return 0 - (int)JDR_INP;
+            }
+#if JD_FASTDECODE == 0
+        } else {
+            dp++;
+#endif
+        }
+#if JD_FASTDECODE == 0
+        d = *dp; dc--;  /* Get a byte, dp points the last read byte */
+#else
+        d = *dp++; dc--;    /* Get a byte, dp points the next byte */
+#endif
+        if (flg) {      /* In flag sequence? */
+            if (d == 0xFF) {
+                continue;   /* Fill byte */
+            }
+            flg = 0;
+            if (d != 0) {
+                break;      /* Not an escape of 0xFF but a marker */
+            }
+        } else if (d == 0xFF) {
+            flg = 1;        /* Enter flag sequence, get trailing byte */
+        }
+    }
+    jd->dptr = dp; jd->dctr = dc;
+
+    return (int)d;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Skip the rest of restart interval and process the restart marker     */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT skip_restart (
+    JDEC *jd,       /* Pointer to the decompressor object */
+    uint16_t rstn   /* Expected restert sequence number */
+)
+{
+    int d;
+
+
+    d = find_marker(jd);    /* Search the entropy coded data for the marker */
+    if (d < 0) {
+        return (JRESULT)(0 - d);
+    }
+
+    /* Check the marker */
+    if ((d & 0xD8) != 0xD0 || (d & 7) != (rstn & 7)) {
+        return JDR_FMT1;    /* Err: expected RSTn marker was not detected (may be corrupted data) */
+    }
+
+    jd->dbit = 0;           /* Discard the bits of skipped data */
+    jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;   /* Reset DC offset */
+    return JDR_OK;
+}
+
+
+
+
+#if JD_PROGRESSIVE
+/*-----------------------------------------------------------------------*/
+/* Get a byte from input stream (segments between the scans)             */
+/*-----------------------------------------------------------------------*/
+
+static int read_byte (  /* >=0: the byte, <0: error code */
+    JDEC *jd            /* Pointer to the decompressor object */
+)
+{
+    if (!jd->dctr) {    /* No input data is available, re-fill input buffer */
+        jd->dptr = jd->inbuf;
+        jd->dctr = jd->infunc(jd, jd->dptr, JD_SZBUF);
+        if (!jd->dctr) {
+            return 0 - (int)JDR_INP;
+        }
+#if JD_FASTDECODE == 0
+    } else {
+        jd->dptr++;
+#endif
+    }
+    jd->dctr--;
+#if JD_FASTDECODE == 0
+    return *jd->dptr;   /* dptr points the last read byte */
+#else
+    return *jd->dptr++; /* dptr points the next byte */
+#endif
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Load the parameters of a scan of progressive JPEG with an SOS segment */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT load_scan (  /* 0:OK, !0:Failed */
+    JDEC *jd,               /* Pointer to the decompressor object */
+    const uint8_t *seg,     /* Pointer to the SOS segment data */
+    size_t len              /* Size of the segment data */
+)
+{
+    unsigned int ns, ss, se, i, c, td;
+
+
+    ns = seg[0];                                /* Number of components in the scan */
+    if (ns < 1 || ns > jd->ncomp || len != 4 + 2 * ns) {
+        return JDR_FMT1;    /* Err: wrong segment */
+    }
+    ss = seg[1 + 2 * ns]; se = seg[2 + 2 * ns]; /* Spectral selection */
+    if (ss ? (ns != 1 || se < ss || se > 63) : se != 0) {
+        return JDR_FMT1;    /* Err: DC and AC elements in a scan or interleaved AC scan */
+    }
+    jd->scan[0] = (uint8_t)ns;
+    jd->scan[4] = (uint8_t)ss; jd->scan[5] = (uint8_t)se;
+    jd->scan[6] = seg[3 + 2 * ns] >> 4;         /* Successive approximation bit position high */
+    jd->scan[7] = seg[3 + 2 * ns] & 15;         /* Successive approximation bit position low */
+    if (jd->scan[7] > 13) {
+        return JDR_FMT1;    /* Err: invalid bit position */
+    }
+
+    for (i = 0; i < ns; i++) {
+        for (c = 0; c < jd->ncomp && jd->compid[c] != seg[1 + 2 * i]; c++) ;  /* Find the component */
+        if (c == jd->ncomp) {
+            return JDR_FMT1;    /* Err: unknown component */
+        }
+        td = 0;
+        if (ss || !jd->scan[6]) {               /* Scans except DC refinement use a huffman table */
+            td = ss ? seg[2 + 2 * i] & 15 : seg[2 + 2 * i] >> 4;
+            if (td > 1) {
+                return JDR_FMT3;    /* Err: supports only table 0 and 1 */
+            }
+            if (!(jd->tbldef & TBL_HUFF(td, ss ? 1 : 0))) {
+                return JDR_FMT1;    /* Err: not loaded */
+            }
+        }
+        if (!(jd->tbldef & TBL_QT(jd->qtid[c]))) {  /* Check dequantizer table for this component */
+            return JDR_FMT1;    /* Err: not loaded */
+        }
+        jd->scan[1 + i] = (uint8_t)(c | td << 4);
+    }
+
+    return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decode a block of a progressive scan into the coefficient buffer      */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT scan_block ( /* 0:OK, !0:Failed */
+    JDEC *jd,           /* Pointer to the decompressor object */
+    int16_t *cp,        /* Coefficients of the block (raster-order) */
+    unsigned int cmp,   /* Component number 0:Y, 1:Cb, 2:Cr */
+    unsigned int id     /* Huffman table ID */
+)
+{
+    unsigned int ss = jd->scan[4], se = jd->scan[5], al = jd->scan[7];
+    unsigned int k, r, s, i;
+    int d, v, p1;
+
+
+    if (!ss) {      /* DC scan */
+        if (!jd->scan[6]) {     /* First scan: DC difference as in baseline JPEG */
+            d = huffext(jd, id, 0);
+            if (d < 0) {
+                return (JRESULT)(0 - d);    /* Err: invalid code or input */
+            }
+            s = (unsigned int)d;
+            if (s) {
+                d = bitext(jd, s);
+                if (d < 0) {
+                    return (JRESULT)(0 - d);    /* Err: input */
+                }
+                s = 1 << (s - 1);
+                if (!(d & s)) {
+                    d -= (s << 1) - 1;    /* Restore negative value if needed */
+                }
+                jd->dcv[cmp] = (int16_t)(jd->dcv[cmp] + d);
+            }
+            cp[0] = (int16_t)(jd->dcv[cmp] * (1 << al));
+        } else {                /* Refinement: next bit of the DC element */
+            d = bitext(jd, 1);
+            if (d < 0) {
+                return (JRESULT)(0 - d);
+            }
+            if (d) {
+                cp[0] |= 1 << al;
+            }
+        }
+        return JDR_OK;
+    }
+
+    if (!jd->scan[6]) {     /* First scan of the AC elements */
+        if (jd->eobrun) {   /* The block is in an EOB run */
+            jd->eobrun--;
+            return JDR_OK;
+        }
+        for (k = ss; k <= se; k++) {
+            d = huffext(jd, id, 1);             /* Extract a huffman coded value (zero runs and bit length) */
+            if (d < 0) {
+                return (JRESULT)(0 - d);
+            }
+            r = (unsigned int)d >> 4; s = d & 15;
+            if (s) {
+                k += r;                         /* Skip leading zero run */
+                if (k > se) {
+                    return JDR_FMT1;    /* Too long zero run */
+                }
+                d = bitext(jd, s);              /* Extract data bits */
+                if (d < 0) {
+                    return (JRESULT)(0 - d);
+                }
+                s = 1 << (s - 1);
+                if (!(d & s)) {
+                    d -= (s << 1) - 1;    /* Restore negative value if needed */
+                }
+                cp[Zig[k]] = (int16_t)(d * (1 << al));
+            } else if (r == 15) {   /* ZRL */
+                k += 15;
+            } else {                /* EOBn: end of this and following 2^r-1 + n blocks */
+                jd->eobrun = (uint16_t)(1 << r);
+                if (r) {
+                    d = bitext(jd, r);
+                    if (d < 0) {
+                        return (JRESULT)(0 - d);
+                    }
+                    jd->eobrun += (uint16_t)d;
+                }
+                jd->eobrun--;
+                break;
+            }
+        }
+        return JDR_OK;
+    }
+
+    /* Refinement of the AC elements: new elements of +-1 and a correction bit for each non-zero element */
+    p1 = 1 << al;
+    k = ss;
+    if (!jd->eobrun) {
+        for ( ; k <= se; k++) {
+            d = huffext(jd, id, 1);
+            if (d < 0) {
+                return (JRESULT)(0 - d);
+            }
+            r = (unsigned int)d >> 4; s = d & 15;
+            v = 0;
+            if (s) {            /* A new element, its sign follows */
+                d = bitext(jd, 1);
+                if (d < 0) {
+                    return (JRESULT)(0 - d);
+                }
+                v = d ? p1 : -p1;
+            } else if (r != 15) {   /* EOBn */
+                jd->eobrun = (uint16_t)(1 << r);
+                if (r) {
+                    d = bitext(jd, r);
+                    if (d < 0) {
+                        return (JRESULT)(0 - d);
+                    }
+                    jd->eobrun += (uint16_t)d;
+                }
+                break;  /* The rest of the block is processed as in EOB run */
+            }
+            for ( ; k <= se; k++) { /* Skip r zero elements, non-zero elements get a correction bit */
+                i = Zig[k];
+                if (cp[i]) {
+                    d = bitext(jd, 1);
+                    if (d < 0) {
+                        return (JRESULT)(0 - d);
+                    }
+                    if (d && !(cp[i] & p1)) {
+                        cp[i] += cp[i] >= 0 ? p1 : -p1;
+                    }
+                } else {
+                    if (!r) {
+                        break;  /* Location of the new element */
+                    }
+                    r--;
+                }
+            }
+            if (v) {
+                if (k > se) {
+                    return JDR_FMT1;    /* Too long zero run */
+                }
+                cp[Zig[k]] = (int16_t)v;
+            }
+        }
+    }
+    if (jd->eobrun) {   /* In EOB run, non-zero elements get a correction bit */
+        for ( ; k <= se; k++) {
+            i = Zig[k];
+            if (cp[i]) {
+                d = bitext(jd, 1);
+                if (d < 0) {
+                    return (JRESULT)(0 - d);
+                }
+                if (d && !(cp[i] & p1)) {
+                    cp[i] += cp[i] >= 0 ? p1 : -p1;
+                }
+            }
+        }
+        jd->eobrun--;
+    }
+
+    return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decode a scan of progressive JPEG into the coefficient buffer         */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT decode_scan (
+    JDEC *jd            /* Pointer to the decompressor object */
+)
+{
+    unsigned int ns, nby, nbpm, mx, my, nmx, bw, nunit, n, i, b, cmp, id, bx, by, rst;
+    uint16_t rsc;
+    int16_t *cp;
+    JRESULT rc;
+
+
+    ns = jd->scan[0];
+    nby = jd->msx * jd->msy;                    /* Number of Y blocks in the MCU */
+    nbpm = nby + (jd->ncomp == 3 ? 2 : 0);      /* Number of blocks in the MCU */
+    mx = jd->msx * 8; my = jd->msy * 8;         /* Size of the MCU (pixel) */
+    nmx = (jd->width + mx - 1) / mx;            /* Number of MCUs in a row */
+    nunit = nmx * ((jd->height + my - 1) / my); /* Number of MCUs in the image */
+    bw = nmx;
+    if (ns == 1 && !(jd->scan[1] & 15)) {       /* Y component in a non-interleaved scan: blocks in raster-order of the component */
+        bw = (jd->width + 7) / 8;
+        nunit = bw * ((jd->height + 7) / 8);
+    }
+
+    jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;   /* Initialize DC values */
+    jd->eobrun = 0;
+    rst = 0; rsc = 0;
+    for (n = 0; n < nunit; n++) {
+        if (jd->nrst && rst++ == jd->nrst) {    /* Process restart interval if enabled */
+            rc = restart(jd, rsc++);
+            if (rc != JDR_OK) {
+                return rc;
+            }
+            jd->eobrun = 0;
+            rst = 1;
+        }
+        for (i = 0; i < ns; i++) {
+            cmp = jd->scan[1 + i] & 15; id = jd->scan[1 + i] >> 4;
+            if (ns > 1) {           /* Interleaved scan: all blocks of the component in the MCU */
+                cp = jd->coef + ((size_t)n * nbpm + (cmp ? nby + cmp - 1 : 0)) * 64;
+                b = cmp ? 1 : nby;
+            } else if (cmp) {       /* C component: a block is an MCU */
+                cp = jd->coef + ((size_t)n * nbpm + nby + cmp - 1) * 64;
+                b = 1;
+            } else {                /* Y component: find the block in the MCU */
+                bx = n % bw; by = n / bw;
+                cp = jd->coef + ((size_t)((by / jd->msy) * nmx + bx / jd->msx) * nbpm + (by % jd->msy) * jd->msx + bx % jd->msx) * 64;
+                b = 1;
+            }
+            for ( ; b; b--, cp += 64) {
+                rc = scan_block(jd, cp, cmp, id);
+                if (rc != JDR_OK) {
+                    return rc;
+                }
+            }
+        }
+    }
+
+    return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Process the segments up to the next scan of progressive JPEG          */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT next_scan (  /* 0:OK (jd->scan[0] is 0 at the end of image), !0:Failed */
+    JDEC *jd            /* Pointer to the decompressor object */
+)
+{
+    uint8_t *seg = (uint8_t *)jd->workbuf;  /* The working buffer is not used while decoding the scans */
+    size_t len, i;
+    int m, d;
+    JRESULT rc;
+
+
+    jd->scan[0] = 0;
+    for (;;) {
+        m = find_marker(jd);    /* Skip padding of the previous scan and get the next marker */
+        if (m < 0) {
+            return (JRESULT)(0 - m);
+        }
+        if (m == 0xD9) {
+            return JDR_OK;  /* EOI: no more scans */
+        }
+        if ((m & 0xF8) == 0xD0) {
+            continue;       /* Ignore a stray RSTn */
+        }
+
+        len = 0;
+        for (i = 0; i < 2; i++) {   /* Get the length field */
+            d = read_byte(jd);
+            if (d < 0) {
+                return (JRESULT)(0 - d);
+            }
+            len = len << 8 | (unsigned int)d;
+        }
+        if (len < 2) {
+            return JDR_FMT1;
+        }
+        len -= 2;           /* Segment content size */
+        if (len > JD_SZBUF && (m == 0xC4 || m == 0xDB || m == 0xDD || m == 0xDA)) {
+            return JDR_MEM2;
+        }
+        for (i = 0; i < len; i++) { /* Load segment data (other segments are skipped) */
+            d = read_byte(jd);
+            if (d < 0) {
+                return (JRESULT)(0 - d);
+            }
+            if (i < JD_SZBUF) {
+                seg[i] = (uint8_t)d;
+            }
+        }
+
+        switch (m) {
+        case 0xC4:  /* DHT - Define Huffman Tables */
+            rc = create_huffman_tbl(jd, seg, len);
+            break;
+
+        case 0xDB:  /* DQT - Define Quaitizer Tables */
+            rc = create_qt_tbl(jd, seg, len);
+            break;
+
+        case 0xDD:  /* DRI - Define Restart Interval */
+            if (len < 2) {
+                return JDR_FMT1;
+            }
+            jd->nrst = (uint16_t)(seg[0] << 8 | seg[1]);
+            rc = JDR_OK;
+            break;
+
+        case 0xDA:  /* SOS - Start of Scan */
+            rc = load_scan(jd, seg, len);
+            if (rc == JDR_OK) {
+                jd->dbit = 0;   /* Start of the entropy coded data */
+                return JDR_OK;
+            }
+            break;
+
+        default:    /* Unknown segment (comment, exif or etc..) */
+            rc = JDR_OK;
+        }
+        if (rc != JDR_OK) {
+            return rc;
+        }
+    }
+}
+#endif
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Check if an MCU is to be output into a rectangular                    */
+/*-----------------------------------------------------------------------*/
+
+static int mcu_in_rect (    /* 1:MCU has pixels in the rectangular, 0:Not */
+    JDEC *jd,           /* Pointer to the decompressor object */
+    unsigned int x,     /* MCU location in the image */
+    unsigned int y,     /* MCU location in the image */
+    const JRECT *rect   /* Rectangular in the output (scaled) image */
+)
+{
+    unsigned int mx, my, rx, ry;
+
+
+    mx = jd->msx * 8; my = jd->msy * 8;                 /* MCU size (pixel) */
+    rx = (x + mx <= jd->width) ? mx : jd->width - x;    /* Output rectangular size, the same as in mcu_output() */
+    ry = (y + my <= jd->height) ? my : jd->height - y;
+    if (JD_USE_SCALE) {
+        rx >>= jd->scale; ry >>= jd->scale;
+        x >>= jd->scale; y >>= jd->scale;
+    }
+    if (!rx || !ry) {
+        return 0;   /* The MCU is not output */
+    }
+
+    return x <= rect->right && x + rx - 1 >= rect->left && y <= rect->bottom && y + ry - 1 >= rect->top;
 }
 
 
@@ -701,7 +1469,8 @@ static JRESULT restart (
 
 static void block_idct (
     int32_t *src,   /* Input block data (de-quantized and pre-scaled for Arai Algorithm) */
-    jd_yuv_t *dst   /* Pointer to the destination to store the block as byte array */
+    jd_yuv_t *dst,  /* Pointer to the destination to store the block as byte array */
+    unsigned int nz /* b7..b0: column has AC elements in rows 1-7, b8: columns 1-7 have elements (JD_FASTDECODE == 3) */
 )
 {
     const int32_t M13 = (int32_t)(1.41421 * 4096), M2 = (int32_t)(1.08239 * 4096), M4 = (int32_t)(2.61313 * 4096), M5 = (int32_t)(1.84776 * 4096);
@@ -709,8 +1478,17 @@ static void block_idct (
     int32_t t10, t11, t12, t13;
     int i;
 
+    (void)nz;
+
     /* Process columns */
     for (i = 0; i < 8; i++) {
+#if JD_FASTDECODE == 3
+        if (!(nz & 1 << i)) {   /* Only the top element: the column is filled with it */
+            src[8 * 7] = src[8 * 6] = src[8 * 5] = src[8 * 4] = src[8 * 3] = src[8 * 2] = src[8 * 1] = src[8 * 0];
+            src++;
+            continue;
+        }
+#endif
         v0 = src[8 * 0];    /* Get even elements */
         v1 = src[8 * 2];
         v2 = src[8 * 4];
@@ -758,6 +1536,14 @@ static void block_idct (
     /* Process rows */
     src -= 8;
     for (i = 0; i < 8; i++) {
+#if JD_FASTDECODE == 3
+        if (!(nz & 0x100)) {    /* Only the first element in each row: the row is filled with it */
+            v0 = (src[0] + (128L << 8)) >> 8;
+            dst[0] = dst[1] = dst[2] = dst[3] = dst[4] = dst[5] = dst[6] = dst[7] = (int16_t)v0;
+            dst += 8; src += 8;
+            continue;
+        }
+#endif
         v0 = src[0] + (128L << 8);  /* Get even elements (remove DC offset (-128) here) */
         v1 = src[2];
         v2 = src[4];
@@ -818,17 +1604,49 @@ static void block_idct (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Store a de-quantized block into the MCU working buffer                */
+/*-----------------------------------------------------------------------*/
+
+static void block_store (
+    JDEC *jd,       /* Pointer to the decompressor object */
+    int32_t *tmp,   /* De-quantized block (it is also used as working buffer of IDCT) */
+    jd_yuv_t *bp,   /* Pointer to the block in the MCU working buffer */
+    int ac,         /* 0: The block has no AC element */
+    unsigned int nz /* Location of non-zero AC elements (see block_idct()) */
+)
+{
+    unsigned int i;
+    int d;
+
+
+    if (!ac || (JD_USE_SCALE && jd->scale == 3)) {  /* If no AC element or scale ratio is 1/8, IDCT can be omitted and the block is filled with DC value */
+        d = (jd_yuv_t)((*tmp / 256) + 128);
+        if (JD_FASTDECODE >= 1) {
+            for (i = 0; i < 64; bp[i++] = d) ;
+        } else {
+            memset(bp, d, 64);
+        }
+    } else {
+        block_idct(tmp, bp, nz);    /* Apply IDCT and store the block to the MCU buffer */
+    }
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Load all blocks in an MCU into working buffer                         */
 /*-----------------------------------------------------------------------*/
 
 static JRESULT mcu_load (
-    JDEC *jd        /* Pointer to the decompressor object */
+    JDEC *jd,       /* Pointer to the decompressor object */
+    int idct        /* 0: Only decode the entropy coded data (MCU is not output) */
 )
 {
     int32_t *tmp = (int32_t *)jd->workbuf;  /* Block working buffer for de-quantize and IDCT */
     int d, e;
-    unsigned int blk, nby, i, bc, z, id, cmp;
+    unsigned int blk, nby, i, bc, z, id, cmp, nz;
     jd_yuv_t *bp;
     const int32_t *dqf;
 
@@ -870,7 +1688,32 @@ static JRESULT mcu_load (
             /* Extract following 63 AC elements from input stream */
             memset(&tmp[1], 0, 63 * sizeof (int32_t));  /* Initialize all AC elements */
             z = 1;      /* Top of the AC elements (in zigzag-order) */
+            nz = 0;     /* Location of non-zero AC elements for IDCT */
             do {
+#if JD_FASTDECODE == 3
+                e = wreg_fill(jd, 16);              /* Table decode of the code and data bits */
+                if (e < 0) {
+                    return (JRESULT)(0 - e);    /* Err: input */
+                }
+                e = jd->hufflut_fac[id][(jd->wreg >> (e - HUFF_BIT)) & HUFF_MASK];
+                if (e) {                            /* It is done if hit in the table */
+                    jd->dbit -= e & 0x0F;           /* Snip the code and data bits */
+                    z += (e >> 4) & 0x0F;           /* Skip leading zero run */
+                    if (z >= 64) {
+                        return JDR_FMT1;    /* Too long zero run */
+                    }
+                    if (!(e >> 8)) {                /* No value: EOB or ZRL */
+                        if (!(e & 0xF0)) {
+                            break;    /* EOB */
+                        }
+                        continue;
+                    }
+                    i = Zig[z];                     /* Get raster-order index */
+                    tmp[i] = (e >> 8) * dqf[i] >> 8;    /* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+                    nz |= (i >= 8 ? 1U << (i & 7) : 0) | ((i & 7) ? 0x100U : 0);
+                    continue;
+                }
+#endif
                 d = huffext(jd, id, 1);             /* Extract a huffman coded value (zero runs and bit length) */
                 if (d == 0) {
                     break;    /* EOB? */
@@ -894,34 +1737,83 @@ static JRESULT mcu_load (
                     }
                     i = Zig[z];                     /* Get raster-order index */
                     tmp[i] = d * dqf[i] >> 8;       /* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+#if JD_FASTDECODE == 3
+                    nz |= (i >= 8 ? 1U << (i & 7) : 0) | ((i & 7) ? 0x100U : 0);
+#endif
                 }
             } while (++z < 64);     /* Next AC element */
 
+            if (idct && (JD_FORMAT != 2 || !cmp)) {   /* C components may not be processed if in grayscale output */
+                block_store(jd, tmp, bp, z != 1, nz);
+            }
+        }
+
+        bp += 64;               /* Next block */
+    }
+
+    return JDR_OK;  /* All blocks have been loaded successfully */
+}
+
+
+
+
+#if JD_PROGRESSIVE
+/*-----------------------------------------------------------------------*/
+/* Load all blocks in an MCU from the coefficient buffer                 */
+/*-----------------------------------------------------------------------*/
+
+static void mcu_load_coef (
+    JDEC *jd,           /* Pointer to the decompressor object */
+    unsigned int mcu    /* MCU number in the image */
+)
+{
+    int32_t *tmp = (int32_t *)jd->workbuf;  /* Block working buffer for de-quantize and IDCT */
+    int d, ac;
+    unsigned int blk, nby, i, cmp, nz;
+    const int16_t *cp;
+    jd_yuv_t *bp;
+    const int32_t *dqf;
+
+
+    nby = jd->msx * jd->msy;    /* Number of Y blocks (1, 2 or 4) */
+    bp = jd->mcubuf;            /* Pointer to the first block of MCU */
+    cp = jd->coef + (size_t)mcu * (nby + (jd->ncomp == 3 ? 2 : 0)) * 64;    /* Coefficients of the MCU */
+
+    for (blk = 0; blk < nby + 2; blk++) {   /* Get nby Y blocks and two C blocks */
+        cmp = (blk < nby) ? 0 : blk - nby + 1;  /* Component number 0:Y, 1:Cb, 2:Cr */
+
+        if (cmp && jd->ncomp != 3) {        /* Clear C blocks if not exist (monochrome image) */
+            for (i = 0; i < 64; bp[i++] = 128) ;
+
+        } else {
             if (JD_FORMAT != 2 || !cmp) {   /* C components may not be processed if in grayscale output */
-                if (z == 1 || (JD_USE_SCALE && jd->scale == 3)) {   /* If no AC element or scale ratio is 1/8, IDCT can be omitted and the block is filled with DC value */
-                    d = (jd_yuv_t)((*tmp / 256) + 128);
-                    if (JD_FASTDECODE >= 1) {
-                        for (i = 0; i < 64; bp[i++] = d) ;
-                    } else {
-                        memset(bp, d, 64);
+                dqf = jd->qttbl[jd->qtid[cmp]];
+                tmp[0] = cp[0] * dqf[0] >> 8;       /* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+                ac = 0; nz = 0;
+                for (i = 1; i < 64; i++) {          /* AC elements (in raster-order) */
+                    d = cp[i];
+                    tmp[i] = d * dqf[i] >> 8;
+                    if (d) {
+                        ac = 1;
+                        nz |= (i >= 8 ? 1U << (i & 7) : 0) | ((i & 7) ? 0x100U : 0);
                     }
-                } else {
-                    block_idct(tmp, bp);    /* Apply IDCT and store the block to the MCU buffer */
                 }
+                block_store(jd, tmp, bp, ac, nz);
             }
+            cp += 64;
         }
 
         bp += 64;               /* Next block */
     }
-
-    return JDR_OK;  /* All blocks have been loaded successfully */
 }
+#endif
 
 
 
 
 /*-----------------------------------------------------------------------*/
 /* Output an MCU: Convert YCrCb to RGB and output it in RGB form         */
+/* (or in Y/Cb/Cr form, 3 bytes per pixel, if jd->ycc is set)            */
 /*-----------------------------------------------------------------------*/
 
 static JRESULT mcu_output (
@@ -983,6 +1875,12 @@ static JRESULT mcu_output (
                         pc++;                       /* Step forward chroma pointer every pixel */
                     }
                     yy = *py++;         /* Get Y component */
+                    if (jd->ycc) {      /* Y/Cb/Cr output */
+                        *pix++ = BYTECLIP(yy);
+                        *pix++ = BYTECLIP(cb + 128);
+                        *pix++ = BYTECLIP(cr + 128);
+                        continue;
+                    }
                     *pix++ = /*R*/ BYTECLIP(yy + ((int)(1.402 * CVACC) * cr) / CVACC);
                     *pix++ = /*G*/ BYTECLIP(yy - ((int)(0.344 * CVACC) * cb + (int)(0.714 * CVACC) * cr) / CVACC);
                     *pix++ = /*B*/ BYTECLIP(yy + ((int)(1.772 * CVACC) * cb) / CVACC);
@@ -1055,7 +1953,11 @@ static JRESULT mcu_output (
             for (ix = 0; ix < mx; ix += 8) {
                 yy = *py;   /* Get Y component */
                 py += 64;
-                if (JD_FORMAT != 2) {
+                if (JD_FORMAT != 2 && jd->ycc) {
+                    *pix++ = BYTECLIP(yy);
+                    *pix++ = BYTECLIP(cb + 128);
+                    *pix++ = BYTECLIP(cr + 128);
+                } else if (JD_FORMAT != 2) {
                     *pix++ = /*R*/ BYTECLIP(yy + ((int)(1.402 * CVACC) * cr / CVACC));
                     *pix++ = /*G*/ BYTECLIP(yy - ((int)(0.344 * CVACC) * cb + (int)(0.714 * CVACC) * cr) / CVACC);
                     *pix++ = /*B*/ BYTECLIP(yy + ((int)(1.772 * CVACC) * cb / CVACC));
@@ -1086,7 +1988,7 @@ static JRESULT mcu_output (
     }
 
     /* Convert RGB888 to RGB565 if needed */
-    if (JD_FORMAT == 1) {
+    if (JD_FORMAT == 1 && !jd->ycc) {
         uint8_t *s = (uint8_t *)jd->workbuf;
         uint16_t w, *d = (uint16_t *)s;
         unsigned int n = rx * ry;
@@ -1113,12 +2015,8 @@ static JRESULT mcu_output (
 #define LDB_WORD(ptr)       (uint16_t)(((uint16_t)*((uint8_t*)(ptr))<<8)|(uint16_t)*(uint8_t*)((ptr)+1))
 
 
-JRESULT jd_prepare (
-    JDEC *jd,               /* Blank decompressor object */
-    size_t (*infunc)(JDEC *, uint8_t *, size_t), /* JPEG stream input function */
-    void *pool,             /* Working buffer for the decompression session */
-    size_t sz_pool,         /* Size of working buffer */
-    void *dev               /* I/O device identifier for the session */
+static JRESULT parse_headers (
+    JDEC *jd                /* Cleared decompressor object with the work memory and the input function */
 )
 {
     uint8_t *seg, b;
@@ -1128,12 +2026,6 @@ JRESULT jd_prepare (
     JRESULT rc;
 
 
-    memset(jd, 0, sizeof (JDEC));   /* Clear decompression object (this might be a problem if machine's null pointer is not all bits zero) */
-    jd->pool = pool;        /* Work memory */
-    jd->sz_pool = sz_pool;  /* Size of given work memory */
-    jd->infunc = infunc;    /* Stream input function */
-    jd->device = dev;       /* I/O device identifier */
-
     jd->inbuf = seg = alloc_pool(jd, JD_SZBUF);     /* Allocate stream input buffer */
     if (!seg) {
         return JDR_MEM1;
@@ -1181,6 +2073,11 @@ JRESULT jd_prepare (
         ofs += 4 + len;     /* Number of bytes loaded */
 
         switch (marker & 0xFF) {
+#if JD_PROGRESSIVE
+        case 0xC2:  /* SOF2 (progressive JPEG) */
+            jd->progressive = 1;
+#endif
+        /* fall through */
         case 0xC0:  /* SOF0 (baseline JPEG) */
             if (len > JD_SZBUF) {
                 return JDR_MEM2;
@@ -1213,6 +2110,9 @@ JRESULT jd_prepare (
                 if (jd->qtid[i] > 3) {
                     return JDR_FMT3;    /* Err: Invalid ID */
                 }
+#if JD_PROGRESSIVE
+                jd->compid[i] = seg[6 + 3 * i];             /* Get component identifier, scans refer to it */
+#endif
             }
             break;
 
@@ -1266,26 +2166,39 @@ JRESULT jd_prepare (
             if (!jd->width || !jd->height) {
                 return JDR_FMT1;    /* Err: Invalid image size */
             }
-            if (seg[0] != jd->ncomp) {
-                return JDR_FMT3;    /* Err: Wrong color components */
-            }
-
-            /* Check if all tables corresponding to each components have been loaded */
-            for (i = 0; i < jd->ncomp; i++) {
-                b = seg[2 + 2 * i]; /* Get huffman table ID */
-                if (b != 0x00 && b != 0x11) {
-                    return JDR_FMT3;    /* Err: Different table number for DC/AC element */
+#if JD_PROGRESSIVE
+            if (jd->progressive) {  /* The first scan of progressive JPEG (it may have a part of the components) */
+                rc = load_scan(jd, seg, len);
+                if (rc != JDR_OK) {
+                    return rc;
+                }
+            } else
+#endif
+            {
+                if (seg[0] != jd->ncomp) {
+                    return JDR_FMT3;    /* Err: Wrong color components */
                 }
-                n = i ? 1 : 0;                          /* Component class */
-                if (!jd->huffbits[n][0] || !jd->huffbits[n][1]) {   /* Check huffman table for this component */
+
+                /* Check if all tables corresponding to each components have been loaded */
+                for (i = 0; i < jd->ncomp; i++) {
+                    b = seg[2 + 2 * i]; /* Get huffman table ID */
+                    if (b != 0x00 && b != 0x11) {
+                        return JDR_FMT3;    /* Err: Different table number for DC/AC element */
+                    }
+                    n = i ? 1 : 0;                          /* Component class */
+                    if (!(jd->tbldef & TBL_HUFF(n, 0)) || !(jd->tbldef & TBL_HUFF(n, 1))) {   /* Check huffman table for this component */
 #if JD_DEFAULT_HUFFMAN
-                    jd_load_default_huffman(jd); // Always returns OK
+                        rc = jd_load_default_huffman(jd);
+                        if (rc != JDR_OK) {
+                            return rc;      /* Err: not enough memory for the tables */
+                        }
 #else
-                    return JDR_FMT1;                    /* Err: Nnot loaded */
+                        return JDR_FMT1;                    /* Err: Nnot loaded */
 #endif
-                }
-                if (!jd->qttbl[jd->qtid[i]]) {          /* Check dequantizer table for this component */
-                    return JDR_FMT1;                    /* Err: Not loaded */
+                    }
+                    if (!(jd->tbldef & TBL_QT(jd->qtid[i]))) {  /* Check dequantizer table for this component */
+                        return JDR_FMT1;                    /* Err: Not loaded */
+                    }
                 }
             }
 
@@ -1298,6 +2211,16 @@ JRESULT jd_prepare (
             if (len < 256) {
                 len = 256;    /* but at least 256 byte is required for IDCT */
             }
+#if JD_PROGRESSIVE
+            if (jd->progressive) {
+                if (len < JD_SZBUF) {
+                    len = JD_SZBUF;     /* The segments between scans are loaded into it */
+                }
+                /* Coefficient buffer of all blocks in the image, in the order of blocks in the MCUs */
+                jd->sz_coef = (size_t)((jd->width + jd->msx * 8 - 1) / (jd->msx * 8)) * ((jd->height + jd->msy * 8 - 1) / (jd->msy * 8))
+                              * (n + (jd->ncomp == 3 ? 2 : 0)) * 64 * sizeof (int16_t);
+            }
+#endif
             jd->workbuf = alloc_pool(jd, len);          /* and it may occupy a part of following MCU working buffer for RGB output */
             if (!jd->workbuf) {
                 return JDR_MEM1;    /* Err: not enough memory */
@@ -1316,7 +2239,9 @@ JRESULT jd_prepare (
             return JDR_OK;      /* Initialization succeeded. Ready to decompress the JPEG image. */
 
         case 0xC1:  /* SOF1 */
+#if !JD_PROGRESSIVE
         case 0xC2:  /* SOF2 */
+#endif
         case 0xC3:  /* SOF3 */
         case 0xC5:  /* SOF5 */
         case 0xC6:  /* SOF6 */
@@ -1341,46 +2266,147 @@ JRESULT jd_prepare (
 
 
 
+JRESULT jd_prepare (
+    JDEC *jd,               /* Blank decompressor object */
+    size_t (*infunc)(JDEC *, uint8_t *, size_t), /* JPEG stream input function */
+    void *pool,             /* Working buffer for the decompression session */
+    size_t sz_pool,         /* Size of working buffer */
+    void *dev               /* I/O device identifier for the session */
+)
+{
+    memset(jd, 0, sizeof (JDEC));   /* Clear decompression object (this might be a problem if machine's null pointer is not all bits zero) */
+    jd->pool = pool;        /* Work memory */
+    jd->sz_pool = sz_pool;  /* Size of given work memory */
+    jd->infunc = infunc;    /* Stream input function */
+    jd->device = dev;       /* I/O device identifier */
+
+    return parse_headers(jd);
+}
+
+
+
 
 /*-----------------------------------------------------------------------*/
-/* Start to decompress the JPEG picture                                  */
+/* Analyze the JPEG image with the tables kept from the previous image   */
+/*-----------------------------------------------------------------------*/
+/* The tables are kept at the start of the working buffer. A table defined
+/  with the same data as in the previous image (e.g. every frame of MJPEG)
+/  is not created again. The decompressor object must be zeroed before the
+/  first call and the same working buffer must be given for the tables to
+/  be kept. */
+
+JRESULT jd_prepare_cached (
+    JDEC *jd,               /* Decompressor object of the previous image or zeroed */
+    size_t (*infunc)(JDEC *, uint8_t *, size_t), /* JPEG stream input function */
+    void *pool,             /* Working buffer for the decompression session */
+    size_t sz_pool,         /* Size of working buffer */
+    void *dev               /* I/O device identifier for the session */
+)
+{
+    JDEC prev;
+    JRESULT rc;
+
+
+    if (jd->tblpool != pool || jd->sz_tblpool != sz_pool) {    /* First image or another working buffer */
+        memset(jd, 0, sizeof (JDEC));
+        jd->pool = pool;
+        jd->sz_pool = sz_pool;
+        rc = alloc_tables(jd);      /* All tables at their max size, so the following memory is free for each image */
+        if (rc != JDR_OK) {
+            return rc;
+        }
+        jd->tblpool = pool;
+        jd->sz_tblpool = sz_pool;
+        jd->sz_tbl = sz_pool - jd->sz_pool;
+    }
+
+    prev = *jd;
+    memset(jd, 0, sizeof (JDEC));   /* Clear the state of the previous image, but keep its tables */
+    memcpy(jd->huffbits, prev.huffbits, sizeof jd->huffbits);
+    memcpy(jd->huffcode, prev.huffcode, sizeof jd->huffcode);
+    memcpy(jd->huffdata, prev.huffdata, sizeof jd->huffdata);
+    memcpy(jd->qttbl, prev.qttbl, sizeof jd->qttbl);
+    memcpy(jd->huffcap, prev.huffcap, sizeof jd->huffcap);
+    memcpy(jd->tblhash, prev.tblhash, sizeof jd->tblhash);
+    memcpy(jd->qtdef, prev.qtdef, sizeof jd->qtdef);
+#if JD_FASTDECODE >= 2
+    memcpy(jd->longofs, prev.longofs, sizeof jd->longofs);
+    memcpy(jd->hufflut_ac, prev.hufflut_ac, sizeof jd->hufflut_ac);
+    memcpy(jd->hufflut_dc, prev.hufflut_dc, sizeof jd->hufflut_dc);
+#if JD_FASTDECODE == 3
+    memcpy(jd->hufflut_fac, prev.hufflut_fac, sizeof jd->hufflut_fac);
+#endif
+#endif
+    jd->tblpool = pool;
+    jd->sz_tblpool = sz_pool;
+    jd->sz_tbl = prev.sz_tbl;
+    jd->pool = (uint8_t *)pool + prev.sz_tbl;  /* Work memory following the tables */
+    jd->sz_pool = sz_pool - prev.sz_tbl;
+    jd->infunc = infunc;
+    jd->device = dev;
+
+    return parse_headers(jd);
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decompress MCUs from the start of a restart interval                  */
 /*-----------------------------------------------------------------------*/
 
-JRESULT jd_decomp (
+static JRESULT decomp_mcus (
     JDEC *jd,                               /* Initialized decompression object */
     int (*outfunc)(JDEC *, void *, JRECT *), /* RGB output function */
-    uint8_t scale                           /* Output de-scaling factor (0 to 3) */
+    const JRECT *rect,                      /* Region in the output (scaled) image, NULL: whole image */
+    unsigned int n,                         /* First MCU (start of the image or of a restart interval) */
+    unsigned int nend                       /* End of MCUs to decompress */
 )
 {
-    unsigned int x, y, mx, my;
+    unsigned int x, y, mx, my, i, nmx, nmcu;
     uint16_t rst, rsc;
+    int skip, out;
     JRESULT rc;
 
 
-    if (scale > (JD_USE_SCALE ? 3 : 0)) {
-        return JDR_PAR;
-    }
-    jd->scale = scale;
-
     mx = jd->msx * 8; my = jd->msy * 8;         /* Size of the MCU (pixel) */
+    nmx = (jd->width + mx - 1) / mx;            /* Number of MCUs in a row */
+    nmcu = nmx * ((jd->height + my - 1) / my);  /* Number of MCUs in the image */
 
     jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;   /* Initialize DC values */
-    rst = rsc = 0;
+    rst = 0;
+    rsc = jd->nrst ? (uint16_t)(n / jd->nrst) : 0;  /* Sequence number of the next restart marker */
+    skip = 0;
 
     rc = JDR_OK;
-    for (y = 0; y < jd->height; y += my) {      /* Vertical loop of MCUs */
-        for (x = 0; x < jd->width; x += mx) {   /* Horizontal loop of MCUs */
-            if (jd->nrst && rst++ == jd->nrst) {    /* Process restart interval if enabled */
-                rc = restart(jd, rsc++);
-                if (rc != JDR_OK) {
-                    return rc;
-                }
-                rst = 1;
-            }
-            rc = mcu_load(jd);                  /* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
+    for ( ; n < nend; n++) {
+        x = (n % nmx) * mx; y = (n / nmx) * my; /* MCU location in the image */
+        if (rect && (JD_USE_SCALE ? y >> jd->scale : y) > rect->bottom) {
+            break;  /* Rest of the image is below the region */
+        }
+        if (jd->nrst && rst++ == jd->nrst) {    /* Process restart interval if enabled */
+            rc = skip ? skip_restart(jd, rsc++) : restart(jd, rsc++);
             if (rc != JDR_OK) {
                 return rc;
             }
+            rst = 1;
+        }
+        if (rect && jd->nrst && rst == 1) { /* Start of a restart interval? */
+            /* The whole interval can be skipped if no MCU is in the region and it is followed by a restart marker */
+            skip = n + jd->nrst < nmcu;
+            for (i = n; skip && i < n + jd->nrst; i++) {
+                skip = !mcu_in_rect(jd, (i % nmx) * mx, (i / nmx) * my, rect);
+            }
+        }
+        if (skip) {
+            continue;
+        }
+        out = !rect || mcu_in_rect(jd, x, y, rect);
+        rc = mcu_load(jd, out);                 /* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
+        if (rc != JDR_OK) {
+            return rc;
+        }
+        if (out) {
             rc = mcu_output(jd, outfunc, x, y); /* Output the MCU (YCbCr to RGB, scaling and output) */
             if (rc != JDR_OK) {
                 return rc;
@@ -1390,3 +2416,154 @@ JRESULT jd_decomp (
 
     return rc;
 }
+
+
+
+
+#if JD_PROGRESSIVE
+/*-----------------------------------------------------------------------*/
+/* Decompress all scans of progressive JPEG and output the MCUs          */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT decomp_progressive (
+    JDEC *jd,                               /* Initialized decompression object */
+    int (*outfunc)(JDEC *, void *, JRECT *), /* RGB output function */
+    const JRECT *rect                       /* Region in the output (scaled) image, NULL: whole image */
+)
+{
+    unsigned int x, y, mx, my, n, nmx, nmcu;
+    JRESULT rc;
+
+
+    if (!jd->coef) {
+        return JDR_PAR;     /* Err: no coefficient buffer */
+    }
+    memset(jd->coef, 0, jd->sz_coef);
+    while (jd->scan[0]) {   /* Decode all scans into the coefficient buffer */
+        rc = decode_scan(jd);
+        if (rc == JDR_OK) {
+            rc = next_scan(jd);
+        }
+        if (rc != JDR_OK) {
+            return rc;
+        }
+    }
+    for (n = 0; n < jd->ncomp; n++) {
+        if (!(jd->tbldef & TBL_QT(jd->qtid[n]))) {
+            return JDR_FMT1;    /* Err: no scan loaded the dequantizer table of this component */
+        }
+    }
+
+    mx = jd->msx * 8; my = jd->msy * 8;         /* Size of the MCU (pixel) */
+    nmx = (jd->width + mx - 1) / mx;            /* Number of MCUs in a row */
+    nmcu = nmx * ((jd->height + my - 1) / my);  /* Number of MCUs in the image */
+    for (n = 0; n < nmcu; n++) {
+        x = (n % nmx) * mx; y = (n / nmx) * my; /* MCU location in the image */
+        if (rect) {
+            if ((JD_USE_SCALE ? y >> jd->scale : y) > rect->bottom) {
+                break;  /* Rest of the image is below the region */
+            }
+            if (!mcu_in_rect(jd, x, y, rect)) {
+                continue;
+            }
+        }
+        mcu_load_coef(jd, n);                   /* Load an MCU (dequantize and apply IDCT) */
+        rc = mcu_output(jd, outfunc, x, y);     /* Output the MCU (YCbCr to RGB, scaling and output) */
+        if (rc != JDR_OK) {
+            return rc;
+        }
+    }
+
+    return JDR_OK;
+}
+#endif
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Start to decompress the JPEG picture                                  */
+/*-----------------------------------------------------------------------*/
+
+JRESULT jd_decomp (
+    JDEC *jd,                               /* Initialized decompression object */
+    int (*outfunc)(JDEC *, void *, JRECT *), /* RGB output function */
+    uint8_t scale                           /* Output de-scaling factor (0 to 3) */
+)
+{
+    return jd_decomp_rect(jd, outfunc, scale, 0);
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Start to decompress a region of the JPEG picture                      */
+/*-----------------------------------------------------------------------*/
+
+JRESULT jd_decomp_rect (
+    JDEC *jd,                               /* Initialized decompression object */
+    int (*outfunc)(JDEC *, void *, JRECT *), /* RGB output function */
+    uint8_t scale,                          /* Output de-scaling factor (0 to 3) */
+    const JRECT *rect                       /* Region in the output (scaled) image, NULL: whole image */
+)
+{
+    unsigned int mx, my;
+
+
+    if (scale > (JD_USE_SCALE ? 3 : 0)) {
+        return JDR_PAR;
+    }
+    jd->scale = scale;
+#if JD_PROGRESSIVE
+    if (jd->progressive) {
+        return decomp_progressive(jd, outfunc, rect);
+    }
+#endif
+
+    mx = jd->msx * 8; my = jd->msy * 8;         /* Size of the MCU (pixel) */
+    return decomp_mcus(jd, outfunc, rect, 0, ((jd->width + mx - 1) / mx) * ((jd->height + my - 1) / my));
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Decompress a range of restart intervals                               */
+/*-----------------------------------------------------------------------*/
+
+JRESULT jd_decomp_part (
+    JDEC *jd,                               /* Initialized decompression object */
+    int (*outfunc)(JDEC *, void *, JRECT *), /* RGB output function */
+    uint8_t scale,                          /* Output de-scaling factor (0 to 3) */
+    const JRECT *rect,                      /* Region in the output (scaled) image, NULL: whole image */
+    unsigned int first,                     /* First restart interval to decompress */
+    unsigned int count                      /* Number of restart intervals to decompress */
+)
+{
+    unsigned int mx, my, nmcu;
+
+
+    if (scale > (JD_USE_SCALE ? 3 : 0) || !jd->nrst) {
+        return JDR_PAR;
+    }
+#if JD_PROGRESSIVE
+    if (jd->progressive) {
+        return JDR_PAR;     /* All scans must be decoded before an MCU can be output */
+    }
+#endif
+    jd->scale = scale;
+
+    /* Discard the buffered input. The next data from the input function must be the entropy coded data of the first interval. */
+    jd->dctr = 0; jd->dbit = 0;
+#if JD_FASTDECODE >= 1
+    jd->wreg = 0; jd->marker = 0;
+#endif
+
+    mx = jd->msx * 8; my = jd->msy * 8;         /* Size of the MCU (pixel) */
+    nmcu = ((jd->width + mx - 1) / mx) * ((jd->height + my - 1) / my);
+    if ((first + count) * jd->nrst < nmcu) {
+        nmcu = (first + count) * jd->nrst;      /* Stop before the restart marker following the last interval */
+    }
+    return decomp_mcus(jd, outfunc, rect, first * jd->nrst, nmcu);
+}
@@ -71,15 +71,34 @@ struct JDEC {
     uint16_t *huffcode[2][2];   /* Huffman code word tables [id][dcac] */
     uint8_t *huffdata[2][2];    /* Huffman decoded data tables [id][dcac] */
     int32_t *qttbl[4];          /* Dequantizer tables [id] */
+    uint16_t huffcap[2][2];     /* Number of codes the huffman tables can hold, tables are reused when redefined [id][dcac] */
+    uint8_t tbldef;             /* Tables defined in the image, b3..b0: huffman [id][dcac], b7..b4: dequantizer [id] */
+    uint32_t tblhash[8];        /* Hash of the last definition of each table (in order of tbldef bits), 0: none */
+    uint8_t *qtdef[4];          /* Last definition data of the dequantizer tables, kept by jd_prepare_cached() [id] */
+    void *tblpool;              /* Working buffer of jd_prepare_cached(), the tables are kept at its start (NULL: not cached) */
+    size_t sz_tblpool;          /* Size of the working buffer of jd_prepare_cached() */
+    size_t sz_tbl;              /* Size of the tables at the start of the working buffer */
 #if JD_FASTDECODE >= 1
     uint32_t wreg;              /* Working shift register */
     uint8_t marker;             /* Detected marker (0:None) */
-#if JD_FASTDECODE == 2
+#if JD_FASTDECODE >= 2
     uint8_t longofs[2][2];      /* Table offset of long code [id][dcac] */
     uint16_t *hufflut_ac[2];    /* Fast huffman decode tables for AC short code [id] */
     uint8_t *hufflut_dc[2];     /* Fast huffman decode tables for DC short code [id] */
+#if JD_FASTDECODE == 3
+    int16_t *hufflut_fac[2];    /* Fast AC element decode tables (code and data bits) [id] */
 #endif
 #endif
+#endif
+#if JD_PROGRESSIVE
+    uint8_t progressive;        /* Progressive JPEG (SOF2) */
+    uint8_t compid[3];          /* Component identifier of each component, Y, Cb, Cr */
+    uint8_t scan[8];            /* Current scan: number of components, component [3] (b3..b0: index, b7..b4: huffman table), Ss, Se, Ah, Al */
+    uint16_t eobrun;            /* Number of blocks remaining in the current EOB run */
+    int16_t *coef;              /* Coefficient buffer of the whole image (sz_coef bytes), set by the application after jd_prepare() */
+    size_t sz_coef;             /* Size of the coefficient buffer required for the image */
+#endif
+    uint8_t ycc;                /* Output Y/Cb/Cr instead of RGB (3 bytes per pixel), set by the application after jd_prepare() */
     void *workbuf;              /* Working buffer for IDCT and RGB output */
     jd_yuv_t *mcubuf;           /* Working buffer for the MCU */
     void *pool;                 /* Pointer to available memory pool */
@@ -92,7 +111,10 @@ struct JDEC {
 
 /* TJpgDec API functions */
 JRESULT jd_prepare (JDEC *jd, size_t (*infunc)(JDEC *, uint8_t *, size_t), void *pool, size_t sz_pool, void *dev);
+JRESULT jd_prepare_cached (JDEC *jd, size_t (*infunc)(JDEC *, uint8_t *, size_t), void *pool, size_t sz_pool, void *dev);
 JRESULT jd_decomp (JDEC *jd, int (*outfunc)(JDEC *, void *, JRECT *), uint8_t scale);
+JRESULT jd_decomp_rect (JDEC *jd, int (*outfunc)(JDEC *, void *, JRECT *), uint8_t scale, const JRECT *rect);
+JRESULT jd_decomp_part (JDEC *jd, int (*outfunc)(JDEC *, void *, JRECT *), uint8_t scale, const JRECT *rect, unsigned int first, unsigned int count);
 
 
 #ifdef __cplusplus
@@ -39,6 +39,7 @@
 /  0: Basic optimization. Suitable for 8/16-bit MCUs.
 /  1: + 32-bit barrel shifter. Suitable for 32-bit MCUs.
 /  2: + Table conversion for huffman decoding (wants 6 << HUFF_BIT bytes of RAM)
+/  3: + Table conversion of AC elements with their data bits, sparse block IDCT (wants 8 << HUFF_BIT bytes of RAM)
 */
 
 #if defined(CONFIG_JD_DEFAULT_HUFFMAN)
@@ -46,3 +47,13 @@
 #else
 #define JD_DEFAULT_HUFFMAN 0
 #endif
+
+#if defined(CONFIG_JD_PROGRESSIVE)
+#define JD_PROGRESSIVE CONFIG_JD_PROGRESSIVE
+#else
+#define JD_PROGRESSIVE 0
+#endif
+/* Support progressive JPEG (SOF2). Coefficients of the whole image are buffered in a buffer given by the application.
+/  0: Disable
+/  1: Enable
+*/
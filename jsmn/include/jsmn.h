@@ -25,6 +25,9 @@
 #define JSMN_H
 
 #include <stddef.h>
+#ifdef JSMN_FAST_SCAN
+#include <string.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -100,6 +103,88 @@ JSMN_API int jsmn_parse(jsmn_parser *parser, const char *js, const size_t len,
                         jsmntok_t *tokens, const unsigned int num_tokens);
 
 #ifndef JSMN_HEADER
+#ifdef JSMN_FAST_SCAN
+/*
+ * Word at a time scanning of string bodies and whitespace. Every byte of the
+ * word is compared at once, without carries between the bytes, so the first
+ * matching byte is exact and the tokens are the same as without the macro.
+ */
+typedef size_t jsmn_word_t;
+
+#define JSMN_WORD_ONES ((jsmn_word_t)-1 / 0xff)
+#define JSMN_WORD_LOW7 (JSMN_WORD_ONES * 0x7f)
+#define JSMN_WORD_HIGH (JSMN_WORD_ONES * 0x80)
+
+/**
+ * High bit set in every zero byte of the word.
+ */
+static jsmn_word_t jsmn_word_zero(const jsmn_word_t w)
+{
+    return ~(((w & JSMN_WORD_LOW7) + JSMN_WORD_LOW7) | w) & JSMN_WORD_HIGH;
+}
+
+/**
+ * High bit set in every byte of the word equal to c.
+ */
+static jsmn_word_t jsmn_word_eq(const jsmn_word_t w, const unsigned char c)
+{
+    return jsmn_word_zero(w ^ (JSMN_WORD_ONES * c));
+}
+
+/**
+ * Offset of the first byte of the word with the high bit set in the mask.
+ */
+static unsigned int jsmn_word_first(const jsmn_word_t mask)
+{
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return (unsigned int)__builtin_ctzll(mask) / 8;
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (unsigned int)__builtin_clzll(mask) / 8 - (8 - sizeof(jsmn_word_t));
+#else
+    /* Bytewise from the start of the word */
+    (void)mask;
+    return 0;
+#endif
+}
+
+/**
+ * Position of the first quote, backslash or null in a string body from pos,
+ * or of the last bytes, which do not fill a word.
+ */
+static unsigned int jsmn_skip_string(const char *js, unsigned int pos,
+                                     const size_t len)
+{
+    jsmn_word_t w, mask;
+    for (; pos + sizeof(jsmn_word_t) <= len; pos += sizeof(jsmn_word_t)) {
+        memcpy(&w, js + pos, sizeof(w));
+        mask = jsmn_word_zero(w) | jsmn_word_eq(w, '\"') | jsmn_word_eq(w, '\\');
+        if (mask) {
+            return pos + jsmn_word_first(mask);
+        }
+    }
+    return pos;
+}
+
+/**
+ * Position of the first byte from pos, which is not whitespace, or of the last
+ * bytes, which do not fill a word.
+ */
+static unsigned int jsmn_skip_space(const char *js, unsigned int pos,
+                                    const size_t len)
+{
+    jsmn_word_t w, mask;
+    for (; pos + sizeof(jsmn_word_t) <= len; pos += sizeof(jsmn_word_t)) {
+        memcpy(&w, js + pos, sizeof(w));
+        mask = ~(jsmn_word_eq(w, ' ') | jsmn_word_eq(w, '\n') | jsmn_word_eq(w, '\t') |
+                 jsmn_word_eq(w, '\r')) & JSMN_WORD_HIGH;
+        if (mask) {
+            return pos + jsmn_word_first(mask);
+        }
+    }
+    return pos;
+}
+#endif /* JSMN_FAST_SCAN */
+
 /**
  * Allocates a fresh unused token from the token pool.
  */
@@ -205,7 +290,14 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
     parser->pos++;
 
     for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
-        char c = js[parser->pos];
+        char c;
+#ifdef JSMN_FAST_SCAN
+        parser->pos = jsmn_skip_string(js, parser->pos, len);
+        if (parser->pos >= len || js[parser->pos] == '\0') {
+            break;
+        }
+#endif
+        c = js[parser->pos];
 
         /* Quote: end of string */
         if (c == '\"') {
@@ -377,6 +469,10 @@ JSMN_API int jsmn_parse(jsmn_parser *parser, const char *js, const size_t len,
         case '\r':
         case '\n':
         case ' ':
+#ifdef JSMN_FAST_SCAN
+            /* The loop moves to the first byte after the whitespace */
+            parser->pos = jsmn_skip_space(js, parser->pos + 1, len) - 1;
+#endif
             break;
         case ':':
             parser->toksuper = parser->toknext - 1;
@@ -1,6 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
 #include <stdio.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "unity_test_utils_memory.h"
 
-void app_main(void)
+void setUp(void)
 {
+    unity_utils_record_free_mem();
+}
 
+void tearDown(void)
+{
+    unity_utils_evaluate_leaks_direct(0);
+}
+
+void app_main(void)
+{
+    printf("Running jsmn component tests\n");
+    unity_run_menu();
 }
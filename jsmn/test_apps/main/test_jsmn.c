@@ -0,0 +1,299 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+#include "test_jsmn_variants.h"
+
+#define TEST_FUZZ_ITERATIONS        2000
+#define TEST_FUZZ_DOC_SIZE          2048
+#define TEST_BENCHMARK_ITERATIONS   20
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/* xorshift32, the same documents on every run */
+static uint32_t test_rand_state;
+
+static uint32_t test_rand(uint32_t n)
+{
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+    return test_rand_state % n;
+}
+
+typedef struct {
+    char *doc;
+    size_t len;
+    size_t size;
+} test_doc_t;
+
+static void test_doc_putc(test_doc_t *d, char c)
+{
+    if (d->len < d->size) {
+        d->doc[d->len++] = c;
+    }
+}
+
+static void test_doc_puts(test_doc_t *d, const char *s)
+{
+    while (*s) {
+        test_doc_putc(d, *s++);
+    }
+}
+
+/* Runs of whitespace, which are often longer than a word */
+static void test_doc_space(test_doc_t *d)
+{
+    static const char space[] = " \t\r\n";
+    const int len = test_rand(4) ? test_rand(3) : test_rand(24);
+    const bool indent = test_rand(2);
+    for (int i = 0; i < len; i++) {
+        test_doc_putc(d, indent && i ? ' ' : space[test_rand(4)]);
+    }
+}
+
+/* String body with long plain runs, escapes, control characters and UTF-8 */
+static void test_doc_string(test_doc_t *d)
+{
+    static const char plain[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=- ";
+    static const char *const special[] = {
+        "\\\"", "\\\\", "\\/", "\\b", "\\f", "\\n", "\\r", "\\t", "\\u00e9", "\\uABCD", "\\u12", "\\x", "\\",
+        "\t", "\x01", "\x7f", "\xc3\xa9", "\xff", "\"",
+    };
+    test_doc_putc(d, '\"');
+    const int len = test_rand(4) ? test_rand(12) : test_rand(400);
+    for (int i = 0; i < len; i++) {
+        if (test_rand(16)) {
+            test_doc_putc(d, plain[test_rand(sizeof(plain) - 1)]);
+        } else {
+            test_doc_puts(d, special[test_rand(sizeof(special) / sizeof(special[0]))]);
+        }
+    }
+    test_doc_putc(d, '\"');
+}
+
+static void test_doc_value(test_doc_t *d, int depth)
+{
+    static const char *const primitives[] = {"0", "-12", "3.25e-7", "true", "false", "null", "tru", "1x", "+1"};
+    test_doc_space(d);
+    const uint32_t kind = depth < 6 ? test_rand(8) : 4 + test_rand(4);
+    if (kind < 2) {
+        const bool obj = kind == 0;
+        test_doc_putc(d, obj ? '{' : '[');
+        const int members = test_rand(6);
+        for (int i = 0; i < members; i++) {
+            if (i) {
+                test_doc_putc(d, ',');
+            }
+            if (obj) {
+                test_doc_space(d);
+                test_doc_string(d);
+                test_doc_space(d);
+                test_doc_putc(d, ':');
+            }
+            test_doc_value(d, depth + 1);
+        }
+        test_doc_space(d);
+        test_doc_putc(d, obj ? '}' : ']');
+    } else if (kind < 6) {
+        test_doc_string(d);
+    } else {
+        test_doc_puts(d, primitives[test_rand(sizeof(primitives) / sizeof(primitives[0]))]);
+    }
+    test_doc_space(d);
+}
+
+/* Random document, often with a few random bytes changed, cut or with a null inside */
+static size_t test_doc_random(char *doc, size_t size)
+{
+    test_doc_t d = {doc, 0, size};
+    test_doc_value(&d, 0);
+    const int mutations = test_rand(3) ? 0 : 1 + test_rand(3);
+    for (int i = 0; i < mutations && d.len; i++) {
+        static const char bytes[] = "{}[]\":,\\ \n0a\0";
+        doc[test_rand(d.len)] = bytes[test_rand(sizeof(bytes) - 1)];
+    }
+    if (d.len && !test_rand(8)) {
+        d.len = test_rand(d.len);
+    }
+    return d.len;
+}
+
+typedef struct {
+    int ret;
+    test_jsmn_parser_t parser;
+    test_jsmn_tok_t tokens[TEST_JSMN_MAX_TOKENS];
+} test_result_t;
+
+static void test_result_assert_equal(const test_result_t *expected, const test_result_t *actual, unsigned int num_tokens)
+{
+    TEST_ASSERT_EQUAL(expected->ret, actual->ret);
+    TEST_ASSERT_EQUAL(expected->parser.pos, actual->parser.pos);
+    TEST_ASSERT_EQUAL(expected->parser.toknext, actual->parser.toknext);
+    TEST_ASSERT_EQUAL(expected->parser.toksuper, actual->parser.toksuper);
+    TEST_ASSERT_EQUAL_MEMORY(expected->tokens, actual->tokens, num_tokens * sizeof(test_jsmn_tok_t));
+}
+
+static void test_parse(test_jsmn_parse_t parse, const char *doc, size_t len, bool with_tokens, unsigned int num_tokens, test_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+    result->parser.toksuper = -1;
+    result->ret = parse(&result->parser, doc, len, with_tokens ? result->tokens : NULL, num_tokens);
+}
+
+/* Parse the same document with both variants: at once, counting the tokens, with too few tokens and in two parts */
+static void test_differential(test_jsmn_parse_t scalar, test_jsmn_parse_t fast, const char *doc, size_t len)
+{
+    static test_result_t expected, actual;
+
+    test_parse(scalar, doc, len, true, TEST_JSMN_MAX_TOKENS, &expected);
+    test_parse(fast, doc, len, true, TEST_JSMN_MAX_TOKENS, &actual);
+    test_result_assert_equal(&expected, &actual, TEST_JSMN_MAX_TOKENS);
+
+    test_parse(scalar, doc, len, false, 0, &expected);
+    test_parse(fast, doc, len, false, 0, &actual);
+    test_result_assert_equal(&expected, &actual, 0);
+
+    /* Continue after JSMN_ERROR_NOMEM with more tokens */
+    const unsigned int few = 1 + test_rand(8);
+    test_parse(scalar, doc, len, true, few, &expected);
+    test_parse(fast, doc, len, true, few, &actual);
+    test_result_assert_equal(&expected, &actual, few);
+    expected.ret = scalar(&expected.parser, doc, len, expected.tokens, TEST_JSMN_MAX_TOKENS);
+    actual.ret = fast(&actual.parser, doc, len, actual.tokens, TEST_JSMN_MAX_TOKENS);
+    test_result_assert_equal(&expected, &actual, TEST_JSMN_MAX_TOKENS);
+
+    /* Continue after JSMN_ERROR_PART with the rest of the document */
+    const size_t part = len ? test_rand(len) : 0;
+    test_parse(scalar, doc, part, true, TEST_JSMN_MAX_TOKENS, &expected);
+    test_parse(fast, doc, part, true, TEST_JSMN_MAX_TOKENS, &actual);
+    test_result_assert_equal(&expected, &actual, TEST_JSMN_MAX_TOKENS);
+    expected.ret = scalar(&expected.parser, doc, len, expected.tokens, TEST_JSMN_MAX_TOKENS);
+    actual.ret = fast(&actual.parser, doc, len, actual.tokens, TEST_JSMN_MAX_TOKENS);
+    test_result_assert_equal(&expected, &actual, TEST_JSMN_MAX_TOKENS);
+}
+
+/**
+ * @brief Differential fuzz test of JSMN_FAST_SCAN against the bytewise parser
+ *
+ * Documents are parsed from every offset of a buffer, so that the words are loaded at all alignments.
+ */
+TEST_CASE("jsmn fast scan is the same as bytewise", "[jsmn]")
+{
+    char *buf = malloc(TEST_FUZZ_DOC_SIZE + 8);
+    TEST_ASSERT_NOT_NULL(buf);
+    test_rand_state = 0x2545f491;
+    for (int i = 0; i < TEST_FUZZ_ITERATIONS; i++) {
+        char *doc = buf + i % 8;
+        const size_t len = test_doc_random(doc, TEST_FUZZ_DOC_SIZE);
+        test_differential(test_jsmn_parse_default, test_jsmn_parse_default_fast, doc, len);
+        test_differential(test_jsmn_parse_strict, test_jsmn_parse_strict_fast, doc, len);
+    }
+
+    /* The words must not be loaded beyond the length, the documents are copied to buffers of the length */
+    static const char *const docs[] = {
+        "{\"key\":\"0123456789abcdef0123456789abcdef\"}",
+        "[                                        1]",
+        "[\"0123456789abcdef\\\"0123456789abcdef\"]",
+        "[\"0123456789abcdef\\u0041bcdef0123456789\"]",
+    };
+    for (int i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        for (size_t len = 0; len <= strlen(docs[i]); len++) {
+            char *doc = malloc(len ? len : 1);
+            TEST_ASSERT_NOT_NULL(doc);
+            memcpy(doc, docs[i], len);
+            test_differential(test_jsmn_parse_default, test_jsmn_parse_default_fast, doc, len);
+            test_differential(test_jsmn_parse_strict, test_jsmn_parse_strict_fast, doc, len);
+            free(doc);
+        }
+    }
+    free(buf);
+}
+
+/* Provisioning payload: certificates and a key as base64 strings, pretty printed with indentation */
+static size_t test_provisioning_doc(char *doc, size_t size)
+{
+    size_t len = snprintf(doc, size, "{\n    \"node_id\": \"esp-node-0001\",\n    \"endpoint\": \"mqtts://broker.local:8883\",\n");
+    static const char *const names[] = {"ca_cert", "client_cert", "client_key"};
+    test_rand_state = 0x12345678;
+    for (int i = 0; i < 3; i++) {
+        len += snprintf(doc + len, size - len, "    \"%s\": \"", names[i]);
+        for (int j = 0; j < 1600; j++) {
+            static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            doc[len++] = base64[test_rand(64)];
+            if (j % 64 == 63) {
+                len += snprintf(doc + len, size - len, "\\n");
+            }
+        }
+        len += snprintf(doc + len, size - len, "\",\n");
+    }
+    len += snprintf(doc + len, size - len, "    \"params\": {\n");
+    for (int i = 0; i < 40; i++) {
+        len += snprintf(doc + len, size - len, "        \"param_%02d\": %d,\n", i, i * 13);
+    }
+    len += snprintf(doc + len, size - len, "        \"last\": true\n    }\n}\n");
+    TEST_ASSERT_LESS_THAN(size, len);
+    return len;
+}
+
+static uint64_t test_benchmark_parse(test_jsmn_bench_t parse, const char *doc, size_t len, int num_tokens)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        const uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(num_tokens, parse(doc, len));
+        total += test_benchmark_now() - start;
+    }
+    return total / TEST_BENCHMARK_ITERATIONS;
+}
+
+/**
+ * @brief Benchmark of JSMN_FAST_SCAN on a document with long strings and indentation
+ */
+TEST_CASE("jsmn fast scan benchmark", "[jsmn][benchmark]")
+{
+    const size_t size = 8 * 1024;
+    char *doc = malloc(size);
+    TEST_ASSERT_NOT_NULL(doc);
+    const size_t len = test_provisioning_doc(doc, size);
+    static test_result_t expected, actual;
+    test_parse(test_jsmn_parse_strict, doc, len, true, TEST_JSMN_MAX_TOKENS, &expected);
+    test_parse(test_jsmn_parse_strict_fast, doc, len, true, TEST_JSMN_MAX_TOKENS, &actual);
+    TEST_ASSERT_GREATER_THAN(0, expected.ret);
+    test_result_assert_equal(&expected, &actual, TEST_JSMN_MAX_TOKENS);
+
+    const uint64_t scalar = test_benchmark_parse(test_jsmn_bench_strict, doc, len, expected.ret);
+    const uint64_t fast = test_benchmark_parse(test_jsmn_bench_strict_fast, doc, len, expected.ret);
+    printf("Parse %zu bytes, %d tokens: bytewise %" PRIu64 ", fast scan %" PRIu64 " " TEST_BENCHMARK_UNIT "\n",
+           len, expected.ret, scalar, fast);
+    free(doc);
+}
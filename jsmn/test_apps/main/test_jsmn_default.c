@@ -0,0 +1,10 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#define JSMN_STATIC
+#include "jsmn.h"
+#include "test_jsmn_variants.h"
+
+TEST_JSMN_VARIANT(default)
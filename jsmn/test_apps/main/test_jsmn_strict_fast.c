@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#define JSMN_STATIC
+#define JSMN_STRICT
+#define JSMN_PARENT_LINKS
+#define JSMN_FAST_SCAN
+#include "jsmn.h"
+#include "test_jsmn_variants.h"
+
+TEST_JSMN_VARIANT(strict_fast)
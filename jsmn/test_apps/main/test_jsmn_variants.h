@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/*
+ * jsmn is compiled with different options in every test_jsmn_<variant>.c file,
+ * which exposes jsmn_parse() with tokens of the same layout for all variants.
+ */
+
+#include <stddef.h>
+
+#define TEST_JSMN_MAX_TOKENS    512
+
+typedef struct {
+    int type;
+    int start;
+    int end;
+    int size;
+    int parent;     /* -1 without JSMN_PARENT_LINKS */
+} test_jsmn_tok_t;
+
+/* Same as jsmn_parser */
+typedef struct {
+    unsigned int pos;
+    unsigned int toknext;
+    int toksuper;
+} test_jsmn_parser_t;
+
+typedef int (*test_jsmn_parse_t)(test_jsmn_parser_t *parser, const char *js, size_t len,
+                                 test_jsmn_tok_t *tokens, unsigned int num_tokens);
+/* Parse the whole document into the tokens of the variant, without conversion */
+typedef int (*test_jsmn_bench_t)(const char *js, size_t len);
+
+int test_jsmn_parse_default(test_jsmn_parser_t *parser, const char *js, size_t len, test_jsmn_tok_t *tokens, unsigned int num_tokens);
+int test_jsmn_bench_default(const char *js, size_t len);
+int test_jsmn_parse_default_fast(test_jsmn_parser_t *parser, const char *js, size_t len, test_jsmn_tok_t *tokens, unsigned int num_tokens);
+int test_jsmn_bench_default_fast(const char *js, size_t len);
+int test_jsmn_parse_strict(test_jsmn_parser_t *parser, const char *js, size_t len, test_jsmn_tok_t *tokens, unsigned int num_tokens);
+int test_jsmn_bench_strict(const char *js, size_t len);
+int test_jsmn_parse_strict_fast(test_jsmn_parser_t *parser, const char *js, size_t len, test_jsmn_tok_t *tokens, unsigned int num_tokens);
+int test_jsmn_bench_strict_fast(const char *js, size_t len);
+
+#ifdef JSMN_H
+
+#ifdef JSMN_PARENT_LINKS
+#define TEST_JSMN_GET_PARENT(tok)       ((tok)->parent)
+#define TEST_JSMN_SET_PARENT(tok, val)  ((tok)->parent = (val))
+#else
+#define TEST_JSMN_GET_PARENT(tok)       (-1)
+#define TEST_JSMN_SET_PARENT(tok, val)  ((void)(val))
+#endif
+
+/* Tokens are converted before and after jsmn_parse(), so that the parser can continue after an error */
+#define TEST_JSMN_VARIANT(name) \
+    static jsmntok_t native[TEST_JSMN_MAX_TOKENS]; \
+    int test_jsmn_bench_##name(const char *js, size_t len) \
+    { \
+        jsmn_parser p; \
+        jsmn_init(&p); \
+        return jsmn_parse(&p, js, len, native, TEST_JSMN_MAX_TOKENS); \
+    } \
+    int test_jsmn_parse_##name(test_jsmn_parser_t *parser, const char *js, size_t len, \
+                               test_jsmn_tok_t *tokens, unsigned int num_tokens) \
+    { \
+        jsmn_parser p = {parser->pos, parser->toknext, parser->toksuper}; \
+        for (unsigned int i = 0; tokens && i < num_tokens; i++) { \
+            native[i].type = (jsmntype_t)tokens[i].type; \
+            native[i].start = tokens[i].start; \
+            native[i].end = tokens[i].end; \
+            native[i].size = tokens[i].size; \
+            TEST_JSMN_SET_PARENT(&native[i], tokens[i].parent); \
+        } \
+        int ret = jsmn_parse(&p, js, len, tokens ? native : NULL, num_tokens); \
+        for (unsigned int i = 0; tokens && i < num_tokens; i++) { \
+            tokens[i].type = native[i].type; \
+            tokens[i].start = native[i].start; \
+            tokens[i].end = native[i].end; \
+            tokens[i].size = native[i].size; \
+            tokens[i].parent = TEST_JSMN_GET_PARENT(&native[i]); \
+        } \
+        parser->pos = p.pos; \
+        parser->toknext = p.toknext; \
+        parser->toksuper = p.toksuper; \
+        return ret; \
+    }
+
+#endif /* JSMN_H */
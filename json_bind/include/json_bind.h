@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef _JSON_BIND_H_
+#define _JSON_BIND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <json_parser.h>
+#include <json_generator.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Maximum number of fields of a descriptor, which are found through a perfect hash of their keys.
+ * The fields of larger descriptors are compared one after another. */
+#define JSON_BIND_HASH_FIELDS   32
+/* Slots of the perfect hash table, at least 4 per field */
+#define JSON_BIND_HASH_SLOTS    128
+
+typedef enum {
+    JSON_BIND_BOOL,         /* bool */
+    JSON_BIND_INT,          /* int */
+    JSON_BIND_INT64,        /* int64_t */
+    JSON_BIND_FLOAT,        /* float */
+    JSON_BIND_STRING,       /* char array, the string as it is in the JSON, without unescaping */
+    JSON_BIND_OBJECT,       /* Nested struct, described by its own descriptor */
+} json_bind_type_t;
+
+typedef struct json_bind_desc json_bind_desc_t;
+
+/* A member of a struct and its key in the JSON object */
+typedef struct {
+    const char *key;
+    json_bind_type_t type;
+    uint16_t offset;
+    uint16_t size;
+    json_bind_desc_t *desc;     /* For JSON_BIND_OBJECT */
+} json_bind_field_t;
+
+/* Descriptor of a struct, a table of its fields:
+ *
+ *     typedef struct {
+ *         int id;
+ *         char name[16];
+ *         config_t config;
+ *     } sensor_t;
+ *
+ *     static const json_bind_field_t sensor_fields[] = {
+ *         JSON_BIND_FIELD("id", sensor_t, id, JSON_BIND_INT),
+ *         JSON_BIND_FIELD("name", sensor_t, name, JSON_BIND_STRING),
+ *         JSON_BIND_OBJECT_FIELD("config", sensor_t, config, &config_desc),
+ *     };
+ *     static json_bind_desc_t sensor_desc = JSON_BIND_DESC(sensor_fields);
+ *
+ * The rest of the descriptor is filled in by json_bind_compile().
+ */
+struct json_bind_desc {
+    const json_bind_field_t *fields;
+    int num_fields;
+    bool compiled;
+    uint32_t seed;                              /* Seed of the perfect hash, 0 if the keys are not hashed */
+    uint32_t shift;                             /* The slot is the top bits of the hash */
+    uint8_t key_lens[JSON_BIND_HASH_FIELDS];
+    uint8_t slots[JSON_BIND_HASH_SLOTS];        /* Index of the field + 1, 0 for an empty slot */
+};
+
+#define JSON_BIND_FIELD(key, type, member, bind_type) \
+    { key, bind_type, offsetof(type, member), sizeof(((type *)0)->member), NULL }
+#define JSON_BIND_OBJECT_FIELD(key, type, member, object_desc) \
+    { key, JSON_BIND_OBJECT, offsetof(type, member), sizeof(((type *)0)->member), object_desc }
+#define JSON_BIND_DESC(fields_array) \
+    { .fields = fields_array, .num_fields = sizeof(fields_array) / sizeof((fields_array)[0]) }
+
+/* Check the descriptor and its nested descriptors, and build the perfect hashes of their keys.
+ *
+ * This is done on the first use of a descriptor. Call it on start up if the descriptor is used by several
+ * tasks. Fails if a field does not match its type, e.g. JSON_BIND_INT for a member which is not an int,
+ * or if a key is longer than 255 bytes.
+ */
+int json_bind_compile(json_bind_desc_t *desc);
+
+/* Fill the struct from the current object of jctx, e.g. right after json_parse_start() or after
+ * json_obj_get_object(). The members of the object are visited once and the fields are found through the
+ * perfect hash. Members without a field are skipped, and fields without a member are left as they are.
+ * A null member leaves its field as it is too, for fields of any type, including strings and nested structs.
+ * Fails on a member of the wrong type or a string, which does not fit into its field.
+ */
+int json_bind_parse(jparse_ctx_t *jctx, json_bind_desc_t *desc, void *out);
+
+/* json_parse_start(), json_bind_parse() and json_parse_end() */
+int json_bind_parse_str(const char *js, int len, json_bind_desc_t *desc, void *out);
+
+/* Generate an object with all fields of the struct, or add it as a named member of the current object */
+int json_bind_gen(json_gen_str_t *jstr, json_bind_desc_t *desc, const void *in);
+int json_bind_gen_obj(json_gen_str_t *jstr, const char *name, json_bind_desc_t *desc, const void *in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JSON_BIND_H_ */
@@ -0,0 +1,265 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <json_bind.h>
+
+/* Seeds tried for every table size before the keys are compared one after another */
+#define JSON_BIND_SEED_TRIES    512
+
+/* FNV-1a of the key, with the seed mixed in */
+static inline uint32_t json_bind_hash(const char *key, size_t len, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    while (len--) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash * 0x9e3779b1u;
+}
+
+/* Try to place every key in its own slot of a table of 2^bits slots */
+static bool json_bind_try_seed(json_bind_desc_t *desc, uint32_t seed, int bits)
+{
+    memset(desc->slots, 0, sizeof(desc->slots));
+    for (int i = 0; i < desc->num_fields; i++) {
+        const uint32_t slot = json_bind_hash(desc->fields[i].key, desc->key_lens[i], seed) >> (32 - bits);
+        if (desc->slots[slot]) {
+            return false;
+        }
+        desc->slots[slot] = i + 1;
+    }
+    desc->seed = seed;
+    desc->shift = 32 - bits;
+    return true;
+}
+
+static size_t json_bind_type_size(json_bind_type_t type)
+{
+    switch (type) {
+    case JSON_BIND_BOOL:
+        return sizeof(bool);
+    case JSON_BIND_INT:
+        return sizeof(int);
+    case JSON_BIND_INT64:
+        return sizeof(int64_t);
+    case JSON_BIND_FLOAT:
+        return sizeof(float);
+    default:
+        return 0;
+    }
+}
+
+int json_bind_compile(json_bind_desc_t *desc)
+{
+    if (desc->compiled) {
+        return OS_SUCCESS;
+    }
+    for (int i = 0; i < desc->num_fields; i++) {
+        const json_bind_field_t *field = &desc->fields[i];
+        if (strlen(field->key) > UINT8_MAX) {
+            return -OS_FAIL;
+        }
+        switch (field->type) {
+        case JSON_BIND_STRING:
+            if (field->size < 1) {
+                return -OS_FAIL;
+            }
+            break;
+        case JSON_BIND_OBJECT:
+            if (!field->desc || json_bind_compile(field->desc) != OS_SUCCESS) {
+                return -OS_FAIL;
+            }
+            break;
+        default:
+            if (field->size != json_bind_type_size(field->type)) {
+                return -OS_FAIL;
+            }
+            break;
+        }
+    }
+    desc->seed = 0;
+    if (desc->num_fields <= JSON_BIND_HASH_FIELDS) {
+        for (int i = 0; i < desc->num_fields; i++) {
+            desc->key_lens[i] = strlen(desc->fields[i].key);
+        }
+        /* The smallest table with at least 4 slots per key, larger ones if no seed works */
+        int bits = 2;
+        while ((1 << bits) < desc->num_fields * 4) {
+            bits++;
+        }
+        for (; (1 << bits) <= JSON_BIND_HASH_SLOTS && !desc->seed; bits++) {
+            for (uint32_t seed = 1; seed <= JSON_BIND_SEED_TRIES; seed++) {
+                if (json_bind_try_seed(desc, seed, bits)) {
+                    break;
+                }
+            }
+        }
+    }
+    desc->compiled = true;
+    return OS_SUCCESS;
+}
+
+static const json_bind_field_t *json_bind_find(const json_bind_desc_t *desc, const char *key, size_t len)
+{
+    if (desc->seed) {
+        const int index = desc->slots[json_bind_hash(key, len, desc->seed) >> desc->shift] - 1;
+        if (index >= 0 && desc->key_lens[index] == len && memcmp(desc->fields[index].key, key, len) == 0) {
+            return &desc->fields[index];
+        }
+        return NULL;
+    }
+    for (int i = 0; i < desc->num_fields; i++) {
+        const json_bind_field_t *field = &desc->fields[i];
+        if (strlen(field->key) == len && memcmp(field->key, key, len) == 0) {
+            return field;
+        }
+    }
+    return NULL;
+}
+
+/* Last token of the subtree of the token */
+static json_tok_t *json_bind_skip(jparse_ctx_t *jctx, json_tok_t *tok)
+{
+    if (jctx->index.next) {
+        return &jctx->tokens[jctx->index.next[tok - jctx->tokens] - 1];
+    }
+    int cnt = tok->size;
+    while (cnt--) {
+        tok = json_bind_skip(jctx, tok + 1);
+    }
+    return tok;
+}
+
+static int json_bind_parse_obj(jparse_ctx_t *jctx, json_tok_t *obj, json_bind_desc_t *desc, uint8_t *out);
+
+static int json_bind_set(jparse_ctx_t *jctx, json_tok_t *tok, const json_bind_field_t *field, uint8_t *out)
+{
+    const char *val = jctx->js + tok->start;
+    const int len = tok->end - tok->start;
+    /* null leaves the field as it is, for every type */
+    if (tok->type == JSMN_PRIMITIVE && len == 4 && memcmp(val, "null", 4) == 0) {
+        return OS_SUCCESS;
+    }
+    if (field->type == JSON_BIND_OBJECT) {
+        return json_bind_parse_obj(jctx, tok, field->desc, out);
+    }
+    if (field->type == JSON_BIND_STRING) {
+        if (tok->type != JSMN_STRING || len > field->size - 1) {
+            return -OS_FAIL;
+        }
+        memcpy(out, val, len);
+        out[len] = '\0';
+        return OS_SUCCESS;
+    }
+    if (tok->type != JSMN_PRIMITIVE) {
+        return -OS_FAIL;
+    }
+    switch (field->type) {
+    case JSON_BIND_BOOL:
+        return json_sax_to_bool(val, len, (bool *)out);
+    case JSON_BIND_INT:
+        return json_sax_to_int(val, len, (int *)out);
+    case JSON_BIND_INT64:
+        return json_sax_to_int64(val, len, (int64_t *)out);
+    case JSON_BIND_FLOAT:
+        return json_sax_to_float(val, len, (float *)out);
+    default:
+        return -OS_FAIL;
+    }
+}
+
+static int json_bind_parse_obj(jparse_ctx_t *jctx, json_tok_t *obj, json_bind_desc_t *desc, uint8_t *out)
+{
+    if (obj->type != JSMN_OBJECT) {
+        return -OS_FAIL;
+    }
+    json_tok_t *tok = obj;
+    int size = obj->size;
+    while (size--) {
+        json_tok_t *key = tok + 1;
+        const json_bind_field_t *field = json_bind_find(desc, jctx->js + key->start, key->end - key->start);
+        if (field && json_bind_set(jctx, key + 1, field, out + field->offset) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+        tok = json_bind_skip(jctx, key);
+    }
+    return OS_SUCCESS;
+}
+
+int json_bind_parse(jparse_ctx_t *jctx, json_bind_desc_t *desc, void *out)
+{
+    if (json_bind_compile(desc) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    return json_bind_parse_obj(jctx, jctx->cur, desc, out);
+}
+
+int json_bind_parse_str(const char *js, int len, json_bind_desc_t *desc, void *out)
+{
+    jparse_ctx_t jctx;
+    if (json_parse_start(&jctx, js, len) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    int ret = json_bind_parse(&jctx, desc, out);
+    json_parse_end(&jctx);
+    return ret;
+}
+
+static int json_bind_gen_fields(json_gen_str_t *jstr, json_bind_desc_t *desc, const uint8_t *in)
+{
+    int ret = 0;
+    for (int i = 0; i < desc->num_fields; i++) {
+        const json_bind_field_t *field = &desc->fields[i];
+        const uint8_t *val = in + field->offset;
+        switch (field->type) {
+        case JSON_BIND_BOOL:
+            ret |= json_gen_obj_set_bool(jstr, field->key, *(const bool *)val);
+            break;
+        case JSON_BIND_INT:
+            ret |= json_gen_obj_set_int(jstr, field->key, *(const int *)val);
+            break;
+        case JSON_BIND_INT64:
+            ret |= json_gen_obj_set_int64(jstr, field->key, *(const int64_t *)val);
+            break;
+        case JSON_BIND_FLOAT:
+            ret |= json_gen_obj_set_float(jstr, field->key, *(const float *)val);
+            break;
+        case JSON_BIND_STRING:
+            ret |= json_gen_obj_set_string(jstr, field->key, (const char *)val);
+            break;
+        case JSON_BIND_OBJECT:
+            ret |= json_gen_push_object(jstr, field->key);
+            ret |= json_bind_gen_fields(jstr, field->desc, val);
+            ret |= json_gen_pop_object(jstr);
+            break;
+        }
+    }
+    return ret;
+}
+
+int json_bind_gen(json_gen_str_t *jstr, json_bind_desc_t *desc, const void *in)
+{
+    if (json_bind_compile(desc) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    int ret = json_gen_start_object(jstr);
+    ret |= json_bind_gen_fields(jstr, desc, in);
+    ret |= json_gen_end_object(jstr);
+    return ret ? -OS_FAIL : OS_SUCCESS;
+}
+
+int json_bind_gen_obj(json_gen_str_t *jstr, const char *name, json_bind_desc_t *desc, const void *in)
+{
+    if (json_bind_compile(desc) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    int ret = json_gen_push_object(jstr, name);
+    ret |= json_bind_gen_fields(jstr, desc, in);
+    ret |= json_gen_pop_object(jstr);
+    return ret ? -OS_FAIL : OS_SUCCESS;
+}
@@ -0,0 +1,442 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+#include "json_bind.h"
+
+#define TEST_DOC_SIZE               2048
+#define TEST_LARGE_FIELDS           40
+#define TEST_BENCHMARK_ITERATIONS   200
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+typedef struct {
+    int interval;
+    int retries;
+    bool enabled;
+    float threshold;
+    char unit[8];
+} test_limits_t;
+
+/* 30 fields, one of them a nested object */
+typedef struct {
+    char node_id[24];
+    char name[32];
+    char fw_version[16];
+    char model[16];
+    char tz[32];
+    int id;
+    int channel;
+    int tx_power;
+    int port;
+    int timeout;
+    int keepalive;
+    int qos;
+    int log_level;
+    int sample_rate;
+    int batch;
+    int64_t uptime;
+    int64_t boot_time;
+    bool wifi;
+    bool ble;
+    bool ota;
+    bool debug;
+    bool dhcp;
+    float lat;
+    float lon;
+    float temp_offset;
+    float hum_offset;
+    float gain;
+    float scale;
+    float bias;
+    test_limits_t limits;
+} test_config_t;
+
+static const json_bind_field_t test_limits_fields[] = {
+    JSON_BIND_FIELD("interval", test_limits_t, interval, JSON_BIND_INT),
+    JSON_BIND_FIELD("retries", test_limits_t, retries, JSON_BIND_INT),
+    JSON_BIND_FIELD("enabled", test_limits_t, enabled, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("threshold", test_limits_t, threshold, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("unit", test_limits_t, unit, JSON_BIND_STRING),
+};
+static json_bind_desc_t test_limits_desc = JSON_BIND_DESC(test_limits_fields);
+
+static const json_bind_field_t test_config_fields[] = {
+    JSON_BIND_FIELD("node_id", test_config_t, node_id, JSON_BIND_STRING),
+    JSON_BIND_FIELD("name", test_config_t, name, JSON_BIND_STRING),
+    JSON_BIND_FIELD("fw_version", test_config_t, fw_version, JSON_BIND_STRING),
+    JSON_BIND_FIELD("model", test_config_t, model, JSON_BIND_STRING),
+    JSON_BIND_FIELD("tz", test_config_t, tz, JSON_BIND_STRING),
+    JSON_BIND_FIELD("id", test_config_t, id, JSON_BIND_INT),
+    JSON_BIND_FIELD("channel", test_config_t, channel, JSON_BIND_INT),
+    JSON_BIND_FIELD("tx_power", test_config_t, tx_power, JSON_BIND_INT),
+    JSON_BIND_FIELD("port", test_config_t, port, JSON_BIND_INT),
+    JSON_BIND_FIELD("timeout", test_config_t, timeout, JSON_BIND_INT),
+    JSON_BIND_FIELD("keepalive", test_config_t, keepalive, JSON_BIND_INT),
+    JSON_BIND_FIELD("qos", test_config_t, qos, JSON_BIND_INT),
+    JSON_BIND_FIELD("log_level", test_config_t, log_level, JSON_BIND_INT),
+    JSON_BIND_FIELD("sample_rate", test_config_t, sample_rate, JSON_BIND_INT),
+    JSON_BIND_FIELD("batch", test_config_t, batch, JSON_BIND_INT),
+    JSON_BIND_FIELD("uptime", test_config_t, uptime, JSON_BIND_INT64),
+    JSON_BIND_FIELD("boot_time", test_config_t, boot_time, JSON_BIND_INT64),
+    JSON_BIND_FIELD("wifi", test_config_t, wifi, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("ble", test_config_t, ble, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("ota", test_config_t, ota, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("debug", test_config_t, debug, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("dhcp", test_config_t, dhcp, JSON_BIND_BOOL),
+    JSON_BIND_FIELD("lat", test_config_t, lat, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("lon", test_config_t, lon, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("temp_offset", test_config_t, temp_offset, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("hum_offset", test_config_t, hum_offset, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("gain", test_config_t, gain, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("scale", test_config_t, scale, JSON_BIND_FLOAT),
+    JSON_BIND_FIELD("bias", test_config_t, bias, JSON_BIND_FLOAT),
+    JSON_BIND_OBJECT_FIELD("limits", test_config_t, limits, &test_limits_desc),
+};
+static json_bind_desc_t test_config_desc = JSON_BIND_DESC(test_config_fields);
+
+static const test_config_t test_config = {
+    .node_id = "esp-node-0001", .name = "Living room \\\"east\\\"", .fw_version = "1.4.2", .model = "ESP32-C3",
+    .tz = "Europe/Prague", .id = 42, .channel = 6, .tx_power = -3, .port = 8883, .timeout = 30000,
+    .keepalive = 120, .qos = 1, .log_level = 3, .sample_rate = 100, .batch = 16,
+    .uptime = 86400123456LL, .boot_time = -1700000000000LL, .wifi = true, .ble = false, .ota = true,
+    .debug = false, .dhcp = true, .lat = 50.0875f, .lon = 14.4214f, .temp_offset = -0.5f, .hum_offset = 2.25f,
+    .gain = 1.5f, .scale = 0.001f, .bias = 0.0f,
+    .limits = { .interval = 60, .retries = 5, .enabled = true, .threshold = 27.5f, .unit = "C" },
+};
+
+static void test_assert_config(const test_config_t *expected, const test_config_t *actual)
+{
+    TEST_ASSERT_EQUAL_STRING(expected->node_id, actual->node_id);
+    TEST_ASSERT_EQUAL_STRING(expected->name, actual->name);
+    TEST_ASSERT_EQUAL_STRING(expected->fw_version, actual->fw_version);
+    TEST_ASSERT_EQUAL_STRING(expected->model, actual->model);
+    TEST_ASSERT_EQUAL_STRING(expected->tz, actual->tz);
+    TEST_ASSERT_EQUAL_MEMORY(&expected->id, &actual->id, offsetof(test_config_t, dhcp) + sizeof(bool) - offsetof(test_config_t, id));
+    TEST_ASSERT_EQUAL_FLOAT(expected->lat, actual->lat);
+    TEST_ASSERT_EQUAL_FLOAT(expected->lon, actual->lon);
+    TEST_ASSERT_EQUAL_FLOAT(expected->temp_offset, actual->temp_offset);
+    TEST_ASSERT_EQUAL_FLOAT(expected->hum_offset, actual->hum_offset);
+    TEST_ASSERT_EQUAL_FLOAT(expected->gain, actual->gain);
+    TEST_ASSERT_EQUAL_FLOAT(expected->scale, actual->scale);
+    TEST_ASSERT_EQUAL_FLOAT(expected->bias, actual->bias);
+    TEST_ASSERT_EQUAL(expected->limits.interval, actual->limits.interval);
+    TEST_ASSERT_EQUAL(expected->limits.retries, actual->limits.retries);
+    TEST_ASSERT_EQUAL(expected->limits.enabled, actual->limits.enabled);
+    TEST_ASSERT_EQUAL_FLOAT(expected->limits.threshold, actual->limits.threshold);
+    TEST_ASSERT_EQUAL_STRING(expected->limits.unit, actual->limits.unit);
+}
+
+/* The same as json_bind_gen(), with the json_generator API */
+static void test_gen_config(json_gen_str_t *jstr, const test_config_t *cfg)
+{
+    json_gen_start_object(jstr);
+    json_gen_obj_set_string(jstr, "node_id", cfg->node_id);
+    json_gen_obj_set_string(jstr, "name", cfg->name);
+    json_gen_obj_set_string(jstr, "fw_version", cfg->fw_version);
+    json_gen_obj_set_string(jstr, "model", cfg->model);
+    json_gen_obj_set_string(jstr, "tz", cfg->tz);
+    json_gen_obj_set_int(jstr, "id", cfg->id);
+    json_gen_obj_set_int(jstr, "channel", cfg->channel);
+    json_gen_obj_set_int(jstr, "tx_power", cfg->tx_power);
+    json_gen_obj_set_int(jstr, "port", cfg->port);
+    json_gen_obj_set_int(jstr, "timeout", cfg->timeout);
+    json_gen_obj_set_int(jstr, "keepalive", cfg->keepalive);
+    json_gen_obj_set_int(jstr, "qos", cfg->qos);
+    json_gen_obj_set_int(jstr, "log_level", cfg->log_level);
+    json_gen_obj_set_int(jstr, "sample_rate", cfg->sample_rate);
+    json_gen_obj_set_int(jstr, "batch", cfg->batch);
+    json_gen_obj_set_int64(jstr, "uptime", cfg->uptime);
+    json_gen_obj_set_int64(jstr, "boot_time", cfg->boot_time);
+    json_gen_obj_set_bool(jstr, "wifi", cfg->wifi);
+    json_gen_obj_set_bool(jstr, "ble", cfg->ble);
+    json_gen_obj_set_bool(jstr, "ota", cfg->ota);
+    json_gen_obj_set_bool(jstr, "debug", cfg->debug);
+    json_gen_obj_set_bool(jstr, "dhcp", cfg->dhcp);
+    json_gen_obj_set_float(jstr, "lat", cfg->lat);
+    json_gen_obj_set_float(jstr, "lon", cfg->lon);
+    json_gen_obj_set_float(jstr, "temp_offset", cfg->temp_offset);
+    json_gen_obj_set_float(jstr, "hum_offset", cfg->hum_offset);
+    json_gen_obj_set_float(jstr, "gain", cfg->gain);
+    json_gen_obj_set_float(jstr, "scale", cfg->scale);
+    json_gen_obj_set_float(jstr, "bias", cfg->bias);
+    json_gen_push_object(jstr, "limits");
+    json_gen_obj_set_int(jstr, "interval", cfg->limits.interval);
+    json_gen_obj_set_int(jstr, "retries", cfg->limits.retries);
+    json_gen_obj_set_bool(jstr, "enabled", cfg->limits.enabled);
+    json_gen_obj_set_float(jstr, "threshold", cfg->limits.threshold);
+    json_gen_obj_set_string(jstr, "unit", cfg->limits.unit);
+    json_gen_pop_object(jstr);
+    json_gen_end_object(jstr);
+}
+
+/* The same as json_bind_parse(), with the json_parser API */
+static int test_parse_config(jparse_ctx_t *jctx, test_config_t *cfg)
+{
+    int ret = json_obj_get_string(jctx, "node_id", cfg->node_id, sizeof(cfg->node_id));
+    ret |= json_obj_get_string(jctx, "name", cfg->name, sizeof(cfg->name));
+    ret |= json_obj_get_string(jctx, "fw_version", cfg->fw_version, sizeof(cfg->fw_version));
+    ret |= json_obj_get_string(jctx, "model", cfg->model, sizeof(cfg->model));
+    ret |= json_obj_get_string(jctx, "tz", cfg->tz, sizeof(cfg->tz));
+    ret |= json_obj_get_int(jctx, "id", &cfg->id);
+    ret |= json_obj_get_int(jctx, "channel", &cfg->channel);
+    ret |= json_obj_get_int(jctx, "tx_power", &cfg->tx_power);
+    ret |= json_obj_get_int(jctx, "port", &cfg->port);
+    ret |= json_obj_get_int(jctx, "timeout", &cfg->timeout);
+    ret |= json_obj_get_int(jctx, "keepalive", &cfg->keepalive);
+    ret |= json_obj_get_int(jctx, "qos", &cfg->qos);
+    ret |= json_obj_get_int(jctx, "log_level", &cfg->log_level);
+    ret |= json_obj_get_int(jctx, "sample_rate", &cfg->sample_rate);
+    ret |= json_obj_get_int(jctx, "batch", &cfg->batch);
+    ret |= json_obj_get_int64(jctx, "uptime", &cfg->uptime);
+    ret |= json_obj_get_int64(jctx, "boot_time", &cfg->boot_time);
+    ret |= json_obj_get_bool(jctx, "wifi", &cfg->wifi);
+    ret |= json_obj_get_bool(jctx, "ble", &cfg->ble);
+    ret |= json_obj_get_bool(jctx, "ota", &cfg->ota);
+    ret |= json_obj_get_bool(jctx, "debug", &cfg->debug);
+    ret |= json_obj_get_bool(jctx, "dhcp", &cfg->dhcp);
+    ret |= json_obj_get_float(jctx, "lat", &cfg->lat);
+    ret |= json_obj_get_float(jctx, "lon", &cfg->lon);
+    ret |= json_obj_get_float(jctx, "temp_offset", &cfg->temp_offset);
+    ret |= json_obj_get_float(jctx, "hum_offset", &cfg->hum_offset);
+    ret |= json_obj_get_float(jctx, "gain", &cfg->gain);
+    ret |= json_obj_get_float(jctx, "scale", &cfg->scale);
+    ret |= json_obj_get_float(jctx, "bias", &cfg->bias);
+    ret |= json_obj_get_object(jctx, "limits");
+    ret |= json_obj_get_int(jctx, "interval", &cfg->limits.interval);
+    ret |= json_obj_get_int(jctx, "retries", &cfg->limits.retries);
+    ret |= json_obj_get_bool(jctx, "enabled", &cfg->limits.enabled);
+    ret |= json_obj_get_float(jctx, "threshold", &cfg->limits.threshold);
+    ret |= json_obj_get_string(jctx, "unit", cfg->limits.unit, sizeof(cfg->limits.unit));
+    ret |= json_obj_leave_object(jctx);
+    return ret;
+}
+
+TEST_CASE("json_bind generates and parses a struct", "[json_bind]")
+{
+    char *doc = malloc(TEST_DOC_SIZE);
+    char *ref = malloc(TEST_DOC_SIZE);
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_compile(&test_config_desc));
+    TEST_ASSERT_NOT_EQUAL(0, test_config_desc.seed);
+    TEST_ASSERT_NOT_EQUAL(0, test_limits_desc.seed);
+
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, ref, TEST_DOC_SIZE, NULL, NULL);
+    test_gen_config(&jstr, &test_config);
+    json_gen_str_end(&jstr);
+    json_gen_str_start(&jstr, doc, TEST_DOC_SIZE, NULL, NULL);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_gen(&jstr, &test_config_desc, &test_config));
+    json_gen_str_end(&jstr);
+    TEST_ASSERT_EQUAL_STRING(ref, doc);
+
+    test_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str(doc, strlen(doc), &test_config_desc, &cfg));
+    test_assert_config(&test_config, &cfg);
+
+    /* As a member, with the document indexed */
+    json_gen_str_start(&jstr, ref, TEST_DOC_SIZE, NULL, NULL);
+    json_gen_start_object(&jstr);
+    json_gen_obj_set_int(&jstr, "version", 2);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_gen_obj(&jstr, "config", &test_config_desc, &test_config));
+    json_gen_end_object(&jstr);
+    json_gen_str_end(&jstr);
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, ref, strlen(ref)));
+    void *arena = malloc(json_parse_index_size(&jctx));
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, json_parse_index_size(&jctx)));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(&jctx, "config"));
+    memset(&cfg, 0, sizeof(cfg));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse(&jctx, &test_config_desc, &cfg));
+    test_assert_config(&test_config, &cfg);
+    json_obj_leave_object(&jctx);
+    json_parse_end(&jctx);
+    free(arena);
+
+    free(ref);
+    free(doc);
+}
+
+TEST_CASE("json_bind members and errors", "[json_bind]")
+{
+    test_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.port = 1234;
+    cfg.limits.retries = 7;
+    /* Any order, unknown members of any type, null and missing members */
+    static const char doc[] = "{ \"limits\": { \"unit\": \"F\", \"extra\": [1, {\"id\": 5}] },"
+                              " \"unknown\": {\"id\": 9, \"name\": \"x\"}, \"id\": 17,"
+                              " \"name\": \"node\", \"port\": null, \"wifi\": true, \"lat\": -1.25,"
+                              " \"list\": [\"id\", 3], \"uptime\": 9007199254740993 }";
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str(doc, strlen(doc), &test_config_desc, &cfg));
+    TEST_ASSERT_EQUAL(17, cfg.id);
+    TEST_ASSERT_EQUAL_STRING("node", cfg.name);
+    TEST_ASSERT_EQUAL(1234, cfg.port);
+    TEST_ASSERT_TRUE(cfg.wifi);
+    TEST_ASSERT_EQUAL_FLOAT(-1.25f, cfg.lat);
+    TEST_ASSERT_TRUE(cfg.uptime == 9007199254740993LL);
+    TEST_ASSERT_EQUAL_STRING("F", cfg.limits.unit);
+    TEST_ASSERT_EQUAL(7, cfg.limits.retries);
+
+    /* null leaves a field of any type as it is */
+    static const char null_doc[] = "{\"id\": null, \"name\": null, \"uptime\": null, \"wifi\": null,"
+                                   " \"lat\": null, \"limits\": null}";
+    test_config_t before;
+    memcpy(&before, &cfg, sizeof(cfg));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str(null_doc, strlen(null_doc), &test_config_desc, &cfg));
+    TEST_ASSERT_EQUAL_MEMORY(&before, &cfg, sizeof(cfg));
+    static const char nested_null_doc[] = "{\"limits\": {\"unit\": null, \"retries\": null}}";
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str(nested_null_doc, strlen(nested_null_doc), &test_config_desc, &cfg));
+    TEST_ASSERT_EQUAL_MEMORY(&before, &cfg, sizeof(cfg));
+
+    /* Wrong types and a string, which does not fit */
+    static const char *const bad_docs[] = {
+        "{\"id\": \"17\"}", "{\"name\": 5}", "{\"wifi\": 2}", "{\"lat\": true}", "{\"limits\": [1]}",
+        "{\"limits\": {\"retries\": {}}}", "{\"model\": \"longer than 15 bytes\"}", "[1, 2]",
+    };
+    for (int i = 0; i < sizeof(bad_docs) / sizeof(bad_docs[0]); i++) {
+        TEST_ASSERT_EQUAL(-OS_FAIL, json_bind_parse_str(bad_docs[i], strlen(bad_docs[i]), &test_config_desc, &cfg));
+    }
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_bind_parse_str("{", 1, &test_config_desc, &cfg));
+
+    /* A field, which does not match its type */
+    static const json_bind_field_t bad_fields[] = {
+        JSON_BIND_FIELD("uptime", test_config_t, uptime, JSON_BIND_INT),
+    };
+    json_bind_desc_t bad_desc = JSON_BIND_DESC(bad_fields);
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_bind_compile(&bad_desc));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_bind_parse_str("{}", 2, &bad_desc, &cfg));
+}
+
+TEST_CASE("json_bind without the perfect hash", "[json_bind]")
+{
+    /* More fields than JSON_BIND_HASH_FIELDS, the keys are compared one after another */
+    static const char *const keys[TEST_LARGE_FIELDS] = {
+        "k0", "k1", "k2", "k3", "k4", "k5", "k6", "k7", "k8", "k9", "k10", "k11", "k12", "k13",
+        "k14", "k15", "k16", "k17", "k18", "k19", "k20", "k21", "k22", "k23", "k24", "k25", "k26",
+        "k27", "k28", "k29", "k30", "k31", "k32", "k33", "k34", "k35", "k36", "k37", "k38", "k39",
+    };
+    typedef struct {
+        int val[TEST_LARGE_FIELDS];
+    } test_large_t;
+    json_bind_field_t fields[TEST_LARGE_FIELDS];
+    for (int i = 0; i < TEST_LARGE_FIELDS; i++) {
+        fields[i] = (json_bind_field_t) {
+            keys[i], JSON_BIND_INT, offsetof(test_large_t, val) + i * sizeof(int), sizeof(int), NULL
+        };
+    }
+    json_bind_desc_t desc = JSON_BIND_DESC(fields);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_compile(&desc));
+    TEST_ASSERT_EQUAL(0, desc.seed);
+
+    test_large_t in, out;
+    for (int i = 0; i < TEST_LARGE_FIELDS; i++) {
+        in.val[i] = i * 1000 - 7;
+    }
+    char doc[TEST_DOC_SIZE];
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, doc, sizeof(doc), NULL, NULL);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_gen(&jstr, &desc, &in));
+    json_gen_str_end(&jstr);
+    memset(&out, 0, sizeof(out));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str(doc, strlen(doc), &desc, &out));
+    TEST_ASSERT_EQUAL_MEMORY(&in, &out, sizeof(in));
+    /* A key, which is the start of another one */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse_str("{\"k\": \"x\", \"k3x\": \"x\"}", 23, &desc, &out));
+}
+
+TEST_CASE("json_bind benchmark", "[json_bind][benchmark]")
+{
+    char *doc = malloc(TEST_DOC_SIZE);
+    TEST_ASSERT_NOT_NULL(doc);
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, doc, TEST_DOC_SIZE, NULL, NULL);
+    json_bind_gen(&jstr, &test_config_desc, &test_config);
+    const int len = json_gen_str_end(&jstr) - 1;
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, doc, len));
+    const size_t arena_size = json_parse_index_size(&jctx);
+    void *arena = malloc(arena_size);
+    TEST_ASSERT_NOT_NULL(arena);
+
+    test_config_t cfg;
+    uint64_t per_field_time = 0;
+    uint64_t bind_time = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_parse_config(&jctx, &cfg));
+        per_field_time += test_benchmark_now() - start;
+
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_bind_parse(&jctx, &test_config_desc, &cfg));
+        bind_time += test_benchmark_now() - start;
+    }
+    test_assert_config(&test_config, &cfg);
+
+    /* The per-field API on an indexed document, the index is built once */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, arena_size));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_parse_config(&jctx, &cfg));
+    uint64_t indexed_time = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        const uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_parse_config(&jctx, &cfg));
+        indexed_time += test_benchmark_now() - start;
+    }
+    json_parse_end(&jctx);
+    printf("Parse 30 fields from %d bytes: json_obj_get_*() %" PRIu64 ", indexed json_obj_get_*() %" PRIu64
+           ", json_bind_parse() %" PRIu64 " " TEST_BENCHMARK_UNIT "\n", len,
+           per_field_time / TEST_BENCHMARK_ITERATIONS, indexed_time / TEST_BENCHMARK_ITERATIONS,
+           bind_time / TEST_BENCHMARK_ITERATIONS);
+
+    uint64_t gen_time = 0;
+    bind_time = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        uint64_t start = test_benchmark_now();
+        json_gen_str_start(&jstr, doc, TEST_DOC_SIZE, NULL, NULL);
+        test_gen_config(&jstr, &test_config);
+        json_gen_str_end(&jstr);
+        gen_time += test_benchmark_now() - start;
+
+        start = test_benchmark_now();
+        json_gen_str_start(&jstr, doc, TEST_DOC_SIZE, NULL, NULL);
+        json_bind_gen(&jstr, &test_config_desc, &test_config);
+        json_gen_str_end(&jstr);
+        bind_time += test_benchmark_now() - start;
+    }
+    printf("Generate 30 fields: json_gen_obj_set_*() %" PRIu64 ", json_bind_gen() %" PRIu64 " " TEST_BENCHMARK_UNIT "\n",
+           gen_time / TEST_BENCHMARK_ITERATIONS, bind_time / TEST_BENCHMARK_ITERATIONS);
+
+    free(arena);
+    free(doc);
+}
@@ -38,6 +38,14 @@ extern "C"
 #define JSON_FLOAT_PRECISION 5
 #endif
 
+/** Formats of float values, see json_gen_str_set_float_format() */
+typedef enum {
+    /** JSON_FLOAT_PRECISION digits after the decimal point, e.g. 0.10000 (default) */
+    JSON_GEN_FLOAT_FIXED = 0,
+    /** The fewest digits which are read back as the same float, e.g. 0.1 */
+    JSON_GEN_FLOAT_SHORTEST,
+} json_gen_float_format_t;
+
 /** JSON string flush callback prototype
  *
  * This is a prototype of the function that needs to be passed to
@@ -50,6 +58,35 @@ extern "C"
  */
 typedef void (*json_gen_flush_cb_t)(char *buf, void *priv);
 
+/** JSON string send callback prototype
+ *
+ * This is a prototype of the function that needs to be passed to
+ * json_gen_str_start_double_buffered(). It hands a full buffer over to the
+ * transport, and the generator continues in the other half of the double buffer.
+ * The buffer must not be written to by the generator, so it should be queued
+ * for sending rather than sent from this function, and the send completion
+ * reported through \ref json_gen_wait_cb_t.
+ *
+ * \param[in] buf Pointer to the data to send. It is also NULL terminated.
+ * \param[in] len Length of the data. Can be 0 for the last buffer.
+ * \param[in] last true for the last buffer of the JSON string, passed on json_gen_str_end()
+ * \param[in] priv Private data passed to json_gen_str_start_double_buffered()
+ */
+typedef void (*json_gen_send_cb_t)(char *buf, int len, bool last, void *priv);
+
+/** JSON string send completion callback prototype
+ *
+ * This is a prototype of the function that needs to be passed to
+ * json_gen_str_start_double_buffered(). It should block until the transport is
+ * done with a buffer passed to the \ref json_gen_send_cb_t before. It is called
+ * once for every buffer sent, before the buffer is written to again and, for the
+ * last two, on json_gen_str_end().
+ *
+ * \param[in] buf Pointer to the buffer the generator waits for
+ * \param[in] priv Private data passed to json_gen_str_start_double_buffered()
+ */
+typedef void (*json_gen_wait_cb_t)(char *buf, void *priv);
+
 /** JSON String structure
  *
  * Please do not set/modify any elements.
@@ -70,6 +107,18 @@ typedef struct {
     char *free_ptr;
     /** Total length */
     int total_len;
+    /** (For Internal use only) */
+    json_gen_float_format_t float_format;
+    /** (For Internal use only) */
+    bool escape;
+    /** (Optional) callback function to hand a full buffer over to the transport */
+    json_gen_send_cb_t send_cb;
+    /** (Optional) callback function to wait for the transport to be done with a buffer */
+    json_gen_wait_cb_t wait_cb;
+    /** (For Internal use only) */
+    char *other_buf;
+    /** (For Internal use only) */
+    bool other_busy;
 } json_gen_str_t;
 
 /** Start a JSON String
@@ -93,10 +142,64 @@ typedef struct {
 void json_gen_str_start(json_gen_str_t *jstr, char *buf, int buf_size,
                         json_gen_flush_cb_t flush_cb, void *priv);
 
+/** Start a double buffered JSON String
+ *
+ * This is an alternative to json_gen_str_start() for sending a JSON string out
+ * while it is being generated, e.g. to a socket or an HTTP/2 stream. The buffer is
+ * split into two halves. When one is full, it is handed over to the transport with
+ * send_cb and the generator continues in the other one. The generator only waits,
+ * with wait_cb, if the transport is still sending the other one, so generation
+ * and transmission overlap.
+ *
+ * \param[out] jstr Pointer to an allocated \ref json_gen_str_t structure.
+ * This will be initialised internally and needs to be passed to all
+ * subsequent function calls
+ * \param[out] buf Pointer to an allocated buffer for both halves. It must not be
+ * freed before json_gen_str_end() returns.
+ * \param[in] buf_size Size of the buffer. Each half gets buf_size / 2 bytes,
+ * including the NULL termination.
+ * \param[in] send_cb Pointer to the function of type \ref json_gen_send_cb_t
+ * which hands a full buffer over to the transport
+ * \param[in] wait_cb Pointer to the function of type \ref json_gen_wait_cb_t
+ * which waits until the transport is done with a buffer
+ * \param[in] priv Private data to be passed to the callbacks. Can be left NULL.
+ */
+void json_gen_str_start_double_buffered(json_gen_str_t *jstr, char *buf, int buf_size,
+                                        json_gen_send_cb_t send_cb, json_gen_wait_cb_t wait_cb,
+                                        void *priv);
+
+/** Set the format of float values
+ *
+ * Floats are written with JSON_FLOAT_PRECISION digits after the decimal point
+ * by default. With \ref JSON_GEN_FLOAT_SHORTEST, they are written with the fewest
+ * digits which are read back as the same float, e.g. 0.1 instead of 0.10000.
+ * Values below 1e-5 and above 1e7 then use an exponent, e.g. 1.5e-07, and
+ * are not rounded to 0.00000.
+ *
+ * \param[in] jstr Pointer to the \ref json_gen_str_t structure initialised by json_gen_str_start()
+ * \param[in] format Format of the float values added after this call
+ */
+void json_gen_str_set_float_format(json_gen_str_t *jstr, json_gen_float_format_t format);
+
+/** Escape the strings
+ *
+ * Names, string values and long string parts are added verbatim by default,
+ * so they have to be escaped by the caller if required. With escaping enabled,
+ * '"', '\\' and the control characters in them are escaped by the generator,
+ * e.g. a newline as \\n and 0x01 as \\u0001. Other bytes, including UTF-8,
+ * are added as they are. The object and array strings passed to
+ * json_gen_push_object_str() and json_gen_push_array_str() are never escaped.
+ *
+ * \param[in] jstr Pointer to the \ref json_gen_str_t structure initialised by json_gen_str_start()
+ * \param[in] escape true to escape the strings added after this call
+ */
+void json_gen_str_set_escaping(json_gen_str_t *jstr, bool escape);
+
 /** End JSON string
  *
  * This should be the last function to be called after the entire JSON string
- * has been generated.
+ * has been generated. For a double buffered JSON string, this sends out the
+ * last buffer and waits until the transport is done with both halves.
  *
  * \param[in] jstr Pointer to the \ref json_gen_str_t structure initialised by
  * json_gen_str_start()
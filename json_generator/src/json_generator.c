@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdlib.h>
 #include <inttypes.h>
 
 #include <json_generator.h>
@@ -26,44 +27,72 @@
 #define MAX_INT64_IN_STR    24
 #define MAX_FLOAT_IN_STR    30
 
+/* Appends a string literal without a strlen() */
+#define json_gen_add_literal(jstr, str) json_gen_add_to_str_len(jstr, str, sizeof(str) - 1)
+
 static inline int json_gen_get_empty_len(json_gen_str_t *jstr)
 {
     return (jstr->buf_size - (jstr->free_ptr - jstr->buf) - 1);
 }
 
+/* Flushes out the buffer. With a send callback, the buffer is handed over
+ * and the other half of the double buffer is used next, once the transport
+ * is done with it.
+ */
+static void json_gen_flush(json_gen_str_t *jstr, bool last)
+{
+    *jstr->free_ptr = '\0';
+    if (!jstr->send_cb) {
+        jstr->flush_cb(jstr->buf, jstr->priv);
+        jstr->free_ptr = jstr->buf;
+        return;
+    }
+    jstr->send_cb(jstr->buf, jstr->free_ptr - jstr->buf, last, jstr->priv);
+    char *sent_buf = jstr->buf;
+    jstr->buf = jstr->other_buf;
+    jstr->other_buf = sent_buf;
+    if (jstr->other_busy) {
+        jstr->wait_cb(jstr->buf, jstr->priv);
+    }
+    jstr->other_busy = true;
+    jstr->free_ptr = jstr->buf;
+}
+
 /* This will add the incoming string to the JSON string buffer
  * and flush it out if the buffer is full. Note that the data being
  * flushed out will always be equal to the size of the buffer unless
  * this is the last chunk being flushed out on json_gen_end_str()
  */
-static int json_gen_add_to_str(json_gen_str_t *jstr, const char *str)
+static int json_gen_add_to_str_len(json_gen_str_t *jstr, const char *str, int len)
 {
-    if (!str) {
-        return 0;
-    }
-    int len = strlen(str);
     jstr->total_len += len;
     if (jstr->buf == NULL) {
         return 0;
     }
+    /* Fast path, the whole string fits */
+    int len_remaining = json_gen_get_empty_len(jstr);
+    if (len <= len_remaining) {
+        memcpy(jstr->free_ptr, str, len);
+        jstr->free_ptr += len;
+        return 0;
+    }
     const char *cur_ptr = str;
     while (1) {
-        int len_remaining = json_gen_get_empty_len(jstr);
         int copy_len = len_remaining > len ? len : len_remaining;
-        memmove(jstr->free_ptr, cur_ptr, copy_len);
+        memcpy(jstr->free_ptr, cur_ptr, copy_len);
         cur_ptr += copy_len;
         jstr->free_ptr += copy_len;
         len -= copy_len;
         if (len) {
-            *jstr->free_ptr = '\0';
             /* Report error if the buffer is full and no flush callback
              * is registered
              */
-            if (!jstr->flush_cb) {
+            if (!jstr->flush_cb && !jstr->send_cb) {
+                *jstr->free_ptr = '\0';
                 return -1;
             }
-            jstr->flush_cb(jstr->buf, jstr->priv);
-            jstr->free_ptr = jstr->buf;
+            json_gen_flush(jstr, false);
+            len_remaining = json_gen_get_empty_len(jstr);
         } else {
             break;
         }
@@ -71,6 +100,348 @@ static int json_gen_add_to_str(json_gen_str_t *jstr, const char *str)
     return 0;
 }
 
+static int json_gen_add_to_str(json_gen_str_t *jstr, const char *str)
+{
+    if (!str) {
+        return 0;
+    }
+    return json_gen_add_to_str_len(jstr, str, strlen(str));
+}
+
+typedef size_t json_gen_word_t;
+
+#define JSON_GEN_WORD_ONES  ((json_gen_word_t)-1 / 0xff)
+#define JSON_GEN_WORD_LOW7  (JSON_GEN_WORD_ONES * 0x7f)
+#define JSON_GEN_WORD_HIGH  (JSON_GEN_WORD_ONES * 0x80)
+
+/* High bit set in every byte of the word which has to be escaped: control
+ * characters, '"' and '\\'. There are no carries between the bytes, so every
+ * byte is tested exactly.
+ */
+static inline json_gen_word_t json_gen_word_escapes(json_gen_word_t w)
+{
+    /* High bit clear for the bytes below 0x20 */
+    const json_gen_word_t ctrl = ((w & JSON_GEN_WORD_LOW7) + JSON_GEN_WORD_ONES * 0x60) | w;
+    /* High bit clear for the bytes equal to '"' or '\\' */
+    const json_gen_word_t quote = w ^ (JSON_GEN_WORD_ONES * '"');
+    const json_gen_word_t bslash = w ^ (JSON_GEN_WORD_ONES * '\\');
+    return ~(ctrl & (((quote & JSON_GEN_WORD_LOW7) + JSON_GEN_WORD_LOW7) | quote) &
+             (((bslash & JSON_GEN_WORD_LOW7) + JSON_GEN_WORD_LOW7) | bslash)) & JSON_GEN_WORD_HIGH;
+}
+
+static inline bool json_gen_needs_escape(unsigned char c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+/* Length of the run of bytes at the start of str which need no escaping */
+static size_t json_gen_clean_len(const char *str, size_t len)
+{
+    size_t pos = 0;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    json_gen_word_t w;
+    for (; pos + sizeof(w) <= len; pos += sizeof(w)) {
+        memcpy(&w, str + pos, sizeof(w));
+        const json_gen_word_t mask = json_gen_word_escapes(w);
+        if (mask) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return pos + __builtin_ctzll(mask) / 8;
+#else
+            return pos + __builtin_clzll(mask) / 8 - (8 - sizeof(w));
+#endif
+        }
+    }
+#endif
+    while (pos < len && !json_gen_needs_escape(str[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+/* Adds str escaped as the body of a JSON string. The runs between the
+ * bytes to escape are copied as a whole, across flushes if required.
+ */
+static int json_gen_add_escaped(json_gen_str_t *jstr, const char *str)
+{
+    if (!str) {
+        return 0;
+    }
+    static const char hex[] = "0123456789abcdef";
+    size_t len = strlen(str);
+    int ret = 0;
+    while (len) {
+        const size_t clean_len = json_gen_clean_len(str, len);
+        if (clean_len) {
+            if (json_gen_add_to_str_len(jstr, str, clean_len)) {
+                ret = -1;
+            }
+            str += clean_len;
+            len -= clean_len;
+            if (!len) {
+                break;
+            }
+        }
+        char esc[6] = { '\\', *str, '0', '0', '0', '0' };
+        int esc_len = 2;
+        switch (*str) {
+        case '"':
+        case '\\':
+            break;
+        case '\b':
+            esc[1] = 'b';
+            break;
+        case '\f':
+            esc[1] = 'f';
+            break;
+        case '\n':
+            esc[1] = 'n';
+            break;
+        case '\r':
+            esc[1] = 'r';
+            break;
+        case '\t':
+            esc[1] = 't';
+            break;
+        default:
+            esc[1] = 'u';
+            esc[4] = hex[(unsigned char)*str >> 4];
+            esc[5] = hex[*str & 0xf];
+            esc_len = 6;
+            break;
+        }
+        if (json_gen_add_to_str_len(jstr, esc, esc_len)) {
+            ret = -1;
+        }
+        str++;
+        len--;
+    }
+    return ret;
+}
+
+/* Adds the body of a JSON string, escaped if enabled with json_gen_str_set_escaping() */
+static inline int json_gen_add_string(json_gen_str_t *jstr, const char *str)
+{
+    if (jstr->escape) {
+        return json_gen_add_escaped(jstr, str);
+    }
+    return json_gen_add_to_str(jstr, str);
+}
+
+/* Returns where a value of up to len bytes can be formatted in place,
+ * or NULL if it has to go through json_gen_add_to_str_len()
+ */
+static inline char *json_gen_reserve(json_gen_str_t *jstr, int len)
+{
+    if (jstr->buf == NULL || json_gen_get_empty_len(jstr) < len) {
+        return NULL;
+    }
+    return jstr->free_ptr;
+}
+
+/* Commits len bytes formatted at out, which is either the pointer
+ * returned by json_gen_reserve() or a temporary buffer
+ */
+static inline int json_gen_commit(json_gen_str_t *jstr, const char *out, int len)
+{
+    if (out != jstr->free_ptr) {
+        return json_gen_add_to_str_len(jstr, out, len);
+    }
+    jstr->free_ptr += len;
+    jstr->total_len += len;
+    return 0;
+}
+
+static const char json_gen_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline int json_gen_u32_len(uint32_t val)
+{
+    if (val < 100000) {
+        return val < 10 ? 1 : val < 100 ? 2 : val < 1000 ? 3 : val < 10000 ? 4 : 5;
+    }
+    return val < 1000000 ? 6 : val < 10000000 ? 7 : val < 100000000 ? 8 : val < 1000000000 ? 9 : 10;
+}
+
+/* Writes the digits of val backwards, ending just before end */
+static inline void json_gen_u32_write(char *end, uint32_t val)
+{
+    while (val >= 100) {
+        const char *pair = &json_gen_digit_pairs[(val % 100) * 2];
+        val /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (val >= 10) {
+        *--end = json_gen_digit_pairs[val * 2 + 1];
+        *--end = json_gen_digit_pairs[val * 2];
+    } else {
+        *--end = '0' + val;
+    }
+}
+
+/* Writes exactly num_digits digits of val, with leading zeros */
+static inline void json_gen_u32_write_fixed(char *out, uint32_t val, int num_digits)
+{
+    char *end = out + num_digits;
+    while (end > out) {
+        *--end = '0' + val % 10;
+        val /= 10;
+    }
+}
+
+static int json_gen_u64_to_str(char *out, uint64_t val)
+{
+    if (val <= UINT32_MAX) {
+        int len = json_gen_u32_len(val);
+        json_gen_u32_write(out + len, val);
+        return len;
+    }
+    /* 64 bit divisions are slow on 32 bit targets, so only split off 8 digits at a time */
+    int len = json_gen_u64_to_str(out, val / 100000000);
+    json_gen_u32_write_fixed(out + len, val % 100000000, 8);
+    return len + 8;
+}
+
+static int json_gen_int64_to_str(char *out, int64_t val)
+{
+    if (val < 0) {
+        *out = '-';
+        return json_gen_u64_to_str(out + 1, -(uint64_t)val) + 1;
+    }
+    return json_gen_u64_to_str(out, val);
+}
+
+static const double json_gen_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12
+};
+
+/* A float times 10^n with n <= 12 is exact in a double: 24 bits of mantissa
+ * and at most 29 bits of 5^n. Whatever is not covered by the exact formatters
+ * below goes through snprintf().
+ */
+#define JSON_GEN_EXACT_POW10_MAX    12
+#define JSON_GEN_DOUBLE_INT_MAX     9007199254740992.0  /* 2^53 */
+
+static inline bool json_gen_float_is_negative(float val)
+{
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return bits >> 31;
+}
+
+/* Writes val as snprintf("%.*f", JSON_FLOAT_PRECISION) does, with the same
+ * round-half-to-even of the exact binary value. Returns -1 for values too
+ * large to be scaled exactly, and for infinities and NaN.
+ */
+static int json_gen_float_to_str_fixed(char *out, float val)
+{
+#if JSON_FLOAT_PRECISION >= 0 && JSON_FLOAT_PRECISION <= JSON_GEN_EXACT_POW10_MAX
+    const bool neg = json_gen_float_is_negative(val);
+    const double abs_val = neg ? -(double)val : (double)val;
+    const double scaled = abs_val * json_gen_pow10[JSON_FLOAT_PRECISION];
+    if (!(scaled < JSON_GEN_DOUBLE_INT_MAX)) {
+        return -1;
+    }
+    uint64_t digits = (uint64_t)scaled;
+    const double frac = scaled - (double)digits;
+    if (frac > 0.5 || (frac == 0.5 && (digits & 1))) {
+        digits++;
+    }
+    char *ptr = out;
+    if (neg) {
+        *ptr++ = '-';
+    }
+#if JSON_FLOAT_PRECISION == 0
+    ptr += json_gen_u64_to_str(ptr, digits);
+#else
+    const uint64_t int_part = digits / (uint64_t)json_gen_pow10[JSON_FLOAT_PRECISION];
+    ptr += json_gen_u64_to_str(ptr, int_part);
+    *ptr++ = '.';
+    json_gen_u32_write_fixed(ptr, digits - int_part * (uint64_t)json_gen_pow10[JSON_FLOAT_PRECISION],
+                             JSON_FLOAT_PRECISION);
+    ptr += JSON_FLOAT_PRECISION;
+#endif
+    return ptr - out;
+#else
+    return -1;
+#endif
+}
+
+/* Writes the fewest digits after the decimal point which are read back as val.
+ * Any decimal closer to val than half the gap to the neighbouring floats rounds
+ * back to val, so this looks for the first scale 10^q at which the nearest integer
+ * is that close. Returns -1 outside of 1e-5 <= |val| < 1e7, where it would need
+ * more than JSON_GEN_EXACT_POW10_MAX digits or an exponent.
+ */
+static int json_gen_float_to_str_shortest(char *out, float val)
+{
+    const bool neg = json_gen_float_is_negative(val);
+    const double abs_val = neg ? -(double)val : (double)val;
+    char *ptr = out;
+    if (neg) {
+        *ptr++ = '-';
+    }
+    if (abs_val == 0) {
+        *ptr++ = '0';
+        return ptr - out;
+    }
+    if (!(abs_val >= 1e-5 && abs_val < 1e7)) {
+        return -1;
+    }
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    const int exp = (bits >> 23) & 0xff;
+    /* Half of the gap to the next float, or a quarter below a power of 2,
+     * where the float below is closer. Built as the double 2^shift.
+     */
+    const int shift = exp - 127 - 23 - 1 - ((bits & 0x7fffff) == 0 ? 1 : 0);
+    const uint64_t half_gap_bits = (uint64_t)(shift + 1023) << 52;
+    double half_gap;
+    memcpy(&half_gap, &half_gap_bits, sizeof(half_gap));
+    for (int q = 0; q <= JSON_GEN_EXACT_POW10_MAX; q++) {
+        const double scaled = abs_val * json_gen_pow10[q];
+        uint64_t digits = (uint64_t)(scaled + 0.5);
+        const double diff = (double)digits - scaled;
+        const double bound = half_gap * json_gen_pow10[q];
+        if (diff < bound && diff > -bound) {
+            if (q == 0) {
+                return ptr - out + json_gen_u64_to_str(ptr, digits);
+            }
+            const uint64_t int_part = digits / (uint64_t)json_gen_pow10[q];
+            ptr += json_gen_u64_to_str(ptr, int_part);
+            *ptr++ = '.';
+            json_gen_u32_write_fixed(ptr, digits - int_part * (uint64_t)json_gen_pow10[q], q);
+            return ptr - out + q;
+        }
+    }
+    return -1;
+}
+
+/* Fallback for json_gen_float_to_str_shortest(), the fewest significant digits
+ * which are read back as val
+ */
+static int json_gen_float_to_str_shortest_slow(char *out, float val)
+{
+    int len = 0;
+    for (int precision = 1; precision <= 9; precision++) {
+        len = snprintf(out, MAX_FLOAT_IN_STR, "%.*g", precision, val);
+        if (strtof(out, NULL) == val) {
+            break;
+        }
+    }
+    return len;
+}
+
 void json_gen_str_start(json_gen_str_t *jstr, char *buf, int buf_size,
                         json_gen_flush_cb_t flush_cb, void *priv)
 {
@@ -82,13 +453,38 @@ void json_gen_str_start(json_gen_str_t *jstr, char *buf, int buf_size,
     jstr->priv = priv;
 }
 
+void json_gen_str_set_float_format(json_gen_str_t *jstr, json_gen_float_format_t format)
+{
+    jstr->float_format = format;
+}
+
+void json_gen_str_set_escaping(json_gen_str_t *jstr, bool escape)
+{
+    jstr->escape = escape;
+}
+
+void json_gen_str_start_double_buffered(json_gen_str_t *jstr, char *buf, int buf_size,
+                                        json_gen_send_cb_t send_cb, json_gen_wait_cb_t wait_cb,
+                                        void *priv)
+{
+    json_gen_str_start(jstr, buf, buf_size / 2, NULL, priv);
+    jstr->other_buf = buf + buf_size / 2;
+    jstr->send_cb = send_cb;
+    jstr->wait_cb = wait_cb;
+}
+
 int json_gen_str_end(json_gen_str_t *jstr)
 {
     int total_len = jstr->total_len;
     if (jstr->buf) {
-        *jstr->free_ptr = '\0';
-        if (jstr->flush_cb) {
-            jstr->flush_cb(jstr->buf, jstr->priv);
+        if (jstr->send_cb) {
+            json_gen_flush(jstr, true);
+            /* Both halves are back from the transport */
+            jstr->wait_cb(jstr->other_buf, jstr->priv);
+        } else if (jstr->flush_cb) {
+            json_gen_flush(jstr, true);
+        } else {
+            *jstr->free_ptr = '\0';
         }
     }
     memset(jstr, 0, sizeof(json_gen_str_t));
@@ -98,41 +494,41 @@ int json_gen_str_end(json_gen_str_t *jstr)
 static inline void json_gen_handle_comma(json_gen_str_t *jstr)
 {
     if (jstr->comma_req) {
-        json_gen_add_to_str(jstr, ",");
+        json_gen_add_literal(jstr, ",");
     }
 }
 
 static int json_gen_handle_name(json_gen_str_t *jstr, const char *name)
 {
-    json_gen_add_to_str(jstr, "\"");
-    json_gen_add_to_str(jstr, name);
-    return json_gen_add_to_str(jstr, "\":");
+    json_gen_add_literal(jstr, "\"");
+    json_gen_add_string(jstr, name);
+    return json_gen_add_literal(jstr, "\":");
 }
 
 int json_gen_start_object(json_gen_str_t *jstr)
 {
     json_gen_handle_comma(jstr);
     jstr->comma_req = false;
-    return json_gen_add_to_str(jstr, "{");
+    return json_gen_add_literal(jstr, "{");
 }
 
 int json_gen_end_object(json_gen_str_t *jstr)
 {
     jstr->comma_req = true;
-    return json_gen_add_to_str(jstr, "}");
+    return json_gen_add_literal(jstr, "}");
 }
 
 int json_gen_start_array(json_gen_str_t *jstr)
 {
     json_gen_handle_comma(jstr);
     jstr->comma_req = false;
-    return json_gen_add_to_str(jstr, "[");
+    return json_gen_add_literal(jstr, "[");
 }
 
 int json_gen_end_array(json_gen_str_t *jstr)
 {
     jstr->comma_req = true;
-    return json_gen_add_to_str(jstr, "]");
+    return json_gen_add_literal(jstr, "]");
 }
 
 int json_gen_push_object(json_gen_str_t *jstr, const char *name)
@@ -140,13 +536,13 @@ int json_gen_push_object(json_gen_str_t *jstr, const char *name)
     json_gen_handle_comma(jstr);
     json_gen_handle_name(jstr, name);
     jstr->comma_req = false;
-    return json_gen_add_to_str(jstr, "{");
+    return json_gen_add_literal(jstr, "{");
 }
 
 int json_gen_pop_object(json_gen_str_t *jstr)
 {
     jstr->comma_req = true;
-    return json_gen_add_to_str(jstr, "}");
+    return json_gen_add_literal(jstr, "}");
 }
 
 int json_gen_push_object_str(json_gen_str_t *jstr, const char *name, const char *object_str)
@@ -162,12 +558,12 @@ int json_gen_push_array(json_gen_str_t *jstr, const char *name)
     json_gen_handle_comma(jstr);
     json_gen_handle_name(jstr, name);
     jstr->comma_req = false;
-    return json_gen_add_to_str(jstr, "[");
+    return json_gen_add_literal(jstr, "[");
 }
 int json_gen_pop_array(json_gen_str_t *jstr)
 {
     jstr->comma_req = true;
-    return json_gen_add_to_str(jstr, "]");
+    return json_gen_add_literal(jstr, "]");
 }
 
 int json_gen_push_array_str(json_gen_str_t *jstr, const char *name, const char *array_str)
@@ -182,9 +578,9 @@ static int json_gen_set_bool(json_gen_str_t *jstr, bool val)
 {
     jstr->comma_req = true;
     if (val) {
-        return json_gen_add_to_str(jstr, "true");
+        return json_gen_add_literal(jstr, "true");
     } else {
-        return json_gen_add_to_str(jstr, "false");
+        return json_gen_add_literal(jstr, "false");
     }
 }
 int json_gen_obj_set_bool(json_gen_str_t *jstr, const char *name, bool val)
@@ -204,8 +600,11 @@ static int json_gen_set_int(json_gen_str_t *jstr, int val)
 {
     jstr->comma_req = true;
     char str[MAX_INT_IN_STR];
-    snprintf(str, MAX_INT_IN_STR, "%d", val);
-    return json_gen_add_to_str(jstr, str);
+    char *out = json_gen_reserve(jstr, MAX_INT_IN_STR);
+    if (!out) {
+        out = str;
+    }
+    return json_gen_commit(jstr, out, json_gen_int64_to_str(out, val));
 }
 
 int json_gen_obj_set_int(json_gen_str_t *jstr, const char *name, int val)
@@ -225,8 +624,11 @@ static int json_gen_set_int64(json_gen_str_t *jstr, int64_t val)
 {
     jstr->comma_req = true;
     char str[MAX_INT64_IN_STR];
-    snprintf(str, MAX_INT64_IN_STR, "%" PRId64, val);
-    return json_gen_add_to_str(jstr, str);
+    char *out = json_gen_reserve(jstr, MAX_INT64_IN_STR);
+    if (!out) {
+        out = str;
+    }
+    return json_gen_commit(jstr, out, json_gen_int64_to_str(out, val));
 }
 
 int json_gen_obj_set_int64(json_gen_str_t *jstr, const char *name, int64_t val)
@@ -246,8 +648,27 @@ static int json_gen_set_float(json_gen_str_t *jstr, float val)
 {
     jstr->comma_req = true;
     char str[MAX_FLOAT_IN_STR];
-    snprintf(str, MAX_FLOAT_IN_STR, "%.*f", JSON_FLOAT_PRECISION, val);
-    return json_gen_add_to_str(jstr, str);
+    char *out = json_gen_reserve(jstr, MAX_FLOAT_IN_STR);
+    if (!out) {
+        out = str;
+    }
+    int len;
+    if (jstr->float_format == JSON_GEN_FLOAT_SHORTEST) {
+        len = json_gen_float_to_str_shortest(out, val);
+        if (len < 0) {
+            len = json_gen_float_to_str_shortest_slow(out, val);
+        }
+    } else {
+        len = json_gen_float_to_str_fixed(out, val);
+        if (len < 0) {
+            len = snprintf(out, MAX_FLOAT_IN_STR, "%.*f", JSON_FLOAT_PRECISION, val);
+        }
+    }
+    /* Values too large for the buffer are truncated */
+    if (len >= MAX_FLOAT_IN_STR) {
+        len = MAX_FLOAT_IN_STR - 1;
+    }
+    return json_gen_commit(jstr, out, len);
 }
 int json_gen_obj_set_float(json_gen_str_t *jstr, const char *name, float val)
 {
@@ -264,9 +685,9 @@ int json_gen_arr_set_float(json_gen_str_t *jstr, float val)
 static int json_gen_set_string(json_gen_str_t *jstr, const char *val)
 {
     jstr->comma_req = true;
-    json_gen_add_to_str(jstr, "\"");
-    json_gen_add_to_str(jstr, val);
-    return json_gen_add_to_str(jstr, "\"");
+    json_gen_add_literal(jstr, "\"");
+    json_gen_add_string(jstr, val);
+    return json_gen_add_literal(jstr, "\"");
 }
 
 int json_gen_obj_set_string(json_gen_str_t *jstr, const char *name, const char *val)
@@ -285,8 +706,8 @@ int json_gen_arr_set_string(json_gen_str_t *jstr, const char *val)
 static int json_gen_set_long_string(json_gen_str_t *jstr, const char *val)
 {
     jstr->comma_req = true;
-    json_gen_add_to_str(jstr, "\"");
-    return json_gen_add_to_str(jstr, val);
+    json_gen_add_literal(jstr, "\"");
+    return json_gen_add_string(jstr, val);
 }
 
 int json_gen_obj_start_long_string(json_gen_str_t *jstr, const char *name, const char *val)
@@ -304,17 +725,17 @@ int json_gen_arr_start_long_string(json_gen_str_t *jstr, const char *val)
 
 int json_gen_add_to_long_string(json_gen_str_t *jstr, const char *val)
 {
-    return json_gen_add_to_str(jstr, val);
+    return json_gen_add_string(jstr, val);
 }
 
 int json_gen_end_long_string(json_gen_str_t *jstr)
 {
-    return json_gen_add_to_str(jstr, "\"");
+    return json_gen_add_literal(jstr, "\"");
 }
 static int json_gen_set_null(json_gen_str_t *jstr)
 {
     jstr->comma_req = true;
-    return json_gen_add_to_str(jstr, "null");
+    return json_gen_add_literal(jstr, "null");
 }
 int json_gen_obj_set_null(json_gen_str_t *jstr, const char *name)
 {
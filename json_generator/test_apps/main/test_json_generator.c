@@ -0,0 +1,565 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+#include "json_generator.h"
+
+#define TEST_NUMBER_ITERATIONS      20000
+#define TEST_TELEMETRY_SAMPLES      450
+#define TEST_TELEMETRY_SIZE         (64 * 1024)
+#define TEST_FLUSH_BUF_SIZE         1024
+#define TEST_BENCHMARK_ITERATIONS   20
+#define TEST_ESCAPE_ITERATIONS      500
+#define TEST_ESCAPE_STR_SIZE        96
+#define TEST_LOG_MESSAGES           200
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/* xorshift32, the same values on every run */
+static uint32_t test_rand_state;
+
+static uint32_t test_rand(void)
+{
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+    return test_rand_state;
+}
+
+/* Collects the flushed chunks of a document */
+typedef struct {
+    char *doc;
+    size_t len;
+    size_t size;
+} test_sink_t;
+
+static void test_sink_flush(char *buf, void *priv)
+{
+    test_sink_t *sink = (test_sink_t *)priv;
+    size_t len = strlen(buf);
+    TEST_ASSERT_LESS_THAN(sink->size, sink->len + len);
+    memcpy(sink->doc + sink->len, buf, len + 1);
+    sink->len += len;
+}
+
+/* Generates a single value and returns it in out */
+static void test_gen_float(char *out, size_t size, float val, json_gen_float_format_t format)
+{
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, out, size, NULL, NULL);
+    json_gen_str_set_float_format(&jstr, format);
+    TEST_ASSERT_EQUAL(0, json_gen_arr_set_float(&jstr, val));
+    json_gen_str_end(&jstr);
+}
+
+static void test_gen_int64(char *out, size_t size, int64_t val)
+{
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, out, size, NULL, NULL);
+    TEST_ASSERT_EQUAL(0, json_gen_arr_set_int64(&jstr, val));
+    json_gen_str_end(&jstr);
+}
+
+static void test_gen_int(char *out, size_t size, int val)
+{
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, out, size, NULL, NULL);
+    TEST_ASSERT_EQUAL(0, json_gen_arr_set_int(&jstr, val));
+    json_gen_str_end(&jstr);
+}
+
+static void test_gen_document(json_gen_str_t *jstr)
+{
+    json_gen_start_object(jstr);
+    json_gen_obj_set_bool(jstr, "on", true);
+    json_gen_obj_set_int(jstr, "min", INT_MIN);
+    json_gen_obj_set_int64(jstr, "ts", INT64_MAX);
+    json_gen_obj_set_float(jstr, "temp", -12.25f);
+    json_gen_obj_set_string(jstr, "name", "node");
+    json_gen_obj_set_null(jstr, "none");
+    json_gen_push_object(jstr, "obj");
+    json_gen_obj_start_long_string(jstr, "long", "first");
+    json_gen_add_to_long_string(jstr, " second");
+    json_gen_end_long_string(jstr);
+    json_gen_pop_object(jstr);
+    json_gen_push_array(jstr, "arr");
+    json_gen_arr_set_bool(jstr, false);
+    json_gen_arr_set_int(jstr, 0);
+    json_gen_arr_set_int64(jstr, -1);
+    json_gen_str_set_float_format(jstr, JSON_GEN_FLOAT_SHORTEST);
+    json_gen_arr_set_float(jstr, 0.1f);
+    json_gen_arr_set_float(jstr, 1.5e-7f);
+    json_gen_str_set_float_format(jstr, JSON_GEN_FLOAT_FIXED);
+    json_gen_arr_set_float(jstr, 0.1f);
+    json_gen_arr_set_string(jstr, "s");
+    json_gen_arr_set_null(jstr);
+    json_gen_start_object(jstr);
+    json_gen_end_object(jstr);
+    json_gen_start_array(jstr);
+    json_gen_end_array(jstr);
+    json_gen_pop_array(jstr);
+    json_gen_push_object_str(jstr, "raw_obj", "{\"x\":1}");
+    json_gen_push_array_str(jstr, "raw_arr", "[1,2]");
+    json_gen_end_object(jstr);
+}
+
+static const char test_document[] =
+    "{\"on\":true,\"min\":-2147483648,\"ts\":9223372036854775807,\"temp\":-12.25000,"
+    "\"name\":\"node\",\"none\":null,\"obj\":{\"long\":\"first second\"},"
+    "\"arr\":[false,0,-1,0.1,1.5e-07,0.10000,\"s\",null,{},[]],"
+    "\"raw_obj\":{\"x\":1},\"raw_arr\":[1,2]}";
+
+TEST_CASE("json_generator document", "[json_generator]")
+{
+    char buf[sizeof(test_document) + 32];
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, buf, sizeof(buf), NULL, NULL);
+    test_gen_document(&jstr);
+    TEST_ASSERT_EQUAL(sizeof(test_document), json_gen_str_end(&jstr));
+    TEST_ASSERT_EQUAL_STRING(test_document, buf);
+
+    /* Length only */
+    json_gen_str_start(&jstr, NULL, 0, NULL, NULL);
+    test_gen_document(&jstr);
+    TEST_ASSERT_EQUAL(sizeof(test_document), json_gen_str_end(&jstr));
+
+    /* Out of space without a flush callback */
+    json_gen_str_start(&jstr, buf, 8, NULL, NULL);
+    TEST_ASSERT_EQUAL(0, json_gen_start_object(&jstr));
+    TEST_ASSERT_EQUAL(-1, json_gen_obj_set_string(&jstr, "name", "node"));
+    json_gen_str_end(&jstr);
+}
+
+TEST_CASE("json_generator flushes every buffer size", "[json_generator]")
+{
+    char out[sizeof(test_document)];
+    char buf[64];
+    for (int buf_size = 2; buf_size <= sizeof(buf); buf_size++) {
+        test_sink_t sink = { .doc = out, .size = sizeof(out) };
+        json_gen_str_t jstr;
+        json_gen_str_start(&jstr, buf, buf_size, test_sink_flush, &sink);
+        test_gen_document(&jstr);
+        TEST_ASSERT_EQUAL(sizeof(test_document), json_gen_str_end(&jstr));
+        TEST_ASSERT_EQUAL_STRING(test_document, out);
+    }
+}
+
+TEST_CASE("json_generator numbers are the same as printf", "[json_generator]")
+{
+    char out[64];
+    char ref[64];
+    static const int64_t ints[] = {
+        0, 1, -1, 9, 10, 99, 100, 4294967295LL, 4294967296LL, 99999999999LL,
+        100000000000LL, INT64_MAX, INT64_MIN, INT64_MIN + 1,
+    };
+    for (int i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        snprintf(ref, sizeof(ref), "%" PRId64, ints[i]);
+        test_gen_int64(out, sizeof(out), ints[i]);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+    }
+    snprintf(ref, sizeof(ref), "%d", INT_MIN);
+    test_gen_int(out, sizeof(out), INT_MIN);
+    TEST_ASSERT_EQUAL_STRING(ref, out);
+
+    static const float floats[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.1f, 0.000005f, 0.000015f, 0.000025f, -0.000001f,
+        0.5f, 2.5f, 123456.789f, 1e7f, 1e10f, 1e11f, 3.4e38f, 1e-30f,
+    };
+    for (int i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        snprintf(ref, sizeof(ref), "%.*f", JSON_FLOAT_PRECISION, floats[i]);
+        ref[29] = '\0';
+        test_gen_float(out, sizeof(out), floats[i], JSON_GEN_FLOAT_FIXED);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+    }
+
+    test_rand_state = 0x2545F491;
+    for (int i = 0; i < TEST_NUMBER_ITERATIONS; i++) {
+        const uint32_t bits = test_rand();
+        const uint64_t rand64 = (uint64_t)test_rand() << 32 | test_rand();
+        const int64_t val = (int64_t)rand64 >> (bits % 64);
+        snprintf(ref, sizeof(ref), "%" PRId64, val);
+        test_gen_int64(out, sizeof(out), val);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+
+        snprintf(ref, sizeof(ref), "%d", (int)val);
+        test_gen_int(out, sizeof(out), (int)val);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+
+        /* Any bit pattern, but mostly exponents of telemetry values */
+        float f;
+        uint32_t float_bits = (bits & 0x807fffff) | ((100 + bits % 60) << 23);
+        memcpy(&f, i % 4 ? &float_bits : &bits, sizeof(f));
+        if (f != f) {
+            continue;
+        }
+        snprintf(ref, sizeof(ref), "%.*f", JSON_FLOAT_PRECISION, f);
+        ref[29] = '\0';
+        test_gen_float(out, sizeof(out), f, JSON_GEN_FLOAT_FIXED);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+    }
+}
+
+TEST_CASE("json_generator shortest floats", "[json_generator]")
+{
+    char out[64];
+    char shorter[64];
+    static const struct {
+        float val;
+        const char *str;
+    } floats[] = {
+        { 0.0f, "0" }, { -0.0f, "-0" }, { 1.0f, "1" }, { 0.1f, "0.1" }, { -2.5f, "-2.5" },
+        { 21.37f, "21.37" }, { 100.0f, "100" }, { 2e-5f, "0.00002" }, { 16777216.0f, "16777216" },
+        { 1.5e-7f, "1.5e-07" }, { 3.4028235e38f, "3.4028235e+38" },
+    };
+    for (int i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        test_gen_float(out, sizeof(out), floats[i].val, JSON_GEN_FLOAT_SHORTEST);
+        TEST_ASSERT_EQUAL_STRING(floats[i].str, out);
+    }
+
+    test_rand_state = 0x9E3779B9;
+    for (int i = 0; i < TEST_NUMBER_ITERATIONS; i++) {
+        const uint32_t bits = test_rand();
+        float f;
+        uint32_t float_bits = (bits & 0x807fffff) | ((100 + bits % 60) << 23);
+        memcpy(&f, i % 4 ? &float_bits : &bits, sizeof(f));
+        if (f != f || f - f != 0) {
+            continue;
+        }
+        test_gen_float(out, sizeof(out), f, JSON_GEN_FLOAT_SHORTEST);
+        TEST_ASSERT_TRUE(strtof(out, NULL) == f);
+        /* One digit less after the decimal point does not read back */
+        const char *dot = strchr(out, '.');
+        if (dot && !strchr(out, 'e')) {
+            snprintf(shorter, sizeof(shorter), "%.*f", (int)strlen(dot + 1) - 1, f);
+            TEST_ASSERT_FALSE(strtof(shorter, NULL) == f);
+        }
+    }
+}
+
+/* The same document as test_gen_telemetry(), with snprintf() */
+static size_t test_printf_telemetry(char *doc, size_t size)
+{
+    size_t len = snprintf(doc, size, "{\"node_id\":\"esp-node-0001\",\"fw\":\"1.4.2\",\"samples\":[");
+    for (int i = 0; i < TEST_TELEMETRY_SAMPLES; i++) {
+        len += snprintf(doc + len, size - len,
+                        "%s{\"ts\":%" PRId64 ",\"seq\":%d,\"temp\":%.*f,\"hum\":%.*f,\"volt\":%.*f,"
+                        "\"rssi\":%d,\"ok\":%s,\"state\":\"%s\"}",
+                        i ? "," : "", (int64_t)(1760000000000LL + i * 250LL), i,
+                        JSON_FLOAT_PRECISION, 20.0f + (i % 97) * 0.13f,
+                        JSON_FLOAT_PRECISION, 40.0f + (i % 31) * 0.7f,
+                        JSON_FLOAT_PRECISION, 3.3f - (i % 13) * 0.01f,
+                        -40 - i % 50, i % 7 ? "true" : "false", i % 3 ? "idle" : "active");
+    }
+    len += snprintf(doc + len, size - len, "]}");
+    return len;
+}
+
+static void test_gen_telemetry(json_gen_str_t *jstr)
+{
+    json_gen_start_object(jstr);
+    json_gen_obj_set_string(jstr, "node_id", "esp-node-0001");
+    json_gen_obj_set_string(jstr, "fw", "1.4.2");
+    json_gen_push_array(jstr, "samples");
+    for (int i = 0; i < TEST_TELEMETRY_SAMPLES; i++) {
+        json_gen_start_object(jstr);
+        json_gen_obj_set_int64(jstr, "ts", 1760000000000LL + i * 250LL);
+        json_gen_obj_set_int(jstr, "seq", i);
+        json_gen_obj_set_float(jstr, "temp", 20.0f + (i % 97) * 0.13f);
+        json_gen_obj_set_float(jstr, "hum", 40.0f + (i % 31) * 0.7f);
+        json_gen_obj_set_float(jstr, "volt", 3.3f - (i % 13) * 0.01f);
+        json_gen_obj_set_int(jstr, "rssi", -40 - i % 50);
+        json_gen_obj_set_bool(jstr, "ok", i % 7);
+        json_gen_obj_set_string(jstr, "state", i % 3 ? "idle" : "active");
+        json_gen_end_object(jstr);
+    }
+    json_gen_pop_array(jstr);
+    json_gen_end_object(jstr);
+}
+
+static void test_count_flush(char *buf, void *priv)
+{
+    *(size_t *)priv += strlen(buf);
+}
+
+TEST_CASE("json_generator telemetry benchmark", "[json_generator][benchmark]")
+{
+    char *ref = malloc(TEST_TELEMETRY_SIZE);
+    char *doc = malloc(TEST_TELEMETRY_SIZE);
+    char *buf = malloc(TEST_FLUSH_BUF_SIZE);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_NOT_NULL(buf);
+
+    const size_t len = test_printf_telemetry(ref, TEST_TELEMETRY_SIZE);
+    TEST_ASSERT_LESS_THAN(TEST_TELEMETRY_SIZE, len);
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, doc, TEST_TELEMETRY_SIZE, NULL, NULL);
+    test_gen_telemetry(&jstr);
+    TEST_ASSERT_EQUAL(len + 1, json_gen_str_end(&jstr));
+    TEST_ASSERT_EQUAL_STRING(ref, doc);
+
+    uint64_t printf_time = 0;
+    uint64_t gen_time = 0;
+    uint64_t flush_time = 0;
+    size_t flushed = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        uint64_t start = test_benchmark_now();
+        test_printf_telemetry(ref, TEST_TELEMETRY_SIZE);
+        printf_time += test_benchmark_now() - start;
+
+        start = test_benchmark_now();
+        json_gen_str_start(&jstr, doc, TEST_TELEMETRY_SIZE, NULL, NULL);
+        test_gen_telemetry(&jstr);
+        json_gen_str_end(&jstr);
+        gen_time += test_benchmark_now() - start;
+
+        flushed = 0;
+        start = test_benchmark_now();
+        json_gen_str_start(&jstr, buf, TEST_FLUSH_BUF_SIZE, test_count_flush, &flushed);
+        test_gen_telemetry(&jstr);
+        json_gen_str_end(&jstr);
+        flush_time += test_benchmark_now() - start;
+    }
+    TEST_ASSERT_EQUAL(len, flushed);
+    printf("Telemetry, %zu bytes: snprintf %" PRIu64 ", json_generator %" PRIu64
+           ", json_generator with %d byte flushes %" PRIu64 " " TEST_BENCHMARK_UNIT "\n",
+           len, printf_time / TEST_BENCHMARK_ITERATIONS, gen_time / TEST_BENCHMARK_ITERATIONS,
+           TEST_FLUSH_BUF_SIZE, flush_time / TEST_BENCHMARK_ITERATIONS);
+
+    free(buf);
+    free(doc);
+    free(ref);
+}
+
+/* Bytewise escaping, as done by the callers before json_gen_str_set_escaping() */
+static size_t test_escape(char *out, const char *str)
+{
+    char *ptr = out;
+    for (; *str; str++) {
+        const unsigned char c = *str;
+        char esc = 0;
+        switch (c) {
+        case '"':
+        case '\\':
+            esc = c;
+            break;
+        case '\b':
+            esc = 'b';
+            break;
+        case '\f':
+            esc = 'f';
+            break;
+        case '\n':
+            esc = 'n';
+            break;
+        case '\r':
+            esc = 'r';
+            break;
+        case '\t':
+            esc = 't';
+            break;
+        }
+        if (esc) {
+            *ptr++ = '\\';
+            *ptr++ = esc;
+        } else if (c < 0x20) {
+            ptr += sprintf(ptr, "\\u%04x", c);
+        } else {
+            *ptr++ = c;
+        }
+    }
+    *ptr = '\0';
+    return ptr - out;
+}
+
+static void test_gen_escaped(json_gen_str_t *jstr, const char *name, const char *val)
+{
+    json_gen_str_set_escaping(jstr, true);
+    json_gen_start_object(jstr);
+    json_gen_obj_set_string(jstr, name, val);
+    json_gen_obj_start_long_string(jstr, "long", val);
+    json_gen_add_to_long_string(jstr, val);
+    json_gen_end_long_string(jstr);
+    json_gen_push_array(jstr, "arr");
+    json_gen_arr_set_string(jstr, val);
+    json_gen_pop_array(jstr);
+    json_gen_end_object(jstr);
+}
+
+/* The expected output of test_gen_escaped() */
+static void test_ref_escaped(char *out, const char *name, const char *val)
+{
+    char *esc = malloc(strlen(val) * 6 + 1);
+    TEST_ASSERT_NOT_NULL(esc);
+    test_escape(esc, val);
+    out += sprintf(out, "{\"");
+    out += test_escape(out, name);
+    sprintf(out, "\":\"%s\",\"long\":\"%s%s\",\"arr\":[\"%s\"]}", esc, esc, esc, esc);
+    free(esc);
+}
+
+TEST_CASE("json_generator escapes strings", "[json_generator]")
+{
+    /* Every byte but the terminating null */
+    char all[256];
+    for (int i = 1; i < 256; i++) {
+        all[i - 1] = i;
+    }
+    all[255] = '\0';
+    const size_t size = sizeof(all) * 6 * 4 + 64;
+    char *ref = malloc(size);
+    char *out = malloc(size);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(out);
+    test_ref_escaped(ref, "key \"\\\n", all);
+    TEST_ASSERT_NOT_NULL(strstr(ref, "\\u0001\\u0002"));
+    TEST_ASSERT_NOT_NULL(strstr(ref, "\\b\\t\\n\\u000b\\f\\r"));
+    TEST_ASSERT_NOT_NULL(strstr(ref, " !\\\"#"));
+
+    json_gen_str_t jstr;
+    char buf[64];
+    for (int buf_size = 2; buf_size <= sizeof(buf); buf_size++) {
+        test_sink_t sink = { .doc = out, .size = size };
+        json_gen_str_start(&jstr, buf, buf_size, test_sink_flush, &sink);
+        test_gen_escaped(&jstr, "key \"\\\n", all);
+        TEST_ASSERT_EQUAL(strlen(ref) + 1, json_gen_str_end(&jstr));
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+    }
+
+    /* Random strings, mostly clean runs, at every alignment */
+    char *str = malloc(TEST_ESCAPE_STR_SIZE + 8);
+    TEST_ASSERT_NOT_NULL(str);
+    test_rand_state = 0x1B873593;
+    for (int i = 0; i < TEST_ESCAPE_ITERATIONS; i++) {
+        const int offset = i % 8;
+        const int len = test_rand() % TEST_ESCAPE_STR_SIZE;
+        for (int j = 0; j < len; j++) {
+            const uint32_t r = test_rand();
+            str[offset + j] = r % 8 ? 'a' + r % 26 : 1 + (r >> 8) % 255;
+        }
+        str[offset + len] = '\0';
+        test_ref_escaped(ref, "k", str + offset);
+        json_gen_str_start(&jstr, out, size, NULL, NULL);
+        test_gen_escaped(&jstr, "k", str + offset);
+        TEST_ASSERT_EQUAL(strlen(ref) + 1, json_gen_str_end(&jstr));
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+
+        /* An exactly sized copy, so that reading past the null shows up with ASan */
+        char *exact = malloc(len + 1);
+        TEST_ASSERT_NOT_NULL(exact);
+        memcpy(exact, str + offset, len + 1);
+        json_gen_str_start(&jstr, out, size, NULL, NULL);
+        test_gen_escaped(&jstr, "k", exact);
+        json_gen_str_end(&jstr);
+        TEST_ASSERT_EQUAL_STRING(ref, out);
+        free(exact);
+    }
+
+    /* Verbatim by default, and out of space without a flush callback */
+    json_gen_str_start(&jstr, out, size, NULL, NULL);
+    json_gen_arr_set_string(&jstr, "\\u00e9\n");
+    json_gen_str_end(&jstr);
+    TEST_ASSERT_EQUAL_STRING("\"\\u00e9\n\"", out);
+    json_gen_str_start(&jstr, buf, 8, NULL, NULL);
+    json_gen_str_set_escaping(&jstr, true);
+    TEST_ASSERT_EQUAL(-1, json_gen_arr_set_string(&jstr, "a\nbcdefgh"));
+    TEST_ASSERT_EQUAL(sizeof("\"a\\nbcdefgh\""), json_gen_str_end(&jstr));
+
+    free(str);
+    free(out);
+    free(ref);
+}
+
+/* Log lines with the occasional quote, path and newline */
+static char *test_log_message(int i)
+{
+    char *msg = malloc(256);
+    TEST_ASSERT_NOT_NULL(msg);
+    snprintf(msg, 256, "I (%d) wifi: connected to ap SSID:\"office-%d\" channel:%d, rssi:-%d, "
+             "config loaded from C:\\esp\\nvs\\cfg_%d.bin%s",
+             1000 + i * 37, i % 5, 1 + i % 13, 40 + i % 50, i,
+             i % 4 ? ", retrying dhcp request after timeout on interface sta0" : "\n\ttrace:\tdhcp\n");
+    return msg;
+}
+
+TEST_CASE("json_generator escaping benchmark", "[json_generator][benchmark]")
+{
+    char *msgs[TEST_LOG_MESSAGES];
+    for (int i = 0; i < TEST_LOG_MESSAGES; i++) {
+        msgs[i] = test_log_message(i);
+    }
+    char *ref = malloc(TEST_TELEMETRY_SIZE);
+    char *doc = malloc(TEST_TELEMETRY_SIZE);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(doc);
+
+    uint64_t copy_time = 0;
+    uint64_t native_time = 0;
+    int len = 0;
+    json_gen_str_t jstr;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        /* Escaped by the caller into a temporary copy */
+        uint64_t start = test_benchmark_now();
+        json_gen_str_start(&jstr, ref, TEST_TELEMETRY_SIZE, NULL, NULL);
+        json_gen_start_array(&jstr);
+        for (int j = 0; j < TEST_LOG_MESSAGES; j++) {
+            char *esc = malloc(strlen(msgs[j]) * 6 + 1);
+            test_escape(esc, msgs[j]);
+            json_gen_arr_set_string(&jstr, esc);
+            free(esc);
+        }
+        json_gen_end_array(&jstr);
+        len = json_gen_str_end(&jstr);
+        copy_time += test_benchmark_now() - start;
+
+        start = test_benchmark_now();
+        json_gen_str_start(&jstr, doc, TEST_TELEMETRY_SIZE, NULL, NULL);
+        json_gen_str_set_escaping(&jstr, true);
+        json_gen_start_array(&jstr);
+        for (int j = 0; j < TEST_LOG_MESSAGES; j++) {
+            json_gen_arr_set_string(&jstr, msgs[j]);
+        }
+        json_gen_end_array(&jstr);
+        TEST_ASSERT_EQUAL(len, json_gen_str_end(&jstr));
+        native_time += test_benchmark_now() - start;
+    }
+    TEST_ASSERT_EQUAL_STRING(ref, doc);
+    printf("Log messages, %d bytes: escaped into a copy %" PRIu64 ", escaped by json_generator %" PRIu64
+           " " TEST_BENCHMARK_UNIT "\n", len - 1, copy_time / TEST_BENCHMARK_ITERATIONS,
+           native_time / TEST_BENCHMARK_ITERATIONS);
+
+    free(doc);
+    free(ref);
+    for (int i = 0; i < TEST_LOG_MESSAGES; i++) {
+        free(msgs[i]);
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "unity.h"
+#include "json_generator.h"
+
+#define TEST_STREAM_VALUES      64
+#define TEST_STREAM_DOC_SIZE    4096
+
+/* A buffer handed over to the transport task */
+typedef struct {
+    char *buf;
+    int len;
+    bool last;
+} test_stream_buf_t;
+
+typedef struct {
+    QueueHandle_t send_queue;
+    QueueHandle_t done_queue;
+    /* Filled by the transport task */
+    char doc[TEST_STREAM_DOC_SIZE];
+    int len;
+    bool overwritten;
+    /* Filled by the callbacks on the generating task */
+    char *expected[2];
+    int num_expected;
+    int num_sent;
+    int num_last;
+    int in_flight;
+    int max_in_flight;
+} test_stream_t;
+
+static uint32_t test_stream_sum(const char *buf, int len)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < len; i++) {
+        sum = sum * 31 + (unsigned char)buf[i];
+    }
+    return sum;
+}
+
+/* Sends the buffers out in order. The buffer must not change while it is being sent. */
+static void test_stream_transport_task(void *arg)
+{
+    test_stream_t *stream = (test_stream_t *)arg;
+    test_stream_buf_t item;
+    do {
+        xQueueReceive(stream->send_queue, &item, portMAX_DELAY);
+        const uint32_t sum = test_stream_sum(item.buf, item.len);
+        /* Let the generator run meanwhile */
+        taskYIELD();
+        if (test_stream_sum(item.buf, item.len) != sum || item.buf[item.len] != '\0' ||
+                stream->len + item.len >= sizeof(stream->doc)) {
+            stream->overwritten = true;
+        } else {
+            memcpy(stream->doc + stream->len, item.buf, item.len);
+            stream->len += item.len;
+        }
+        xQueueSend(stream->done_queue, &item.buf, portMAX_DELAY);
+    } while (!item.last);
+    vTaskDelete(NULL);
+}
+
+static void test_stream_send(char *buf, int len, bool last, void *priv)
+{
+    test_stream_t *stream = (test_stream_t *)priv;
+    TEST_ASSERT_LESS_THAN(2, stream->num_expected);
+    stream->expected[stream->num_expected++] = buf;
+    stream->num_sent++;
+    stream->num_last += last;
+    if (++stream->in_flight > stream->max_in_flight) {
+        stream->max_in_flight = stream->in_flight;
+    }
+    test_stream_buf_t item = { .buf = buf, .len = len, .last = last };
+    xQueueSend(stream->send_queue, &item, portMAX_DELAY);
+}
+
+/* The buffers come back in the order they were sent */
+static void test_stream_wait(char *buf, void *priv)
+{
+    test_stream_t *stream = (test_stream_t *)priv;
+    char *done;
+    xQueueReceive(stream->done_queue, &done, portMAX_DELAY);
+    TEST_ASSERT_GREATER_THAN(0, stream->num_expected);
+    TEST_ASSERT_EQUAL_PTR(stream->expected[0], done);
+    TEST_ASSERT_EQUAL_PTR(buf, done);
+    stream->expected[0] = stream->expected[1];
+    stream->num_expected--;
+    stream->in_flight--;
+}
+
+static void test_stream_gen(json_gen_str_t *jstr)
+{
+    json_gen_start_object(jstr);
+    json_gen_push_array(jstr, "values");
+    for (int i = 0; i < TEST_STREAM_VALUES; i++) {
+        json_gen_start_object(jstr);
+        json_gen_obj_set_int(jstr, "id", i * 7919);
+        json_gen_obj_set_float(jstr, "val", i * 0.25f);
+        json_gen_obj_set_string(jstr, "name", i % 2 ? "sensor" : "a longer sensor name");
+        json_gen_end_object(jstr);
+    }
+    json_gen_pop_array(jstr);
+    json_gen_end_object(jstr);
+}
+
+TEST_CASE("json_generator double buffered", "[json_generator]")
+{
+    char *ref = malloc(TEST_STREAM_DOC_SIZE);
+    test_stream_t *stream = calloc(1, sizeof(test_stream_t));
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(stream);
+    json_gen_str_t jstr;
+    json_gen_str_start(&jstr, ref, TEST_STREAM_DOC_SIZE, NULL, NULL);
+    test_stream_gen(&jstr);
+    const int total_len = json_gen_str_end(&jstr);
+    TEST_ASSERT_LESS_THAN(TEST_STREAM_DOC_SIZE, total_len);
+
+    stream->send_queue = xQueueCreate(2, sizeof(test_stream_buf_t));
+    stream->done_queue = xQueueCreate(2, sizeof(char *));
+    TEST_ASSERT_NOT_NULL(stream->send_queue);
+    TEST_ASSERT_NOT_NULL(stream->done_queue);
+    /* Halves from 1 byte of data to more than the whole document */
+    static const int buf_sizes[] = { 4, 5, 6, 17, 64, 130, 511, 1024, 8192 };
+    for (int i = 0; i < sizeof(buf_sizes) / sizeof(buf_sizes[0]); i++) {
+        char *buf = malloc(buf_sizes[i]);
+        TEST_ASSERT_NOT_NULL(buf);
+        QueueHandle_t send_queue = stream->send_queue;
+        QueueHandle_t done_queue = stream->done_queue;
+        memset(stream, 0, sizeof(test_stream_t));
+        stream->send_queue = send_queue;
+        stream->done_queue = done_queue;
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_stream_transport_task, "json_gen_transport", 4096,
+                                              stream, uxTaskPriorityGet(NULL), NULL));
+
+        json_gen_str_start_double_buffered(&jstr, buf, buf_sizes[i], test_stream_send, test_stream_wait, stream);
+        test_stream_gen(&jstr);
+        TEST_ASSERT_EQUAL(total_len, json_gen_str_end(&jstr));
+
+        /* Every buffer is back, the last one was flagged, and none was written to while in flight */
+        TEST_ASSERT_EQUAL(0, stream->in_flight);
+        TEST_ASSERT_EQUAL(1, stream->num_last);
+        TEST_ASSERT_FALSE(stream->overwritten);
+        TEST_ASSERT_EQUAL(total_len - 1, stream->len);
+        stream->doc[stream->len] = '\0';
+        TEST_ASSERT_EQUAL_STRING(ref, stream->doc);
+        if (stream->num_sent > 2) {
+            TEST_ASSERT_EQUAL(2, stream->max_in_flight);
+        }
+        /* Let the transport task delete itself */
+        vTaskDelay(1);
+        free(buf);
+    }
+    vQueueDelete(stream->send_queue);
+    vQueueDelete(stream->done_queue);
+    free(stream);
+    free(ref);
+}
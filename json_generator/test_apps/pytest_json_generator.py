@@ -0,0 +1,14 @@
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+
+@pytest.mark.generic
+def test_json_generator(dut) -> None:
+    dut.run_all_single_board_cases()
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_json_generator_linux(dut: Dut) -> None:
+    dut.run_all_single_board_cases()
@@ -33,12 +33,53 @@ extern "C"
 typedef jsmn_parser json_parser_t;
 typedef jsmntok_t json_tok_t;
 
+/* Optional index of the parsed tokens, see json_parse_index_start() */
+typedef struct {
+    int *next;          /* Index of the first token after the subtree of every token */
+    int *tables;        /* Arena offset of the key hash table of every object or of the element table
+                         * of every array, 0 if not built yet */
+    uint8_t *arena;
+    size_t arena_size;
+    size_t arena_used;
+} json_index_t;
+
+/* Position in an array, see json_arr_iter_begin() */
+typedef struct {
+    int arr;            /* Token index of the array */
+    int index;          /* Index of the current element, -1 before the first one */
+    int elem;           /* Token index of the current element */
+} json_arr_iter_t;
+
+/* Number of arrays, whose last accessed element is remembered, e.g. an array of objects with arrays */
+#define JSON_ARR_CURSORS    4
+
+/* Last accessed elements of arrays, see json_parse_arr_cursors_start() */
+typedef struct {
+    json_arr_iter_t iters[JSON_ARR_CURSORS];
+    int next;           /* Cursor replaced by the next array */
+} json_arr_cursors_t;
+
+/* State of parsing a document received in chunks, see json_parse_chunk_start() */
+typedef struct {
+    char *text;         /* The document without whitespace outside of strings, owned by the context */
+    size_t len;
+    size_t size;
+    int max_tokens;
+    int status;         /* Result of the last jsmn_parse(), the number of tokens of a complete document */
+    bool in_string;
+    bool escape;
+    bool space;         /* Whitespace after a primitive, which is added only before another primitive or a string */
+} json_chunk_state_t;
+
 typedef struct {
     json_parser_t parser;
     const char *js;
     json_tok_t *tokens;
     json_tok_t *cur;
     int num_tokens;
+    json_chunk_state_t chunk;
+    json_index_t index;
+    json_arr_cursors_t *arr_cursors;    /* Optional, see json_parse_arr_cursors_start() */
 } jparse_ctx_t;
 
 int json_parse_start(jparse_ctx_t *jctx, const char *js, int len);
@@ -46,6 +87,53 @@ int json_parse_end(jparse_ctx_t *jctx);
 int json_parse_start_static(jparse_ctx_t *jctx, const char *js, int len, json_tok_t *buffer_tokens, int buffer_tokens_max_count);
 int json_parse_end_static(jparse_ctx_t *jctx);
 
+/* Parse a document received in chunks, e.g. from BLE or HTTP, without reassembling it first:
+ *
+ *     json_parse_chunk_start(&jctx, content_length);
+ *     while (receive(buf, sizeof(buf), &len)) {
+ *         json_parse_chunk(&jctx, buf, len);
+ *     }
+ *     json_parse_chunk_end(&jctx);
+ *     // json_obj_get_*() as usual
+ *     json_parse_end(&jctx);
+ *
+ * Every chunk is copied without whitespace outside of strings into a buffer of the context, which grows as needed,
+ * and the parser continues on it from where it stopped. So only the chunk being parsed, the tokens and the compacted
+ * document are in memory. len_hint is the expected size of the document for the first allocations, or 0.
+ * json_obj_get_object_str() and json_obj_get_array_str() return the values without the whitespace.
+ * On failure, the context is freed and json_parse_end() is not needed.
+ */
+int json_parse_chunk_start(jparse_ctx_t *jctx, int len_hint);
+int json_parse_chunk(jparse_ctx_t *jctx, const char *chunk, int len);
+int json_parse_chunk_end(jparse_ctx_t *jctx);
+
+/* Size of the arena needed by json_parse_index_start() to index all objects of the parsed document */
+size_t json_parse_index_size(jparse_ctx_t *jctx);
+/* Index the parsed document, after json_parse_start() or json_parse_start_static().
+ *
+ * Links to the next sibling of every token are built at once, so that skipping a value does not walk its
+ * subtree. Hash tables of the keys of objects are built lazily in the arena, on the first lookup in the
+ * object, so that json_obj_get_*() do not compare the key with every member. Tables of the elements of
+ * arrays are built the same way, for json_arr_get_*() with any index. When the arena is full, the members
+ * of the remaining objects and arrays are searched one after another.
+ * The arena is owned by the caller and must be valid until json_parse_end() or json_parse_end_static().
+ * As the tables are built by json_obj_get_*() and json_arr_get_*(), an indexed document must not be read
+ * from several threads at once.
+ */
+int json_parse_index_start(jparse_ctx_t *jctx, void *arena, size_t size);
+
+/* Let json_arr_get_*() continue from the last accessed element of an array, after json_parse_start(),
+ * json_parse_start_static() or json_parse_chunk_end().
+ *
+ * Without the cursors, every json_arr_get_*() skips all preceding elements of the array, so reading all
+ * elements one after another is quadratic. With them, it is linear, also with an index in a for loop or
+ * with json_arr_iter_next(). The last accessed element is remembered for JSON_ARR_CURSORS arrays.
+ * The cursors are owned by the caller and must be valid until json_parse_end() or json_parse_end_static().
+ * As json_arr_get_*() and json_arr_iter_next() update them, the document must not be read from several
+ * threads at once then.
+ */
+int json_parse_arr_cursors_start(jparse_ctx_t *jctx, json_arr_cursors_t *cursors);
+
 int json_obj_get_array(jparse_ctx_t *jctx, const char *name, int *num_elem);
 int json_obj_leave_array(jparse_ctx_t *jctx);
 int json_obj_get_object(jparse_ctx_t *jctx, const char *name);
@@ -72,6 +160,127 @@ int json_arr_get_float(jparse_ctx_t *jctx, uint32_t index, float *val);
 int json_arr_get_string(jparse_ctx_t *jctx, uint32_t index, char *val, int size);
 int json_arr_get_strlen(jparse_ctx_t *jctx, uint32_t index, int *strlen);
 
+/* Iterate the array entered with json_obj_get_array() or json_arr_get_array():
+ *
+ *     json_arr_iter_t iter;
+ *     json_arr_iter_begin(jctx, &iter);
+ *     while (json_arr_iter_next(jctx, &iter) == OS_SUCCESS) {
+ *         json_arr_get_int(jctx, iter.index, &val);
+ *     }
+ *
+ * With json_parse_arr_cursors_start(), json_arr_get_*() with iter.index do not search for the element,
+ * it is found by json_arr_iter_next().
+ */
+int json_arr_iter_begin(jparse_ctx_t *jctx, json_arr_iter_t *iter);
+/* Move to the next element, -OS_FAIL after the last one */
+int json_arr_iter_next(jparse_ctx_t *jctx, json_arr_iter_t *iter);
+
+/* Event-driven (SAX) parsing, which does not need the whole document or its tokens in memory */
+
+/* Maximum nesting of objects and arrays of the document */
+#ifndef JSON_SAX_MAX_DEPTH
+#define JSON_SAX_MAX_DEPTH  16
+#endif
+
+/* Maximum length of the path of a value, see json_sax_path() */
+#ifndef JSON_SAX_PATH_MAX
+#define JSON_SAX_PATH_MAX   128
+#endif
+
+/* Maximum number of paths of json_sax_set_filter() */
+#define JSON_SAX_MAX_FILTERS    32
+
+typedef enum {
+    JSON_SAX_OBJ_START,
+    JSON_SAX_OBJ_END,
+    JSON_SAX_ARR_START,
+    JSON_SAX_ARR_END,
+    JSON_SAX_KEY,           /* Key of the next value, without quotes */
+    JSON_SAX_STRING,        /* String value, without quotes and with escapes as in the document */
+    JSON_SAX_PRIMITIVE,     /* Number, true, false or null */
+} json_sax_event_t;
+
+typedef struct json_sax_ctx json_sax_ctx_t;
+
+/* Called for every event. val and len are set for keys and values only, val is valid until the callback
+ * returns. Any return value other than OS_SUCCESS stops parsing. */
+typedef int (*json_sax_cb_t)(json_sax_ctx_t *sax, json_sax_event_t event, const char *val, int len, void *priv);
+
+/* Object or array entered by the SAX parser */
+typedef struct {
+    uint16_t path_len;  /* Length of the path of the object or array */
+    bool obj;
+    int index;          /* Index of the current member or element */
+    uint32_t filter_mask;   /* Filter paths, which can be inside */
+} json_sax_level_t;
+
+struct json_sax_ctx {
+    json_sax_cb_t cb;
+    void *priv;
+    const char *const *filter;
+    int num_filters;
+    int match;          /* Index of the filter path, which the current path is in, -1 if none */
+    int match_len;      /* Length of the matching filter path */
+    char *buf;          /* Value, which continues in the next chunk */
+    int buf_size;
+    int buf_len;
+    int tok_start;      /* Offset of the current key or value in the chunk */
+    int key_start;      /* Offset of the current key in the path */
+    int skip;           /* Nesting of the skipped object or array */
+    int depth;
+    uint8_t state;
+    uint8_t hex;        /* Remaining hex digits of a \u escape */
+    bool key;
+    bool keep;          /* The current value is passed to the callback */
+    bool split;         /* The current key or value started in a previous chunk */
+    bool escape;
+    bool in_string;
+    json_sax_level_t levels[JSON_SAX_MAX_DEPTH];
+    char path[JSON_SAX_PATH_MAX];
+    int path_len;
+};
+
+/* Start parsing a document with callbacks, e.g. when it is too big for its tokens:
+ *
+ *     json_sax_start(&sax, cb, priv, buf, sizeof(buf));
+ *     json_sax_set_filter(&sax, paths, num_paths);
+ *     while (receive(chunk, sizeof(chunk), &len)) {
+ *         json_sax_parse(&sax, chunk, len);
+ *     }
+ *     json_sax_end(&sax);
+ *
+ * Nothing is allocated, the memory is the context and buf. Keys and values are passed to the callback from
+ * the chunk, only a value which continues in the next chunk is copied to buf. Such a value must fit in buf
+ * with a terminating null, otherwise parsing fails. buf can be NULL, when the document is parsed in one chunk,
+ * unless it is a number, true, false or null at the top level, which ends with the document. As its end is
+ * known only in json_sax_end(), such a value is always copied to buf.
+ */
+int json_sax_start(json_sax_ctx_t *sax, json_sax_cb_t cb, void *priv, char *buf, int buf_size);
+/* Pass only the events at and below the given paths to the callback, see json_sax_path(), up to
+ * JSON_SAX_MAX_FILTERS paths.
+ * E.g. "wifi.ssid", "nodes[].id" or "params" for all members of "params". Objects and arrays, which
+ * cannot contain the paths, are skipped only matching the brackets, without checking their syntax.
+ * The paths must be valid until json_sax_end().
+ */
+int json_sax_set_filter(json_sax_ctx_t *sax, const char *const *paths, int num_paths);
+/* Parse the next chunk of the document */
+int json_sax_parse(json_sax_ctx_t *sax, const char *js, int len);
+/* Finish parsing, -OS_FAIL if the document is not complete */
+int json_sax_end(json_sax_ctx_t *sax);
+/* Path of the current value from the callback: keys joined with '.' and "[]" for elements of arrays,
+ * e.g. "nodes[].location.room". The path of an object or an array is the same for its start and end. */
+const char *json_sax_path(json_sax_ctx_t *sax);
+/* Index of the current value in its array or object, -1 at the top level */
+int json_sax_index(json_sax_ctx_t *sax);
+/* Index of the filter path, which the current path is in, -1 without filter */
+int json_sax_filter_index(json_sax_ctx_t *sax);
+
+/* Conversions of the values passed to json_sax_cb_t */
+int json_sax_to_bool(const char *val, int len, bool *out);
+int json_sax_to_int(const char *val, int len, int *out);
+int json_sax_to_int64(const char *val, int len, int64_t *out);
+int json_sax_to_float(const char *val, int len, float *out);
+
 #ifdef __cplusplus
 }
 #endif
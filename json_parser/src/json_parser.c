@@ -23,24 +23,179 @@
 #include <jsmn.h>
 #include <json_parser.h>
 
+/* Objects and arrays with fewer members are searched linearly, also when indexed */
+#define JSON_INDEX_MIN_MEMBERS  8
+
+/* Initial size of the token array of json_parse_start(), from the length of the document */
+#define JSON_PARSE_BYTES_PER_TOKEN  6
+#define JSON_PARSE_MIN_TOKENS       16
+
+/* Initial size of the text of json_parse_chunk_start() */
+#define JSON_CHUNK_MIN_TEXT         256
+
+static bool token_matches_len(jparse_ctx_t *ctx, json_tok_t *tok, const char *str, size_t len)
+{
+    return (len == (size_t)(tok->end - tok->start))
+           && (memcmp(ctx->js + tok->start, str, len) == 0);
+}
+
 static bool token_matches_str(jparse_ctx_t *ctx, json_tok_t *tok, const char *str)
 {
-    const char *js = ctx->js;
-    return ((strncmp(js + tok->start, str, strlen(str)) == 0)
-            && (strlen(str) == (size_t)(tok->end - tok->start)));
+    return token_matches_len(ctx, tok, str, strlen(str));
 }
 
-static json_tok_t *json_skip_elem(json_tok_t *token)
+static json_tok_t *json_skip_elem_recursive(json_tok_t *token)
 {
     json_tok_t *cur = token;
     int cnt = cur->size;
     while (cnt--) {
         cur++;
-        cur = json_skip_elem(cur);
+        cur = json_skip_elem_recursive(cur);
     }
     return cur;
 }
 
+/* Last token of the subtree of the token */
+static json_tok_t *json_skip_elem(jparse_ctx_t *jctx, json_tok_t *token)
+{
+    if (jctx->index.next) {
+        return &jctx->tokens[jctx->index.next[token - jctx->tokens] - 1];
+    }
+    return json_skip_elem_recursive(token);
+}
+
+static uint32_t json_index_hash(const char *str, size_t len)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Number of slots of the key table of an object, a power of two at most half full */
+static uint32_t json_index_table_slots(int num_keys)
+{
+    uint32_t slots = JSON_INDEX_MIN_MEMBERS * 2;
+    while (slots < (uint32_t)num_keys * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+/* Table of the object or array in the arena, NULL if it is not built yet and does not fit */
+static int *json_index_table_alloc(jparse_ctx_t *jctx, int tok, size_t table_size, bool *built)
+{
+    json_index_t *index = &jctx->index;
+    *built = index->tables[tok] != 0;
+    if (*built) {
+        return (int *)(index->arena + index->tables[tok]);
+    }
+    if (index->arena_size - index->arena_used < table_size) {
+        return NULL;
+    }
+    int *table = (int *)(index->arena + index->arena_used);
+    index->tables[tok] = index->arena_used;
+    index->arena_used += table_size;
+    return table;
+}
+
+/* Key table of the object: the number of slots followed by the token index of the key in every slot, 0 if empty */
+static int *json_index_key_table(jparse_ctx_t *jctx, int obj)
+{
+    const uint32_t slots = json_index_table_slots(jctx->tokens[obj].size);
+    const size_t table_size = (slots + 1) * sizeof(int);
+    bool built;
+    int *table = json_index_table_alloc(jctx, obj, table_size, &built);
+    if (!table || built) {
+        return table;
+    }
+
+    memset(table, 0, table_size);
+    table[0] = slots;
+    int key = obj + 1;
+    for (int i = 0; i < jctx->tokens[obj].size; i++) {
+        json_tok_t *tok = &jctx->tokens[key];
+        uint32_t pos = json_index_hash(jctx->js + tok->start, tok->end - tok->start) & (slots - 1);
+        while (table[pos + 1]) {
+            pos = (pos + 1) & (slots - 1);
+        }
+        table[pos + 1] = key;
+        key = jctx->index.next[key];
+    }
+    return table;
+}
+
+/* With duplicate keys, the first one is found, like with the linear search */
+static json_tok_t *json_index_obj_search(jparse_ctx_t *jctx, int obj, const char *key)
+{
+    const size_t len = strlen(key);
+    int *table = NULL;
+    if (jctx->tokens[obj].size >= JSON_INDEX_MIN_MEMBERS) {
+        table = json_index_key_table(jctx, obj);
+    }
+
+    if (!table) {
+        int cur = obj + 1;
+        for (int i = 0; i < jctx->tokens[obj].size; i++) {
+            if (token_matches_len(jctx, &jctx->tokens[cur], key, len)) {
+                return &jctx->tokens[cur];
+            }
+            cur = jctx->index.next[cur];
+        }
+        return NULL;
+    }
+
+    const uint32_t mask = table[0] - 1;
+    uint32_t pos = json_index_hash(key, len) & mask;
+    while (table[pos + 1]) {
+        json_tok_t *tok = &jctx->tokens[table[pos + 1]];
+        if (token_matches_len(jctx, tok, key, len)) {
+            return tok;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
+
+/* Element table of the array: the token index of every element */
+static int *json_index_elem_table(jparse_ctx_t *jctx, int arr)
+{
+    bool built;
+    int *table = json_index_table_alloc(jctx, arr, jctx->tokens[arr].size * sizeof(int), &built);
+    if (!table || built) {
+        return table;
+    }
+
+    int elem = arr + 1;
+    for (int i = 0; i < jctx->tokens[arr].size; i++) {
+        table[i] = elem;
+        elem = jctx->index.next[elem];
+    }
+    return table;
+}
+
+/* Cursor of the array, a new one replaces the oldest one. NULL without json_parse_arr_cursors_start() */
+static json_arr_iter_t *json_arr_cursor(jparse_ctx_t *jctx, int arr)
+{
+    json_arr_cursors_t *cursors = jctx->arr_cursors;
+    if (!cursors) {
+        return NULL;
+    }
+    for (int i = 0; i < JSON_ARR_CURSORS; i++) {
+        if (cursors->iters[i].arr == arr && cursors->iters[i].elem > arr) {
+            return &cursors->iters[i];
+        }
+    }
+    json_arr_iter_t *cursor = &cursors->iters[cursors->next];
+    cursors->next = (cursors->next + 1) % JSON_ARR_CURSORS;
+    cursor->arr = arr;
+    cursor->index = 0;
+    cursor->elem = arr + 1;
+    return cursor;
+}
+
 static int json_tok_to_bool(jparse_ctx_t *jctx, json_tok_t *tok, bool *val)
 {
     if (token_matches_str(jctx, tok, "true") || token_matches_str(jctx, tok, "1")) {
@@ -113,12 +268,16 @@ static json_tok_t *json_obj_search(jparse_ctx_t *jctx, const char *key)
         return NULL;
     }
 
+    if (jctx->index.next) {
+        return json_index_obj_search(jctx, tok - jctx->tokens, key);
+    }
+
     while (size--) {
         tok++;
         if (token_matches_str(jctx, tok, key)) {
             return tok;
         }
-        tok = json_skip_elem(tok);
+        tok = json_skip_elem(jctx, tok);
     }
     return NULL;
 }
@@ -290,14 +449,33 @@ static json_tok_t *json_arr_search(jparse_ctx_t *ctx, uint32_t index)
     if (index > (uint32_t)(tok->size - 1)) {
         return NULL;
     }
-    /* Increment by 1, so that token points to index 0 */
-    tok++;
-    while (index--) {
-        tok = json_skip_elem(tok);
+    const int arr = tok - ctx->tokens;
+    if (ctx->index.next && tok->size >= JSON_INDEX_MIN_MEMBERS) {
+        int *table = json_index_elem_table(ctx, arr);
+        if (table) {
+            return &ctx->tokens[table[index]];
+        }
+    }
+
+    /* Continue from the last accessed element, if it is not after the element */
+    json_arr_iter_t *cursor = json_arr_cursor(ctx, arr);
+    uint32_t i = 0;
+    tok = &ctx->tokens[arr + 1];
+    if (cursor && (uint32_t)cursor->index <= index) {
+        i = cursor->index;
+        tok = &ctx->tokens[cursor->elem];
+    }
+    for (; i < index; i++) {
+        tok = json_skip_elem(ctx, tok);
         tok++;
     }
+    if (cursor) {
+        cursor->index = index;
+        cursor->elem = tok - ctx->tokens;
+    }
     return tok;
 }
+
 static json_tok_t *json_arr_get_val_tok(jparse_ctx_t *jctx, uint32_t index, jsmntype_t type)
 {
     json_tok_t *tok = json_arr_search(jctx, index);
@@ -403,27 +581,88 @@ int json_arr_get_strlen(jparse_ctx_t *jctx, uint32_t index, int *strlen)
     return OS_SUCCESS;
 }
 
-int json_parse_start(jparse_ctx_t *jctx, const char *js, int len)
+int json_arr_iter_begin(jparse_ctx_t *jctx, json_arr_iter_t *iter)
+{
+    if (jctx->cur->type != JSMN_ARRAY) {
+        return -OS_FAIL;
+    }
+    iter->arr = jctx->cur - jctx->tokens;
+    iter->index = -1;
+    iter->elem = iter->arr;
+    return OS_SUCCESS;
+}
+
+int json_arr_iter_next(jparse_ctx_t *jctx, json_arr_iter_t *iter)
+{
+    json_tok_t *arr = &jctx->tokens[iter->arr];
+    if (iter->index + 1 >= arr->size) {
+        return -OS_FAIL;
+    }
+    if (iter->index < 0) {
+        iter->elem = iter->arr + 1;
+    } else {
+        iter->elem = json_skip_elem(jctx, &jctx->tokens[iter->elem]) - jctx->tokens + 1;
+    }
+    iter->index++;
+
+    /* json_arr_get_*() find the element at the cursor */
+    json_arr_iter_t *cursor = json_arr_cursor(jctx, iter->arr);
+    if (cursor) {
+        *cursor = *iter;
+    }
+    return OS_SUCCESS;
+}
+
+/* Exact number of tokens from a counting pass, then the tokens, with the least memory */
+static int json_parse_start_counted(jparse_ctx_t *jctx, const char *js, int len)
 {
-    memset(jctx, 0, sizeof(jparse_ctx_t));
     jsmn_init(&jctx->parser);
     int num_tokens = jsmn_parse(&jctx->parser, js, len, NULL, 0);
     if (num_tokens <= 0) {
         return -OS_FAIL;
     }
-    jctx->num_tokens = num_tokens;
     jctx->tokens = calloc(num_tokens, sizeof(json_tok_t));
     if (!jctx->tokens) {
         return -OS_FAIL;
     }
-    jctx->js = js;
     jsmn_init(&jctx->parser);
-    int ret = jsmn_parse(&jctx->parser, js, len, jctx->tokens, jctx->num_tokens);
+    return jsmn_parse(&jctx->parser, js, len, jctx->tokens, num_tokens);
+}
+
+int json_parse_start(jparse_ctx_t *jctx, const char *js, int len)
+{
+    memset(jctx, 0, sizeof(jparse_ctx_t));
+
+    /* The document is parsed once, into a token array growing from an estimate. The parser continues
+     * from the token, which did not fit, after the array is reallocated. */
+    jsmn_init(&jctx->parser);
+    int max_tokens = len / JSON_PARSE_BYTES_PER_TOKEN + JSON_PARSE_MIN_TOKENS;
+    int ret;
+    do {
+        json_tok_t *tokens = realloc(jctx->tokens, max_tokens * sizeof(json_tok_t));
+        if (!tokens) {
+            free(jctx->tokens);
+            jctx->tokens = NULL;
+            ret = json_parse_start_counted(jctx, js, len);
+            break;
+        }
+        jctx->tokens = tokens;
+        ret = jsmn_parse(&jctx->parser, js, len, jctx->tokens, max_tokens);
+        max_tokens *= 2;
+    } while (ret == JSMN_ERROR_NOMEM);
+
     if (ret <= 0) {
         free(jctx->tokens);
         memset(jctx, 0, sizeof(jparse_ctx_t));
         return -OS_FAIL;
     }
+    /* Give the unused tokens back */
+    json_tok_t *tokens = realloc(jctx->tokens, ret * sizeof(json_tok_t));
+    if (tokens) {
+        jctx->tokens = tokens;
+    }
+    jctx->num_tokens = ret;
+    jctx->js = js;
     jctx->cur = jctx->tokens;
     return OS_SUCCESS;
 }
@@ -433,7 +672,157 @@ int json_parse_end(jparse_ctx_t *jctx)
     if (jctx->tokens) {
         free(jctx->tokens);
     }
+    free(jctx->chunk.text);
+    memset(jctx, 0, sizeof(jparse_ctx_t));
+    return OS_SUCCESS;
+}
+
+int json_parse_chunk_start(jparse_ctx_t *jctx, int len_hint)
+{
     memset(jctx, 0, sizeof(jparse_ctx_t));
+    jsmn_init(&jctx->parser);
+    json_chunk_state_t *chunk = &jctx->chunk;
+    chunk->size = len_hint > JSON_CHUNK_MIN_TEXT ? len_hint : JSON_CHUNK_MIN_TEXT;
+    chunk->max_tokens = chunk->size / JSON_PARSE_BYTES_PER_TOKEN + JSON_PARSE_MIN_TOKENS;
+    chunk->text = malloc(chunk->size);
+    jctx->tokens = malloc(chunk->max_tokens * sizeof(json_tok_t));
+    if (!chunk->text || !jctx->tokens) {
+        json_parse_end(jctx);
+        return -OS_FAIL;
+    }
+    return OS_SUCCESS;
+}
+
+/* Characters of numbers, true, false and null, which cannot be separated only by removing whitespace */
+static bool json_chunk_is_primitive(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+}
+
+/* Append the chunk to the text, without whitespace outside of strings */
+static void json_chunk_append(json_chunk_state_t *chunk, const char *js, int len)
+{
+    char *text = chunk->text;
+    size_t pos = chunk->len;
+    for (int i = 0; i < len; i++) {
+        const char c = js[i];
+        if (chunk->in_string) {
+            if (chunk->escape) {
+                chunk->escape = false;
+            } else if (c == '\\') {
+                chunk->escape = true;
+            } else if (c == '\"') {
+                chunk->in_string = false;
+            }
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            /* Whitespace after a primitive separates it from a following primitive or string, e.g. [1 2] */
+            chunk->space = pos > 0 && json_chunk_is_primitive(text[pos - 1]);
+            continue;
+        } else {
+            if (chunk->space && (c == '\"' || json_chunk_is_primitive(c))) {
+                text[pos++] = ' ';
+            }
+            chunk->space = false;
+            chunk->in_string = c == '\"';
+        }
+        text[pos++] = c;
+    }
+    chunk->len = pos;
+}
+
+/* Make room for len more bytes of text */
+static int json_chunk_reserve(jparse_ctx_t *jctx, size_t len)
+{
+    json_chunk_state_t *chunk = &jctx->chunk;
+    if (chunk->size - chunk->len >= len) {
+        return OS_SUCCESS;
+    }
+    size_t size = chunk->size * 2;
+    if (size < chunk->len + len) {
+        size = chunk->len + len;
+    }
+    char *text = realloc(chunk->text, size);
+    if (!text) {
+        json_parse_end(jctx);
+        return -OS_FAIL;
+    }
+    chunk->text = text;
+    chunk->size = size;
+    return OS_SUCCESS;
+}
+
+/* Continue parsing the text, a string or a primitive at its end is parsed again after the next chunk */
+static int json_chunk_parse(jparse_ctx_t *jctx)
+{
+    json_chunk_state_t *chunk = &jctx->chunk;
+    int ret;
+    while ((ret = jsmn_parse(&jctx->parser, chunk->text, chunk->len, jctx->tokens, chunk->max_tokens)) == JSMN_ERROR_NOMEM) {
+        json_tok_t *tokens = realloc(jctx->tokens, chunk->max_tokens * 2 * sizeof(json_tok_t));
+        if (!tokens) {
+            json_parse_end(jctx);
+            return -OS_FAIL;
+        }
+        jctx->tokens = tokens;
+        chunk->max_tokens *= 2;
+    }
+    if (ret < 0 && ret != JSMN_ERROR_PART) {
+        json_parse_end(jctx);
+        return -OS_FAIL;
+    }
+    chunk->status = ret;
+    return OS_SUCCESS;
+}
+
+int json_parse_chunk(jparse_ctx_t *jctx, const char *js, int len)
+{
+    json_chunk_state_t *chunk = &jctx->chunk;
+    if (!chunk->text || len < 0) {
+        return -OS_FAIL;
+    }
+    /* With the space, which separated the last primitive from this chunk */
+    if (json_chunk_reserve(jctx, (size_t)len + 1) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    json_chunk_append(chunk, js, len);
+    return json_chunk_parse(jctx);
+}
+
+int json_parse_chunk_end(jparse_ctx_t *jctx)
+{
+    json_chunk_state_t *chunk = &jctx->chunk;
+    if (!chunk->text) {
+        return -OS_FAIL;
+    }
+    /* In strict mode, a primitive ends only before a delimiter, e.g. the top level value of "3 " */
+    if (chunk->space) {
+        if (json_chunk_reserve(jctx, 1) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+        chunk->text[chunk->len++] = ' ';
+        chunk->space = false;
+        if (json_chunk_parse(jctx) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    if (chunk->status <= 0) {
+        json_parse_end(jctx);
+        return -OS_FAIL;
+    }
+    /* Give the unused memory back */
+    char *text = realloc(chunk->text, chunk->len ? chunk->len : 1);
+    if (text) {
+        chunk->text = text;
+        chunk->size = chunk->len ? chunk->len : 1;
+    }
+    json_tok_t *tokens = realloc(jctx->tokens, chunk->status * sizeof(json_tok_t));
+    if (tokens) {
+        jctx->tokens = tokens;
+        chunk->max_tokens = chunk->status;
+    }
+    jctx->num_tokens = chunk->status;
+    jctx->js = chunk->text;
+    jctx->cur = jctx->tokens;
     return OS_SUCCESS;
 }
 
@@ -443,25 +832,18 @@ int json_parse_start_static(jparse_ctx_t *jctx, const char *js, int len, json_to
     memset(buffer_tokens, 0, buffer_tokens_max_count * sizeof(json_tok_t));
     memset(jctx, 0, sizeof(jparse_ctx_t));
 
-    // Check fit
+    // Parse, the document does not fit, if the parser runs out of tokens
     jsmn_init(&jctx->parser);
-    int num_tokens = jsmn_parse(&jctx->parser, js, len, NULL, 0);
-    if (num_tokens <= 0 || num_tokens > buffer_tokens_max_count) {
+    int ret = jsmn_parse(&jctx->parser, js, len, buffer_tokens, buffer_tokens_max_count);
+    if (ret <= 0) {
+        memset(jctx, 0, sizeof(jparse_ctx_t));
         return -OS_FAIL;
     }
 
     // Set struct
-    jctx->num_tokens = num_tokens;
+    jctx->num_tokens = ret;
     jctx->tokens = buffer_tokens;
     jctx->js = js;
-
-    // Parse
-    jsmn_init(&jctx->parser);
-    int ret = jsmn_parse(&jctx->parser, js, len, jctx->tokens, jctx->num_tokens);
-    if (ret <= 0) {
-        memset(jctx, 0, sizeof(jparse_ctx_t));
-        return -OS_FAIL;
-    }
     jctx->cur = jctx->tokens;
     return OS_SUCCESS;
 }
@@ -471,3 +853,64 @@ int json_parse_end_static(jparse_ctx_t *jctx)
     memset(jctx, 0, sizeof(jparse_ctx_t));
     return OS_SUCCESS;
 }
+
+size_t json_parse_index_size(jparse_ctx_t *jctx)
+{
+    /* The links, the offsets of the tables, the tables and the alignment of the arena */
+    size_t size = 2 * jctx->num_tokens * sizeof(int) + sizeof(int) - 1;
+    for (int i = 0; i < jctx->num_tokens; i++) {
+        if (jctx->tokens[i].size < JSON_INDEX_MIN_MEMBERS) {
+            continue;
+        }
+        if (jctx->tokens[i].type == JSMN_OBJECT) {
+            size += (json_index_table_slots(jctx->tokens[i].size) + 1) * sizeof(int);
+        } else if (jctx->tokens[i].type == JSMN_ARRAY) {
+            size += jctx->tokens[i].size * sizeof(int);
+        }
+    }
+    return size;
+}
+
+int json_parse_index_start(jparse_ctx_t *jctx, void *arena, size_t size)
+{
+    if (!jctx->tokens || !arena) {
+        return -OS_FAIL;
+    }
+    const size_t align = (sizeof(int) - (uintptr_t)arena % sizeof(int)) % sizeof(int);
+    const size_t links_size = 2 * jctx->num_tokens * sizeof(int);
+    if (size < align + links_size) {
+        return -OS_FAIL;
+    }
+
+    json_index_t *index = &jctx->index;
+    index->arena = (uint8_t *)arena + align;
+    index->arena_size = size - align;
+    index->arena_used = links_size;
+    index->next = (int *)index->arena;
+    index->tables = index->next + jctx->num_tokens;
+    memset(index->tables, 0, jctx->num_tokens * sizeof(int));
+
+    /* Children follow their parent, so the sizes of the subtrees are summed up from the last token */
+    for (int i = 0; i < jctx->num_tokens; i++) {
+        index->next[i] = 1;
+    }
+    for (int i = jctx->num_tokens - 1; i > 0; i--) {
+        if (jctx->tokens[i].parent >= 0) {
+            index->next[jctx->tokens[i].parent] += index->next[i];
+        }
+    }
+    for (int i = 0; i < jctx->num_tokens; i++) {
+        index->next[i] += i;
+    }
+    return OS_SUCCESS;
+}
+
+int json_parse_arr_cursors_start(jparse_ctx_t *jctx, json_arr_cursors_t *cursors)
+{
+    if (!jctx->tokens || !cursors) {
+        return -OS_FAIL;
+    }
+    memset(cursors, 0, sizeof(json_arr_cursors_t));
+    jctx->arr_cursors = cursors;
+    return OS_SUCCESS;
+}
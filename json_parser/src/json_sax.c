@@ -0,0 +1,535 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <json_parser.h>
+
+/* What the parser expects next */
+enum {
+    JSON_SAX_S_VALUE,
+    JSON_SAX_S_ARR_FIRST,     /* A value or the end of an empty array */
+    JSON_SAX_S_OBJ_FIRST,     /* A key or the end of an empty object */
+    JSON_SAX_S_MEMBER,        /* A key after a comma */
+    JSON_SAX_S_COLON,
+    JSON_SAX_S_NEXT,          /* A comma or the end of the object or array */
+    JSON_SAX_S_STRING,        /* Rest of a key or a string value */
+    JSON_SAX_S_PRIMITIVE,     /* Rest of a primitive value */
+    JSON_SAX_S_SKIP,          /* Rest of an object or array, which is not in the filter */
+    JSON_SAX_S_DONE,
+    JSON_SAX_S_ERROR,
+};
+
+/* Classes of the characters outside of strings */
+#define JSON_SAX_SPACE      1
+#define JSON_SAX_PRIM       2
+
+static const uint8_t json_sax_class[256] = {
+    ['\t'] = JSON_SAX_SPACE, ['\n'] = JSON_SAX_SPACE, ['\r'] = JSON_SAX_SPACE, [' '] = JSON_SAX_SPACE,
+    ['+'] = JSON_SAX_PRIM, ['-'] = JSON_SAX_PRIM, ['.'] = JSON_SAX_PRIM,
+    ['0' ... '9'] = JSON_SAX_PRIM, ['A' ... 'Z'] = JSON_SAX_PRIM, ['a' ... 'z'] = JSON_SAX_PRIM,
+};
+
+static bool json_sax_is_space(char c)
+{
+    return json_sax_class[(uint8_t)c] == JSON_SAX_SPACE;
+}
+
+static bool json_sax_is_primitive(char c)
+{
+    return json_sax_class[(uint8_t)c] == JSON_SAX_PRIM;
+}
+
+static bool json_sax_is_hex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int json_sax_fail(json_sax_ctx_t *sax)
+{
+    sax->state = JSON_SAX_S_ERROR;
+    return -OS_FAIL;
+}
+
+static int json_sax_emit(json_sax_ctx_t *sax, json_sax_event_t event, const char *val, int len)
+{
+    if (sax->filter && sax->match < 0) {
+        return OS_SUCCESS;
+    }
+    if (sax->cb(sax, event, val, len, sax->priv) != OS_SUCCESS) {
+        return json_sax_fail(sax);
+    }
+    return OS_SUCCESS;
+}
+
+static void json_sax_path_truncate(json_sax_ctx_t *sax, int len)
+{
+    sax->path_len = len;
+    sax->path[len] = 0;
+    if (sax->match_len > len) {
+        sax->match = -1;
+        sax->match_len = 0;
+    }
+}
+
+static int json_sax_path_append(json_sax_ctx_t *sax, const char *str, int len)
+{
+    if (sax->path_len + len >= JSON_SAX_PATH_MAX) {
+        return json_sax_fail(sax);
+    }
+    memcpy(sax->path + sax->path_len, str, len);
+    sax->path_len += len;
+    sax->path[sax->path_len] = 0;
+    return OS_SUCCESS;
+}
+
+/* Filter paths, which can be at or below the current path */
+static uint32_t json_sax_filter_mask(json_sax_ctx_t *sax)
+{
+    return sax->depth ? sax->levels[sax->depth - 1].filter_mask : (uint32_t)((1ULL << sax->num_filters) - 1);
+}
+
+/* Check the path, which has just got longer, against the filter */
+static void json_sax_path_match(json_sax_ctx_t *sax)
+{
+    if (!sax->filter || sax->match >= 0) {
+        return;
+    }
+    /* The filter paths in the mask start with the path of the object or array */
+    const int offset = sax->depth ? sax->levels[sax->depth - 1].path_len : 0;
+    for (uint32_t mask = json_sax_filter_mask(sax); mask; mask &= mask - 1) {
+        const int i = __builtin_ctz(mask);
+        if (strcmp(sax->filter[i] + offset, sax->path + offset) == 0) {
+            sax->match = i;
+            sax->match_len = sax->path_len;
+            return;
+        }
+    }
+}
+
+/* Filter paths inside the object or array at the current path, 0 if it can be skipped */
+static uint32_t json_sax_path_needed(json_sax_ctx_t *sax, bool obj)
+{
+    if (!sax->filter || sax->match >= 0) {
+        return UINT32_MAX;
+    }
+    uint32_t needed = 0;
+    const int offset = sax->depth ? sax->levels[sax->depth - 1].path_len : 0;
+    for (uint32_t mask = json_sax_filter_mask(sax); mask; mask &= mask - 1) {
+        const int i = __builtin_ctz(mask);
+        const char *path = sax->filter[i];
+        if (strncmp(path + offset, sax->path + offset, sax->path_len - offset) != 0) {
+            continue;
+        }
+        const char c = path[sax->path_len];
+        if (obj ? (c == '.' || (sax->path_len == 0 && c && c != '[')) : c == '[') {
+            needed |= 1UL << i;
+        }
+    }
+    return needed;
+}
+
+static int json_sax_buf_append(json_sax_ctx_t *sax, const char *str, int len)
+{
+    if (sax->buf_len + len >= sax->buf_size) {
+        return json_sax_fail(sax);
+    }
+    if (len) {
+        memcpy(sax->buf + sax->buf_len, str, len);
+        sax->buf_len += len;
+    }
+    sax->buf[sax->buf_len] = 0;
+    return OS_SUCCESS;
+}
+
+static void json_sax_value_end(json_sax_ctx_t *sax)
+{
+    sax->state = sax->depth ? JSON_SAX_S_NEXT : JSON_SAX_S_DONE;
+}
+
+/* The string or the primitive ends before js[end] */
+static int json_sax_token_end(json_sax_ctx_t *sax, const char *js, int end, json_sax_event_t event)
+{
+    const char *val = js + sax->tok_start;
+    int len = end - sax->tok_start;
+    if (sax->key) {
+        if (json_sax_path_append(sax, val, len) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+        json_sax_path_match(sax);
+        sax->state = JSON_SAX_S_COLON;
+        return json_sax_emit(sax, JSON_SAX_KEY, sax->path + sax->key_start, sax->path_len - sax->key_start);
+    }
+    json_sax_value_end(sax);
+    if (!sax->keep) {
+        return OS_SUCCESS;
+    }
+    if (sax->split) {
+        if (json_sax_buf_append(sax, val, len) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+        val = sax->buf;
+        len = sax->buf_len;
+    }
+    return json_sax_emit(sax, event, val, len);
+}
+
+/* Keep the part of the key or the value at the end of the chunk */
+static int json_sax_token_split(json_sax_ctx_t *sax, const char *js, int len)
+{
+    const int part = len - sax->tok_start;
+    if (sax->key) {
+        if (json_sax_path_append(sax, js + sax->tok_start, part) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    } else if (sax->keep) {
+        if (!sax->split) {
+            sax->buf_len = 0;
+        }
+        if (json_sax_buf_append(sax, js + sax->tok_start, part) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    sax->split = true;
+    return OS_SUCCESS;
+}
+
+static void json_sax_token_start(json_sax_ctx_t *sax, int start, bool key, uint8_t state)
+{
+    sax->state = state;
+    sax->tok_start = start;
+    sax->key = key;
+    sax->keep = !sax->filter || sax->match >= 0;
+    sax->split = false;
+    sax->escape = false;
+    sax->hex = 0;
+}
+
+static int json_sax_key_start(json_sax_ctx_t *sax, int start)
+{
+    json_sax_level_t *level = &sax->levels[sax->depth - 1];
+    level->index++;
+    json_sax_path_truncate(sax, level->path_len);
+    if (level->path_len && json_sax_path_append(sax, ".", 1) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    sax->key_start = sax->path_len;
+    json_sax_token_start(sax, start, true, JSON_SAX_S_STRING);
+    return OS_SUCCESS;
+}
+
+static int json_sax_container_start(json_sax_ctx_t *sax, bool obj)
+{
+    const uint32_t filter_mask = json_sax_path_needed(sax, obj);
+    if (!filter_mask) {
+        sax->state = JSON_SAX_S_SKIP;
+        sax->skip = 1;
+        sax->in_string = false;
+        sax->escape = false;
+        return OS_SUCCESS;
+    }
+    if (sax->depth == JSON_SAX_MAX_DEPTH) {
+        return json_sax_fail(sax);
+    }
+    if (json_sax_emit(sax, obj ? JSON_SAX_OBJ_START : JSON_SAX_ARR_START, NULL, 0) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    json_sax_level_t *level = &sax->levels[sax->depth++];
+    level->path_len = sax->path_len;
+    level->obj = obj;
+    level->index = -1;
+    level->filter_mask = filter_mask;
+    sax->state = obj ? JSON_SAX_S_OBJ_FIRST : JSON_SAX_S_ARR_FIRST;
+    return OS_SUCCESS;
+}
+
+static int json_sax_container_end(json_sax_ctx_t *sax, char c)
+{
+    json_sax_level_t *level = &sax->levels[sax->depth - 1];
+    if (c != (level->obj ? '}' : ']')) {
+        return json_sax_fail(sax);
+    }
+    sax->depth--;
+    json_sax_path_truncate(sax, level->path_len);
+    json_sax_value_end(sax);
+    return json_sax_emit(sax, level->obj ? JSON_SAX_OBJ_END : JSON_SAX_ARR_END, NULL, 0);
+}
+
+static int json_sax_value_start(json_sax_ctx_t *sax, const char *js, int pos)
+{
+    const char c = js[pos];
+    if (sax->depth && !sax->levels[sax->depth - 1].obj) {
+        json_sax_level_t *level = &sax->levels[sax->depth - 1];
+        level->index++;
+        json_sax_path_truncate(sax, level->path_len);
+        if (json_sax_path_append(sax, "[]", 2) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+        json_sax_path_match(sax);
+    }
+    if (c == '{' || c == '[') {
+        return json_sax_container_start(sax, c == '{');
+    } else if (c == '\"') {
+        json_sax_token_start(sax, pos + 1, false, JSON_SAX_S_STRING);
+    } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        json_sax_token_start(sax, pos, false, JSON_SAX_S_PRIMITIVE);
+    } else {
+        return json_sax_fail(sax);
+    }
+    return OS_SUCCESS;
+}
+
+/* Scan the rest of a key or a string value, the position of the closing quote or len */
+static int json_sax_string(json_sax_ctx_t *sax, const char *js, int pos, int len)
+{
+    while (pos < len) {
+        const char c = js[pos];
+        if (sax->hex) {
+            if (!json_sax_is_hex(c)) {
+                return -1;
+            }
+            sax->hex--;
+        } else if (sax->escape) {
+            if (c == 'u') {
+                sax->hex = 4;
+            } else if (!strchr("\"\\/bfnrt", c) || c == 0) {
+                return -1;
+            }
+            sax->escape = false;
+        } else if (c == '\"') {
+            return pos;
+        } else if (c == '\\') {
+            sax->escape = true;
+        } else if ((unsigned char)c < 0x20) {
+            return -1;
+        } else {
+            /* Plain characters up to the next quote or escape */
+            for (pos++; pos < len && js[pos] != '\"' && js[pos] != '\\' && (unsigned char)js[pos] >= 0x20; pos++) {
+            }
+            continue;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+/* Scan the rest of a skipped object or array, the position after its end or len */
+static int json_sax_skip(json_sax_ctx_t *sax, const char *js, int pos, int len)
+{
+    for (; pos < len; pos++) {
+        const char c = js[pos];
+        if (sax->in_string) {
+            if (sax->escape) {
+                sax->escape = false;
+            } else if (c == '\\') {
+                sax->escape = true;
+            } else if (c == '\"') {
+                sax->in_string = false;
+            }
+        } else if (c == '\"') {
+            sax->in_string = true;
+        } else if (c == '{' || c == '[') {
+            sax->skip++;
+        } else if ((c == '}' || c == ']') && --sax->skip == 0) {
+            json_sax_value_end(sax);
+            return pos + 1;
+        }
+    }
+    return pos;
+}
+
+int json_sax_start(json_sax_ctx_t *sax, json_sax_cb_t cb, void *priv, char *buf, int buf_size)
+{
+    if (!sax || !cb || buf_size < 0 || (!buf && buf_size)) {
+        return -OS_FAIL;
+    }
+    memset(sax, 0, sizeof(json_sax_ctx_t));
+    sax->cb = cb;
+    sax->priv = priv;
+    sax->buf = buf;
+    sax->buf_size = buf_size;
+    sax->match = -1;
+    sax->state = JSON_SAX_S_VALUE;
+    return OS_SUCCESS;
+}
+
+int json_sax_set_filter(json_sax_ctx_t *sax, const char *const *paths, int num_paths)
+{
+    if (!paths || num_paths <= 0 || num_paths > JSON_SAX_MAX_FILTERS || sax->state != JSON_SAX_S_VALUE || sax->depth) {
+        return -OS_FAIL;
+    }
+    sax->filter = paths;
+    sax->num_filters = num_paths;
+    json_sax_path_match(sax);
+    return OS_SUCCESS;
+}
+
+int json_sax_parse(json_sax_ctx_t *sax, const char *js, int len)
+{
+    if (sax->state == JSON_SAX_S_ERROR || len < 0) {
+        return -OS_FAIL;
+    }
+    sax->tok_start = 0;
+    int pos = 0;
+    while (pos < len) {
+        const char c = js[pos];
+        switch (sax->state) {
+        case JSON_SAX_S_STRING:
+            pos = json_sax_string(sax, js, pos, len);
+            if (pos < 0) {
+                return json_sax_fail(sax);
+            }
+            if (pos < len && json_sax_token_end(sax, js, pos++, JSON_SAX_STRING) != OS_SUCCESS) {
+                return -OS_FAIL;
+            }
+            continue;
+        case JSON_SAX_S_PRIMITIVE:
+            while (pos < len && json_sax_is_primitive(js[pos])) {
+                pos++;
+            }
+            if (pos == len) {
+                continue;
+            }
+            if (!json_sax_is_space(js[pos]) && js[pos] != ',' && js[pos] != '}' && js[pos] != ']') {
+                return json_sax_fail(sax);
+            }
+            /* The delimiter is parsed in the next state */
+            if (json_sax_token_end(sax, js, pos, JSON_SAX_PRIMITIVE) != OS_SUCCESS) {
+                return -OS_FAIL;
+            }
+            continue;
+        case JSON_SAX_S_SKIP:
+            pos = json_sax_skip(sax, js, pos, len);
+            continue;
+        default:
+            break;
+        }
+        pos++;
+        if (json_sax_is_space(c)) {
+            continue;
+        }
+        int ret = OS_SUCCESS;
+        switch (sax->state) {
+        case JSON_SAX_S_ARR_FIRST:
+            if (c == ']') {
+                ret = json_sax_container_end(sax, c);
+                break;
+            }
+        /* fall through */
+        case JSON_SAX_S_VALUE:
+            ret = json_sax_value_start(sax, js, pos - 1);
+            break;
+        case JSON_SAX_S_OBJ_FIRST:
+            if (c == '}') {
+                ret = json_sax_container_end(sax, c);
+                break;
+            }
+        /* fall through */
+        case JSON_SAX_S_MEMBER:
+            ret = c == '\"' ? json_sax_key_start(sax, pos) : json_sax_fail(sax);
+            break;
+        case JSON_SAX_S_COLON:
+            if (c != ':') {
+                return json_sax_fail(sax);
+            }
+            sax->state = JSON_SAX_S_VALUE;
+            break;
+        case JSON_SAX_S_NEXT:
+            if (c == ',') {
+                sax->state = sax->levels[sax->depth - 1].obj ? JSON_SAX_S_MEMBER : JSON_SAX_S_VALUE;
+            } else {
+                ret = json_sax_container_end(sax, c);
+            }
+            break;
+        default:
+            return json_sax_fail(sax);
+        }
+        if (ret != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    if (sax->state == JSON_SAX_S_STRING || sax->state == JSON_SAX_S_PRIMITIVE) {
+        return json_sax_token_split(sax, js, len);
+    }
+    return OS_SUCCESS;
+}
+
+int json_sax_end(json_sax_ctx_t *sax)
+{
+    /* A primitive at the top level ends with the document */
+    if (sax->state == JSON_SAX_S_PRIMITIVE && sax->depth == 0) {
+        sax->tok_start = 0;
+        if (json_sax_token_end(sax, "", 0, JSON_SAX_PRIMITIVE) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    if (sax->state != JSON_SAX_S_DONE) {
+        return json_sax_fail(sax);
+    }
+    return OS_SUCCESS;
+}
+
+const char *json_sax_path(json_sax_ctx_t *sax)
+{
+    return sax->path;
+}
+
+int json_sax_index(json_sax_ctx_t *sax)
+{
+    return sax->depth ? sax->levels[sax->depth - 1].index : -1;
+}
+
+int json_sax_filter_index(json_sax_ctx_t *sax)
+{
+    return sax->match;
+}
+
+int json_sax_to_bool(const char *val, int len, bool *out)
+{
+    if ((len == 4 && memcmp(val, "true", 4) == 0) || (len == 1 && val[0] == '1')) {
+        *out = true;
+    } else if ((len == 5 && memcmp(val, "false", 5) == 0) || (len == 1 && val[0] == '0')) {
+        *out = false;
+    } else {
+        return -OS_FAIL;
+    }
+    return OS_SUCCESS;
+}
+
+/* The value is followed by a delimiter or a null, so the conversions stop at its end */
+int json_sax_to_int(const char *val, int len, int *out)
+{
+    char *endptr;
+    int i = strtoul(val, &endptr, 10);
+    if (len && endptr == val + len) {
+        *out = i;
+        return OS_SUCCESS;
+    }
+    return -OS_FAIL;
+}
+
+int json_sax_to_int64(const char *val, int len, int64_t *out)
+{
+    char *endptr;
+    int64_t i64 = strtoull(val, &endptr, 10);
+    if (len && endptr == val + len) {
+        *out = i64;
+        return OS_SUCCESS;
+    }
+    return -OS_FAIL;
+}
+
+int json_sax_to_float(const char *val, int len, float *out)
+{
+    char *endptr;
+    float f = strtof(val, &endptr);
+    if (len && endptr == val + len) {
+        *out = f;
+        return OS_SUCCESS;
+    }
+    return -OS_FAIL;
+}
@@ -1,5 +1,7 @@
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
+#include <math.h>
 #include "json_parser.h"
 #include "unity.h"
 
@@ -14,48 +16,465 @@
             "\"arrays\":\"yes\"},\n"\
             "\"int_64\":109174583252}"
 
-TEST_CASE("json_parser basic tests", "[json_parser]")
+static void test_basic_reads(jparse_ctx_t *jctx)
 {
-    jparse_ctx_t jctx;
-    int ret = json_parse_start(&jctx, json_test_str, strlen(json_test_str));
-    TEST_ASSERT_EQUAL(OS_SUCCESS, ret);
-
     char str_val[64];
     int int_val, num_elem;
     int64_t int64_val;
     bool bool_val;
     float float_val;
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(&jctx, "str_val", str_val, sizeof(str_val)));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(jctx, "str_val", str_val, sizeof(str_val)));
     TEST_ASSERT_EQUAL_STRING("JSON Parser", str_val);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_float(&jctx, "float_val", &float_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_float(jctx, "float_val", &float_val));
     TEST_ASSERT(fabs(float_val - 2.0f) < 0.0001f);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(&jctx, "int_val", &int_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "int_val", &int_val));
     TEST_ASSERT_EQUAL_INT(2017, int_val);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_bool(&jctx, "bool_val", &bool_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_bool(jctx, "bool_val", &bool_val));
     TEST_ASSERT_EQUAL(false, bool_val);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(&jctx, "supported_el", &num_elem));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "supported_el", &num_elem));
     const char *expected_values[] = {"bool", "int", "float", "str", "object", "array"};
     TEST_ASSERT_EQUAL(sizeof(expected_values) / sizeof(expected_values[0]), num_elem);
     for (int i = 0; i < num_elem; ++i) {
-        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_string(&jctx, i, str_val, sizeof(str_val)));
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_string(jctx, i, str_val, sizeof(str_val)));
         TEST_ASSERT_EQUAL_STRING(expected_values[i], str_val);
     }
-    json_obj_leave_array(&jctx);
+    json_obj_leave_array(jctx);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(&jctx, "features"));
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_bool(&jctx, "objects", &bool_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "features"));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_bool(jctx, "objects", &bool_val));
     TEST_ASSERT_EQUAL(true, bool_val);
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(&jctx, "arrays", str_val, sizeof(str_val)));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(jctx, "arrays", str_val, sizeof(str_val)));
     TEST_ASSERT_EQUAL_STRING("yes", str_val);
-    json_obj_leave_object(&jctx);
+    json_obj_leave_object(jctx);
 
-    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int64(&jctx, "int_64", &int64_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int64(jctx, "int_64", &int64_val));
     TEST_ASSERT(int64_val == 109174583252);
+}
+
+TEST_CASE("json_parser basic tests", "[json_parser]")
+{
+    jparse_ctx_t jctx;
+    int ret = json_parse_start(&jctx, json_test_str, strlen(json_test_str));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, ret);
+    test_basic_reads(&jctx);
+    json_parse_end(&jctx);
+}
+
+TEST_CASE("json_parser index", "[json_parser]")
+{
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, json_test_str, strlen(json_test_str)));
+    int arena[64];
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(arena), json_parse_index_size(&jctx));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, sizeof(arena)));
+    test_basic_reads(&jctx);
+    json_parse_end(&jctx);
+
+    /* Not aligned arena */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, json_test_str, strlen(json_test_str)));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_parse_index_start(&jctx, (char *)arena + 1, 2 * jctx.num_tokens * sizeof(int)));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, (char *)arena + 1, sizeof(arena) - 1));
+    test_basic_reads(&jctx);
+    json_parse_end(&jctx);
+}
+
+/* Object with enough members for a key table, with nested values, a duplicate and an empty key */
+#define json_test_index_str "{\"k0\":0,\"k1\":{\"a\":[1,{\"b\":2}],\"k0\":5},\"k2\":2,\"k3\":[3,[3,3]],\"k4\":4," \
+            "\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"\":9,\"k2\":22,\"k10\":{},\"k11\":11,\"k12\":12}"
+
+static void test_index_reads(jparse_ctx_t *jctx)
+{
+    const char *keys[] = {"k0", "k2", "k4", "k5", "k6", "k7", "k8", "", "k11", "k12"};
+    const int values[] = {0, 2, 4, 5, 6, 7, 8, 9, 11, 12};
+    int val, num_elem;
+    for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, keys[i], &val));
+        TEST_ASSERT_EQUAL(values[i], val);
+    }
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_obj_get_int(jctx, "k9", &val));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_obj_get_int(jctx, "k", &val));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_obj_get_int(jctx, "k00", &val));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_obj_get_int(jctx, "b", &val));
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "k1"));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "k0", &val));
+    TEST_ASSERT_EQUAL(5, val);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "a", &num_elem));
+    TEST_ASSERT_EQUAL(2, num_elem);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_object(jctx, 1));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "b", &val));
+    TEST_ASSERT_EQUAL(2, val);
+    json_arr_leave_object(jctx);
+    json_obj_leave_array(jctx);
+    json_obj_leave_object(jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "k3", &num_elem));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_array(jctx, 1));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_int(jctx, 1, &val));
+    TEST_ASSERT_EQUAL(3, val);
+    json_arr_leave_array(jctx);
+    json_obj_leave_array(jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "k10"));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_obj_get_int(jctx, "k0", &val));
+    json_obj_leave_object(jctx);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "k12", &val));
+    TEST_ASSERT_EQUAL(12, val);
+}
+
+TEST_CASE("json_parser index key tables", "[json_parser]")
+{
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, json_test_index_str, strlen(json_test_index_str)));
+    test_index_reads(&jctx);
+    const size_t size = json_parse_index_size(&jctx);
+    int *arena = malloc(size);
+    TEST_ASSERT_NOT_NULL(arena);
+
+    /* With all key tables, with the links only, and without the index again */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, size));
+    test_index_reads(&jctx);
+    test_index_reads(&jctx);
+    TEST_ASSERT_LESS_OR_EQUAL(jctx.index.arena_size, jctx.index.arena_used);
+    json_parse_end(&jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, json_test_index_str, strlen(json_test_index_str)));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, 2 * jctx.num_tokens * sizeof(int)));
+    test_index_reads(&jctx);
+    json_parse_end(&jctx);
+    free(arena);
+}
+/* Array of objects with nested arrays, the elements are read in any order */
+#define json_test_arr_str "{\"list\":[{\"id\":0,\"v\":[0,1]},{\"id\":1,\"v\":[1,2,3]},{\"id\":2,\"v\":[]},3,[4,[4]]," \
+            "{\"id\":5,\"v\":[5]},6,7,8,{\"id\":9,\"v\":[9,10,11,12,13,14,15,16,17]}],\"empty\":[]}"
+
+static void test_arr_reads(jparse_ctx_t *jctx)
+{
+    const int ids[] = {0, 1, 2, -1, -1, 5, -1, -1, -1, 9};
+    const int order[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 9, 5, 0, 7, 3, 1};
+    int val, num_elem;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "list", &num_elem));
+    TEST_ASSERT_EQUAL(10, num_elem);
+    for (int i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        const int index = order[i];
+        if (ids[index] < 0) {
+            if (json_arr_get_int(jctx, index, &val) == OS_SUCCESS) {
+                TEST_ASSERT_EQUAL(index, val);
+            } else {
+                TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_array(jctx, index));
+                TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_int(jctx, 0, &val));
+                TEST_ASSERT_EQUAL(4, val);
+                json_arr_leave_array(jctx);
+            }
+            continue;
+        }
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_object(jctx, index));
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "id", &val));
+        TEST_ASSERT_EQUAL(index, val);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "v", &num_elem));
+        for (int j = num_elem - 1; j >= 0; j--) {
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_int(jctx, j, &val));
+            TEST_ASSERT_EQUAL(index + j, val);
+        }
+        TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_get_int(jctx, num_elem, &val));
+        json_obj_leave_array(jctx);
+        json_arr_leave_object(jctx);
+    }
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_get_int(jctx, 10, &val));
+
+    /* Iterator, with other arrays read inside of the loop */
+    json_arr_iter_t iter;
+    int count = 0;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_iter_begin(jctx, &iter));
+    while (json_arr_iter_next(jctx, &iter) == OS_SUCCESS) {
+        TEST_ASSERT_EQUAL(count, iter.index);
+        if (json_arr_get_object(jctx, iter.index) == OS_SUCCESS) {
+            json_arr_iter_t inner;
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "v", &num_elem));
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_iter_begin(jctx, &inner));
+            for (int j = 0; j < num_elem; j++) {
+                TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_iter_next(jctx, &inner));
+                TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_int(jctx, inner.index, &val));
+                TEST_ASSERT_EQUAL(count + j, val);
+            }
+            TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_iter_next(jctx, &inner));
+            json_obj_leave_array(jctx);
+            json_arr_leave_object(jctx);
+        } else if (json_arr_get_int(jctx, iter.index, &val) == OS_SUCCESS) {
+            TEST_ASSERT_EQUAL(count, val);
+        } else {
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_array(jctx, iter.index));
+            json_arr_leave_array(jctx);
+        }
+        count++;
+    }
+    TEST_ASSERT_EQUAL(10, count);
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_iter_next(jctx, &iter));
+    json_obj_leave_array(jctx);
+
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_iter_begin(jctx, &iter));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "empty", &num_elem));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_iter_begin(jctx, &iter));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_arr_iter_next(jctx, &iter));
+    json_obj_leave_array(jctx);
+}
+
+TEST_CASE("json_parser array access", "[json_parser]")
+{
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, json_test_arr_str, strlen(json_test_arr_str)));
+
+    /* Without the cursors, reading does not modify the context */
+    jparse_ctx_t copy;
+    memcpy(&copy, &jctx, sizeof(copy));
+    test_arr_reads(&jctx);
+    TEST_ASSERT_EQUAL_MEMORY(&copy, &jctx, sizeof(copy));
+
+    /* With the cursors, which continue from the last accessed elements */
+    json_arr_cursors_t cursors;
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_parse_arr_cursors_start(&jctx, NULL));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_arr_cursors_start(&jctx, &cursors));
+    test_arr_reads(&jctx);
+    test_arr_reads(&jctx);
+    TEST_ASSERT_NOT_EQUAL(0, cursors.iters[0].elem);
 
+    /* With the element tables, and with the links only */
+    const size_t size = json_parse_index_size(&jctx);
+    void *arena = malloc(size);
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, size));
+    test_arr_reads(&jctx);
+    test_arr_reads(&jctx);
+    TEST_ASSERT_LESS_OR_EQUAL(jctx.index.arena_size, jctx.index.arena_used);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, 2 * jctx.num_tokens * sizeof(int)));
+    test_arr_reads(&jctx);
     json_parse_end(&jctx);
-}
\ No newline at end of file
+    free(arena);
+}
+
+/* Parse the document in chunks of the size */
+static int test_parse_chunks(jparse_ctx_t *jctx, const char *js, int len, int chunk_len)
+{
+    if (json_parse_chunk_start(jctx, 0) != OS_SUCCESS) {
+        return -OS_FAIL;
+    }
+    for (int pos = 0; pos < len; pos += chunk_len) {
+        if (json_parse_chunk(jctx, js + pos, len - pos < chunk_len ? len - pos : chunk_len) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    return json_parse_chunk_end(jctx);
+}
+
+#define json_test_chunk_str "{ \"text\" : \"a \\\"quoted\\\" \\\\ value\\n\" ,\n  \"list\" : [ 1 , -2.5e3 , true , null ] }"
+
+TEST_CASE("json_parser chunks", "[json_parser]")
+{
+    jparse_ctx_t jctx;
+    char str_val[64];
+    int int_val, num_elem;
+    bool bool_val;
+    float float_val;
+
+    for (int chunk_len = 1; chunk_len <= strlen(json_test_str); chunk_len++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_parse_chunks(&jctx, json_test_str, strlen(json_test_str), chunk_len));
+        test_basic_reads(&jctx);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object_str(&jctx, "features", str_val, sizeof(str_val)));
+        TEST_ASSERT_EQUAL_STRING("{\"objects\":true,\"arrays\":\"yes\"}", str_val);
+        json_parse_end(&jctx);
+    }
+
+    for (int chunk_len = 1; chunk_len <= strlen(json_test_chunk_str); chunk_len++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_parse_chunks(&jctx, json_test_chunk_str, strlen(json_test_chunk_str), chunk_len));
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(&jctx, "text", str_val, sizeof(str_val)));
+        TEST_ASSERT_EQUAL_STRING("a \\\"quoted\\\" \\\\ value\\n", str_val);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(&jctx, "list", &num_elem));
+        TEST_ASSERT_EQUAL(4, num_elem);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_int(&jctx, 0, &int_val));
+        TEST_ASSERT_EQUAL(1, int_val);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_float(&jctx, 1, &float_val));
+        TEST_ASSERT(fabs(float_val + 2500.0f) < 0.0001f);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_bool(&jctx, 2, &bool_val));
+        TEST_ASSERT_EQUAL(true, bool_val);
+        json_obj_leave_array(&jctx);
+        json_parse_end(&jctx);
+    }
+
+    /* The same result as json_parse_start(), removed whitespace must not join primitives */
+    const char *docs[] = {"[tru e]", "[1 2]", "[1 ,2]", "{\"a\":1", "{\"a\":\"b", "{\"a\" 1}", "", " [ ] ", "3 ", "3", "[1 \"a\"]", "[true\n]"};
+    for (int i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        const int expected = json_parse_start(&jctx, docs[i], strlen(docs[i]));
+        json_parse_end(&jctx);
+        for (int chunk_len = 1; chunk_len <= 3; chunk_len++) {
+            TEST_ASSERT_EQUAL(expected, test_parse_chunks(&jctx, docs[i], strlen(docs[i]), chunk_len));
+            if (expected != OS_SUCCESS) {
+                TEST_ASSERT_NULL(jctx.tokens);
+            }
+            json_parse_end(&jctx);
+        }
+    }
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_parse_chunk(&jctx, "{}", 2));
+}
+
+/* Log of the SAX events, one line per event with the path and the index of the value */
+typedef struct {
+    char log[1024];
+    int len;
+    int stop_after;
+} test_sax_log_t;
+
+static int test_sax_log_cb(json_sax_ctx_t *sax, json_sax_event_t event, const char *val, int len, void *priv)
+{
+    test_sax_log_t *log = priv;
+    const char *names[] = {"{", "}", "[", "]", "key", "str", "prim"};
+    log->len += snprintf(log->log + log->len, sizeof(log->log) - log->len, "%s %s#%d %.*s\n", names[event],
+                         json_sax_path(sax), json_sax_index(sax), len, val ? val : "");
+    TEST_ASSERT_LESS_THAN(sizeof(log->log), log->len);
+    return --log->stop_after ? OS_SUCCESS : -OS_FAIL;
+}
+
+static int test_sax_chunks(test_sax_log_t *log, const char *const *filter, int num_filters, const char *js, int chunk_len)
+{
+    json_sax_ctx_t sax;
+    char buf[32];
+    memset(log, 0, sizeof(*log));
+    log->stop_after = -1;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, test_sax_log_cb, log, buf, sizeof(buf)));
+    if (filter) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_set_filter(&sax, filter, num_filters));
+    }
+    const int len = strlen(js);
+    for (int pos = 0; pos < len; pos += chunk_len) {
+        if (json_sax_parse(&sax, js + pos, len - pos < chunk_len ? len - pos : chunk_len) != OS_SUCCESS) {
+            return -OS_FAIL;
+        }
+    }
+    return json_sax_end(&sax);
+}
+
+TEST_CASE("json_parser sax", "[json_parser]")
+{
+    test_sax_log_t log;
+    const char *expected =
+        "{ #-1 \n"
+        "key text#0 text\n"
+        "str text#0 a \\\"quoted\\\" \\\\ value\\n\n"
+        "key list#1 list\n"
+        "[ list#1 \n"
+        "prim list[]#0 1\n"
+        "prim list[]#1 -2.5e3\n"
+        "prim list[]#2 true\n"
+        "prim list[]#3 null\n"
+        "] list#1 \n"
+        "} #-1 \n";
+    for (int chunk_len = 1; chunk_len <= strlen(json_test_chunk_str); chunk_len++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, json_test_chunk_str, chunk_len));
+        TEST_ASSERT_EQUAL_STRING(expected, log.log);
+    }
+
+    /* Only the selected values, the other objects and arrays are skipped */
+    const char *filter[] = {"int_val", "features.arrays", "supported_el", "missing.key"};
+    expected =
+        "key int_val#2 int_val\n"
+        "prim int_val#2 2017\n"
+        "key supported_el#4 supported_el\n"
+        "[ supported_el#4 \n"
+        "str supported_el[]#0 bool\n"
+        "str supported_el[]#1 int\n"
+        "str supported_el[]#2 float\n"
+        "str supported_el[]#3 str\n"
+        "str supported_el[]#4 object\n"
+        "str supported_el[]#5 array\n"
+        "] supported_el#4 \n"
+        "key features.arrays#1 arrays\n"
+        "str features.arrays#1 yes\n";
+    for (int chunk_len = 1; chunk_len <= strlen(json_test_str); chunk_len++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, filter, 4, json_test_str, chunk_len));
+        TEST_ASSERT_EQUAL_STRING(expected, log.log);
+    }
+
+    /* Values in arrays of objects, top level arrays and primitives */
+    const char *elem_filter[] = {"[].b[]"};
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, elem_filter, 1, "[{\"a\":[1],\"b\":[2,3]},{\"b\":[]},{\"b\":[4]}]", 5));
+    TEST_ASSERT_EQUAL_STRING("prim [].b[]#0 2\nprim [].b[]#1 3\nprim [].b[]#0 4\n", log.log);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, " -12 ", 2));
+    TEST_ASSERT_EQUAL_STRING("prim #-1 -12\n", log.log);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, "-12", 1));
+    TEST_ASSERT_EQUAL_STRING("prim #-1 -12\n", log.log);
+
+    const char *invalid[] = {"[tru e]", "[1 2]", "{\"a\":1", "{\"a\":\"b", "{\"a\" 1}", "", "[1,]", "{\"a\":1]",
+                             "[\"\\x\"]", "[\"\\u12g4\"]", "[\"a\nb\"]", "{} {}", "{\"a\":1,}", "[1:2]", "{1:2}"
+                            };
+    for (int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        for (int chunk_len = 1; chunk_len <= 3; chunk_len++) {
+            TEST_ASSERT_EQUAL(-OS_FAIL, test_sax_chunks(&log, NULL, 0, invalid[i], chunk_len));
+        }
+    }
+
+    /* Limits of the nesting and of the path */
+    char deep[2 * JSON_SAX_MAX_DEPTH + 3];
+    memset(deep, '[', JSON_SAX_MAX_DEPTH);
+    memset(deep + JSON_SAX_MAX_DEPTH, ']', JSON_SAX_MAX_DEPTH);
+    deep[2 * JSON_SAX_MAX_DEPTH] = 0;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, deep, 7));
+    memmove(deep + 1, deep, 2 * JSON_SAX_MAX_DEPTH + 1);
+    deep[0] = '[';
+    strcat(deep, "]");
+    TEST_ASSERT_EQUAL(-OS_FAIL, test_sax_chunks(&log, NULL, 0, deep, 7));
+    char long_key[JSON_SAX_PATH_MAX + 8];
+    snprintf(long_key, sizeof(long_key), "{\"%0*d\":1}", JSON_SAX_PATH_MAX - 1, 0);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, long_key, 7));
+    snprintf(long_key, sizeof(long_key), "{\"%0*d\":1}", JSON_SAX_PATH_MAX, 0);
+    TEST_ASSERT_EQUAL(-OS_FAIL, test_sax_chunks(&log, NULL, 0, long_key, 7));
+
+    /* A value, which continues in the next chunk, must fit in the buffer, parsing fails at the end of the chunk */
+    json_sax_ctx_t sax;
+    memset(&log, 0, sizeof(log));
+    log.stop_after = -1;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, test_sax_log_cb, &log, NULL, 0));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_parse(&sax, "[\"abc\",\"d", 9));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_parse(&sax, "ef\"]", 4));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_end(&sax));
+    TEST_ASSERT_EQUAL_STRING("[ #-1 \nstr []#0 abc\n", log.log);
+
+    /* A primitive at the top level ends with the document, so it needs the buffer also in one chunk */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, test_sax_chunks(&log, NULL, 0, "true", 4));
+    TEST_ASSERT_EQUAL_STRING("prim #-1 true\n", log.log);
+    memset(&log, 0, sizeof(log));
+    log.stop_after = -1;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, test_sax_log_cb, &log, NULL, 0));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_parse(&sax, "42", 2));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_end(&sax));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, test_sax_log_cb, &log, NULL, 0));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_parse(&sax, "42\n", 3));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_end(&sax));
+    TEST_ASSERT_EQUAL_STRING("prim #-1 42\n", log.log);
+
+    /* The callback stops parsing */
+    memset(&log, 0, sizeof(log));
+    log.stop_after = 2;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, test_sax_log_cb, &log, NULL, 0));
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_parse(&sax, "[1,2,3]", 7));
+    TEST_ASSERT_EQUAL_STRING("[ #-1 \nprim []#0 1\n", log.log);
+
+    /* Values of the callbacks */
+    bool bool_val;
+    int int_val;
+    int64_t int64_val;
+    float float_val;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_bool("true,", 4, &bool_val));
+    TEST_ASSERT_EQUAL(true, bool_val);
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_to_bool("null,", 4, &bool_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_int("2017]", 4, &int_val));
+    TEST_ASSERT_EQUAL(2017, int_val);
+    TEST_ASSERT_EQUAL(-OS_FAIL, json_sax_to_int("2.5]", 3, &int_val));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_int64("109174583252}", 12, &int64_val));
+    TEST_ASSERT(int64_val == 109174583252);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_float("-2.5e3 ", 6, &float_val));
+    TEST_ASSERT(fabs(float_val + 2500.0f) < 0.0001f);
+}
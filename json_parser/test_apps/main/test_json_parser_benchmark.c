@@ -0,0 +1,512 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+/* The reference of the parse benchmark uses jsmn directly, with the same options as json_parser */
+#define JSMN_PARENT_LINKS
+#define JSMN_STRICT
+#define JSMN_STATIC
+#include "jsmn.h"
+#include "json_parser.h"
+
+#define TEST_BENCHMARK_ITERATIONS   20
+#define TEST_CONFIG_PARAMS          250
+#define TEST_CONFIG_NODES           60
+/* Nodes of the large document of the parse benchmark, about 100 KB */
+#define TEST_LARGE_NODES            330
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/* Provisioning/config document: device info, network settings, a flat object of parameters and a list of
+ * nodes with their own settings. With TEST_CONFIG_PARAMS and TEST_CONFIG_NODES, it has about 20 KB. */
+static char *test_config_doc(int params, int nodes, size_t *doc_len)
+{
+    const size_t doc_size = 512 + params * 24 + nodes * 320;
+    char *doc = malloc(doc_size);
+    TEST_ASSERT_NOT_NULL(doc);
+    size_t len = 0;
+#define DOC_APPEND(...) do { \
+        len += snprintf(doc + len, doc_size - len, __VA_ARGS__); \
+        TEST_ASSERT_LESS_THAN(doc_size, len); \
+    } while (0)
+
+    DOC_APPEND("{\"version\":3,\"device\":{\"name\":\"esp-node\",\"serial\":\"ESP-0001-A7\",\"model\":\"ESP32-S3\","
+               "\"fw\":\"2.4.1\",\"tz\":\"CET-1CEST\",\"secure\":true},");
+    DOC_APPEND("\"wifi\":{\"ssid\":\"factory-floor-2\",\"password\":\"a3f9c02e71d4b58e\",\"channel\":11,"
+               "\"retries\":5,\"power_save\":false},");
+    DOC_APPEND("\"params\":{");
+    for (int i = 0; i < params; i++) {
+        DOC_APPEND("%s\"param_%03d\":%d", i ? "," : "", i, i * 7);
+    }
+    DOC_APPEND("},\"nodes\":[");
+    for (int i = 0; i < nodes; i++) {
+        DOC_APPEND("%s{\"id\":%d,\"name\":\"node-%02d\",\"type\":\"sensor\",\"enabled\":true,"
+                   "\"location\":{\"building\":\"B%d\",\"floor\":%d,\"room\":\"R%03d\"},"
+                   "\"thresholds\":[%d,%d,%d,%d],\"interval\":%d,\"report\":\"mqtt\",\"qos\":1,"
+                   "\"calibration\":{\"offset\":0.%d,\"gain\":1.0%d},\"tags\":[\"indoor\",\"zone-%d\"]}",
+                   i ? "," : "", i, i, i % 4, i % 7, i, i, i + 1, i + 2, i + 3, 1000 + i, i % 10, i % 10, i % 5);
+    }
+    DOC_APPEND("],\"mqtt\":{\"uri\":\"mqtts://broker.local:8883\",\"client_id\":\"esp-node-0001\",\"keepalive\":120,"
+               "\"topic\":\"factory/line2/node1\",\"clean\":true}}");
+#undef DOC_APPEND
+    *doc_len = len;
+    return doc;
+}
+
+/* Read all settings of the document, the result is the sum of the values */
+static int64_t test_config_read(jparse_ctx_t *jctx)
+{
+    int64_t sum = 0;
+    int val, num_elem;
+    bool flag;
+    char str[32];
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "version", &val));
+    sum += val;
+
+    /* Settings at the end of the document are the most expensive to find */
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "mqtt"));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "keepalive", &val));
+    sum += val;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_string(jctx, "uri", str, sizeof(str)));
+    sum += strlen(str);
+    json_obj_leave_object(jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "wifi"));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "channel", &val));
+    sum += val;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_bool(jctx, "power_save", &flag));
+    sum += flag;
+    json_obj_leave_object(jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "params"));
+    for (int i = TEST_CONFIG_PARAMS - 1; i >= 0; i--) {
+        char key[16];
+        snprintf(key, sizeof(key), "param_%03d", i);
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, key, &val));
+        sum += val;
+    }
+    json_obj_leave_object(jctx);
+
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(jctx, "nodes", &num_elem));
+    for (int i = 0; i < num_elem; i++) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_object(jctx, i));
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "interval", &val));
+        sum += val;
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "qos", &val));
+        sum += val;
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_object(jctx, "location"));
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "floor", &val));
+        sum += val;
+        json_obj_leave_object(jctx);
+        json_arr_leave_object(jctx);
+    }
+    json_obj_leave_array(jctx);
+    return sum;
+}
+
+/**
+ * @brief Benchmark of reading a config document with and without the index
+ *
+ * The time with the index includes json_parse_index_start() and building of the key tables.
+ */
+TEST_CASE("json_parser index benchmark", "[json_parser][benchmark]")
+{
+    size_t doc_len;
+    char *doc = test_config_doc(TEST_CONFIG_PARAMS, TEST_CONFIG_NODES, &doc_len);
+    jparse_ctx_t jctx;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, doc, doc_len));
+    const size_t arena_size = json_parse_index_size(&jctx);
+    void *arena = malloc(arena_size);
+    TEST_ASSERT_NOT_NULL(arena);
+
+    const int64_t expected = test_config_read(&jctx);
+    uint64_t linear = 0, indexed = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        memset(&jctx.index, 0, sizeof(jctx.index));
+        uint64_t start = test_benchmark_now();
+        int64_t sum = test_config_read(&jctx);
+        linear += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, arena_size));
+        sum = test_config_read(&jctx);
+        indexed += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+    }
+    printf("Config document %zu bytes, %d tokens, index arena %zu bytes: read %" PRIu64 ", with index %" PRIu64
+           " " TEST_BENCHMARK_UNIT "\n", doc_len, jctx.num_tokens, arena_size,
+           linear / TEST_BENCHMARK_ITERATIONS, indexed / TEST_BENCHMARK_ITERATIONS);
+
+    json_parse_end(&jctx);
+    free(arena);
+    free(doc);
+}
+
+/* json_parse_start() before it parsed in one pass: count the tokens, allocate them and parse again */
+static int test_parse_two_pass(const char *js, size_t len, jsmntok_t **tokens)
+{
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    int num_tokens = jsmn_parse(&parser, js, len, NULL, 0);
+    TEST_ASSERT_GREATER_THAN(0, num_tokens);
+    *tokens = calloc(num_tokens, sizeof(jsmntok_t));
+    TEST_ASSERT_NOT_NULL(*tokens);
+    jsmn_init(&parser);
+    return jsmn_parse(&parser, js, len, *tokens, num_tokens);
+}
+
+static void test_parse_benchmark(int params, int nodes)
+{
+    size_t doc_len;
+    char *doc = test_config_doc(params, nodes, &doc_len);
+
+    uint64_t two_pass = 0, one_pass = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        jsmntok_t *tokens;
+        uint64_t start = test_benchmark_now();
+        const int num_tokens = test_parse_two_pass(doc, doc_len, &tokens);
+        two_pass += test_benchmark_now() - start;
+
+        jparse_ctx_t jctx;
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, doc, doc_len));
+        one_pass += test_benchmark_now() - start;
+
+        TEST_ASSERT_EQUAL(num_tokens, jctx.num_tokens);
+        TEST_ASSERT_EQUAL_MEMORY(tokens, jctx.tokens, num_tokens * sizeof(jsmntok_t));
+        json_parse_end(&jctx);
+        free(tokens);
+    }
+    printf("Parse %zu bytes: two passes %" PRIu64 ", json_parse_start %" PRIu64 " " TEST_BENCHMARK_UNIT "\n",
+           doc_len, two_pass / TEST_BENCHMARK_ITERATIONS, one_pass / TEST_BENCHMARK_ITERATIONS);
+    free(doc);
+}
+
+/**
+ * @brief Benchmark of json_parse_start() against counting the tokens in a separate pass
+ */
+TEST_CASE("json_parser parse benchmark", "[json_parser][benchmark]")
+{
+    test_parse_benchmark(TEST_CONFIG_PARAMS, TEST_CONFIG_NODES);
+    test_parse_benchmark(TEST_CONFIG_PARAMS, TEST_LARGE_NODES);
+}
+
+#define TEST_CHUNK_SIZE     512
+
+/* Indent the document like a pretty printer, with a new line after every '{', '[' and ',' outside of strings */
+static char *test_pretty_doc(const char *doc, size_t doc_len, size_t *pretty_len)
+{
+    const size_t pretty_size = doc_len * 8;
+    char *pretty = malloc(pretty_size);
+    TEST_ASSERT_NOT_NULL(pretty);
+    size_t len = 0;
+    int depth = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < doc_len; i++) {
+        const char c = doc[i];
+        if (c == '"' && (i == 0 || doc[i - 1] != '\\')) {
+            in_string = !in_string;
+        }
+        if (!in_string && (c == '}' || c == ']')) {
+            depth--;
+            len += snprintf(pretty + len, pretty_size - len, "\n%*s", depth * 4, "");
+        }
+        pretty[len++] = c;
+        if (!in_string && (c == '{' || c == '[' || c == ',')) {
+            depth += c != ',';
+            len += snprintf(pretty + len, pretty_size - len, "\n%*s", depth * 4, "");
+        } else if (!in_string && c == ':') {
+            pretty[len++] = ' ';
+        }
+        TEST_ASSERT_LESS_THAN(pretty_size, len);
+    }
+    *pretty_len = len;
+    return pretty;
+}
+
+/**
+ * @brief Benchmark of parsing a pretty printed document in chunks against reassembling it first
+ *
+ * The peak memory of reassembling is the document and its tokens, for chunks it is the compacted text,
+ * the tokens and one chunk, with the spare room of the growing buffers.
+ */
+TEST_CASE("json_parser chunk benchmark", "[json_parser][benchmark]")
+{
+    size_t doc_len, pretty_len;
+    char *doc = test_config_doc(TEST_CONFIG_PARAMS, TEST_LARGE_NODES, &doc_len);
+    char *pretty = test_pretty_doc(doc, doc_len, &pretty_len);
+    free(doc);
+
+    uint64_t whole = 0, chunked = 0;
+    size_t whole_mem = 0, chunked_mem = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        /* Chunks are copied as they would be received */
+        jparse_ctx_t jctx;
+        uint64_t start = test_benchmark_now();
+        char *buf = malloc(pretty_len);
+        TEST_ASSERT_NOT_NULL(buf);
+        for (size_t pos = 0; pos < pretty_len; pos += TEST_CHUNK_SIZE) {
+            const size_t len = pretty_len - pos < TEST_CHUNK_SIZE ? pretty_len - pos : TEST_CHUNK_SIZE;
+            memcpy(buf + pos, pretty + pos, len);
+        }
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, buf, pretty_len));
+        whole += test_benchmark_now() - start;
+        const int num_tokens = jctx.num_tokens;
+        whole_mem = pretty_len + num_tokens * sizeof(json_tok_t);
+        json_parse_end(&jctx);
+        free(buf);
+
+        char chunk[TEST_CHUNK_SIZE];
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_chunk_start(&jctx, 0));
+        for (size_t pos = 0; pos < pretty_len; pos += TEST_CHUNK_SIZE) {
+            const size_t len = pretty_len - pos < TEST_CHUNK_SIZE ? pretty_len - pos : TEST_CHUNK_SIZE;
+            memcpy(chunk, pretty + pos, len);
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_chunk(&jctx, chunk, len));
+            const size_t mem = jctx.chunk.size + jctx.chunk.max_tokens * sizeof(json_tok_t) + TEST_CHUNK_SIZE;
+            chunked_mem = mem > chunked_mem ? mem : chunked_mem;
+        }
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_chunk_end(&jctx));
+        chunked += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(num_tokens, jctx.num_tokens);
+        TEST_ASSERT_EQUAL(doc_len, jctx.chunk.len);
+        json_parse_end(&jctx);
+    }
+    printf("Parse %zu bytes in chunks of %d: reassembled %" PRIu64 " " TEST_BENCHMARK_UNIT " %zu bytes, "
+           "chunked %" PRIu64 " " TEST_BENCHMARK_UNIT " %zu bytes\n", pretty_len, TEST_CHUNK_SIZE,
+           whole / TEST_BENCHMARK_ITERATIONS, whole_mem, chunked / TEST_BENCHMARK_ITERATIONS, chunked_mem);
+    free(pretty);
+}
+
+/* The settings of test_config_read() for the SAX parser, the callback switches on the index of the path */
+static const char *const test_sax_config_paths[] = {
+    "version", "mqtt.keepalive", "mqtt.uri", "wifi.channel", "wifi.power_save", "params",
+    "nodes[].interval", "nodes[].qos", "nodes[].location.floor",
+};
+
+static int test_sax_config_cb(json_sax_ctx_t *sax, json_sax_event_t event, const char *val, int len, void *priv)
+{
+    int64_t *sum = priv;
+    int ival;
+    bool flag;
+    if (event == JSON_SAX_STRING) {
+        /* mqtt.uri */
+        *sum += len;
+    } else if (event == JSON_SAX_PRIMITIVE) {
+        if (json_sax_filter_index(sax) == 4) {
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_bool(val, len, &flag));
+            *sum += flag;
+        } else {
+            TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_to_int(val, len, &ival));
+            *sum += ival;
+        }
+    }
+    return OS_SUCCESS;
+}
+
+static int test_sax_count_cb(json_sax_ctx_t *sax, json_sax_event_t event, const char *val, int len, void *priv)
+{
+    (*(int64_t *)priv)++;
+    return OS_SUCCESS;
+}
+
+static int64_t test_sax_read(const char *doc, size_t doc_len, size_t chunk_len, bool filter)
+{
+    json_sax_ctx_t sax;
+    char buf[64];
+    int64_t sum = 0;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_start(&sax, filter ? test_sax_config_cb : test_sax_count_cb, &sum,
+                                                 buf, sizeof(buf)));
+    if (filter) {
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_set_filter(&sax, test_sax_config_paths,
+                                                          sizeof(test_sax_config_paths) / sizeof(test_sax_config_paths[0])));
+    }
+    for (size_t pos = 0; pos < doc_len; pos += chunk_len) {
+        const size_t len = doc_len - pos < chunk_len ? doc_len - pos : chunk_len;
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_parse(&sax, doc + pos, len));
+    }
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_sax_end(&sax));
+    return sum;
+}
+
+/**
+ * @brief Benchmark of reading the settings of the large config document with the SAX parser against the tokens
+ *
+ * The memory of the tokens is the document and its tokens. The SAX parser needs only its context, the buffer
+ * of split values and the chunk.
+ */
+TEST_CASE("json_parser sax benchmark", "[json_parser][benchmark]")
+{
+    size_t doc_len;
+    char *doc = test_config_doc(TEST_CONFIG_PARAMS, TEST_LARGE_NODES, &doc_len);
+
+    uint64_t tokens = 0, sax_whole = 0, sax_chunks = 0, sax_events = 0;
+    size_t tokens_mem = 0;
+    int64_t events = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        jparse_ctx_t jctx;
+        uint64_t start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, doc, doc_len));
+        const int64_t sum = test_config_read(&jctx);
+        tokens += test_benchmark_now() - start;
+        tokens_mem = doc_len + jctx.num_tokens * sizeof(json_tok_t);
+        json_parse_end(&jctx);
+
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(sum, test_sax_read(doc, doc_len, doc_len, true));
+        sax_whole += test_benchmark_now() - start;
+
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(sum, test_sax_read(doc, doc_len, TEST_CHUNK_SIZE, true));
+        sax_chunks += test_benchmark_now() - start;
+
+        /* All events, without the filter */
+        start = test_benchmark_now();
+        events = test_sax_read(doc, doc_len, TEST_CHUNK_SIZE, false);
+        sax_events += test_benchmark_now() - start;
+    }
+    printf("Read %zu bytes: tokens %" PRIu64 " " TEST_BENCHMARK_UNIT " %zu bytes, sax %" PRIu64 ", "
+           "in chunks of %d %" PRIu64 " " TEST_BENCHMARK_UNIT " %zu bytes, all %" PRId64 " events %" PRIu64 " "
+           TEST_BENCHMARK_UNIT "\n", doc_len, tokens / TEST_BENCHMARK_ITERATIONS, tokens_mem,
+           sax_whole / TEST_BENCHMARK_ITERATIONS, TEST_CHUNK_SIZE, sax_chunks / TEST_BENCHMARK_ITERATIONS,
+           sizeof(json_sax_ctx_t) + 64 + TEST_CHUNK_SIZE, events, sax_events / TEST_BENCHMARK_ITERATIONS);
+    free(doc);
+}
+
+#define TEST_SCAN_RESULTS   500
+
+/* Wi-Fi scan results */
+static char *test_scan_doc(size_t *doc_len)
+{
+    const size_t doc_size = 64 + TEST_SCAN_RESULTS * 112;
+    char *doc = malloc(doc_size);
+    TEST_ASSERT_NOT_NULL(doc);
+    size_t len = snprintf(doc, doc_size, "{\"ap_list\":[");
+    for (int i = 0; i < TEST_SCAN_RESULTS; i++) {
+        len += snprintf(doc + len, doc_size - len, "%s{\"ssid\":\"network-%03d\",\"bssid\":\"24:0a:c4:%02x:%02x:%02x\","
+                        "\"rssi\":-%d,\"channel\":%d,\"auth\":%d}", i ? "," : "", i, i & 0xff, i >> 8, i % 7,
+                        30 + i % 60, 1 + i % 13, i % 5);
+        TEST_ASSERT_LESS_THAN(doc_size, len);
+    }
+    len += snprintf(doc + len, doc_size - len, "]}");
+    TEST_ASSERT_LESS_THAN(doc_size, len);
+    *doc_len = len;
+    return doc;
+}
+
+static int test_scan_read_ap(jparse_ctx_t *jctx, int index)
+{
+    int rssi, channel;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_arr_get_object(jctx, index));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "rssi", &rssi));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_int(jctx, "channel", &channel));
+    json_arr_leave_object(jctx);
+    return rssi + channel;
+}
+
+/**
+ * @brief Benchmark of reading all elements of an array
+ *
+ * Without the cursors of json_parse_arr_cursors_start(), every element is found from the start of the array.
+ */
+TEST_CASE("json_parser array benchmark", "[json_parser][benchmark]")
+{
+    size_t doc_len;
+    char *doc = test_scan_doc(&doc_len);
+    jparse_ctx_t jctx;
+    int num_elem;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_start(&jctx, doc, doc_len));
+    const size_t arena_size = json_parse_index_size(&jctx);
+    void *arena = malloc(arena_size);
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, json_obj_get_array(&jctx, "ap_list", &num_elem));
+    TEST_ASSERT_EQUAL(TEST_SCAN_RESULTS, num_elem);
+
+    int expected = 0;
+    for (int i = 0; i < num_elem; i++) {
+        expected += test_scan_read_ap(&jctx, i);
+    }
+
+    json_arr_cursors_t cursors;
+    uint64_t no_cursor = 0, by_index = 0, iterator = 0, indexed = 0;
+    for (int n = 0; n < TEST_BENCHMARK_ITERATIONS; n++) {
+        int sum = 0;
+        uint64_t start = test_benchmark_now();
+        for (int i = 0; i < num_elem; i++) {
+            sum += test_scan_read_ap(&jctx, i);
+        }
+        no_cursor += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_arr_cursors_start(&jctx, &cursors));
+
+        sum = 0;
+        start = test_benchmark_now();
+        for (int i = 0; i < num_elem; i++) {
+            sum += test_scan_read_ap(&jctx, i);
+        }
+        by_index += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+
+        sum = 0;
+        start = test_benchmark_now();
+        json_arr_iter_t iter;
+        json_arr_iter_begin(&jctx, &iter);
+        while (json_arr_iter_next(&jctx, &iter) == OS_SUCCESS) {
+            sum += test_scan_read_ap(&jctx, iter.index);
+        }
+        iterator += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+
+        /* Elements in reverse order, with the element table */
+        sum = 0;
+        start = test_benchmark_now();
+        TEST_ASSERT_EQUAL(OS_SUCCESS, json_parse_index_start(&jctx, arena, arena_size));
+        for (int i = num_elem - 1; i >= 0; i--) {
+            sum += test_scan_read_ap(&jctx, i);
+        }
+        indexed += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(expected, sum);
+        memset(&jctx.index, 0, sizeof(jctx.index));
+        jctx.arr_cursors = NULL;
+    }
+    printf("Array of %d objects: without cursors %" PRIu64 ", by index %" PRIu64 ", iterator %" PRIu64
+           ", indexed in reverse %" PRIu64 " " TEST_BENCHMARK_UNIT "\n", num_elem,
+           no_cursor / TEST_BENCHMARK_ITERATIONS, by_index / TEST_BENCHMARK_ITERATIONS,
+           iterator / TEST_BENCHMARK_ITERATIONS, indexed / TEST_BENCHMARK_ITERATIONS);
+
+    json_parse_end(&jctx);
+    free(arena);
+    free(doc);
+}
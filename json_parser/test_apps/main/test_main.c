@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,7 +7,11 @@
 #include "unity.h"
 #include "unity_test_runner.h"
 #include "esp_heap_caps.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_newlib.h"
+#endif // !CONFIG_IDF_TARGET_LINUX
+
 #include "unity_test_utils_memory.h"
 
 void setUp(void)
@@ -17,7 +21,9 @@ void setUp(void)
 
 void tearDown(void)
 {
+#if !CONFIG_IDF_TARGET_LINUX
     esp_reent_cleanup();    //clean up some of the newlib's lazy allocations
+#endif // !CONFIG_IDF_TARGET_LINUX
     unity_utils_evaluate_leaks_direct(0);
 }
 
@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Row-streaming QOI encoder and decoder.
+ *
+ * qoi_encode() and qoi_decode() allocate the whole output image. The functions
+ * below work on one row of pixels at a time, into and from buffers of the
+ * caller, and never allocate memory. The encoded stream is byte-identical to
+ * the output of qoi_encode().
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "qoi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of the QOI header written by qoi_stream_encode_begin() */
+#define QOI_STREAM_HEADER_SIZE  14
+
+/** Size of the end marker written by qoi_stream_encode_end() */
+#define QOI_STREAM_END_SIZE     8
+
+/**
+ * @brief Output buffer size, which is always enough for qoi_stream_encode_row()
+ *
+ * In the worst case every pixel is encoded as QOI_OP_RGB or QOI_OP_RGBA, plus
+ * one QOI_OP_RUN ending a run of pixels from the previous row.
+ */
+#define QOI_STREAM_ROW_MAX_SIZE(width, channels)    ((size_t)(width) * ((channels) + 1) + 1)
+
+/**
+ * @brief State of the streaming encoder
+ *
+ * Pixels are kept packed in one word as R | G << 8 | B << 16 | A << 24, so that
+ * runs and the index are checked with single word compares.
+ */
+typedef struct {
+    qoi_desc desc;          /*!< Description of the encoded image */
+    uint32_t index[64];     /*!< Previously seen pixels */
+    uint32_t px_prev;       /*!< Previous pixel */
+    uint32_t run;           /*!< Number of pixels equal to px_prev, which are not written yet */
+    uint32_t row;           /*!< Number of encoded rows */
+} qoi_stream_encoder_t;
+
+/**
+ * @brief State of the streaming decoder
+ */
+typedef struct {
+    qoi_desc desc;          /*!< Description of the decoded image, from its header */
+    const uint8_t *data;    /*!< Encoded image */
+    size_t pos;             /*!< Position of the next chunk in data */
+    size_t chunks_len;      /*!< Size of data without the end marker */
+    uint32_t index[64];     /*!< Previously seen pixels */
+    uint32_t px;            /*!< Last decoded pixel */
+    uint32_t run;           /*!< Number of pixels equal to px, which are not output yet */
+    uint32_t row;           /*!< Number of decoded rows */
+    uint8_t channels;       /*!< Number of channels of the output rows */
+} qoi_stream_decoder_t;
+
+/**
+ * @brief Start encoding an image and write its header
+ *
+ * @param[out] enc      Encoder state
+ * @param[in]  desc     Description of the image, the same as for qoi_encode()
+ * @param[out] out      Output buffer
+ * @param[in]  out_size Size of the output buffer, at least QOI_STREAM_HEADER_SIZE
+ *
+ * @return Number of bytes written to out, or -1 on invalid arguments
+ */
+int qoi_stream_encode_begin(qoi_stream_encoder_t *enc, const qoi_desc *desc, void *out, size_t out_size);
+
+/**
+ * @brief Encode the next row of the image
+ *
+ * A run of equal pixels can continue into the next row, so a row may produce
+ * no output at all.
+ *
+ * @param[in,out] enc      Encoder state
+ * @param[in]     row      Pixels of the row, desc.width * desc.channels bytes
+ * @param[out]    out      Output buffer
+ * @param[in]     out_size Size of the output buffer, at least QOI_STREAM_ROW_MAX_SIZE(desc.width, desc.channels)
+ *
+ * @return Number of bytes written to out, or -1 on invalid arguments or when all rows are already encoded
+ */
+int qoi_stream_encode_row(qoi_stream_encoder_t *enc, const void *row, void *out, size_t out_size);
+
+/**
+ * @brief Finish the image and write the end marker
+ *
+ * @param[in]  enc      Encoder state, with all rows of the image encoded
+ * @param[out] out      Output buffer
+ * @param[in]  out_size Size of the output buffer, at least QOI_STREAM_END_SIZE
+ *
+ * @return Number of bytes written to out, or -1 on invalid arguments or when some rows are not encoded
+ */
+int qoi_stream_encode_end(qoi_stream_encoder_t *enc, void *out, size_t out_size);
+
+/**
+ * @brief Parse the header of an encoded image and start decoding it
+ *
+ * The encoded image must stay in memory (RAM or memory mapped flash) until the
+ * last row is decoded.
+ *
+ * @param[out] dec      Decoder state
+ * @param[in]  data     Encoded image
+ * @param[in]  size     Size of the encoded image
+ * @param[out] desc     Description of the image from its header, can be NULL
+ * @param[in]  channels Number of channels of the output rows: 3, 4 or 0 to use the channels of the image
+ *
+ * @return 0 on success, -1 on invalid arguments or an invalid header
+ */
+int qoi_stream_decode_begin(qoi_stream_decoder_t *dec, const void *data, size_t size, qoi_desc *desc, int channels);
+
+/**
+ * @brief Decode the next row of the image
+ *
+ * @param[in,out] dec Decoder state
+ * @param[out]    row Output buffer of desc.width * channels bytes
+ *
+ * @return 0 on success, -1 on invalid arguments or when all rows are already decoded
+ */
+int qoi_stream_decode_row(qoi_stream_decoder_t *dec, void *row);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: MIT
  *
@@ -9,6 +9,322 @@
  * place where the qoi_encode()/qoi_decode()/qoi_write()/qoi_read() functions
  * are compiled. All other users of the component just #include "qoi.h" and
  * link against this compiled object.
+ *
+ * The row-streaming encoder and decoder from qoi_stream.h are implemented
+ * below, with the chunk definitions of the library.
  */
+#include <string.h>
+#include "qoi_stream.h"
+
 #define QOI_IMPLEMENTATION
 #include "qoi.h"
+
+#define QOI_STREAM_RUN_MAX  62
+
+/* The top bit of every byte in a word */
+#define QOI_STREAM_HI       0x80808080u
+
+/* Read a pixel packed as R | G << 8 | B << 16 | A << 24. Three channel pixels are opaque. */
+static inline __attribute__((always_inline)) uint32_t qoi_stream_load(const uint8_t *px, const unsigned int channels)
+{
+    if (channels == 4) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint32_t v;
+        memcpy(&v, px, sizeof(v));
+        return v;
+#else
+        return px[0] | px[1] << 8 | px[2] << 16 | (uint32_t)px[3] << 24;
+#endif
+    }
+    return px[0] | px[1] << 8 | px[2] << 16 | 0xff000000u;
+}
+
+static inline __attribute__((always_inline)) void qoi_stream_store(uint8_t *px, uint32_t v, const unsigned int channels)
+{
+    if (channels == 4) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(px, &v, sizeof(v));
+        return;
+#else
+        px[3] = v >> 24;
+#endif
+    }
+    px[0] = v;
+    px[1] = v >> 8;
+    px[2] = v >> 16;
+}
+
+/* QOI_COLOR_HASH() with two multiplications, R and B, G and A are in the 16-bit halves of the words */
+static inline uint32_t qoi_stream_hash(uint32_t px)
+{
+    return (((px & 0x00ff00ffu) * 0x00030007u + ((px >> 8) & 0x00ff00ffu) * 0x0005000bu) >> 16) & 63;
+}
+
+/* Add and subtract all bytes of the words at once, without carries between the bytes */
+static inline uint32_t qoi_stream_add_bytes(uint32_t a, uint32_t b)
+{
+    return ((a & ~QOI_STREAM_HI) + (b & ~QOI_STREAM_HI)) ^ ((a ^ b) & QOI_STREAM_HI);
+}
+
+static inline uint32_t qoi_stream_sub_bytes(uint32_t a, uint32_t b)
+{
+    return ((a | QOI_STREAM_HI) - (b & ~QOI_STREAM_HI)) ^ ((a ^ ~b) & QOI_STREAM_HI);
+}
+
+static void qoi_stream_write_32(uint8_t *bytes, uint32_t v)
+{
+    bytes[0] = v >> 24;
+    bytes[1] = v >> 16;
+    bytes[2] = v >> 8;
+    bytes[3] = v;
+}
+
+static uint32_t qoi_stream_read_32(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+}
+
+int qoi_stream_encode_begin(qoi_stream_encoder_t *enc, const qoi_desc *desc, void *out, size_t out_size)
+{
+    if (enc == NULL || desc == NULL || out == NULL || out_size < QOI_STREAM_HEADER_SIZE ||
+            desc->width == 0 || desc->height == 0 ||
+            desc->channels < 3 || desc->channels > 4 ||
+            desc->colorspace > 1 ||
+            desc->height >= QOI_PIXELS_MAX / desc->width) {
+        return -1;
+    }
+
+    memset(enc, 0, sizeof(*enc));
+    enc->desc = *desc;
+    enc->px_prev = 0xff000000u;
+
+    uint8_t *bytes = out;
+    qoi_stream_write_32(bytes, QOI_MAGIC);
+    qoi_stream_write_32(bytes + 4, desc->width);
+    qoi_stream_write_32(bytes + 8, desc->height);
+    bytes[12] = desc->channels;
+    bytes[13] = desc->colorspace;
+    return QOI_STREAM_HEADER_SIZE;
+}
+
+static inline __attribute__((always_inline)) size_t qoi_stream_encode_pixels(qoi_stream_encoder_t *enc, const uint8_t *in,
+        uint8_t *bytes, const unsigned int channels)
+{
+    const uint8_t *const end = in + enc->desc.width * channels;
+    uint32_t px_prev = enc->px_prev;
+    uint32_t run = enc->run;
+    size_t p = 0;
+
+    while (in < end) {
+        uint32_t px = qoi_stream_load(in, channels);
+        in += channels;
+
+        if (px == px_prev) {
+            run++;
+            while (in < end && qoi_stream_load(in, channels) == px_prev) {
+                run++;
+                in += channels;
+            }
+            while (run >= QOI_STREAM_RUN_MAX) {
+                bytes[p++] = QOI_OP_RUN | (QOI_STREAM_RUN_MAX - 1);
+                run -= QOI_STREAM_RUN_MAX;
+            }
+            continue;
+        }
+
+        if (run > 0) {
+            bytes[p++] = QOI_OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        const uint32_t index_pos = qoi_stream_hash(px);
+        if (enc->index[index_pos] == px) {
+            bytes[p++] = QOI_OP_INDEX | index_pos;
+        } else {
+            enc->index[index_pos] = px;
+
+            if ((px ^ px_prev) >> 24 == 0) {
+                /* Differences of R, G and B in the low three bytes, biased by 2 for QOI_OP_DIFF */
+                const uint32_t diff = qoi_stream_sub_bytes(px, px_prev);
+                const uint32_t biased = qoi_stream_add_bytes(diff, 0x00020202u);
+
+                if ((biased & 0x00fcfcfcu) == 0) {
+                    bytes[p++] = QOI_OP_DIFF | (biased & 0x03) << 4 | (biased >> 6 & 0x0c) | (biased >> 16 & 0x03);
+                } else {
+                    const int8_t vr = (int8_t)diff;
+                    const int8_t vg = (int8_t)(diff >> 8);
+                    const int8_t vb = (int8_t)(diff >> 16);
+                    const int8_t vg_r = (int8_t)(vr - vg);
+                    const int8_t vg_b = (int8_t)(vb - vg);
+
+                    if ((unsigned int)(vg_r + 8) < 16 && (unsigned int)(vg + 32) < 64 && (unsigned int)(vg_b + 8) < 16) {
+                        bytes[p++] = QOI_OP_LUMA | (vg + 32);
+                        bytes[p++] = (vg_r + 8) << 4 | (vg_b + 8);
+                    } else {
+                        bytes[p++] = QOI_OP_RGB;
+                        bytes[p++] = px;
+                        bytes[p++] = px >> 8;
+                        bytes[p++] = px >> 16;
+                    }
+                }
+            } else {
+                bytes[p++] = QOI_OP_RGBA;
+                bytes[p++] = px;
+                bytes[p++] = px >> 8;
+                bytes[p++] = px >> 16;
+                bytes[p++] = px >> 24;
+            }
+        }
+        px_prev = px;
+    }
+
+    enc->px_prev = px_prev;
+    enc->run = run;
+    return p;
+}
+
+int qoi_stream_encode_row(qoi_stream_encoder_t *enc, const void *row, void *out, size_t out_size)
+{
+    if (enc == NULL || row == NULL || out == NULL || enc->row >= enc->desc.height ||
+            out_size < QOI_STREAM_ROW_MAX_SIZE(enc->desc.width, enc->desc.channels)) {
+        return -1;
+    }
+
+    uint8_t *bytes = out;
+    size_t p;
+    if (enc->desc.channels == 4) {
+        p = qoi_stream_encode_pixels(enc, row, bytes, 4);
+    } else {
+        p = qoi_stream_encode_pixels(enc, row, bytes, 3);
+    }
+
+    /* The run cannot continue after the last pixel of the image */
+    if (++enc->row == enc->desc.height && enc->run > 0) {
+        bytes[p++] = QOI_OP_RUN | (enc->run - 1);
+        enc->run = 0;
+    }
+    return p;
+}
+
+int qoi_stream_encode_end(qoi_stream_encoder_t *enc, void *out, size_t out_size)
+{
+    if (enc == NULL || out == NULL || out_size < QOI_STREAM_END_SIZE || enc->row != enc->desc.height) {
+        return -1;
+    }
+
+    memcpy(out, qoi_padding, QOI_STREAM_END_SIZE);
+    return QOI_STREAM_END_SIZE;
+}
+
+int qoi_stream_decode_begin(qoi_stream_decoder_t *dec, const void *data, size_t size, qoi_desc *desc, int channels)
+{
+    if (dec == NULL || data == NULL || (channels != 0 && channels != 3 && channels != 4) ||
+            size < QOI_STREAM_HEADER_SIZE + QOI_STREAM_END_SIZE) {
+        return -1;
+    }
+
+    const uint8_t *bytes = data;
+    qoi_desc header = {
+        .width = qoi_stream_read_32(bytes + 4),
+        .height = qoi_stream_read_32(bytes + 8),
+        .channels = bytes[12],
+        .colorspace = bytes[13],
+    };
+    if (qoi_stream_read_32(bytes) != QOI_MAGIC ||
+            header.width == 0 || header.height == 0 ||
+            header.channels < 3 || header.channels > 4 ||
+            header.colorspace > 1 ||
+            header.height >= QOI_PIXELS_MAX / header.width) {
+        return -1;
+    }
+
+    memset(dec, 0, sizeof(*dec));
+    dec->desc = header;
+    dec->data = bytes;
+    dec->pos = QOI_STREAM_HEADER_SIZE;
+    dec->chunks_len = size - QOI_STREAM_END_SIZE;
+    dec->px = 0xff000000u;
+    dec->channels = channels ? channels : header.channels;
+    if (desc) {
+        *desc = header;
+    }
+    return 0;
+}
+
+static inline __attribute__((always_inline)) void qoi_stream_decode_pixels(qoi_stream_decoder_t *dec, uint8_t *out,
+        const unsigned int channels)
+{
+    const uint8_t *const bytes = dec->data;
+    const size_t chunks_len = dec->chunks_len;
+    uint8_t *const end = out + dec->desc.width * channels;
+    size_t p = dec->pos;
+    uint32_t px = dec->px;
+    uint32_t run = dec->run;
+
+    while (out < end) {
+        if (run > 0) {
+            /* Fill the rest of the run in this row */
+            size_t n = (end - out) / channels;
+            if (n > run) {
+                n = run;
+            }
+            run -= n;
+            while (n--) {
+                qoi_stream_store(out, px, channels);
+                out += channels;
+            }
+            continue;
+        }
+
+        /* When the chunks end early, the last pixel repeats, like in qoi_decode() */
+        if (p < chunks_len) {
+            const uint32_t b1 = bytes[p++];
+
+            if (b1 == QOI_OP_RGB) {
+                px = (px & 0xff000000u) | bytes[p] | bytes[p + 1] << 8 | bytes[p + 2] << 16;
+                p += 3;
+            } else if (b1 == QOI_OP_RGBA) {
+                px = qoi_stream_load(bytes + p, 4);
+                p += 4;
+            } else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+                px = dec->index[b1];
+            } else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+                const uint32_t diff = (b1 >> 4 & 0x03) | (b1 << 6 & 0x0300) | (b1 & 0x03) << 16;
+                px = qoi_stream_add_bytes(px, qoi_stream_sub_bytes(diff, 0x00020202u));
+            } else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+                const uint32_t b2 = bytes[p++];
+                const uint32_t vg = (b1 & 0x3f) - 32;
+                const uint32_t diff = ((vg - 8 + (b2 >> 4)) & 0xff) | (vg & 0xff) << 8 | ((vg - 8 + (b2 & 0x0f)) & 0xff) << 16;
+                px = qoi_stream_add_bytes(px, diff);
+            } else {
+                /* QOI_OP_RUN, the current pixel is output by the run too */
+                run = (b1 & 0x3f) + 1;
+                dec->index[qoi_stream_hash(px)] = px;
+                continue;
+            }
+            dec->index[qoi_stream_hash(px)] = px;
+        }
+
+        qoi_stream_store(out, px, channels);
+        out += channels;
+    }
+
+    dec->pos = p;
+    dec->px = px;
+    dec->run = run;
+}
+
+int qoi_stream_decode_row(qoi_stream_decoder_t *dec, void *row)
+{
+    if (dec == NULL || row == NULL || dec->data == NULL || dec->row >= dec->desc.height) {
+        return -1;
+    }
+
+    if (dec->channels == 4) {
+        qoi_stream_decode_pixels(dec, row, 4);
+    } else {
+        qoi_stream_decode_pixels(dec, row, 3);
+    }
+    dec->row++;
+    return 0;
+}
@@ -0,0 +1,365 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+#include "qoi.h"
+#include "qoi_stream.h"
+
+extern const uint8_t golden_qoi[] asm("_binary_golden_result_qoi_start");
+extern const uint8_t golden_qoi_end[] asm("_binary_golden_result_qoi_end");
+#define golden_qoi_len ((size_t)(golden_qoi_end - golden_qoi))
+
+/* Size of the image in examples/qoi_encode */
+#define TEST_GOLDEN_W 160
+#define TEST_GOLDEN_H 120
+
+#define TEST_BENCHMARK_ITERATIONS   100
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_BENCHMARK_UNIT         "ns"
+#else
+#define TEST_BENCHMARK_UNIT         "cycles"
+#endif
+
+/* The same image as in examples/qoi_encode */
+static void test_fill_golden(uint8_t *px, uint32_t width, uint32_t height)
+{
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            size_t i = (y * width + x) * 4;
+            px[i + 0] = (uint8_t)(x * 255 / width);
+            px[i + 1] = (uint8_t)(y * 255 / height);
+            px[i + 2] = (uint8_t)((x + y) * 255 / (width + height));
+            px[i + 3] = 0xff;
+            if (x >= width / 4 && x < 3 * width / 4 &&
+                    y >= height / 4 && y < 3 * height / 4) {
+                px[i + 0] = 0xE0;
+                px[i + 1] = 0x30;
+                px[i + 2] = 0x40;
+            }
+        }
+    }
+}
+
+/* Random image with long runs, repeated colors, small and big differences and changes of alpha */
+static void test_fill_random(uint8_t *px, const qoi_desc *desc, uint32_t seed)
+{
+    const size_t len = (size_t)desc->width * desc->height * desc->channels;
+    uint8_t color[4] = { 0, 0, 0, 255 };
+    for (size_t i = 0; i < len; i += desc->channels) {
+        seed = seed * 1103515245 + 12345;
+        const uint32_t r = seed >> 8;
+        switch (r % 8) {
+        case 0: /* Long run */
+        case 1:
+            break;
+        case 2: /* Small difference */
+            color[0] += (r >> 4) % 4 - 2;
+            color[1] += (r >> 6) % 4 - 2;
+            color[2] += (r >> 8) % 4 - 2;
+            break;
+        case 3: /* Luma difference */
+            color[1] += (r >> 4) % 64 - 32;
+            color[0] = color[1] + (r >> 10) % 16 - 8;
+            color[2] = color[1] + (r >> 14) % 16 - 8;
+            break;
+        case 4: /* One of a few colors */
+            color[0] = (r >> 4) % 4 * 60;
+            color[1] = (r >> 6) % 4 * 60;
+            color[2] = (r >> 8) % 4 * 60;
+            break;
+        case 5: /* Alpha */
+            color[3] = (r >> 4) % 3 * 127;
+            break;
+        default:
+            color[0] = r >> 4;
+            color[1] = r >> 12;
+            color[2] = r >> 20;
+            break;
+        }
+        /* Keep long runs, also across rows */
+        if (r % 8 < 2 && i >= desc->channels) {
+            memcpy(&px[i], &px[i - desc->channels], desc->channels);
+            continue;
+        }
+        memcpy(&px[i], color, desc->channels);
+    }
+}
+
+/* Encode the image row by row, through a buffer of one row */
+static uint8_t *test_stream_encode(const uint8_t *px, const qoi_desc *desc, size_t *out_len)
+{
+    const size_t row_len = desc->width * desc->channels;
+    const size_t row_max = QOI_STREAM_ROW_MAX_SIZE(desc->width, desc->channels);
+    uint8_t *row_out = malloc(row_max);
+    uint8_t *out = malloc(QOI_STREAM_HEADER_SIZE + desc->height * row_max + QOI_STREAM_END_SIZE);
+    TEST_ASSERT_NOT_NULL(row_out);
+    TEST_ASSERT_NOT_NULL(out);
+
+    qoi_stream_encoder_t enc;
+    int ret = qoi_stream_encode_begin(&enc, desc, out, QOI_STREAM_HEADER_SIZE);
+    TEST_ASSERT_EQUAL(QOI_STREAM_HEADER_SIZE, ret);
+    size_t len = ret;
+    for (uint32_t y = 0; y < desc->height; y++) {
+        ret = qoi_stream_encode_row(&enc, px + y * row_len, row_out, row_max);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, ret);
+        memcpy(out + len, row_out, ret);
+        len += ret;
+    }
+    ret = qoi_stream_encode_end(&enc, out + len, QOI_STREAM_END_SIZE);
+    TEST_ASSERT_EQUAL(QOI_STREAM_END_SIZE, ret);
+    *out_len = len + ret;
+
+    free(row_out);
+    return out;
+}
+
+/* Decode the image row by row */
+static uint8_t *test_stream_decode(const uint8_t *qoi, size_t qoi_len, qoi_desc *desc, int channels)
+{
+    qoi_stream_decoder_t dec;
+    TEST_ASSERT_EQUAL(0, qoi_stream_decode_begin(&dec, qoi, qoi_len, desc, channels));
+    if (channels == 0) {
+        channels = desc->channels;
+    }
+    const size_t row_len = desc->width * channels;
+    uint8_t *out = malloc(row_len * desc->height);
+    TEST_ASSERT_NOT_NULL(out);
+    for (uint32_t y = 0; y < desc->height; y++) {
+        TEST_ASSERT_EQUAL(0, qoi_stream_decode_row(&dec, out + y * row_len));
+    }
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_row(&dec, out));
+
+    return out;
+}
+
+/* The stream must be the same as from qoi_encode() and decode to the same pixels as with qoi_decode() */
+static void test_stream_same(const uint8_t *px, const qoi_desc *desc)
+{
+    int ref_len;
+    uint8_t *ref = qoi_encode(px, desc, &ref_len);
+    TEST_ASSERT_NOT_NULL(ref);
+
+    size_t len;
+    uint8_t *out = test_stream_encode(px, desc, &len);
+    TEST_ASSERT_EQUAL(ref_len, len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, out, len);
+
+    for (int channels = 3; channels <= 4; channels++) {
+        qoi_desc ref_desc, out_desc;
+        uint8_t *ref_px = qoi_decode(ref, ref_len, &ref_desc, channels);
+        TEST_ASSERT_NOT_NULL(ref_px);
+        uint8_t *out_px = test_stream_decode(out, len, &out_desc, channels);
+        TEST_ASSERT_EQUAL(ref_desc.width, out_desc.width);
+        TEST_ASSERT_EQUAL(ref_desc.height, out_desc.height);
+        TEST_ASSERT_EQUAL(ref_desc.channels, out_desc.channels);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(ref_px, out_px, desc->width * desc->height * channels);
+        if (channels == desc->channels) {
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(px, out_px, desc->width * desc->height * channels);
+        }
+        free(ref_px);
+        free(out_px);
+    }
+
+    free(out);
+    free(ref);
+}
+
+TEST_CASE("QOI stream: golden image", "[qoi]")
+{
+    const qoi_desc desc = {
+        .width = TEST_GOLDEN_W,
+        .height = TEST_GOLDEN_H,
+        .channels = 4,
+        .colorspace = QOI_SRGB,
+    };
+    uint8_t *px = malloc(TEST_GOLDEN_W * TEST_GOLDEN_H * 4);
+    TEST_ASSERT_NOT_NULL(px);
+    test_fill_golden(px, desc.width, desc.height);
+
+    size_t len;
+    uint8_t *out = test_stream_encode(px, &desc, &len);
+    TEST_ASSERT_EQUAL(golden_qoi_len, len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(golden_qoi, out, len);
+    free(out);
+
+    test_stream_same(px, &desc);
+
+    qoi_desc out_desc;
+    out = test_stream_decode(golden_qoi, golden_qoi_len, &out_desc, 0);
+    TEST_ASSERT_EQUAL(4, out_desc.channels);
+    TEST_ASSERT_EQUAL(QOI_SRGB, out_desc.colorspace);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(px, out, TEST_GOLDEN_W * TEST_GOLDEN_H * 4);
+    free(out);
+    free(px);
+}
+
+TEST_CASE("QOI stream: random images", "[qoi]")
+{
+    const struct {
+        uint32_t width;
+        uint32_t height;
+    } sizes[] = {
+        { 1, 1 },
+        { 1, 100 },
+        { 7, 5 },
+        { 100, 3 },
+        { 321, 17 },
+    };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (uint8_t channels = 3; channels <= 4; channels++) {
+            const qoi_desc desc = {
+                .width = sizes[i].width,
+                .height = sizes[i].height,
+                .channels = channels,
+                .colorspace = QOI_LINEAR,
+            };
+            uint8_t *px = malloc(desc.width * desc.height * channels);
+            TEST_ASSERT_NOT_NULL(px);
+            test_fill_random(px, &desc, i * 10 + channels);
+            test_stream_same(px, &desc);
+
+            /* Runs longer than QOI_OP_RUN and across rows, also up to the end of the image */
+            memset(px, 0x55, desc.width * desc.height * channels);
+            test_stream_same(px, &desc);
+            free(px);
+        }
+    }
+}
+
+TEST_CASE("QOI stream: invalid arguments", "[qoi]")
+{
+    const qoi_desc desc = {
+        .width = 4,
+        .height = 2,
+        .channels = 4,
+        .colorspace = QOI_SRGB,
+    };
+    uint8_t px[4 * 4] = { 0 };
+    uint8_t out[QOI_STREAM_ROW_MAX_SIZE(4, 4)];
+    qoi_stream_encoder_t enc;
+    qoi_desc bad = desc;
+    bad.channels = 2;
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_begin(&enc, &bad, out, sizeof(out)));
+    bad = desc;
+    bad.width = 0;
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_begin(&enc, &bad, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_begin(&enc, &desc, out, QOI_STREAM_HEADER_SIZE - 1));
+
+    TEST_ASSERT_EQUAL(QOI_STREAM_HEADER_SIZE, qoi_stream_encode_begin(&enc, &desc, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_row(&enc, px, out, sizeof(out) - 1));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_end(&enc, out, sizeof(out)));
+    TEST_ASSERT_GREATER_OR_EQUAL(0, qoi_stream_encode_row(&enc, px, out, sizeof(out)));
+    TEST_ASSERT_GREATER_OR_EQUAL(0, qoi_stream_encode_row(&enc, px, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_row(&enc, px, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_encode_end(&enc, out, QOI_STREAM_END_SIZE - 1));
+    TEST_ASSERT_EQUAL(QOI_STREAM_END_SIZE, qoi_stream_encode_end(&enc, out, sizeof(out)));
+
+    qoi_stream_decoder_t dec;
+    uint8_t bad_qoi[64];
+    memcpy(bad_qoi, golden_qoi, sizeof(bad_qoi));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_begin(&dec, bad_qoi, QOI_STREAM_HEADER_SIZE + QOI_STREAM_END_SIZE - 1, NULL, 0));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_begin(&dec, bad_qoi, sizeof(bad_qoi), NULL, 2));
+    bad_qoi[0] = 'Q';
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_begin(&dec, bad_qoi, sizeof(bad_qoi), NULL, 0));
+    bad_qoi[0] = 'q';
+    bad_qoi[12] = 5;
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_begin(&dec, bad_qoi, sizeof(bad_qoi), NULL, 0));
+    TEST_ASSERT_EQUAL(-1, qoi_stream_decode_row(NULL, px));
+}
+
+/* CPU cycles on the chip, nanoseconds on the Linux target */
+static uint64_t test_benchmark_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/**
+ * @brief Benchmark of the streaming codec against qoi_encode() and qoi_decode() with the image of examples/qoi_encode
+ *
+ * The results are printed per pixel.
+ */
+TEST_CASE("QOI stream benchmark", "[qoi][benchmark]")
+{
+    const qoi_desc desc = {
+        .width = TEST_GOLDEN_W,
+        .height = TEST_GOLDEN_H,
+        .channels = 4,
+        .colorspace = QOI_SRGB,
+    };
+    const size_t row_len = TEST_GOLDEN_W * 4;
+    const size_t row_max = QOI_STREAM_ROW_MAX_SIZE(TEST_GOLDEN_W, 4);
+    const uint32_t pixels = TEST_GOLDEN_W * TEST_GOLDEN_H;
+    uint8_t *px = malloc(pixels * 4);
+    uint8_t *out = malloc(QOI_STREAM_HEADER_SIZE + TEST_GOLDEN_H * row_max + QOI_STREAM_END_SIZE);
+    TEST_ASSERT_NOT_NULL(px);
+    TEST_ASSERT_NOT_NULL(out);
+    test_fill_golden(px, desc.width, desc.height);
+
+    uint64_t encode = 0, stream_encode = 0, decode = 0, stream_decode = 0;
+    for (int i = 0; i < TEST_BENCHMARK_ITERATIONS; i++) {
+        int len;
+        uint64_t start = test_benchmark_now();
+        void *ref = qoi_encode(px, &desc, &len);
+        encode += test_benchmark_now() - start;
+        TEST_ASSERT_NOT_NULL(ref);
+        free(ref);
+
+        /* The whole stream is written into one buffer, so the time is the time of the encoder only */
+        qoi_stream_encoder_t enc;
+        start = test_benchmark_now();
+        size_t stream_len = qoi_stream_encode_begin(&enc, &desc, out, QOI_STREAM_HEADER_SIZE);
+        for (uint32_t y = 0; y < TEST_GOLDEN_H; y++) {
+            stream_len += qoi_stream_encode_row(&enc, px + y * row_len, out + stream_len, row_max);
+        }
+        stream_len += qoi_stream_encode_end(&enc, out + stream_len, QOI_STREAM_END_SIZE);
+        stream_encode += test_benchmark_now() - start;
+        TEST_ASSERT_EQUAL(golden_qoi_len, stream_len);
+
+        qoi_desc ref_desc;
+        start = test_benchmark_now();
+        ref = qoi_decode(golden_qoi, golden_qoi_len, &ref_desc, 4);
+        decode += test_benchmark_now() - start;
+        TEST_ASSERT_NOT_NULL(ref);
+        free(ref);
+
+        /* Every row is decoded into the same buffer */
+        qoi_stream_decoder_t dec;
+        start = test_benchmark_now();
+        qoi_stream_decode_begin(&dec, golden_qoi, golden_qoi_len, NULL, 4);
+        for (uint32_t y = 0; y < TEST_GOLDEN_H; y++) {
+            qoi_stream_decode_row(&dec, px);
+        }
+        stream_decode += test_benchmark_now() - start;
+        test_fill_golden(px, desc.width, desc.height);
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(golden_qoi, out, golden_qoi_len);
+
+    const uint64_t n = (uint64_t)TEST_BENCHMARK_ITERATIONS * pixels;
+    printf("QOI %dx%d: qoi_encode %" PRIu64 ", stream encode %" PRIu64 ", qoi_decode %" PRIu64
+           ", stream decode %" PRIu64 " " TEST_BENCHMARK_UNIT "/100 pixels\n",
+           TEST_GOLDEN_W, TEST_GOLDEN_H, encode * 100 / n, stream_encode * 100 / n,
+           decode * 100 / n, stream_decode * 100 / n);
+
+    free(out);
+    free(px);
+}